@@ -0,0 +1,128 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_ARENA_H
+#define NJUDB_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "../../common/error.h"
+#include "../../common/micro.h"
+#include "config.h"
+
+namespace njudb {
+
+/**
+ * A bump allocator for memory with the lifetime of a query or of a chunk, such as the rows of a chunk materialized as
+ * RecordView to be sent, sorted or ranked. Allocating moves a pointer forward in the current block, a new block is
+ * taken when it is full, and nothing is freed on its own: Reset releases everything at once and keeps the first block
+ * for the next use. Requests larger than a block get a block of their own. An arena is used by one thread at a time.
+ */
+class Arena
+{
+public:
+  explicit Arena(size_t block_size = ARENA_BLOCK_SIZE) : block_size_(block_size) {}
+
+  ~Arena() = default;
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(Arena)
+
+  /**
+   * @return size bytes aligned to align, valid until Reset or the arena is destroyed
+   * @param align a power of 2 no larger than alignof(std::max_align_t)
+   */
+  auto Allocate(size_t size, size_t align = alignof(std::max_align_t)) -> char *
+  {
+    NJUDB_ASSERT(align != 0 && (align & (align - 1)) == 0 && align <= alignof(std::max_align_t), "invalid alignment");
+    auto pos = (pos_ + align - 1) & ~(align - 1);
+    if (blocks_.empty() || pos + size > blocks_.back().size_) {
+      // a new block starts at the alignment of new
+      NewBlock(size);
+      pos = 0;
+    }
+    pos_ = pos + size;
+    used_ += size;
+    return blocks_.back().data_.get() + pos;
+  }
+
+  /**
+   * @return a copy of size bytes of src
+   */
+  auto Copy(const char *src, size_t size) -> char *
+  {
+    auto dst = Allocate(size, 1);
+    std::memcpy(dst, src, size);
+    return dst;
+  }
+
+  /**
+   * Release all the memory allocated, the first block is kept and the others are freed
+   */
+  void Reset()
+  {
+    if (blocks_.size() > 1) {
+      blocks_.resize(1);
+    }
+    pos_  = 0;
+    used_ = 0;
+  }
+
+  /**
+   * @return bytes allocated since the last Reset
+   */
+  [[nodiscard]] auto GetUsedBytes() const -> size_t { return used_; }
+
+  /**
+   * @return bytes of the blocks held
+   */
+  [[nodiscard]] auto GetReservedBytes() const -> size_t
+  {
+    size_t reserved = 0;
+    for (const auto &block : blocks_) {
+      reserved += block.size_;
+    }
+    return reserved;
+  }
+
+private:
+  struct Block
+  {
+    std::unique_ptr<char[]> data_;
+    size_t                  size_;
+  };
+
+  void NewBlock(size_t need)
+  {
+    auto size = std::max(block_size_, need);
+    blocks_.push_back({std::unique_ptr<char[]>(new char[size]), size});
+    pos_ = 0;
+  }
+
+  size_t             block_size_;
+  std::vector<Block> blocks_;
+  size_t             pos_{0};  // bytes before it in the last block are allocated
+  size_t             used_{0};
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_ARENA_H
@@ -23,23 +23,71 @@
 #define NJUDB_CONFIG_H
 #include <string>
 /// storage
-constexpr size_t  PAGE_SIZE        = 4096;
-constexpr size_t  BUFFER_POOL_SIZE = 8;
+// page size is chosen when building njudb (cmake -DNJUDB_PAGE_SIZE=...), 4/8/16 KiB are supported,
+// it is recorded in the header of every table file so that files formatted with another page size are rejected
+#ifndef NJUDB_PAGE_SIZE
+#define NJUDB_PAGE_SIZE 4096
+#endif
+constexpr size_t PAGE_SIZE = NJUDB_PAGE_SIZE;
+static_assert(PAGE_SIZE == 4096 || PAGE_SIZE == 8192 || PAGE_SIZE == 16384, "page size must be 4, 8 or 16 KiB");
+// alignment of the buffers, offsets and sizes of direct io, the logical block size of common devices
+constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+static_assert(PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0, "pages must be aligned for direct io");
+// table and index files grow by extents of EXTENT_PAGES pages preallocated on disk, see DiskManager::AllocatePage
+constexpr size_t EXTENT_PAGES = 64;
+// default number of frames in the buffer pool, overridden by the --buffer-pool-size startup option
+constexpr size_t BUFFER_POOL_SIZE = 8;
+// number of latch-sharded partitions in the buffer pool, 1 means a single latch for the whole pool
+constexpr size_t BUFFER_POOL_PARTITIONS = 1;
+// read-ahead window of sequential scans in pages, it starts small, doubles while the scan stays sequential and is
+// capped by READ_AHEAD_MAX_PAGES and a quarter of the buffer pool
+constexpr size_t READ_AHEAD_INIT_PAGES = 4;
+constexpr size_t READ_AHEAD_MAX_PAGES  = 64;
+// dirty pages are copied to a staging buffer before they are written back, a vectored write covers at most
+// WRITE_BACK_MAX_PAGES adjacent pages
+constexpr size_t WRITE_BACK_MAX_PAGES = 64;
+// the background flusher of the buffer pool wakes up every FLUSHER_INTERVAL_MS and writes back the dirty unpinned
+// frames once the ratio of dirty frames reaches FLUSHER_DIRTY_RATIO, or FLUSHER_CHECKPOINT_INTERVAL_MS has passed since
+// the last write-back
+constexpr double FLUSHER_DIRTY_RATIO            = 0.5;
+constexpr size_t FLUSHER_INTERVAL_MS            = 100;
+constexpr size_t FLUSHER_CHECKPOINT_INTERVAL_MS = 5000;
+// LRUReplacer, LRUKReplacer, ARCReplacer or TwoQueueReplacer
 const std::string REPLACER         = "LRUReplacer";
 // enable this to use LRUKReplacer
 const size_t REPLACER_LRU_K = 10;
 /// system
 constexpr size_t MAX_REC_SIZE = 1024;
+// VARCHAR values longer than it are moved out of the slotted page into overflow pages
+constexpr size_t VARCHAR_INLINE_SIZE = PAGE_SIZE / 8;
+// a record with VARCHAR fields is limited by VARCHAR_REC_SIZE in memory instead of MAX_REC_SIZE
+constexpr size_t VARCHAR_REC_SIZE = 64 * 1024;
+// a compressed PAX page has COMPRESSED_PAX_SLOT_FACTOR times the slots of a PAX page, inserts stop at
+// COMPRESSED_PAX_RESERVE bytes of free space so that updates, which may encode worse, still fit
+constexpr size_t COMPRESSED_PAX_SLOT_FACTOR = 4;
+constexpr size_t COMPRESSED_PAX_RESERVE     = PAGE_SIZE / 16;
 /// executor
 // 64MB, used for sort executor's buffer
 constexpr size_t SORT_BUFFER_SIZE = 64 * 1024 * 1024;
 // 10-way merge sort, max tmp file to use in merge sort
 constexpr size_t SORT_WAY_NUM = 10;
+// worker threads of ExternalSorter, 0 uses all the hardware threads
+constexpr size_t SORT_THREAD_NUM = 0;
+// ExternalSorter writes its runs and reads them ahead in blocks of at most SORT_RUN_BLOCK_SIZE bytes
+constexpr size_t SORT_RUN_BLOCK_SIZE = 1024 * 1024;
+// a sort under a limit of at most TOPN_MAX_LIMIT records keeps them in a heap instead of sorting all the records
+constexpr size_t TOPN_MAX_LIMIT = 64 * 1024;
+// number of records in a chunk of the vectorized executors, see VectorChunk
+constexpr size_t VECTOR_SIZE = 1024;
+// bytes of a block of the per-query arena, see Arena
+constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
 
 const std::string DB_SUFFIX  = ".db";
 const std::string TAB_SUFFIX = ".tab";
 const std::string IDX_SUFFIX = ".idx";
 const std::string TMP_SUFFIX = ".tmp";
+// zone map of a table, saved when the table is closed
+const std::string ZMP_SUFFIX = ".zmp";
 
 const std::string DB_DIR  = "db";
 const std::string TAB_DIR = "tab";
@@ -0,0 +1,176 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_FIELD_ACCESS_H
+#define NJUDB_FIELD_ACCESS_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+#include "../../common/error.h"
+#include "types.h"
+
+namespace njudb {
+
+template <FieldType Type>
+struct FieldTraits;
+
+template <>
+struct FieldTraits<TYPE_BOOL>
+{
+  using ValueType = bool;
+};
+
+template <>
+struct FieldTraits<TYPE_INT>
+{
+  using ValueType = int32_t;
+};
+
+template <>
+struct FieldTraits<TYPE_FLOAT>
+{
+  using ValueType = float;
+};
+
+template <>
+struct FieldTraits<TYPE_STRING>
+{
+  using ValueType = std::string_view;
+};
+
+template <>
+struct FieldTraits<TYPE_VARCHAR>
+{
+  using ValueType = std::string_view;
+};
+
+/**
+ * Typed access to a field in the memory of a record, i.e. Record::GetData() plus the field offset. The field is read
+ * as its C++ type without creating a Value, and compared and hashed with the same semantics as the Value subclasses:
+ * a string ends at its first '\0' or at the field size. The access of each type is generated at compile time, the
+ * functions returned by GetFieldCompareFn and GetFieldHashFn are picked once from the schema and called per record.
+ */
+template <FieldType Type>
+class FieldAccess
+{
+public:
+  using ValueType = typename FieldTraits<Type>::ValueType;
+
+  static auto Load(const char *mem, size_t size) -> ValueType
+  {
+    if constexpr (std::is_same_v<ValueType, std::string_view>) {
+      return {mem, strnlen(mem, size)};
+    } else {
+      ValueType value;
+      std::memcpy(&value, mem, sizeof(ValueType));
+      return value;
+    }
+  }
+
+  static auto Compare(const char *lhs, size_t lsize, const char *rhs, size_t rsize) -> int
+  {
+    return Compare(Load(lhs, lsize), Load(rhs, rsize));
+  }
+
+  static auto Compare(ValueType lhs, ValueType rhs) -> int
+  {
+    if constexpr (std::is_same_v<ValueType, std::string_view>) {
+      auto res = lhs.compare(rhs);
+      return res < 0 ? -1 : (res > 0 ? 1 : 0);
+    } else {
+      return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+    }
+  }
+
+  static auto Hash(const char *mem, size_t size) -> size_t
+  {
+    auto value = Load(mem, size);
+    if constexpr (std::is_same_v<ValueType, std::string_view> || std::is_same_v<ValueType, bool>) {
+      return std::hash<ValueType>{}(value);
+    } else {
+      // numbers are hashed as double, which holds any INT or FLOAT exactly, so that equal keys of the two types
+      // hash the same, +0.0 and -0.0 are equal
+      auto number = static_cast<double>(value);
+      return std::hash<double>{}(number == 0 ? 0.0 : number);
+    }
+  }
+};
+
+/// compare two fields, returns -1, 0 or 1
+using FieldCompareFn = int (*)(const char *lhs, size_t lsize, const char *rhs, size_t rsize);
+
+using FieldHashFn = size_t (*)(const char *mem, size_t size);
+
+namespace detail {
+
+// an INT and a FLOAT are compared as floats, like ValueFactory::AlignTypes
+template <FieldType LType, FieldType RType>
+auto CompareNumbers(const char *lhs, size_t lsize, const char *rhs, size_t rsize) -> int
+{
+  return FieldAccess<TYPE_FLOAT>::Compare(static_cast<float>(FieldAccess<LType>::Load(lhs, lsize)),
+      static_cast<float>(FieldAccess<RType>::Load(rhs, rsize)));
+}
+
+inline auto IsString(FieldType type) -> bool { return type == TYPE_STRING || type == TYPE_VARCHAR; }
+
+}  // namespace detail
+
+/**
+ * @return the function comparing a field of ltype with a field of rtype, the types should be the same, or both strings,
+ * or an INT and a FLOAT
+ */
+inline auto GetFieldCompareFn(FieldType ltype, FieldType rtype) -> FieldCompareFn
+{
+  if (detail::IsString(ltype) && detail::IsString(rtype)) {
+    return &FieldAccess<TYPE_STRING>::Compare;
+  }
+  if (ltype == TYPE_INT && rtype == TYPE_FLOAT) {
+    return &detail::CompareNumbers<TYPE_INT, TYPE_FLOAT>;
+  }
+  if (ltype == TYPE_FLOAT && rtype == TYPE_INT) {
+    return &detail::CompareNumbers<TYPE_FLOAT, TYPE_INT>;
+  }
+  if (ltype == rtype) {
+    switch (ltype) {
+      case TYPE_BOOL: return &FieldAccess<TYPE_BOOL>::Compare;
+      case TYPE_INT: return &FieldAccess<TYPE_INT>::Compare;
+      case TYPE_FLOAT: return &FieldAccess<TYPE_FLOAT>::Compare;
+      default: break;
+    }
+  }
+  NJUDB_THROW(NJUDB_TYPE_MISSMATCH, fmt::format("{} != {}", FieldTypeToString(ltype), FieldTypeToString(rtype)));
+}
+
+inline auto GetFieldHashFn(FieldType type) -> FieldHashFn
+{
+  switch (type) {
+    case TYPE_BOOL: return &FieldAccess<TYPE_BOOL>::Hash;
+    case TYPE_INT: return &FieldAccess<TYPE_INT>::Hash;
+    case TYPE_FLOAT: return &FieldAccess<TYPE_FLOAT>::Hash;
+    case TYPE_STRING:
+    case TYPE_VARCHAR: return &FieldAccess<TYPE_STRING>::Hash;
+    default: NJUDB_THROW(NJUDB_UNSUPPORTED_OP, fmt::format("hash {}", FieldTypeToString(type)));
+  }
+}
+
+}  // namespace njudb
+
+#endif  // NJUDB_FIELD_ACCESS_H
@@ -26,6 +26,7 @@
 #include <memory>
 #include "../../common/micro.h"
 #include "types.h"
+#include "config.h"
 
 struct FieldSchema;
 
@@ -80,19 +81,28 @@ struct RTField
   }
 };
 
+// a table file starts with TABLE_FILE_MAGIC and the version of its layout. Files written before the header had them
+// are upgraded when they are opened, see TableManager::OpenTable
+constexpr uint32_t TABLE_FILE_MAGIC   = 0x42444A4E;  // "NJDB"
+constexpr uint32_t TABLE_FILE_VERSION = 1;
+
 /**
  * Table header is the first page of a table, it contains the meta information of the table
  */
 struct TableHeader
 {
+  uint32_t  magic_{TABLE_FILE_MAGIC};
+  uint32_t  version_{TABLE_FILE_VERSION};
   size_t    page_num_{0};
-  page_id_t first_free_page_{INVALID_PAGE_ID};
   size_t    rec_num_{0};
   size_t    rec_size_{0};
   size_t    rec_per_page_{0};
   size_t    field_num_{0};
-  size_t    bitmap_size_{0};   // bit map size == BITMAP_SIZE(n_rec_per_page)
-  size_t    nullmap_size_{0};  // null map size == BITMAP_SIZE(n_field)
+  size_t    bitmap_size_{0};                       // bit map size == BITMAP_SIZE(n_rec_per_page)
+  size_t    nullmap_size_{0};                      // null map size == BITMAP_SIZE(n_field)
+  size_t    page_size_{PAGE_SIZE};                 // page size the table file is formatted with
+  size_t    extent_end_{0};                        // pages before it are preallocated, see DiskManager::AllocatePage
+  page_id_t free_overflow_page_{INVALID_PAGE_ID};  // head of the freed overflow pages, see OverflowStore
 };
 
 #endif  // NJUDB_META_H
@@ -22,6 +22,7 @@
 #ifndef NJUDB_PAGE_H
 #define NJUDB_PAGE_H
 
+#include <mutex>  // NOLINT
 #include "../../common/micro.h"
 #include "config.h"
 #include "types.h"
@@ -54,6 +55,12 @@ public:
 
   auto GetData() -> char * { return data_; }
 
+  // bind the page to its buffer of PAGE_SIZE bytes, the buffer is owned by the buffer pool
+  void SetData(char *data) { data_ = data; }
+
+  // serializes the writers of the records in the page, held only while the page is pinned
+  auto GetLatch() -> std::mutex & { return latch_; }
+
   auto GetLsn() -> lsn_t
   {
     NJUDB_ASSERT(pid_ != FILE_HEADER_PAGE_ID, "Can't load data from file header page");
@@ -94,13 +101,16 @@ public:
   {
     fid_ = INVALID_FILE_ID;
     pid_ = INVALID_PAGE_ID;
-    memset(data_, 0, PAGE_SIZE);
+    if (data_ != nullptr) {
+      memset(data_, 0, PAGE_SIZE);
+    }
   }
 
 private:
-  file_id_t fid_{INVALID_FILE_ID};
-  page_id_t pid_{INVALID_PAGE_ID};
-  char      data_[PAGE_SIZE]{};
+  file_id_t  fid_{INVALID_FILE_ID};
+  page_id_t  pid_{INVALID_PAGE_ID};
+  char      *data_{nullptr};
+  std::mutex latch_;
 };
 
 #endif  // NJUDB_PAGE_H
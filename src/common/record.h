@@ -22,11 +22,14 @@
 #ifndef NJUDB_RECORD_MANAGER_H
 #define NJUDB_RECORD_MANAGER_H
 
+#include <algorithm>
 #include "../../common/micro.h"
+#include "arena.h"
 #include "meta.h"
 #include "rid.h"
 #include "value.h"
 #include "bitmap.h"
+#include "field_access.h"
 
 namespace njudb {
 
@@ -119,6 +122,40 @@ public:
 
   [[nodiscard]] auto GetRecordLength() const -> size_t { return rec_len_; }
 
+  [[nodiscard]] auto IsVarField(size_t index) const -> bool
+  {
+    NJUDB_ASSERT(index < fields_.size(), "Index out of range");
+    return fields_[index].field_.field_type_ == TYPE_VARCHAR;
+  }
+
+  [[nodiscard]] auto HasVarField() const -> bool { return GetVarFieldCount() > 0; }
+
+  /**
+   * The counts below are not kept in members, the gold libraries of the labs build schemas of the layout without them
+   */
+  [[nodiscard]] auto GetVarFieldCount() const -> size_t
+  {
+    return static_cast<size_t>(std::count_if(fields_.begin(), fields_.end(), [](const RTField &field) {
+      return field.field_.field_type_ == TYPE_VARCHAR;
+    }));
+  }
+
+  /**
+   * In memory, a VARCHAR(n) field takes n bytes like CHAR(n) so that records keep a fixed length, only pages store the
+   * values at their actual lengths (see SlottedPageHandle)
+   * @return the total length of the fields that are not VARCHAR
+   */
+  [[nodiscard]] auto GetFixedLength() const -> size_t
+  {
+    size_t len = 0;
+    for (const auto &field : fields_) {
+      if (field.field_.field_type_ != TYPE_VARCHAR) {
+        len += field.field_.field_size_;
+      }
+    }
+    return len;
+  }
+
   [[nodiscard]] auto GetFieldCount() const -> size_t { return fields_.size(); }
 
   auto HasField(table_id_t tid, const std::string &name) -> bool
@@ -228,8 +265,7 @@ public:
    */
   Record(const RecordSchema *schema, const char *null_map_mem, const char *data, RID rid) : schema_(schema)
   {
-    data_    = new char[schema_->GetRecordLength()];
-    nullmap_ = new char[BITMAP_SIZE(schema_->GetFieldCount())];
+    Allocate();
     std::memcpy(data_, data, schema_->GetRecordLength());
     if (null_map_mem == nullptr) {
       memset(nullmap_, 0, BITMAP_SIZE(schema_->GetFieldCount()));
@@ -248,8 +284,7 @@ public:
   Record(const RecordSchema *schema, const std::vector<ValueSptr> &values, RID rid)
   {
     schema_  = schema;
-    data_    = new char[schema_->GetRecordLength()];
-    nullmap_ = new char[BITMAP_SIZE(schema_->GetFieldCount())];
+    Allocate();
     memset(data_, 0, schema_->GetRecordLength());
     memset(nullmap_, 0, BITMAP_SIZE(schema_->GetFieldCount()));
     size_t cursor = 0;
@@ -289,7 +324,8 @@ public:
             *reinterpret_cast<float *>(data_ + cursor) = value->Get();
             break;
           }
-          case FieldType::TYPE_STRING: {
+          case FieldType::TYPE_STRING:
+          case FieldType::TYPE_VARCHAR: {
             auto value = std::dynamic_pointer_cast<StringValue>(values[i]);
             if (value == nullptr)
               NJUDB_THROW(NJUDB_TYPE_MISSMATCH,
@@ -322,8 +358,7 @@ public:
   Record(const RecordSchema *schema, const Record &other) : schema_(schema)
   {
     // new can deal with GetRecordLength() == 0
-    data_    = new char[schema_->GetRecordLength()];
-    nullmap_ = new char[BITMAP_SIZE(schema_->GetFieldCount())];
+    Allocate();
     memset(data_, 0, schema_->GetRecordLength());
     memset(nullmap_, 0, BITMAP_SIZE(schema_->GetFieldCount()));
     for (size_t i = 0; i < schema_->GetFieldCount(); ++i) {
@@ -355,8 +390,7 @@ public:
     NJUDB_ASSERT(schema->GetRecordLength() == rec1.schema_->GetRecordLength() + rec2.schema_->GetRecordLength(),
         "Record length mismatch");
     schema_  = schema;
-    data_    = new char[schema_->GetRecordLength()];
-    nullmap_ = new char[BITMAP_SIZE(schema_->GetFieldCount())];
+    Allocate();
     memset(data_, 0, schema_->GetRecordLength());
     memset(nullmap_, 0, BITMAP_SIZE(schema_->GetFieldCount()));
     memcpy(data_, rec1.data_, rec1.schema_->GetRecordLength());
@@ -382,8 +416,7 @@ public:
   explicit Record(const RecordSchema *schema)
   {
     schema_  = schema;
-    data_    = new char[schema_->GetRecordLength()];
-    nullmap_ = new char[BITMAP_SIZE(schema_->GetFieldCount())];
+    Allocate();
     // set nullmap to all 1
     memset(data_, 0, schema_->GetRecordLength());
     memset(nullmap_, 0xff, BITMAP_SIZE(schema_->GetFieldCount()));
@@ -396,12 +429,9 @@ public:
     delete[] nullmap_;
   }
 
-  Record(const Record &record)
-      : schema_(record.schema_),
-        data_(new char[schema_->GetRecordLength()]),
-        nullmap_(new char[BITMAP_SIZE(schema_->GetFieldCount())]),
-        rid_(record.rid_)
+  Record(const Record &record) : schema_(record.schema_), rid_(record.rid_)
   {
+    Allocate();
     std::memcpy(data_, record.data_, schema_->GetRecordLength());
     std::memcpy(nullmap_, record.nullmap_, BITMAP_SIZE(schema_->GetFieldCount()));
   }
@@ -411,9 +441,10 @@ public:
     if (this == &record) {
       return *this;
     }
-    schema_  = record.schema_;
-    data_    = new char[schema_->GetRecordLength()];
-    nullmap_ = new char[BITMAP_SIZE(schema_->GetFieldCount())];
+    delete[] data_;
+    delete[] nullmap_;
+    schema_ = record.schema_;
+    Allocate();
     std::memcpy(data_, record.data_, schema_->GetRecordLength());
     std::memcpy(nullmap_, record.nullmap_, BITMAP_SIZE(schema_->GetFieldCount()));
     rid_ = record.rid_;
@@ -453,6 +484,10 @@ public:
            std::memcmp(nullmap_, other.nullmap_, BITMAP_SIZE(schema_->GetFieldCount())) == 0;
   }
 
+  /**
+   * HashIndex places its keys into buckets by this hash, so it must not change for the indexes already on disk. It
+   * hashes fields by their own types, use RecordHasher for keys that mix INT and FLOAT fields.
+   */
   [[nodiscard]] auto Hash() const -> size_t
   {
     // use schema and data_ to generate hash
@@ -473,6 +508,7 @@ public:
           hash ^= std::hash<float>{}(*reinterpret_cast<const float *>(data_ + schema_->offsets_[i]));
           break;
         case FieldType::TYPE_STRING:
+        case FieldType::TYPE_VARCHAR:
           hash ^= std::hash<std::string>{}(std::string(data_ + schema_->offsets_[i], field.field_.field_size_));
           break;
         default: NJUDB_FATAL("Unsupported field type to hash");
@@ -513,31 +549,40 @@ public:
 
   [[nodiscard]] auto GetNullMap() const -> const char * { return nullmap_; }
 
+  [[nodiscard]] auto IsNull(size_t index) const -> bool { return BitMap::GetBit(nullmap_, index); }
+
+  /**
+   * @return the raw bytes of the field, read them by FieldAccess of the field type
+   */
+  [[nodiscard]] auto GetField(size_t index) const -> const char * { return data_ + schema_->offsets_[index]; }
+
   static auto Compare(const Record &lrec, const Record &rrec) -> int
   {
     // compare two records,
     //  NJUDB_ASSERT(Record, Compare, lrec.GetSchema() == rrec.GetSchema(), "Schema mismatch");
     // more loose assert to support two similar records
     NJUDB_ASSERT(lrec.GetSchema()->GetFieldCount() == rrec.GetSchema()->GetFieldCount(), "field count mismatch");
+    // fields are read in place by their types, use RecordComparator to compare many records of the same schemas
     for (size_t i = 0; i < lrec.GetSchema()->GetFieldCount(); ++i) {
-      auto lval = lrec.GetValueAt(i);
-      auto rval = rrec.GetValueAt(i);
-      if (lval->IsNull() && rval->IsNull()) {
+      auto lnull = lrec.IsNull(i);
+      auto rnull = rrec.IsNull(i);
+      if (lnull && rnull) {
         continue;
       }
-      if (lval->IsNull() || rval->IsNull()) {
-        return lval->IsNull() ? -1 : 1;
+      if (lnull || rnull) {
+        return lnull ? -1 : 1;
       }
-      if (*lval < *rval) {
-        return -1;
-      }
-      if (*lval > *rval) {
-        return 1;
+      auto &lfield = lrec.GetSchema()->GetFieldAt(i).field_;
+      auto &rfield = rrec.GetSchema()->GetFieldAt(i).field_;
+      auto  res    = GetFieldCompareFn(lfield.field_type_, rfield.field_type_)(
+          lrec.GetField(i), lfield.field_size_, rrec.GetField(i), rfield.field_size_);
+      if (res != 0) {
+        return res;
       }
     }
     return 0;
   }
-  
+
   [[nodiscard]] auto ToString() const -> std::string
   {
     std::string str = "{";
@@ -553,9 +598,160 @@ public:
   }
 
 private:
+  // the data and the null map are allocated apart, the records built and freed by the gold libraries of the labs
+  // expect so
+  void Allocate()
+  {
+    data_    = new char[schema_->GetRecordLength()];
+    nullmap_ = new char[BITMAP_SIZE(schema_->GetFieldCount())];
+  }
+
   const RecordSchema *schema_;
-  char               *data_;
-  char               *nullmap_;
+  char               *data_{nullptr};
+  char               *nullmap_{nullptr};
+  RID                 rid_{};
+};
+
+/**
+ * A record that does not own its memory, it points to the data and the null map of a Record, or of a record built in
+ * an Arena by the factories below. A view is passed by value without copying the record. A view is valid as long as
+ * the memory it points to, materialize it by ToRecord to keep it longer.
+ * The rows of vectorized chunks are sent, sorted and ranked as views built in an arena (see
+ * VectorChunk::GetRecordView). Project, Concat and MakeNull mirror the Record constructors used by the tuple projection
+ * and joins, which are lab exercises that pass records as RecordUptr through AbstractExecutor::GetRecord, so they do
+ * not build their records in an arena yet.
+ */
+class RecordView
+{
+public:
+  RecordView() = default;
+
+  RecordView(const RecordSchema *schema, const char *null_map, const char *data, RID rid = INVALID_RID)
+      : schema_(schema), data_(data), nullmap_(null_map), rid_(rid)
+  {}
+
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  RecordView(const Record &record)
+      : schema_(record.GetSchema()), data_(record.GetData()), nullmap_(record.GetNullMap()), rid_(record.GetRID())
+  {}
+
+  /**
+   * Copy a record into the arena
+   */
+  static auto Copy(Arena &arena, const RecordView &other) -> RecordView
+  {
+    auto mem = Alloc(arena, other.schema_);
+    std::memcpy(mem, other.data_, other.schema_->GetRecordLength());
+    std::memcpy(mem + other.schema_->GetRecordLength(), other.nullmap_, BITMAP_SIZE(other.schema_->GetFieldCount()));
+    return {other.schema_, mem + other.schema_->GetRecordLength(), mem, other.rid_};
+  }
+
+  /**
+   * Build the fields of schema from another record in the arena, like Record(schema, other)
+   * @param schema should be a subset of the schema of other
+   */
+  static auto Project(Arena &arena, const RecordSchema *schema, const RecordView &other) -> RecordView
+  {
+    auto mem     = Alloc(arena, schema);
+    auto nullmap = mem + schema->GetRecordLength();
+    for (size_t i = 0; i < schema->GetFieldCount(); ++i) {
+      auto &field     = schema->GetFieldAt(i);
+      auto  other_idx = other.schema_->GetRTFieldIndex(field);
+      if (other_idx == other.schema_->GetFieldCount()) {
+        NJUDB_FATAL("Field not found in other record");
+      }
+      std::memcpy(mem + schema->GetFieldOffset(i), other.GetField(other_idx), field.field_.field_size_);
+      BitMap::SetBit(nullmap, i, other.IsNull(other_idx));
+    }
+    return {schema, nullmap, mem, INVALID_RID};
+  }
+
+  /**
+   * Concatenate two records in the arena, like Record(schema, rec1, rec2)
+   * @param schema should be a combination of the schemas of the two records
+   */
+  static auto Concat(Arena &arena, const RecordSchema *schema, const RecordView &left, const RecordView &right)
+      -> RecordView
+  {
+    NJUDB_ASSERT(schema->GetFieldCount() == left.schema_->GetFieldCount() + right.schema_->GetFieldCount(),
+        "Field count mismatch");
+    auto left_len = left.schema_->GetRecordLength();
+    auto mem      = Alloc(arena, schema);
+    auto nullmap  = mem + schema->GetRecordLength();
+    std::memcpy(mem, left.data_, left_len);
+    std::memcpy(mem + left_len, right.data_, right.schema_->GetRecordLength());
+    for (size_t i = 0; i < left.schema_->GetFieldCount(); ++i) {
+      BitMap::SetBit(nullmap, i, left.IsNull(i));
+    }
+    for (size_t i = 0; i < right.schema_->GetFieldCount(); ++i) {
+      BitMap::SetBit(nullmap, left.schema_->GetFieldCount() + i, right.IsNull(i));
+    }
+    return {schema, nullmap, mem, INVALID_RID};
+  }
+
+  /**
+   * Build a record with all fields set to null in the arena, like Record(schema)
+   */
+  static auto MakeNull(Arena &arena, const RecordSchema *schema) -> RecordView
+  {
+    auto mem = Alloc(arena, schema);
+    std::memset(mem, 0, schema->GetRecordLength());
+    std::memset(mem + schema->GetRecordLength(), 0xff, BITMAP_SIZE(schema->GetFieldCount()));
+    return {schema, mem + schema->GetRecordLength(), mem, INVALID_RID};
+  }
+
+  [[nodiscard]] auto GetSchema() const -> const RecordSchema * { return schema_; }
+
+  [[nodiscard]] auto GetData() const -> const char * { return data_; }
+
+  [[nodiscard]] auto GetNullMap() const -> const char * { return nullmap_; }
+
+  [[nodiscard]] auto GetRID() const -> RID { return rid_; }
+
+  [[nodiscard]] auto IsNull(size_t index) const -> bool { return BitMap::GetBit(nullmap_, index); }
+
+  /**
+   * @return the raw bytes of the field, in the same format as in Record::GetData
+   */
+  [[nodiscard]] auto GetField(size_t index) const -> const char * { return data_ + schema_->GetFieldOffset(index); }
+
+  [[nodiscard]] auto GetValueAt(size_t index) const -> ValueSptr
+  {
+    NJUDB_ASSERT(index < schema_->GetFieldCount(), "Index out of range");
+    auto &field = schema_->GetFieldAt(index);
+    if (IsNull(index)) {
+      return ValueFactory::CreateNullValue(field.field_.field_type_);
+    }
+    return ValueFactory::CreateValue(field.field_.field_type_, GetField(index), field.field_.field_size_);
+  }
+
+  [[nodiscard]] auto ToRecord() const -> RecordUptr { return std::make_unique<Record>(schema_, nullmap_, data_, rid_); }
+
+  [[nodiscard]] auto ToString() const -> std::string
+  {
+    std::string str = "{";
+    for (size_t i = 0; i < schema_->GetFieldCount(); ++i) {
+      str += GetValueAt(i)->ToString();
+      if (i != schema_->GetFieldCount() - 1) {
+        str += ", ";
+      }
+    }
+    str += "}";
+    return str;
+  }
+
+private:
+  // the data followed by a cleared null map
+  static auto Alloc(Arena &arena, const RecordSchema *schema) -> char *
+  {
+    auto mem = arena.Allocate(schema->GetRecordLength() + BITMAP_SIZE(schema->GetFieldCount()));
+    std::memset(mem + schema->GetRecordLength(), 0, BITMAP_SIZE(schema->GetFieldCount()));
+    return mem;
+  }
+
+  const RecordSchema *schema_{nullptr};
+  const char         *data_{nullptr};
+  const char         *nullmap_{nullptr};
   RID                 rid_{};
 };
 
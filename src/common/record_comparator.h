@@ -0,0 +1,200 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_RECORD_COMPARATOR_H
+#define NJUDB_RECORD_COMPARATOR_H
+
+#include <vector>
+
+#include "field_access.h"
+#include "record.h"
+
+namespace njudb {
+
+/**
+ * Compare records by key fields without creating any Value or key Record. The offsets, sizes and typed compare
+ * functions of the keys are resolved from the schemas once at construction, comparing two records then reads each
+ * key in place from the record memory. Keys are compared in order like Record::Compare, a null is smaller than any
+ * value and equal to another null.
+ *
+ * It serves the sort keys of a record (schema, key_schema), the join keys of two inputs (lschema, lkey_schema,
+ * rschema, rkey_schema) and the keys stored in an index, whose memory may have no null map.
+ */
+class RecordComparator
+{
+public:
+  /**
+   * Compare the i-th field of lkey_schema in records of lschema with the i-th field of rkey_schema in records of
+   * rschema
+   */
+  RecordComparator(const RecordSchema *lschema, const RecordSchema *lkey_schema, const RecordSchema *rschema,
+      const RecordSchema *rkey_schema)
+  {
+    NJUDB_ASSERT(lkey_schema->GetFieldCount() == rkey_schema->GetFieldCount(), "field count mismatch");
+    keys_.reserve(lkey_schema->GetFieldCount());
+    for (size_t i = 0; i < lkey_schema->GetFieldCount(); i++) {
+      auto  lidx   = FindField(*lschema, lkey_schema->GetFieldAt(i));
+      auto  ridx   = FindField(*rschema, rkey_schema->GetFieldAt(i));
+      auto &lfield = lschema->GetFieldAt(lidx).field_;
+      auto &rfield = rschema->GetFieldAt(ridx).field_;
+      keys_.push_back({.compare_ = GetFieldCompareFn(lfield.field_type_, rfield.field_type_),
+          .lidx_                 = lidx,
+          .ridx_                 = ridx,
+          .loffset_              = lschema->GetFieldOffset(lidx),
+          .roffset_              = rschema->GetFieldOffset(ridx),
+          .lsize_                = lfield.field_size_,
+          .rsize_                = rfield.field_size_});
+    }
+  }
+
+  /**
+   * Compare records of schema by the fields of key_schema
+   */
+  RecordComparator(const RecordSchema *schema, const RecordSchema *key_schema)
+      : RecordComparator(schema, key_schema, schema, key_schema)
+  {}
+
+  /**
+   * Compare records of schema by all of its fields
+   */
+  explicit RecordComparator(const RecordSchema *schema) : RecordComparator(schema, schema, schema, schema) {}
+
+  /**
+   * @return -1, 0 or 1 as lhs is less than, equal to or greater than rhs
+   */
+  [[nodiscard]] auto Compare(const RecordView &lhs, const RecordView &rhs) const -> int
+  {
+    return Compare(lhs.GetNullMap(), lhs.GetData(), rhs.GetNullMap(), rhs.GetData());
+  }
+
+  [[nodiscard]] auto Compare(const Record &lhs, const Record &rhs) const -> int
+  {
+    return Compare(lhs.GetNullMap(), lhs.GetData(), rhs.GetNullMap(), rhs.GetData());
+  }
+
+  /**
+   * Compare records given by their memory
+   * @param lnull the null map of the left record, nullptr if none of its fields is null
+   * @param rnull the null map of the right record, nullptr if none of its fields is null
+   */
+  [[nodiscard]] auto Compare(const char *lnull, const char *ldata, const char *rnull, const char *rdata) const -> int
+  {
+    for (const auto &key : keys_) {
+      auto lis_null = lnull != nullptr && BitMap::GetBit(lnull, key.lidx_);
+      auto ris_null = rnull != nullptr && BitMap::GetBit(rnull, key.ridx_);
+      if (lis_null || ris_null) {
+        if (lis_null && ris_null) {
+          continue;
+        }
+        return lis_null ? -1 : 1;
+      }
+      auto res = key.compare_(ldata + key.loffset_, key.lsize_, rdata + key.roffset_, key.rsize_);
+      if (res != 0) {
+        return res;
+      }
+    }
+    return 0;
+  }
+
+  [[nodiscard]] auto GetKeyCount() const -> size_t { return keys_.size(); }
+
+private:
+  struct Key
+  {
+    FieldCompareFn compare_;
+    size_t         lidx_;
+    size_t         ridx_;
+    size_t         loffset_;
+    size_t         roffset_;
+    size_t         lsize_;
+    size_t         rsize_;
+  };
+
+  static auto FindField(const RecordSchema &schema, const RTField &field) -> size_t
+  {
+    auto idx = schema.GetRTFieldIndex(field);
+    if (idx == schema.GetFieldCount()) {
+      NJUDB_THROW(NJUDB_FIELD_MISS, field.field_.field_name_);
+    }
+    return idx;
+  }
+
+  std::vector<Key> keys_;
+};
+
+/**
+ * Hash records by key fields in place, the counterpart of RecordComparator for hash join and aggregation. Keys that
+ * compare equal hash the same, including an INT and a FLOAT of the same value, and null keys are skipped like in
+ * Record::Hash. The hashes differ from Record::Hash, which is kept for the buckets of HashIndex, so they are only
+ * for tables built in memory.
+ */
+class RecordHasher
+{
+public:
+  RecordHasher(const RecordSchema *schema, const RecordSchema *key_schema)
+  {
+    keys_.reserve(key_schema->GetFieldCount());
+    for (const auto &key_field : key_schema->GetFields()) {
+      auto idx = schema->GetRTFieldIndex(key_field);
+      if (idx == schema->GetFieldCount()) {
+        NJUDB_THROW(NJUDB_FIELD_MISS, key_field.field_.field_name_);
+      }
+      auto &field = schema->GetFieldAt(idx).field_;
+      keys_.push_back({.hash_ = GetFieldHashFn(field.field_type_),
+          .idx_               = idx,
+          .offset_            = schema->GetFieldOffset(idx),
+          .size_              = field.field_size_});
+    }
+  }
+
+  explicit RecordHasher(const RecordSchema *schema) : RecordHasher(schema, schema) {}
+
+  [[nodiscard]] auto Hash(const RecordView &rec) const -> size_t { return Hash(rec.GetNullMap(), rec.GetData()); }
+
+  [[nodiscard]] auto Hash(const Record &rec) const -> size_t { return Hash(rec.GetNullMap(), rec.GetData()); }
+
+  /**
+   * @param null_map nullptr if none of the fields is null
+   */
+  [[nodiscard]] auto Hash(const char *null_map, const char *data) const -> size_t
+  {
+    size_t hash = 0;
+    for (const auto &key : keys_) {
+      if (null_map != nullptr && BitMap::GetBit(null_map, key.idx_)) {
+        continue;
+      }
+      // combine in order so that swapped keys hash differently
+      hash = hash * 31 + key.hash_(data + key.offset_, key.size_);
+    }
+    return hash;
+  }
+
+private:
+  struct Key
+  {
+    FieldHashFn hash_;
+    size_t      idx_;
+    size_t      offset_;
+    size_t      size_;
+  };
+
+  std::vector<Key> keys_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_RECORD_COMPARATOR_H
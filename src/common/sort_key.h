@@ -0,0 +1,244 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_SORT_KEY_H
+#define NJUDB_SORT_KEY_H
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "record.h"
+
+namespace njudb {
+
+/**
+ * Encode the key fields of a record into a normalized key: a byte string whose order under memcmp is the order of
+ * Record::Compare on the keys, so that comparing two keys is a single memcmp and the keys can be radix sorted byte
+ * by byte. Every key field takes a fixed number of bytes, the normalized key of a schema has a fixed size:
+ *
+ *   [null byte][value bytes] for each key field
+ *
+ * - the null byte is 0 for a null and 1 otherwise, a null is smaller than any value, its value bytes are zero
+ * - INT: the sign bit flipped, big endian
+ * - FLOAT: the sign bit flipped for a positive number, all bits flipped for a negative one, big endian, -0.0 is
+ *   stored as 0.0
+ * - BOOL: one byte
+ * - CHAR(n) and VARCHAR(n): the n bytes of the string up to its first '\0', padded with '\0'
+ *
+ * With is_desc, all the bytes of a field are flipped so that larger values come first and nulls come last, like
+ * SortExecutor::Compare with is_desc. A key encoded from a key record can be decoded back to the record.
+ * The keys are for sorting only, the B+ tree index still stores its keys as raw key records.
+ */
+class SortKeyEncoder
+{
+public:
+  /**
+   * Encode the fields of key_schema read from records of schema
+   */
+  SortKeyEncoder(const RecordSchema *schema, const RecordSchema *key_schema, bool is_desc = false)
+      : key_schema_(key_schema), is_decodable_(schema == key_schema), is_desc_(is_desc)
+  {
+    keys_.reserve(key_schema->GetFieldCount());
+    for (size_t i = 0; i < key_schema->GetFieldCount(); i++) {
+      auto &key_field = key_schema->GetFieldAt(i);
+      auto  idx       = schema->GetRTFieldIndex(key_field);
+      if (idx == schema->GetFieldCount()) {
+        NJUDB_THROW(NJUDB_FIELD_MISS, key_field.field_.field_name_);
+      }
+      auto &field = schema->GetFieldAt(idx).field_;
+      switch (field.field_type_) {
+        case TYPE_BOOL:
+        case TYPE_INT:
+        case TYPE_FLOAT:
+        case TYPE_STRING:
+        case TYPE_VARCHAR: break;
+        default: NJUDB_THROW(NJUDB_UNSUPPORTED_OP, fmt::format("sort key of {}", FieldTypeToString(field.field_type_)));
+      }
+      keys_.push_back({.type_ = field.field_type_,
+          .idx_               = idx,
+          .offset_            = schema->GetFieldOffset(idx),
+          .size_              = field.field_size_,
+          .key_offset_        = key_size_});
+      key_size_ += 1 + field.field_size_;
+    }
+  }
+
+  /**
+   * Encode all the fields of records of key_schema, e.g. the keys of an index
+   */
+  explicit SortKeyEncoder(const RecordSchema *key_schema, bool is_desc = false)
+      : SortKeyEncoder(key_schema, key_schema, is_desc)
+  {}
+
+  /**
+   * @return the size of a normalized key
+   */
+  [[nodiscard]] auto GetKeySize() const -> size_t { return key_size_; }
+
+  [[nodiscard]] auto IsDesc() const -> bool { return is_desc_; }
+
+  /**
+   * Write the normalized key of a record to key, which has GetKeySize() bytes
+   * @param null_map the null map of the record, nullptr if none of its fields is null
+   */
+  void Encode(const char *null_map, const char *data, char *key) const
+  {
+    auto out = reinterpret_cast<unsigned char *>(key);
+    for (const auto &k : keys_) {
+      auto dst = out + k.key_offset_;
+      if (null_map != nullptr && BitMap::GetBit(null_map, k.idx_)) {
+        std::memset(dst, 0, 1 + k.size_);
+      } else {
+        dst[0] = 1;
+        EncodeField(k, data + k.offset_, dst + 1);
+      }
+      if (is_desc_) {
+        for (size_t i = 0; i <= k.size_; i++) {
+          dst[i] = ~dst[i];
+        }
+      }
+    }
+  }
+
+  void Encode(const Record &record, char *key) const { Encode(record.GetNullMap(), record.GetData(), key); }
+
+  void Encode(const RecordView &record, char *key) const { Encode(record.GetNullMap(), record.GetData(), key); }
+
+  [[nodiscard]] auto Encode(const Record &record) const -> std::string
+  {
+    std::string key(key_size_, '\0');
+    Encode(record, key.data());
+    return key;
+  }
+
+  /**
+   * Rebuild a record of the key schema from a normalized key, the encoder should be created from the key schema
+   * alone, i.e. SortKeyEncoder(key_schema)
+   */
+  [[nodiscard]] auto Decode(const char *key) const -> RecordUptr
+  {
+    NJUDB_ASSERT(is_decodable_, "the encoder reads keys from another schema");
+    std::vector<char> data(key_schema_->GetRecordLength(), 0);
+    std::vector<char> null_map(BITMAP_SIZE(key_schema_->GetFieldCount()), 0);
+    std::vector<char> field;
+    for (const auto &k : keys_) {
+      field.assign(key + k.key_offset_, key + k.key_offset_ + 1 + k.size_);
+      if (is_desc_) {
+        for (auto &byte : field) {
+          byte = static_cast<char>(~byte);
+        }
+      }
+      if (field[0] == 0) {
+        BitMap::SetBit(null_map.data(), k.idx_, true);
+        continue;
+      }
+      DecodeField(k, reinterpret_cast<const unsigned char *>(field.data()) + 1, data.data() + k.offset_);
+    }
+    return std::make_unique<Record>(key_schema_, null_map.data(), data.data(), INVALID_RID);
+  }
+
+  /**
+   * @return the order of two normalized keys of this encoder
+   */
+  [[nodiscard]] auto Compare(const char *lhs, const char *rhs) const -> int
+  {
+    auto res = std::memcmp(lhs, rhs, key_size_);
+    return res < 0 ? -1 : (res > 0 ? 1 : 0);
+  }
+
+private:
+  struct Key
+  {
+    FieldType type_;
+    size_t    idx_;
+    size_t    offset_;      // offset of the field in the record
+    size_t    size_;        // size of the field
+    size_t    key_offset_;  // offset of the null byte in the normalized key
+  };
+
+  static void StoreBigEndian(uint32_t value, unsigned char *dst)
+  {
+    for (int i = 3; i >= 0; i--) {
+      dst[i] = static_cast<unsigned char>(value & 0xff);
+      value >>= 8;
+    }
+  }
+
+  static auto LoadBigEndian(const unsigned char *src) -> uint32_t
+  {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+      value = (value << 8) | src[i];
+    }
+    return value;
+  }
+
+  static void EncodeField(const Key &k, const char *src, unsigned char *dst)
+  {
+    switch (k.type_) {
+      case TYPE_BOOL: dst[0] = FieldAccess<TYPE_BOOL>::Load(src, k.size_) ? 1 : 0; break;
+      case TYPE_INT: {
+        auto value = static_cast<uint32_t>(FieldAccess<TYPE_INT>::Load(src, k.size_));
+        StoreBigEndian(value ^ 0x80000000U, dst);
+        break;
+      }
+      case TYPE_FLOAT: {
+        auto     value = FieldAccess<TYPE_FLOAT>::Load(src, k.size_);
+        uint32_t bits  = 0;
+        value          = value == 0.0f ? 0.0f : value;
+        std::memcpy(&bits, &value, sizeof(bits));
+        StoreBigEndian((bits & 0x80000000U) != 0 ? ~bits : bits ^ 0x80000000U, dst);
+        break;
+      }
+      default: {
+        auto str = FieldAccess<TYPE_STRING>::Load(src, k.size_);
+        std::memcpy(dst, str.data(), str.size());
+        std::memset(dst + str.size(), 0, k.size_ - str.size());
+      }
+    }
+  }
+
+  static void DecodeField(const Key &k, const unsigned char *src, char *dst)
+  {
+    switch (k.type_) {
+      case TYPE_BOOL: *reinterpret_cast<bool *>(dst) = src[0] != 0; break;
+      case TYPE_INT: {
+        auto value = static_cast<int32_t>(LoadBigEndian(src) ^ 0x80000000U);
+        std::memcpy(dst, &value, sizeof(value));
+        break;
+      }
+      case TYPE_FLOAT: {
+        auto bits = LoadBigEndian(src);
+        bits      = (bits & 0x80000000U) != 0 ? bits ^ 0x80000000U : ~bits;
+        std::memcpy(dst, &bits, sizeof(bits));
+        break;
+      }
+      default: std::memcpy(dst, src, k.size_);
+    }
+  }
+
+  const RecordSchema *key_schema_;
+  bool                is_decodable_;
+  bool                is_desc_;
+  std::vector<Key>    keys_;
+  size_t              key_size_{0};
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_SORT_KEY_H
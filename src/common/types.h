@@ -48,7 +48,8 @@ constexpr int32_t INVALID_FILE_ID  = -1;
 
 #define ENUM_ENTITIES \
   ENUM(NARY_MODEL)    \
-  ENUM(PAX_MODEL)
+  ENUM(PAX_MODEL)     \
+  ENUM(PAX_COMPRESSED_MODEL)
 #define ENUM(ent) ENUMENTRY(ent)
 DECLARE_ENUM(StorageModel)
 #undef ENUM
@@ -63,7 +64,8 @@ ENUM_TO_STRING_BODY(StorageModel)
   ENUM(TYPE_INT)      \
   ENUM(TYPE_FLOAT)    \
   ENUM(TYPE_STRING)   \
-  ENUM(TYPE_ARRAY)
+  ENUM(TYPE_ARRAY)    \
+  ENUM(TYPE_VARCHAR)
 #define ENUM(ent) ENUMENTRY(ent)
 DECLARE_ENUM(FieldType)
 #undef ENUM
@@ -158,6 +160,19 @@ inline auto CompOpToString(CompOp op) -> const char *{
   }
 }
 
+/**
+ * Whether a comparison with a null operand holds, as the operators of Value decide it: a null is equal to a null and
+ * not equal to a value, and no order holds with a null
+ */
+inline auto CompOpOnNull(CompOp op, bool lhs_null, bool rhs_null) -> bool
+{
+  switch (op) {
+    case OP_EQ: return lhs_null && rhs_null;
+    case OP_NE: return lhs_null != rhs_null;
+    default: return false;
+  }
+}
+
 #define ENUM_ENTITIES \
   ENUM(NONE)          \
   ENUM(BPTREE)        \
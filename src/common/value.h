@@ -574,7 +574,8 @@ public:
       case FieldType::TYPE_BOOL: return ValueFactory::CreateBoolValue(*reinterpret_cast<const bool *>(data));
       case FieldType::TYPE_INT: return ValueFactory::CreateIntValue(*reinterpret_cast<const int32_t *>(data));
       case FieldType::TYPE_FLOAT: return ValueFactory::CreateFloatValue(*reinterpret_cast<const float *>(data));
-      case FieldType::TYPE_STRING: return ValueFactory::CreateStringValue(data, size);
+      case FieldType::TYPE_STRING:
+      case FieldType::TYPE_VARCHAR: return ValueFactory::CreateStringValue(data, size);
       default: NJUDB_FATAL("Unsupported field type");
     }
   }
@@ -585,7 +586,8 @@ public:
       case FieldType::TYPE_INT: return std::make_shared<IntValue>(0, true);
       case FieldType::TYPE_FLOAT: return std::make_shared<FloatValue>(0.0f, true);
       case FieldType::TYPE_BOOL: return std::make_shared<BoolValue>(false, true);
-      case FieldType::TYPE_STRING: return std::make_shared<StringValue>("", 0, true);
+      case FieldType::TYPE_STRING:
+      case FieldType::TYPE_VARCHAR: return std::make_shared<StringValue>("", 0, true);
       case FieldType::TYPE_ARRAY: return std::make_shared<ArrayValue>(std::vector<ValueSptr>(), true);
       default: NJUDB_FATAL("Unknown FieldType");
     }
@@ -611,6 +613,10 @@ public:
     if (value->GetType() == type) {
       return value;
     }
+    // a VARCHAR field only differs from a CHAR field in how it is stored in a page, both are read as strings
+    if (value->GetType() == FieldType::TYPE_STRING && type == FieldType::TYPE_VARCHAR) {
+      return value;
+    }
     if (value->GetType() == FieldType::TYPE_INT) {
       if (type != FieldType::TYPE_FLOAT) {
         NJUDB_THROW(NJUDB_TYPE_MISSMATCH,
@@ -645,6 +651,7 @@ public:
       case TYPE_BOOL:
         return CreateBoolValue(false);
       case TYPE_STRING:
+      case TYPE_VARCHAR:
         return CreateStringValue("", 0);
       default:
         NJUDB_THROW(NJUDB_TYPE_MISSMATCH, "Unsupported field type for min value");
@@ -661,6 +668,7 @@ public:
       case TYPE_BOOL:
         return CreateBoolValue(true);
       case TYPE_STRING:
+      case TYPE_VARCHAR:
         // Create a large string for max comparison
         return CreateStringValue("\xFF\xFF\xFF\xFF", 4);
       default:
@@ -0,0 +1,362 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_VECTOR_CHUNK_H
+#define NJUDB_VECTOR_CHUNK_H
+
+#include <string>
+#include <string_view>
+
+#include "config.h"
+#include "record.h"
+
+namespace njudb {
+
+class ColumnVector;
+class VectorChunk;
+DEFINE_SHARED_PTR(ColumnVector);
+DEFINE_UNIQUE_PTR(VectorChunk);
+
+/**
+ * A column of a vectorized chunk, the values are stored back to back in the same fixed-length format as in a record so
+ * that a column of INT or FLOAT can be read as an array of int32_t or float, a null value is zero filled and flagged in
+ * a byte of the null array
+ */
+class ColumnVector
+{
+public:
+  ColumnVector(FieldType type, size_t width, size_t capacity = VECTOR_SIZE) : type_(type), width_(width)
+  {
+    data_.reserve(capacity * width_);
+    nulls_.reserve(capacity);
+  }
+
+  [[nodiscard]] auto GetType() const -> FieldType { return type_; }
+
+  [[nodiscard]] auto GetWidth() const -> size_t { return width_; }
+
+  [[nodiscard]] auto GetSize() const -> size_t { return nulls_.size(); }
+
+  auto GetData() -> char * { return data_.data(); }
+
+  [[nodiscard]] auto GetData() const -> const char * { return data_.data(); }
+
+  [[nodiscard]] auto GetNulls() const -> const uint8_t * { return nulls_.data(); }
+
+  [[nodiscard]] auto IsNull(size_t row) const -> bool { return nulls_[row] != 0; }
+
+  [[nodiscard]] auto GetRaw(size_t row) const -> const char * { return data_.data() + row * width_; }
+
+  /**
+   * @return the string value of the row without the padding zeros, only for CHAR and VARCHAR columns
+   */
+  [[nodiscard]] auto GetString(size_t row) const -> std::string_view
+  {
+    return {GetRaw(row), strnlen(GetRaw(row), width_)};
+  }
+
+  [[nodiscard]] auto GetValueAt(size_t row) const -> ValueSptr
+  {
+    if (IsNull(row)) {
+      return ValueFactory::CreateNullValue(type_);
+    }
+    if (type_ == TYPE_STRING || type_ == TYPE_VARCHAR) {
+      auto str = GetString(row);
+      return ValueFactory::CreateStringValue(std::string(str).c_str(), str.size());
+    }
+    return ValueFactory::CreateValue(type_, GetRaw(row), width_);
+  }
+
+  void Append(const char *src, bool is_null)
+  {
+    data_.resize(data_.size() + width_, 0);
+    if (!is_null) {
+      std::memcpy(data_.data() + data_.size() - width_, src, width_);
+    }
+    nulls_.push_back(is_null ? 1 : 0);
+  }
+
+  void Append(const ColumnVector &other, size_t row) { Append(other.GetRaw(row), other.IsNull(row)); }
+
+  /**
+   * Append a zero filled value, a non-null value is written by the caller to the returned address, which is valid
+   * until the next append
+   */
+  auto AppendSlot(bool is_null) -> char *
+  {
+    data_.resize(data_.size() + width_, 0);
+    nulls_.push_back(is_null ? 1 : 0);
+    return data_.data() + data_.size() - width_;
+  }
+
+  void Append(const ValueSptr &value)
+  {
+    data_.resize(data_.size() + width_, 0);
+    nulls_.push_back(value->IsNull() ? 1 : 0);
+    if (value->IsNull()) {
+      return;
+    }
+    char *dst = data_.data() + data_.size() - width_;
+    switch (type_) {
+      case TYPE_BOOL: *reinterpret_cast<bool *>(dst) = std::dynamic_pointer_cast<BoolValue>(value)->Get(); break;
+      case TYPE_INT:
+        *reinterpret_cast<int32_t *>(dst) =
+            std::dynamic_pointer_cast<IntValue>(ValueFactory::CastTo(value, TYPE_INT))->Get();
+        break;
+      case TYPE_FLOAT:
+        *reinterpret_cast<float *>(dst) =
+            std::dynamic_pointer_cast<FloatValue>(ValueFactory::CastTo(value, TYPE_FLOAT))->Get();
+        break;
+      case TYPE_STRING:
+      case TYPE_VARCHAR: {
+        const auto &str = std::dynamic_pointer_cast<StringValue>(value)->Get();
+        std::memcpy(dst, str.data(), std::min(str.size(), width_));
+        break;
+      }
+      default: NJUDB_FATAL("Unsupported field type");
+    }
+  }
+
+  /**
+   * Append the rows [begin, end) of another column of the same type at once
+   */
+  void AppendRange(const ColumnVector &other, size_t begin, size_t end)
+  {
+    data_.insert(data_.end(), other.data_.begin() + begin * width_, other.data_.begin() + end * width_);
+    nulls_.insert(nulls_.end(), other.nulls_.begin() + begin, other.nulls_.begin() + end);
+  }
+
+  /**
+   * Drop the rows from size on
+   */
+  void Truncate(size_t size)
+  {
+    data_.resize(size * width_);
+    nulls_.resize(size);
+  }
+
+  void Reset()
+  {
+    data_.clear();
+    nulls_.clear();
+  }
+
+private:
+  FieldType            type_;
+  size_t               width_;
+  std::vector<char>    data_;
+  std::vector<uint8_t> nulls_;
+};
+
+/**
+ * A chunk of at most VECTOR_SIZE records stored column by column, passed between the vectorized executors. Filters do
+ * not move the values, they narrow the selection vector holding the rows that are still alive, in ascending order.
+ * Columns are shared pointers so that a projection hands the columns of its child over without copying them.
+ */
+class VectorChunk
+{
+public:
+  VectorChunk() = delete;
+
+  explicit VectorChunk(const RecordSchema *schema, size_t capacity = VECTOR_SIZE) : schema_(schema), capacity_(capacity)
+  {
+    cols_.reserve(schema_->GetFieldCount());
+    for (const auto &field : schema_->GetFields()) {
+      cols_.push_back(std::make_shared<ColumnVector>(field.field_.field_type_, field.field_.field_size_, capacity_));
+    }
+  }
+
+  VectorChunk(const RecordSchema *schema, std::vector<ColumnVectorSptr> cols)
+      : schema_(schema), cols_(std::move(cols)), capacity_(VECTOR_SIZE)
+  {
+    NJUDB_ASSERT(schema_->GetFieldCount() == cols_.size(), "Field count mismatch");
+  }
+
+  ~VectorChunk() = default;
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(VectorChunk)
+
+  [[nodiscard]] auto GetSchema() const -> const RecordSchema * { return schema_; }
+
+  [[nodiscard]] auto GetColCount() const -> size_t { return cols_.size(); }
+
+  [[nodiscard]] auto GetCol(size_t index) const -> const ColumnVector & { return *cols_[index]; }
+
+  auto GetCol(size_t index) -> ColumnVector & { return *cols_[index]; }
+
+  [[nodiscard]] auto GetColPtr(size_t index) const -> ColumnVectorSptr { return cols_[index]; }
+
+  /**
+   * @return the number of rows stored in the columns, including the rows filtered out by the selection vector
+   */
+  [[nodiscard]] auto GetRowCount() const -> size_t { return cols_.empty() ? row_num_ : cols_[0]->GetSize(); }
+
+  [[nodiscard]] auto IsFull() const -> bool { return GetRowCount() >= capacity_; }
+
+  [[nodiscard]] auto HasSelection() const -> bool { return has_sel_; }
+
+  [[nodiscard]] auto GetSelection() const -> const std::vector<uint32_t> & { return sel_; }
+
+  void SetSelection(std::vector<uint32_t> sel)
+  {
+    sel_     = std::move(sel);
+    has_sel_ = true;
+  }
+
+  /**
+   * @return the number of rows alive
+   */
+  [[nodiscard]] auto GetSelectedCount() const -> size_t { return has_sel_ ? sel_.size() : GetRowCount(); }
+
+  /**
+   * @param i the i-th row alive
+   * @return the position of the row in the columns
+   */
+  [[nodiscard]] auto GetSelectedRow(size_t i) const -> size_t { return has_sel_ ? sel_[i] : i; }
+
+  /**
+   * @return the positions of the rows alive, the selection vector or all the rows if there is none
+   */
+  [[nodiscard]] auto GetSelectedRows() const -> std::vector<uint32_t>
+  {
+    if (has_sel_) {
+      return sel_;
+    }
+    std::vector<uint32_t> rows(GetRowCount());
+    for (size_t i = 0; i < rows.size(); i++) {
+      rows[i] = static_cast<uint32_t>(i);
+    }
+    return rows;
+  }
+
+  void AppendRecord(const RecordView &record)
+  {
+    NJUDB_ASSERT(record.GetSchema()->GetFieldCount() == cols_.size(), "Field count mismatch");
+    for (size_t i = 0; i < cols_.size(); i++) {
+      cols_[i]->Append(record.GetData() + schema_->GetFieldOffset(i), BitMap::GetBit(record.GetNullMap(), i));
+    }
+    row_num_++;
+  }
+
+  /**
+   * Append a row of another chunk with the same layout
+   */
+  void AppendRow(const VectorChunk &other, size_t row)
+  {
+    for (size_t i = 0; i < cols_.size(); i++) {
+      cols_[i]->Append(*other.cols_[i], row);
+    }
+    row_num_++;
+  }
+
+  /**
+   * Append the concatenation of two rows, the schema should be the combination of the schemas of the two chunks
+   */
+  void AppendRow(const VectorChunk &left, size_t left_row, const VectorChunk &right, size_t right_row)
+  {
+    NJUDB_ASSERT(left.cols_.size() + right.cols_.size() == cols_.size(), "Field count mismatch");
+    for (size_t i = 0; i < left.cols_.size(); i++) {
+      cols_[i]->Append(*left.cols_[i], left_row);
+    }
+    for (size_t i = 0; i < right.cols_.size(); i++) {
+      cols_[left.cols_.size() + i]->Append(*right.cols_[i], right_row);
+    }
+    row_num_++;
+  }
+
+  /**
+   * Materialize a row as a record under the schema of the chunk
+   */
+  [[nodiscard]] auto GetRecord(size_t row) const -> RecordUptr
+  {
+    std::vector<char> data(schema_->GetRecordLength());
+    std::vector<char> null_map(BITMAP_SIZE(schema_->GetFieldCount()), 0);
+    WriteRow(row, data.data(), null_map.data());
+    return std::make_unique<Record>(schema_, null_map.data(), data.data(), INVALID_RID);
+  }
+
+  /**
+   * Materialize a row as a record built in the arena
+   */
+  [[nodiscard]] auto GetRecordView(Arena &arena, size_t row) const -> RecordView
+  {
+    auto data     = arena.Allocate(schema_->GetRecordLength() + BITMAP_SIZE(schema_->GetFieldCount()));
+    auto null_map = data + schema_->GetRecordLength();
+    std::memset(null_map, 0, BITMAP_SIZE(schema_->GetFieldCount()));
+    WriteRow(row, data, null_map);
+    return {schema_, null_map, data, INVALID_RID};
+  }
+
+  /**
+   * Append the values of the columns in a row to key, two rows get the same key iff their values are equal, which is
+   * used to group and join rows by hashing. Nulls get the same key as each other, strings are cut at the first zero.
+   * @param col_idx the columns of the key
+   * @param row
+   * @param key
+   */
+  void PackRow(const std::vector<size_t> &col_idx, size_t row, std::string &key) const
+  {
+    for (auto idx : col_idx) {
+      const auto &col = *cols_[idx];
+      key.push_back(col.IsNull(row) ? 1 : 0);
+      if (col.IsNull(row)) {
+        continue;
+      }
+      switch (col.GetType()) {
+        case TYPE_STRING:
+        case TYPE_VARCHAR: {
+          auto str = col.GetString(row);
+          auto len = static_cast<uint16_t>(str.size());
+          key.append(reinterpret_cast<const char *>(&len), sizeof(len));
+          key.append(str);
+          break;
+        }
+        case TYPE_FLOAT: {
+          // +0.0 and -0.0 are equal
+          float value = *reinterpret_cast<const float *>(col.GetRaw(row));
+          value       = value == 0.0f ? 0.0f : value;
+          key.append(reinterpret_cast<const char *>(&value), sizeof(float));
+          break;
+        }
+        default: key.append(col.GetRaw(row), col.GetWidth());
+      }
+    }
+  }
+
+private:
+  // null_map should be cleared
+  void WriteRow(size_t row, char *data, char *null_map) const
+  {
+    for (size_t i = 0; i < cols_.size(); i++) {
+      std::memcpy(data + schema_->GetFieldOffset(i), cols_[i]->GetRaw(row), cols_[i]->GetWidth());
+      if (cols_[i]->IsNull(row)) {
+        BitMap::SetBit(null_map, i, true);
+      }
+    }
+  }
+
+  const RecordSchema           *schema_;
+  std::vector<ColumnVectorSptr> cols_;
+  size_t                        capacity_;
+  size_t                        row_num_{0};  // only counts the rows of a chunk without columns
+  bool                          has_sel_{false};
+  std::vector<uint32_t>         sel_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_VECTOR_CHUNK_H
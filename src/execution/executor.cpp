@@ -28,6 +28,12 @@ namespace njudb {
 
 // translate the plan to executor
 auto Executor::Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHandle *db) -> AbstractExecutorUptr
+{
+  return Translate(plan, db, vectorized_);
+}
+
+auto Executor::Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHandle *db, bool vectorized)
+    -> AbstractExecutorUptr
 {
   if (db == nullptr) {
     NJUDB_THROW(NJUDB_DB_NOT_OPEN, "");
@@ -42,6 +48,8 @@ auto Executor::Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHand
     return std::make_unique<DescTableExecutor>(db->GetTable(desc_table->table_name_));
   } else if (const auto show_table = std::dynamic_pointer_cast<ShowTablesPlan>(plan)) {
     return std::make_unique<ShowTablesExecutor>(db);
+  } else if (const auto show_buffer_pool = std::dynamic_pointer_cast<ShowBufferPoolPlan>(plan)) {
+    return std::make_unique<ShowBufferPoolExecutor>(db->GetBufferPoolManager());
   } else if (const auto create_index = std::dynamic_pointer_cast<CreateIndexPlan>(plan)) {
     return std::make_unique<CreateIndexExecutor>(create_index->index_name_,
         create_index->table_name_,
@@ -70,23 +78,48 @@ auto Executor::Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHand
       NJUDB_THROW(NJUDB_TABLE_MISS, update->table_name_);
     }
     return std::make_unique<UpdateExecutor>(
-        Translate(update->child_, db), tab, db->GetIndexes(update->table_name_), std::move(update->updates_));
+        Translate(update->child_, db, false), tab, db->GetIndexes(update->table_name_), std::move(update->updates_));
   } else if (const auto del = std::dynamic_pointer_cast<DeletePlan>(plan)) {
     auto tab = db->GetTable(del->table_name_);
     if (tab == nullptr) {
       NJUDB_THROW(NJUDB_TABLE_MISS, del->table_name_);
     }
-    return std::make_unique<DeleteExecutor>(Translate(del->child_, db), tab, db->GetIndexes(del->table_name_));
+    return std::make_unique<DeleteExecutor>(Translate(del->child_, db, false), tab, db->GetIndexes(del->table_name_));
   } else if (const auto filter = std::dynamic_pointer_cast<FilterPlan>(plan)) {
+    if (vectorized) {
+      if (const auto scan = std::dynamic_pointer_cast<ScanPlan>(filter->child_)) {
+        // the records returned by the vectorized scan already satisfy the pushed-down conditions
+        auto tab = db->GetTable(scan->table_name_);
+        if (tab == nullptr) {
+          NJUDB_THROW(NJUDB_TABLE_MISS, scan->table_name_);
+        }
+        return std::make_unique<SeqScanExecutorVec>(tab, filter->conds_);
+      }
+      return std::make_unique<FilterExecutorVec>(Translate(filter->child_, db, vectorized), filter->conds_);
+    }
     std::function<bool(const Record &)> filter_func = [filter](const Record &record) {
       return ConditionExpr::Eval(filter->conds_, record);
     };
-    return std::make_unique<FilterExecutor>(Translate(filter->child_, db), std::move(filter_func));
+#ifndef NJUDB_GOLD_LAB02
+    if (const auto scan = std::dynamic_pointer_cast<ScanPlan>(filter->child_)) {
+      // push the conditions down to the scan, which skips the pages that can not satisfy them
+      auto tab = db->GetTable(scan->table_name_);
+      if (tab == nullptr) {
+        NJUDB_THROW(NJUDB_TABLE_MISS, scan->table_name_);
+      }
+      return std::make_unique<FilterExecutor>(
+          std::make_unique<SeqScanExecutor>(tab, filter->conds_), std::move(filter_func));
+    }
+#endif
+    return std::make_unique<FilterExecutor>(Translate(filter->child_, db, vectorized), std::move(filter_func));
   } else if (const auto scan = std::dynamic_pointer_cast<ScanPlan>(plan)) {
     auto tab = db->GetTable(scan->table_name_);
     if (tab == nullptr) {
       NJUDB_THROW(NJUDB_TABLE_MISS, scan->table_name_);
     }
+    if (vectorized) {
+      return std::make_unique<SeqScanExecutorVec>(tab);
+    }
     return std::make_unique<SeqScanExecutor>(tab);
   } else if (const auto idx_scan = std::dynamic_pointer_cast<IdxScanPlan>(plan)) {
     return std::make_unique<IdxScanExecutor>(db->GetTable(idx_scan->table_name_),
@@ -94,25 +127,51 @@ auto Executor::Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHand
         idx_scan->conds_,
         true);  // Default to ascending order
   } else if (const auto sort_plan = std::dynamic_pointer_cast<SortPlan>(plan)) {
+    if (vectorized) {
+      return std::make_unique<SortExecutorVec>(
+          Translate(sort_plan->child_, db, vectorized), std::move(sort_plan->key_schema_), sort_plan->is_desc_);
+    }
     return std::make_unique<SortExecutor>(
-        Translate(sort_plan->child_, db), std::move(sort_plan->key_schema_), sort_plan->is_desc_);
+        Translate(sort_plan->child_, db, vectorized), std::move(sort_plan->key_schema_), sort_plan->is_desc_);
+  } else if (const auto top_n = std::dynamic_pointer_cast<TopNPlan>(plan)) {
+    // a top-n only keeps limit records, it reads the chunks of the child and is vectorized either way
+    return std::make_unique<TopNExecutorVec>(Translate(top_n->child_, db, vectorized),
+        std::move(top_n->key_schema_),
+        top_n->is_desc_,
+        top_n->limit_);
   } else if (const auto proj_plan = std::dynamic_pointer_cast<ProjectPlan>(plan)) {
-    return std::make_unique<ProjectionExecutor>(Translate(proj_plan->child_, db), std::move(proj_plan->schema_));
+    if (vectorized) {
+      return std::make_unique<ProjectionExecutorVec>(
+          Translate(proj_plan->child_, db, vectorized), std::move(proj_plan->schema_));
+    }
+    return std::make_unique<ProjectionExecutor>(
+        Translate(proj_plan->child_, db, vectorized), std::move(proj_plan->schema_));
   } else if (const auto join_plan = std::dynamic_pointer_cast<JoinPlan>(plan)) {
     if (join_plan->strategy_ == NESTED_LOOP) {
-      return std::make_unique<NestedLoopJoinExecutor>(
-          join_plan->type_, Translate(join_plan->left_, db), Translate(join_plan->right_, db), join_plan->conds_);
+      return std::make_unique<NestedLoopJoinExecutor>(join_plan->type_,
+          Translate(join_plan->left_, db, vectorized),
+          Translate(join_plan->right_, db, vectorized),
+          join_plan->conds_);
     } else if (join_plan->strategy_ == HASH_JOIN) {
+      if (vectorized &&
+          HashJoinExecutorVec::IsKeyCompatible(*join_plan->left_key_schema_, *join_plan->right_key_schema_)) {
+        return std::make_unique<HashJoinExecutorVec>(join_plan->type_,
+            Translate(join_plan->left_, db, vectorized),
+            Translate(join_plan->right_, db, vectorized),
+            std::move(join_plan->left_key_schema_),
+            std::move(join_plan->right_key_schema_),
+            std::move(join_plan->conds_));
+      }
       return std::make_unique<HashJoinExecutor>(join_plan->type_,
-          Translate(join_plan->left_, db),
-          Translate(join_plan->right_, db),
+          Translate(join_plan->left_, db, vectorized),
+          Translate(join_plan->right_, db, vectorized),
           std::move(join_plan->left_key_schema_),
           std::move(join_plan->right_key_schema_),
           std::move(join_plan->conds_));
     } else if (join_plan->strategy_ == SORT_MERGE) {
       return std::make_unique<SortMergeJoinExecutor>(join_plan->type_,
-          Translate(join_plan->left_, db),
-          Translate(join_plan->right_, db),
+          Translate(join_plan->left_, db, vectorized),
+          Translate(join_plan->right_, db, vectorized),
           std::move(join_plan->left_key_schema_),
           std::move(join_plan->right_key_schema_),
           join_plan->join_op_);
@@ -120,10 +179,14 @@ auto Executor::Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHand
   } else if (const auto agg_plan = std::dynamic_pointer_cast<AggregatePlan>(plan)) {
     auto agg_schema   = std::make_unique<RecordSchema>(agg_plan->agg_fields);
     auto group_schema = std::make_unique<RecordSchema>(agg_plan->group_fields_);
+    if (vectorized) {
+      return std::make_unique<AggregateExecutorVec>(
+          Translate(agg_plan->child_, db, vectorized), std::move(agg_schema), std::move(group_schema));
+    }
     return std::make_unique<AggregateExecutor>(
-        Translate(agg_plan->child_, db), std::move(agg_schema), std::move(group_schema));
+        Translate(agg_plan->child_, db, vectorized), std::move(agg_schema), std::move(group_schema));
   } else if (const auto lim = std::dynamic_pointer_cast<LimitPlan>(plan)) {
-    return std::make_unique<LimitExecutor>(Translate(lim->child_, db), lim->limit_);
+    return std::make_unique<LimitExecutor>(Translate(lim->child_, db, vectorized), lim->limit_);
 
   } else {
     NJUDB_FATAL("Unknown plan type");
@@ -138,6 +201,20 @@ void Executor::Execute(const AbstractExecutorUptr &executor, Context *ctx)
   } else {
     auto header = executor->GetOutSchema();
     ctx->nt_ctl_->SendRecHeader(ctx->client_fd_, header);
+    if (dynamic_cast<AbstractVecExecutor *>(executor.get()) != nullptr) {
+      // the records of a vectorized executor are materialized from its chunks only to be sent, they are built in the
+      // arena of the query, which is cleared after each chunk
+      Arena arena;
+      executor->Init();
+      for (auto chunk = executor->NextChunk(); chunk != nullptr; chunk = executor->NextChunk()) {
+        for (size_t i = 0; i < chunk->GetSelectedCount(); i++) {
+          ctx->nt_ctl_->SendRec(ctx->client_fd_, chunk->GetRecordView(arena, chunk->GetSelectedRow(i)));
+        }
+        arena.Reset();
+      }
+      ctx->nt_ctl_->SendRecFinish(ctx->client_fd_);
+      return;
+    }
     for (executor->Init(); !executor->IsEnd(); executor->Next()) {
       auto rec = executor->GetRecord();
       NJUDB_ASSERT(rec != nullptr, "");
@@ -30,11 +30,23 @@ namespace njudb {
 class Executor
 {
 public:
-  Executor() = default;
+  /**
+   * @param vectorized translate scans, filters, projections, aggregations, hash joins and sorts of queries to the
+   * vectorized executors, which pass chunks of records to each other, see AbstractVecExecutor. Top-n sorts are
+   * translated to the vectorized executor either way.
+   */
+  explicit Executor(bool vectorized = false) : vectorized_(vectorized) {}
 
   auto Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHandle *db) -> AbstractExecutorUptr;
 
   void Execute(const AbstractExecutorUptr &executor, Context *ctx);
+
+private:
+  auto Translate(const std::shared_ptr<AbstractPlan> &plan, DatabaseHandle *db, bool vectorized)
+      -> AbstractExecutorUptr;
+
+private:
+  bool vectorized_;
 };
 }  // namespace njudb
 
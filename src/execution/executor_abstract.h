@@ -24,7 +24,7 @@
 
 #include "../../common/error.h"
 #include "../../common/micro.h"
-#include "common/record.h"
+#include "common/vector_chunk.h"
 
 namespace njudb {
 
@@ -71,6 +71,15 @@ public:
     return std::make_unique<Record>(*record_);
   };
 
+  /**
+   * Get the next chunk of at most VECTOR_SIZE records after Init, the chunks of the vectorized executors are filled in
+   * by the executors, the other executors fill the chunk with their records one by one through Next.
+   * It is not virtual so that the virtual table stays that of the executors in the gold libraries of the labs, it
+   * dispatches to AbstractVecExecutor by its type instead.
+   * @return nullptr if there is no more record
+   */
+  auto NextChunk() -> VectorChunkUptr;
+
 protected:
   RecordSchemaUptr out_schema_;
   RecordUptr       record_;
@@ -81,6 +90,99 @@ private:
 
 DEFINE_UNIQUE_PTR(AbstractExecutor);
 
+/**
+ * Base of the vectorized executors, which work on a chunk of records at a time. They are driven by NextChunk by a
+ * vectorized parent, and walk through the rows of their chunks for Next and IsEnd so that any executor can be their
+ * parent.
+ */
+class AbstractVecExecutor : public AbstractExecutor
+{
+public:
+  AbstractVecExecutor() : AbstractExecutor(Basic) {}
+
+  ~AbstractVecExecutor() override = default;
+
+  void Init() final
+  {
+    InitVec();
+    pos_   = 0;
+    chunk_ = FetchSelectedChunk();
+    LoadRecord();
+  }
+
+  void Next() final
+  {
+    if (++pos_ == chunk_->GetSelectedCount()) {
+      pos_   = 0;
+      chunk_ = FetchSelectedChunk();
+    }
+    LoadRecord();
+  }
+
+  [[nodiscard]] auto IsEnd() const -> bool final { return chunk_ == nullptr; }
+
+  /**
+   * The chunk returned by AbstractExecutor::NextChunk for a vectorized executor
+   */
+  auto NextVecChunk() -> VectorChunkUptr
+  {
+    if (chunk_ == nullptr) {
+      return FetchSelectedChunk();
+    }
+    // the first chunk has been fetched by Init, drop the rows already returned by Next
+    if (pos_ > 0) {
+      auto rows = chunk_->GetSelectedRows();
+      rows.erase(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(pos_));
+      chunk_->SetSelection(std::move(rows));
+      pos_ = 0;
+    }
+    record_ = nullptr;
+    return std::move(chunk_);
+  }
+
+protected:
+  virtual void InitVec() = 0;
+
+  /**
+   * @return the next chunk, whose rows may all be filtered out by the selection vector, nullptr if there is no more
+   */
+  virtual auto FetchChunk() -> VectorChunkUptr = 0;
+
+private:
+  auto FetchSelectedChunk() -> VectorChunkUptr
+  {
+    auto chunk = FetchChunk();
+    while (chunk != nullptr && chunk->GetSelectedCount() == 0) {
+      chunk = FetchChunk();
+    }
+    return chunk;
+  }
+
+  void LoadRecord() { record_ = chunk_ == nullptr ? nullptr : chunk_->GetRecord(chunk_->GetSelectedRow(pos_)); }
+
+private:
+  VectorChunkUptr chunk_;
+  size_t          pos_{0};
+};
+
+DEFINE_UNIQUE_PTR(AbstractVecExecutor);
+
+inline auto AbstractExecutor::NextChunk() -> VectorChunkUptr
+{
+  if (auto *vec = dynamic_cast<AbstractVecExecutor *>(this); vec != nullptr) {
+    return vec->NextVecChunk();
+  }
+  if (IsEnd()) {
+    return nullptr;
+  }
+  auto chunk = std::make_unique<VectorChunk>(GetOutSchema());
+  while (!IsEnd() && !chunk->IsFull()) {
+    chunk->AppendRecord(*record_);
+    Next();
+  }
+  return chunk;
+}
+
 }  // namespace njudb
 
 #endif  // NJUDB_EXECUTOR_ABSTRACT_H
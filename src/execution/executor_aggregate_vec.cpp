@@ -15,10 +15,247 @@
  - along with this program.  If not, see <https://www.gnu.org/licenses/>.
  -----------------------------------------------------------------------------*/
 
+
 //
 // Created by ziqi on 2024/8/12.
 //
 
 #include "executor_aggregate_vec.h"
 
-namespace njudb {}  // namespace njudb
\ No newline at end of file
+namespace njudb {
+
+AggregateExecutorVec::AggregateExecutorVec(
+    AbstractExecutorUptr child, RecordSchemaUptr agg_schema, RecordSchemaUptr group_schema)
+    : child_(std::move(child)), agg_schema_(std::move(agg_schema)), group_schema_(std::move(group_schema))
+{
+  std::vector<RTField> fields;
+  for (const auto &field : group_schema_->GetFields()) {
+    fields.push_back(field);
+  }
+  for (const auto &field : agg_schema_->GetFields()) {
+    fields.push_back(field);
+  }
+  out_schema_ = std::make_unique<RecordSchema>(fields);
+
+  // like AggregateExecutor, fields are found by table id and field name only
+  auto child_schema = child_->GetOutSchema();
+  auto find_field   = [child_schema](const RTField &field) {
+    auto idx = child_schema->GetFieldIndex(field.field_.table_id_, field.field_.field_name_);
+    if (idx == child_schema->GetFieldCount()) {
+      NJUDB_THROW(NJUDB_FIELD_MISS, field.field_.field_name_);
+    }
+    return idx;
+  };
+  for (const auto &field : group_schema_->GetFields()) {
+    group_idx_.push_back(find_field(field));
+  }
+  for (const auto &field : agg_schema_->GetFields()) {
+    AggState state{field.agg_type_, 0, TYPE_NULL, {}, {}, {}, {}};
+    if (field.agg_type_ != AGG_COUNT_STAR) {
+      state.col_idx_ = find_field(field);
+      state.type_    = child_schema->GetFieldAt(state.col_idx_).field_.field_type_;
+    }
+    if ((field.agg_type_ == AGG_SUM || field.agg_type_ == AGG_AVG) && state.type_ != TYPE_INT &&
+        state.type_ != TYPE_FLOAT) {
+      NJUDB_THROW(NJUDB_UNSUPPORTED_OP,
+          fmt::format("{} on {}", AggTypeToString(field.agg_type_), FieldTypeToString(state.type_)));
+    }
+    states_.push_back(std::move(state));
+  }
+}
+
+void AggregateExecutorVec::InitVec()
+{
+  child_->Init();
+  group_map_.clear();
+  groups_    = std::make_unique<VectorChunk>(group_schema_.get());
+  group_num_ = 0;
+  for (auto &state : states_) {
+    state.count_.clear();
+    state.int_acc_.clear();
+    state.float_acc_.clear();
+    state.str_acc_.clear();
+  }
+  // without group fields, all the records fall into one group, which exists even if there is no record
+  if (group_idx_.empty()) {
+    AddGroup();
+  }
+  consumed_ = false;
+  emit_pos_ = 0;
+}
+
+void AggregateExecutorVec::AddGroup()
+{
+  group_num_++;
+  for (auto &state : states_) {
+    state.count_.push_back(0);
+    state.int_acc_.push_back(0);
+    state.float_acc_.push_back(0);
+    if (state.type_ == TYPE_STRING || state.type_ == TYPE_VARCHAR) {
+      state.str_acc_.emplace_back();
+    }
+  }
+}
+
+void AggregateExecutorVec::Consume(const VectorChunk &chunk)
+{
+  auto rows = chunk.GetSelectedRows();
+  group_ids_.assign(chunk.GetRowCount(), 0);
+  if (!group_idx_.empty()) {
+    std::string key;
+    for (auto row : rows) {
+      key.clear();
+      chunk.PackRow(group_idx_, row, key);
+      auto [iter, inserted] = group_map_.try_emplace(key, group_num_);
+      if (inserted) {
+        for (size_t i = 0; i < group_idx_.size(); i++) {
+          groups_->GetCol(i).Append(chunk.GetCol(group_idx_[i]), row);
+        }
+        AddGroup();
+      }
+      group_ids_[row] = iter->second;
+    }
+  }
+  for (auto &state : states_) {
+    Update(state, chunk, rows);
+  }
+}
+
+void AggregateExecutorVec::Update(AggState &state, const VectorChunk &chunk, const std::vector<uint32_t> &rows)
+{
+  auto &count = state.count_;
+  if (state.agg_type_ == AGG_COUNT_STAR) {
+    for (auto row : rows) {
+      count[group_ids_[row]]++;
+    }
+    return;
+  }
+  const auto &col   = chunk.GetCol(state.col_idx_);
+  auto        nulls = col.GetNulls();
+  if (state.agg_type_ == AGG_COUNT) {
+    for (auto row : rows) {
+      count[group_ids_[row]] += nulls[row] == 0 ? 1 : 0;
+    }
+    return;
+  }
+  bool is_min = state.agg_type_ == AGG_MIN;
+  // the first value of a group is taken as it is by MIN and MAX
+  auto update = [&state, is_min](auto &acc, size_t group, auto value) {
+    if (state.agg_type_ == AGG_SUM || state.agg_type_ == AGG_AVG) {
+      acc[group] += value;
+    } else if (state.count_[group] == 0 || (is_min ? value < acc[group] : acc[group] < value)) {
+      acc[group] = value;
+    }
+    state.count_[group]++;
+  };
+  switch (state.type_) {
+    case TYPE_INT: {
+      auto data = reinterpret_cast<const int32_t *>(col.GetData());
+      for (auto row : rows) {
+        if (nulls[row] == 0) {
+          update(state.int_acc_, group_ids_[row], static_cast<int64_t>(data[row]));
+        }
+      }
+      break;
+    }
+    case TYPE_FLOAT: {
+      auto data = reinterpret_cast<const float *>(col.GetData());
+      for (auto row : rows) {
+        if (nulls[row] == 0) {
+          update(state.float_acc_, group_ids_[row], data[row]);
+        }
+      }
+      break;
+    }
+    case TYPE_BOOL: {
+      auto data = reinterpret_cast<const bool *>(col.GetData());
+      for (auto row : rows) {
+        if (nulls[row] == 0) {
+          update(state.int_acc_, group_ids_[row], static_cast<int64_t>(data[row]));
+        }
+      }
+      break;
+    }
+    case TYPE_STRING:
+    case TYPE_VARCHAR: {
+      for (auto row : rows) {
+        if (nulls[row] == 0) {
+          auto   str   = col.GetString(row);
+          size_t group = group_ids_[row];
+          if (state.count_[group] == 0 || (is_min ? str < state.str_acc_[group] : state.str_acc_[group] < str)) {
+            state.str_acc_[group] = str;
+          }
+          state.count_[group]++;
+        }
+      }
+      break;
+    }
+    default: NJUDB_THROW(NJUDB_UNSUPPORTED_OP, FieldTypeToString(state.type_));
+  }
+}
+
+void AggregateExecutorVec::Finalize(const AggState &state, size_t group, ColumnVector &col)
+{
+  auto count = state.count_[group];
+  if (state.agg_type_ == AGG_COUNT_STAR || state.agg_type_ == AGG_COUNT) {
+    auto value = static_cast<int32_t>(count);
+    col.Append(reinterpret_cast<const char *>(&value), false);
+    return;
+  }
+  if (count == 0) {
+    col.Append(nullptr, true);
+    return;
+  }
+  switch (state.type_) {
+    case TYPE_INT: {
+      auto acc   = state.agg_type_ == AGG_AVG ? state.int_acc_[group] / count : state.int_acc_[group];
+      auto value = static_cast<int32_t>(acc);
+      col.Append(reinterpret_cast<const char *>(&value), false);
+      break;
+    }
+    case TYPE_FLOAT: {
+      auto value = state.float_acc_[group];
+      if (state.agg_type_ == AGG_AVG) {
+        value /= static_cast<float>(count);
+      }
+      col.Append(reinterpret_cast<const char *>(&value), false);
+      break;
+    }
+    case TYPE_BOOL: {
+      bool value = state.int_acc_[group] != 0;
+      col.Append(reinterpret_cast<const char *>(&value), false);
+      break;
+    }
+    default: {
+      std::string value(state.str_acc_[group]);
+      value.resize(col.GetWidth(), '\0');
+      col.Append(value.data(), false);
+    }
+  }
+}
+
+auto AggregateExecutorVec::FetchChunk() -> VectorChunkUptr
+{
+  if (!consumed_) {
+    for (auto chunk = child_->NextChunk(); chunk != nullptr; chunk = child_->NextChunk()) {
+      Consume(*chunk);
+    }
+    consumed_ = true;
+  }
+  if (emit_pos_ == group_num_) {
+    return nullptr;
+  }
+  auto chunk = std::make_unique<VectorChunk>(out_schema_.get());
+  auto end   = std::min(group_num_, emit_pos_ + VECTOR_SIZE);
+  for (; emit_pos_ < end; emit_pos_++) {
+    for (size_t i = 0; i < group_idx_.size(); i++) {
+      chunk->GetCol(i).Append(groups_->GetCol(i), emit_pos_);
+    }
+    for (size_t i = 0; i < states_.size(); i++) {
+      Finalize(states_[i], emit_pos_, chunk->GetCol(group_idx_.size() + i));
+    }
+  }
+  return chunk;
+}
+
+}  // namespace njudb
@@ -15,18 +15,77 @@
  - along with this program.  If not, see <https://www.gnu.org/licenses/>.
  -----------------------------------------------------------------------------*/
 
+
 //
 // Created by ziqi on 2024/8/12.
 //
 
+/**
+ * @brief Vectorized hash aggregation. The rows of each chunk of the child are first mapped to their group ids through a
+ * hash table keyed by the packed values of the group columns (see VectorChunk::PackRow), then each aggregate updates
+ * the states of the groups in a loop over its input column typed by the column type.
+ */
+
 #ifndef NJUDB_EXECUTOR_AGGREGATE_VEC_H
 #define NJUDB_EXECUTOR_AGGREGATE_VEC_H
+#include <string>
+#include <unordered_map>
 #include "executor_abstract.h"
 
 namespace njudb {
 
-class AggregateExecutorVec : public AbstractExecutor
-{};
+class AggregateExecutorVec : public AbstractVecExecutor
+{
+public:
+  AggregateExecutorVec(AbstractExecutorUptr child, RecordSchemaUptr agg_schema, RecordSchemaUptr group_schema);
+
+private:
+  void InitVec() override;
+
+  auto FetchChunk() -> VectorChunkUptr override;
+
+  // the states of an aggregate of all the groups, indexed by group id
+  struct AggState
+  {
+    AggType   agg_type_;
+    size_t    col_idx_;  // input column in the chunks of the child, unused by COUNT(*)
+    FieldType type_;     // type of the input column
+
+    std::vector<int64_t>     count_;      // number of non-null values aggregated
+    std::vector<int64_t>     int_acc_;    // SUM and AVG of INT, MIN and MAX of INT and BOOL
+    std::vector<float>       float_acc_;  // SUM, AVG, MIN and MAX of FLOAT
+    std::vector<std::string> str_acc_;    // MIN and MAX of strings
+  };
+
+  /**
+   * Aggregate the rows alive in the chunk into their groups, new groups are added to the hash table
+   */
+  void Consume(const VectorChunk &chunk);
+
+  void Update(AggState &state, const VectorChunk &chunk, const std::vector<uint32_t> &rows);
+
+  void AddGroup();
+
+  /**
+   * Write the result of the aggregate of the group into col
+   */
+  static void Finalize(const AggState &state, size_t group, ColumnVector &col);
+
+private:
+  AbstractExecutorUptr child_;
+  RecordSchemaUptr     agg_schema_;
+  RecordSchemaUptr     group_schema_;
+
+  std::vector<size_t>                     group_idx_;  // group columns in the chunks of the child
+  std::unordered_map<std::string, size_t> group_map_;  // packed group values -> group id
+  VectorChunkUptr                         groups_;     // values of the group columns of each group
+  size_t                                  group_num_{0};
+  std::vector<AggState>                   states_;
+  std::vector<size_t>                     group_ids_;  // group ids of the rows of the chunk being consumed
+
+  bool   consumed_{false};
+  size_t emit_pos_{0};  // groups before it have been returned
+};
 
 }  // namespace njudb
 
@@ -23,18 +23,26 @@
 #define NJUDB_EXECUTOR_DEFS_H
 
 #include "executor_aggregate.h"
+#include "executor_aggregate_vec.h"
 #include "executor_ddl.h"
 #include "executor_delete.h"
 #include "executor_filter.h"
+#include "executor_filter_vec.h"
 #include "executor_idxscan.h"
 #include "executor_insert.h"
 #include "executor_join_nestedloop.h"
 #include "executor_join_hash.h"
+#include "executor_join_hash_vec.h"
 #include "executor_join_sortmerge.h"
 #include "executor_limit.h"
 #include "executor_projection.h"
+#include "executor_projection_vec.h"
 #include "executor_seqscan.h"
+#include "executor_seqscan_vec.h"
+#include "executor_show_bufferpool.h"
 #include "executor_sort.h"
+#include "executor_sort_vec.h"
+#include "executor_topn_vec.h"
 #include "executor_update.h"
 
 #endif  // NJUDB_EXECUTOR_DEFS_H
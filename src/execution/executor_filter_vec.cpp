@@ -0,0 +1,40 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "executor_filter_vec.h"
+#include "expr/condition_expr.h"
+
+namespace njudb {
+
+FilterExecutorVec::FilterExecutorVec(AbstractExecutorUptr child, ConditionVec conds)
+    : child_(std::move(child)), conds_(std::move(conds))
+{}
+
+auto FilterExecutorVec::GetOutSchema() const -> const RecordSchema * { return child_->GetOutSchema(); }
+
+void FilterExecutorVec::InitVec() { child_->Init(); }
+
+auto FilterExecutorVec::FetchChunk() -> VectorChunkUptr
+{
+  auto chunk = child_->NextChunk();
+  if (chunk != nullptr) {
+    ConditionExpr::Select(conds_, *chunk);
+  }
+  return chunk;
+}
+
+}  // namespace njudb
@@ -0,0 +1,49 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Vectorized filter, narrows the selection vector of the chunks of the child with ConditionExpr::Select, the
+ * values of the chunks are not moved
+ */
+
+#ifndef NJUDB_EXECUTOR_FILTER_VEC_H
+#define NJUDB_EXECUTOR_FILTER_VEC_H
+#include "executor_abstract.h"
+#include "common/condition.h"
+
+namespace njudb {
+
+class FilterExecutorVec : public AbstractVecExecutor
+{
+public:
+  FilterExecutorVec(AbstractExecutorUptr child, ConditionVec conds);
+
+  [[nodiscard]] auto GetOutSchema() const -> const RecordSchema * override;
+
+private:
+  void InitVec() override;
+
+  auto FetchChunk() -> VectorChunkUptr override;
+
+private:
+  AbstractExecutorUptr child_;
+  ConditionVec         conds_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_EXECUTOR_FILTER_VEC_H
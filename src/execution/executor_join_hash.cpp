@@ -38,7 +38,10 @@ HashJoinExecutor::HashJoinExecutor(JoinType join_type, AbstractExecutorUptr left
       current_left_has_match_(false),
       need_output_null_match_(false),
       build_records_(0),
-      probe_records_(0)
+      probe_records_(0),
+      left_key_hash_(left_->GetOutSchema(), left_key_schema_.get()),
+      right_key_hash_(right_->GetOutSchema(), right_key_schema_.get()),
+      key_cmp_(left_->GetOutSchema(), left_key_schema_.get(), right_->GetOutSchema(), right_key_schema_.get())
 {
   if (use_bloom_filter_) {
     bloom_filter_ = std::make_unique<BloomFilter>(8192, 3);
@@ -0,0 +1,198 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "executor_join_hash_vec.h"
+#include "expr/condition_expr.h"
+
+#include <algorithm>
+
+namespace njudb {
+
+HashJoinExecutorVec::HashJoinExecutorVec(JoinType join_type, AbstractExecutorUptr left, AbstractExecutorUptr right,
+    RecordSchemaUptr left_key_schema, RecordSchemaUptr right_key_schema, ConditionVec conditions)
+    : join_type_(join_type),
+      left_(std::move(left)),
+      right_(std::move(right)),
+      left_key_schema_(std::move(left_key_schema)),
+      right_key_schema_(std::move(right_key_schema)),
+      conditions_(std::move(conditions))
+{
+  NJUDB_ASSERT(join_type_ == INNER_JOIN || join_type_ == OUTER_JOIN, "Unknown join type");
+  NJUDB_ASSERT(IsKeyCompatible(*left_key_schema_, *right_key_schema_), "Incompatible join keys");
+  auto                 left_schema  = left_->GetOutSchema();
+  auto                 right_schema = right_->GetOutSchema();
+  std::vector<RTField> fields;
+  fields.reserve(left_schema->GetFieldCount() + right_schema->GetFieldCount());
+  for (const auto &field : left_schema->GetFields()) {
+    fields.push_back(field);
+  }
+  for (const auto &field : right_schema->GetFields()) {
+    fields.push_back(field);
+  }
+  out_schema_ = std::make_unique<RecordSchema>(fields);
+
+  auto find_keys = [](const RecordSchema &schema, const RecordSchema &key_schema, std::vector<size_t> &key_idx) {
+    for (const auto &field : key_schema.GetFields()) {
+      auto idx = schema.GetRTFieldIndex(field);
+      if (idx == schema.GetFieldCount()) {
+        NJUDB_THROW(NJUDB_FIELD_MISS, field.field_.field_name_);
+      }
+      key_idx.push_back(idx);
+    }
+  };
+  find_keys(*left_schema, *left_key_schema_, left_key_idx_);
+  find_keys(*right_schema, *right_key_schema_, right_key_idx_);
+}
+
+auto HashJoinExecutorVec::IsKeyCompatible(const RecordSchema &left_key_schema, const RecordSchema &right_key_schema)
+    -> bool
+{
+  if (left_key_schema.GetFieldCount() != right_key_schema.GetFieldCount()) {
+    return false;
+  }
+  auto kind = [](FieldType type) { return type == TYPE_VARCHAR ? TYPE_STRING : type; };
+  for (size_t i = 0; i < left_key_schema.GetFieldCount(); i++) {
+    if (kind(left_key_schema.GetFieldAt(i).field_.field_type_) !=
+        kind(right_key_schema.GetFieldAt(i).field_.field_type_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HashJoinExecutorVec::InitVec()
+{
+  left_->Init();
+  right_->Init();
+  BuildHashTable();
+  pending_.clear();
+  left_end_ = false;
+}
+
+static auto HasNullKey(const VectorChunk &chunk, const std::vector<size_t> &key_idx, size_t row) -> bool
+{
+  return std::any_of(key_idx.begin(), key_idx.end(), [&](size_t idx) { return chunk.GetCol(idx).IsNull(row); });
+}
+
+void HashJoinExecutorVec::BuildHashTable()
+{
+  build_chunks_.clear();
+  hash_table_.clear();
+  std::string key;
+  for (auto chunk = right_->NextChunk(); chunk != nullptr; chunk = right_->NextChunk()) {
+    auto chunk_id = static_cast<uint32_t>(build_chunks_.size());
+    for (size_t i = 0; i < chunk->GetSelectedCount(); i++) {
+      auto row = chunk->GetSelectedRow(i);
+      if (HasNullKey(*chunk, right_key_idx_, row)) {
+        continue;
+      }
+      key.clear();
+      chunk->PackRow(right_key_idx_, row, key);
+      hash_table_[key].emplace_back(chunk_id, static_cast<uint32_t>(row));
+    }
+    build_chunks_.push_back(std::move(chunk));
+  }
+}
+
+void HashJoinExecutorVec::FlushPairs(
+    VectorChunkUptr pairs, const std::vector<uint32_t> &probe_rows, std::vector<bool> &matched)
+{
+  if (pairs->GetRowCount() == 0) {
+    return;
+  }
+  if (!conditions_.empty()) {
+    ConditionExpr::Select(conditions_, *pairs);
+  }
+  for (size_t i = 0; i < pairs->GetSelectedCount(); i++) {
+    matched[probe_rows[pairs->GetSelectedRow(i)]] = true;
+  }
+  pending_.push_back(std::move(pairs));
+}
+
+void HashJoinExecutorVec::Probe(const VectorChunk &probe)
+{
+  // matched is indexed by the rows of the probe chunk, probe_rows by the rows of the chunk of pairs
+  std::vector<bool>     matched(probe.GetRowCount(), false);
+  std::vector<uint32_t> probe_rows;
+  auto                  pairs = std::make_unique<VectorChunk>(out_schema_.get());
+  std::string           key;
+  for (size_t i = 0; i < probe.GetSelectedCount(); i++) {
+    auto row = probe.GetSelectedRow(i);
+    if (HasNullKey(probe, left_key_idx_, row)) {
+      continue;
+    }
+    key.clear();
+    probe.PackRow(left_key_idx_, row, key);
+    auto iter = hash_table_.find(key);
+    if (iter == hash_table_.end()) {
+      continue;
+    }
+    for (auto [chunk_id, build_row] : iter->second) {
+      pairs->AppendRow(probe, row, *build_chunks_[chunk_id], build_row);
+      probe_rows.push_back(static_cast<uint32_t>(row));
+      if (pairs->IsFull()) {
+        FlushPairs(std::move(pairs), probe_rows, matched);
+        pairs = std::make_unique<VectorChunk>(out_schema_.get());
+        probe_rows.clear();
+      }
+    }
+  }
+  FlushPairs(std::move(pairs), probe_rows, matched);
+  if (join_type_ != OUTER_JOIN) {
+    return;
+  }
+  auto padded = std::make_unique<VectorChunk>(out_schema_.get());
+  for (size_t i = 0; i < probe.GetSelectedCount(); i++) {
+    auto row = probe.GetSelectedRow(i);
+    if (matched[row]) {
+      continue;
+    }
+    for (size_t col = 0; col < probe.GetColCount(); col++) {
+      padded->GetCol(col).Append(probe.GetCol(col), row);
+    }
+    for (size_t col = probe.GetColCount(); col < padded->GetColCount(); col++) {
+      padded->GetCol(col).Append(nullptr, true);
+    }
+    if (padded->IsFull()) {
+      pending_.push_back(std::move(padded));
+      padded = std::make_unique<VectorChunk>(out_schema_.get());
+    }
+  }
+  if (padded->GetRowCount() > 0) {
+    pending_.push_back(std::move(padded));
+  }
+}
+
+auto HashJoinExecutorVec::FetchChunk() -> VectorChunkUptr
+{
+  while (pending_.empty() && !left_end_) {
+    auto probe = left_->NextChunk();
+    if (probe == nullptr) {
+      left_end_ = true;
+      break;
+    }
+    Probe(*probe);
+  }
+  if (pending_.empty()) {
+    return nullptr;
+  }
+  auto chunk = std::move(pending_.front());
+  pending_.pop_front();
+  return chunk;
+}
+
+}  // namespace njudb
@@ -0,0 +1,88 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_EXECUTOR_JOIN_HASH_VEC_H
+#define NJUDB_EXECUTOR_JOIN_HASH_VEC_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "executor_abstract.h"
+#include "common/condition.h"
+
+namespace njudb {
+
+/**
+ * Vectorized hash join for equi-join conditions
+ * - the chunks of the right child are kept in memory and their rows are put into a hash table keyed by the packed
+ *   values of the right key columns (see VectorChunk::PackRow)
+ * - each chunk of the left child probes the hash table, the pairs found are gathered into chunks of at most
+ *   VECTOR_SIZE records, which are filtered by the join conditions with ConditionExpr::Select
+ * - for an outer join, the left records without any pair left are padded with nulls
+ * Keys with nulls never match. The key columns on both sides must be of the same type, see IsKeyCompatible.
+ */
+class HashJoinExecutorVec : public AbstractVecExecutor
+{
+public:
+  HashJoinExecutorVec(JoinType join_type, AbstractExecutorUptr left, AbstractExecutorUptr right,
+      RecordSchemaUptr left_key_schema, RecordSchemaUptr right_key_schema, ConditionVec conditions);
+
+  /**
+   * @return whether the keys compare equal iff their packed values are equal
+   */
+  static auto IsKeyCompatible(const RecordSchema &left_key_schema, const RecordSchema &right_key_schema) -> bool;
+
+private:
+  void InitVec() override;
+
+  auto FetchChunk() -> VectorChunkUptr override;
+
+  void BuildHashTable();
+
+  /**
+   * Join a chunk of the left child and push the results into the pending chunks
+   */
+  void Probe(const VectorChunk &probe);
+
+  /**
+   * Filter the chunk of pairs by the join conditions, mark the left rows still having a pair and push the chunk
+   */
+  void FlushPairs(VectorChunkUptr pairs, const std::vector<uint32_t> &probe_rows, std::vector<bool> &matched);
+
+private:
+  JoinType             join_type_;
+  AbstractExecutorUptr left_;
+  AbstractExecutorUptr right_;
+  RecordSchemaUptr     left_key_schema_;
+  RecordSchemaUptr     right_key_schema_;
+  ConditionVec         conditions_;
+  std::vector<size_t>  left_key_idx_;
+  std::vector<size_t>  right_key_idx_;
+
+  // chunks of the right child and the hash table of their rows, key -> (chunk, row)
+  std::vector<VectorChunkUptr>                                                build_chunks_;
+  std::unordered_map<std::string, std::vector<std::pair<uint32_t, uint32_t>>> hash_table_;
+
+  std::deque<VectorChunkUptr> pending_;  // joined chunks to return
+  bool                        left_end_{false};
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_EXECUTOR_JOIN_HASH_VEC_H
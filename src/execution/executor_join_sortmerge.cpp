@@ -28,9 +28,15 @@ SortMergeJoinExecutor::SortMergeJoinExecutor(JoinType join_type, AbstractExecuto
     : JoinExecutor(join_type, std::move(left), std::move(right), {}),
       left_key_schema_(std::move(left_key_schema)),
       right_key_schema_(std::move(right_key_schema)),
-      join_op_(join_op)
+      join_op_(join_op),
+      key_cmp_(left_->GetOutSchema(), left_key_schema_.get(), right_->GetOutSchema(), right_key_schema_.get())
 {}
 
+auto SortMergeJoinExecutor::Compare(const Record &left, const Record &right) const -> int
+{
+  return key_cmp_.Compare(left, right);
+}
+
 void SortMergeJoinExecutor::InitInnerJoin() { NJUDB_STUDENT_TODO(l3, f2); }
 
 void SortMergeJoinExecutor::NextInnerJoin() { NJUDB_STUDENT_TODO(l3, f2); }
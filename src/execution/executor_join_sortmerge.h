@@ -29,6 +29,7 @@
 
 #include "executor_join.h"
 #include "common/types.h"
+#include "common/record_comparator.h"
 
 namespace njudb {
 class SortMergeJoinExecutor : public JoinExecutor
@@ -51,7 +52,7 @@ private:
   [[nodiscard]] auto IsEndOuterJoin() const -> bool override;
 
   /**
-   * lexical compare used in equality join
+   * lexical compare of the keys of a left and a right record used in equality join, the keys are read in place
    */
   [[nodiscard]] auto Compare(const Record &left, const Record &right) const -> int;
 
@@ -81,6 +82,11 @@ private:
   // For inequality joins: track right iterator position
   RecordUptr right_rec_;
   bool       right_exhausted_{false};
+
+  // the join of the gold library of lab03 has the layout without it
+#ifndef NJUDB_GOLD_LAB03
+  RecordComparator key_cmp_;
+#endif
 };
 }  // namespace njudb
 
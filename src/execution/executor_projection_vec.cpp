@@ -0,0 +1,55 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "executor_projection_vec.h"
+
+namespace njudb {
+
+ProjectionExecutorVec::ProjectionExecutorVec(AbstractExecutorUptr child, RecordSchemaUptr proj_schema)
+    : child_(std::move(child))
+{
+  out_schema_ = std::move(proj_schema);
+  for (const auto &field : out_schema_->GetFields()) {
+    auto idx = child_->GetOutSchema()->GetRTFieldIndex(field);
+    if (idx == child_->GetOutSchema()->GetFieldCount()) {
+      NJUDB_FATAL("Field not found in child schema");
+    }
+    col_idx_.push_back(idx);
+  }
+}
+
+void ProjectionExecutorVec::InitVec() { child_->Init(); }
+
+auto ProjectionExecutorVec::FetchChunk() -> VectorChunkUptr
+{
+  auto child_chunk = child_->NextChunk();
+  if (child_chunk == nullptr) {
+    return nullptr;
+  }
+  std::vector<ColumnVectorSptr> cols;
+  cols.reserve(col_idx_.size());
+  for (auto idx : col_idx_) {
+    cols.push_back(child_chunk->GetColPtr(idx));
+  }
+  auto chunk = std::make_unique<VectorChunk>(out_schema_.get(), std::move(cols));
+  if (child_chunk->HasSelection()) {
+    chunk->SetSelection(child_chunk->GetSelection());
+  }
+  return chunk;
+}
+
+}  // namespace njudb
@@ -0,0 +1,45 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Vectorized projection, the columns in the projection schema are taken from the chunks of the child without
+ * being copied, the selection vector is kept
+ */
+
+#ifndef NJUDB_EXECUTOR_PROJECTION_VEC_H
+#define NJUDB_EXECUTOR_PROJECTION_VEC_H
+
+#include "executor_abstract.h"
+
+namespace njudb {
+class ProjectionExecutorVec : public AbstractVecExecutor
+{
+public:
+  ProjectionExecutorVec(AbstractExecutorUptr child, RecordSchemaUptr proj_schema);
+
+private:
+  void InitVec() override;
+
+  auto FetchChunk() -> VectorChunkUptr override;
+
+private:
+  AbstractExecutorUptr child_;
+  std::vector<size_t>  col_idx_;  // index of each projected column in the schema of the child
+};
+}  // namespace njudb
+
+#endif  // NJUDB_EXECUTOR_PROJECTION_VEC_H
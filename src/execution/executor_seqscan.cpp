@@ -25,10 +25,14 @@ namespace njudb {
 
 SeqScanExecutor::SeqScanExecutor(TableHandle *tab) : AbstractExecutor(Basic), tab_(tab) {}
 
+SeqScanExecutor::SeqScanExecutor(TableHandle *tab, ConditionVec conds)
+    : AbstractExecutor(Basic), tab_(tab), conds_(std::move(conds))
+{}
+
 void SeqScanExecutor::Init()
 {
-  rid_ = tab_->GetFirstRID();
-  
+  rid_ = tab_->GetFirstRID(conds_);
+
   NJUDB_STUDENT_TODO(l2, t1);
 }
 
@@ -21,7 +21,9 @@
 
 /**
  * @brief Iterate over all records in the table, check TableHandle for more details
- * 
+ * The conditions of a filter right above the scan are pushed down to it, the scan passes them to
+ * TableHandle::GetFirstRID and TableHandle::GetNextRID to skip the pages excluded by the zone map, the records are
+ * still checked by the filter.
  */
 
 #ifndef NJUDB_EXECUTOR_SEQSCAN_H
@@ -35,6 +37,10 @@ class SeqScanExecutor : public AbstractExecutor
 public:
   explicit SeqScanExecutor(TableHandle *tab);
 
+#ifndef NJUDB_GOLD_LAB02
+  SeqScanExecutor(TableHandle *tab, ConditionVec conds);
+#endif
+
   void Init() override;
 
   void Next() override;
@@ -46,6 +52,10 @@ public:
 private:
   TableHandle *tab_;
   RID          rid_;
+  // the scan of the gold library of lab02 has the layout without pushed-down conditions
+#ifndef NJUDB_GOLD_LAB02
+  ConditionVec conds_;  // pushed-down conditions
+#endif
 };
 }  // namespace njudb
 
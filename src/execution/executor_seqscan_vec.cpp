@@ -0,0 +1,58 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "executor_seqscan_vec.h"
+#include "expr/condition_expr.h"
+
+namespace njudb {
+
+SeqScanExecutorVec::SeqScanExecutorVec(TableHandle *tab, ConditionVec conds) : tab_(tab), conds_(std::move(conds)) {}
+
+auto SeqScanExecutorVec::GetOutSchema() const -> const RecordSchema * { return &tab_->GetSchema(); }
+
+void SeqScanExecutorVec::InitVec()
+{
+  page_id_  = FILE_HEADER_PAGE_ID + 1;
+  buffer_   = std::make_unique<VectorChunk>(GetOutSchema());
+  filtered_ = true;
+}
+
+auto SeqScanExecutorVec::FetchChunk() -> VectorChunkUptr
+{
+  while (!buffer_->IsFull() && page_id_ < static_cast<page_id_t>(tab_->GetTableHeader().page_num_)) {
+    filtered_ = tab_->ReadVector(page_id_++, conds_, *buffer_) && filtered_;
+  }
+  auto rows = buffer_->GetRowCount();
+  if (rows == 0) {
+    return nullptr;
+  }
+  auto chunk = std::move(buffer_);
+  buffer_    = std::make_unique<VectorChunk>(GetOutSchema());
+  // whole pages are read, the records beyond VECTOR_SIZE are moved on to the next chunk
+  if (rows > VECTOR_SIZE) {
+    for (size_t i = 0; i < chunk->GetColCount(); i++) {
+      buffer_->GetCol(i).AppendRange(chunk->GetCol(i), VECTOR_SIZE, rows);
+      chunk->GetCol(i).Truncate(VECTOR_SIZE);
+    }
+  }
+  if (!filtered_) {
+    ConditionExpr::Select(conds_, *chunk);
+  }
+  return chunk;
+}
+
+}  // namespace njudb
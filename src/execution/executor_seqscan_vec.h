@@ -0,0 +1,53 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Vectorized sequential scan, reads the table page by page with TableHandle::ReadVector, which copies the values
+ * of the records straight into the columns of a chunk until it holds VECTOR_SIZE records. The pushed-down conditions
+ * are passed to ReadVector, so the pages excluded by the zone map are skipped and compressed PAX pages evaluate them on
+ * the encoded columns; the records of other pages are filtered by ConditionExpr::Select.
+ */
+
+#ifndef NJUDB_EXECUTOR_SEQSCAN_VEC_H
+#define NJUDB_EXECUTOR_SEQSCAN_VEC_H
+#include "executor_abstract.h"
+#include "system/handle/table_handle.h"
+
+namespace njudb {
+class SeqScanExecutorVec : public AbstractVecExecutor
+{
+public:
+  explicit SeqScanExecutorVec(TableHandle *tab, ConditionVec conds = {});
+
+  [[nodiscard]] auto GetOutSchema() const -> const RecordSchema * override;
+
+private:
+  void InitVec() override;
+
+  auto FetchChunk() -> VectorChunkUptr override;
+
+private:
+  TableHandle *tab_;
+  ConditionVec conds_;  // pushed-down conditions
+
+  page_id_t       page_id_{INVALID_PAGE_ID};  // the page to read next
+  VectorChunkUptr buffer_;                    // records read but not returned yet
+  bool            filtered_{true};            // whether the records read so far satisfy the conditions
+};
+}  // namespace njudb
+
+#endif  // NJUDB_EXECUTOR_SEQSCAN_VEC_H
@@ -0,0 +1,85 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#define MAX_TABNAME_LEN 128
+
+#include "executor_show_bufferpool.h"
+
+namespace njudb {
+
+ShowBufferPoolExecutor::ShowBufferPoolExecutor(BufferPoolManager *bpm)
+    : AbstractExecutor(DDL), bpm_(bpm), is_end_(false), cursor_(0)
+{
+  std::vector<RTField> fields;
+  fields.push_back(RTField{.field_ = {.table_id_ = INVALID_TABLE_ID,
+                               .field_name_      = "Name",
+                               .field_size_      = MAX_TABNAME_LEN,
+                               .field_type_      = TYPE_STRING}});
+  fields.push_back(RTField{.field_ = {.table_id_ = INVALID_TABLE_ID,
+                               .field_name_      = "Value",
+                               .field_size_      = 24,
+                               .field_type_      = TYPE_STRING}});
+  out_schema_ = std::make_unique<RecordSchema>(fields);
+}
+
+void ShowBufferPoolExecutor::Init()
+{
+  auto stats   = bpm_->GetStats();
+  auto fetches = stats.hits_ + stats.misses_;
+  rows_.clear();
+  rows_.emplace_back("pool size", std::to_string(stats.pool_size_));
+  rows_.emplace_back("partitions", std::to_string(bpm_->GetPartitionNum()));
+  rows_.emplace_back("replacer", REPLACER);
+  rows_.emplace_back("resident pages", std::to_string(stats.resident_pages_));
+  rows_.emplace_back("dirty pages", std::to_string(stats.dirty_pages_));
+  rows_.emplace_back("hits", std::to_string(stats.hits_));
+  rows_.emplace_back("misses", std::to_string(stats.misses_));
+  rows_.emplace_back(
+      "hit ratio", fetches == 0 ? "-" : fmt::format("{:.4f}", static_cast<double>(stats.hits_) / fetches));
+  rows_.emplace_back("prefetched pages", std::to_string(stats.prefetches_));
+  rows_.emplace_back("evictions", std::to_string(stats.evictions_));
+  rows_.emplace_back("pin waits", std::to_string(stats.pin_waits_));
+  rows_.emplace_back("foreground writes", std::to_string(stats.writes_.foreground_writes_));
+  rows_.emplace_back("background writes", std::to_string(stats.writes_.background_writes_));
+  for (const auto &[file, pages] : stats.file_residency_) {
+    rows_.emplace_back(fmt::format("resident pages of {}", file), std::to_string(pages));
+  }
+  cursor_ = 0;
+  is_end_ = false;
+  Next();
+}
+
+void ShowBufferPoolExecutor::Next()
+{
+  if (is_end_) {
+    NJUDB_FATAL("ShowBufferPoolExecutor is end");
+  }
+  if (cursor_ >= rows_.size()) {
+    is_end_ = true;
+    return;
+  }
+  const auto &[name, value] = rows_[cursor_];
+  std::vector<ValueSptr> values;
+  values.push_back(ValueFactory::CreateStringValue(name.c_str(), std::min(name.size(), size_t{MAX_TABNAME_LEN})));
+  values.push_back(ValueFactory::CreateStringValue(value.c_str(), std::min(value.size(), size_t{24})));
+  record_ = std::make_unique<Record>(out_schema_.get(), values, INVALID_RID);
+  cursor_++;
+}
+
+auto ShowBufferPoolExecutor::IsEnd() const -> bool { return is_end_; }
+
+}  // namespace njudb
@@ -0,0 +1,57 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Output the counters of the buffer pool, it is not a lab exercise so it is kept apart from the DDL executors
+ */
+
+#ifndef NJUDB_EXECUTOR_SHOW_BUFFERPOOL_H
+#define NJUDB_EXECUTOR_SHOW_BUFFERPOOL_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/buffer/buffer_pool_manager.h"
+#include "executor_abstract.h"
+
+namespace njudb {
+
+/**
+ * Output the counters of the buffer pool as (Name, Value) rows, see BufferPoolStats
+ */
+class ShowBufferPoolExecutor : public AbstractExecutor
+{
+public:
+  explicit ShowBufferPoolExecutor(BufferPoolManager *bpm);
+
+  void Init() override;
+
+  void Next() override;
+
+  [[nodiscard]] auto IsEnd() const -> bool override;
+
+private:
+  BufferPoolManager                               *bpm_;
+  std::vector<std::pair<std::string, std::string>> rows_;
+  bool                                             is_end_;
+  size_t                                           cursor_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_EXECUTOR_SHOW_BUFFERPOOL_H
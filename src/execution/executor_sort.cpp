@@ -36,7 +36,8 @@ SortExecutor::SortExecutor(AbstractExecutorUptr child, RecordSchemaUptr key_sche
       is_merge_sort_(false),
       max_rec_num_(SORT_BUFFER_SIZE / child_->GetOutSchema()->GetRecordLength()),
       tmp_file_num_(0),
-      merge_result_file_(fmt::format("sort_result_{}", sort_result_fresh_id_++))
+      merge_result_file_(fmt::format("sort_result_{}", sort_result_fresh_id_++)),
+      key_cmp_(child_->GetOutSchema(), key_schema_.get())
 {
   // For debugging, you can uncomment this line for more frequent sort and merge
   //  max_rec_num_ = 10;
@@ -79,9 +80,8 @@ auto SortExecutor::IsEnd() const -> bool
 
 auto SortExecutor::Compare(const Record &lhs, const Record &rhs) const -> bool
 {
-  auto lkey = std::make_unique<Record>(key_schema_.get(), lhs);
-  auto rkey = std::make_unique<Record>(key_schema_.get(), rhs);
-  return is_desc_ ? Record::Compare(*lkey, *rkey) > 0 : lkey->Compare(*lkey, *rkey) < 0;
+  auto res = key_cmp_.Compare(lhs, rhs);
+  return is_desc_ ? res > 0 : res < 0;
 }
 
 auto SortExecutor::GetOutSchema() const -> const RecordSchema * { return child_->GetOutSchema(); }
@@ -30,6 +30,7 @@
 #include <fstream>
 #include <utility>
 #include "executor_abstract.h"
+#include "common/record_comparator.h"
 
 namespace njudb {
 
@@ -143,6 +144,10 @@ private:
   std::string merge_result_file_;
   // we use file stream instead of disk manager to obtain faster sort speed;
   std::unique_ptr<std::ifstream> merge_result_file_handle_;
+  // compares the keys in place, no key record is built. The sort of the gold library of lab02 has the layout without it
+#ifndef NJUDB_GOLD_LAB02
+  RecordComparator key_cmp_;
+#endif
 };
 
 }  // namespace njudb
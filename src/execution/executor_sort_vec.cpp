@@ -0,0 +1,60 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "executor_sort_vec.h"
+
+#include "common/arena.h"
+
+namespace njudb {
+
+SortExecutorVec::SortExecutorVec(AbstractExecutorUptr child, RecordSchemaUptr key_schema, bool is_desc,
+    size_t buffer_size, size_t thread_num)
+    : child_(std::move(child)),
+      key_schema_(std::move(key_schema)),
+      is_desc_(is_desc),
+      buffer_size_(buffer_size),
+      thread_num_(thread_num)
+{}
+
+void SortExecutorVec::InitVec()
+{
+  // a sorter is created for each Init so that the executor can be rescanned
+  sorter_ = nullptr;
+  sorter_ = std::make_unique<ExternalSorter>(
+      child_->GetOutSchema(), key_schema_.get(), is_desc_, buffer_size_, thread_num_);
+  child_->Init();
+  Arena arena;
+  for (auto chunk = child_->NextChunk(); chunk != nullptr; chunk = child_->NextChunk()) {
+    for (size_t i = 0; i < chunk->GetSelectedCount(); i++) {
+      sorter_->Add(chunk->GetRecordView(arena, chunk->GetSelectedRow(i)));
+    }
+    arena.Reset();
+  }
+  sorter_->Finish();
+}
+
+auto SortExecutorVec::FetchChunk() -> VectorChunkUptr
+{
+  auto       chunk = std::make_unique<VectorChunk>(GetOutSchema());
+  RecordView record;
+  while (!chunk->IsFull() && sorter_->Next(record)) {
+    chunk->AppendRecord(record);
+  }
+  return chunk->GetRowCount() == 0 ? nullptr : std::move(chunk);
+}
+
+}  // namespace njudb
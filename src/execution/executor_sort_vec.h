@@ -0,0 +1,61 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Vectorized sort, the records of the child are sorted by ExternalSorter on their normalized keys, which sorts
+ * and merges with all the worker threads and spills to run files once SORT_BUFFER_SIZE is exceeded
+ */
+
+#ifndef NJUDB_EXECUTOR_SORT_VEC_H
+#define NJUDB_EXECUTOR_SORT_VEC_H
+
+#include "executor_abstract.h"
+#include "external_sorter.h"
+
+namespace njudb {
+class SortExecutorVec : public AbstractVecExecutor
+{
+public:
+  SortExecutorVec(AbstractExecutorUptr child, RecordSchemaUptr key_schema, bool is_desc,
+      size_t buffer_size = SORT_BUFFER_SIZE, size_t thread_num = SORT_THREAD_NUM);
+
+  [[nodiscard]] auto GetOutSchema() const -> const RecordSchema * override { return child_->GetOutSchema(); }
+
+  /**
+   * @return the number of runs spilled by the last sort
+   */
+  [[nodiscard]] auto GetSpilledRunCount() const -> size_t
+  {
+    return sorter_ == nullptr ? 0 : sorter_->GetSpilledRunCount();
+  }
+
+private:
+  void InitVec() override;
+
+  auto FetchChunk() -> VectorChunkUptr override;
+
+private:
+  AbstractExecutorUptr            child_;
+  RecordSchemaUptr                key_schema_;
+  bool                            is_desc_;
+  size_t                          buffer_size_;
+  size_t                          thread_num_;
+  std::unique_ptr<ExternalSorter> sorter_;
+};
+}  // namespace njudb
+
+#endif  // NJUDB_EXECUTOR_SORT_VEC_H
@@ -0,0 +1,117 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "executor_topn_vec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/arena.h"
+
+namespace njudb {
+
+TopNExecutorVec::TopNExecutorVec(AbstractExecutorUptr child, RecordSchemaUptr key_schema, bool is_desc, size_t limit)
+    : child_(std::move(child)),
+      key_schema_(std::move(key_schema)),
+      limit_(limit),
+      encoder_(child_->GetOutSchema(), key_schema_.get(), is_desc),
+      key_size_(encoder_.GetKeySize()),
+      rec_len_(child_->GetOutSchema()->GetRecordLength()),
+      entry_size_(key_size_ + sizeof(size_t) + rec_len_ + BITMAP_SIZE(child_->GetOutSchema()->GetFieldCount()))
+{}
+
+void TopNExecutorVec::InitVec()
+{
+  heap_.clear();
+  pos_ = 0;
+  if (limit_ == 0) {
+    return;
+  }
+  auto less = [this](size_t lhs, size_t rhs) { return Less(lhs, rhs); };
+  // the entry at spare takes the key of the next record, and is swapped with the top if the record goes before it
+  size_t spare = limit_;
+  size_t seq   = 0;
+  child_->Init();
+  Arena arena;
+  for (auto chunk = child_->NextChunk(); chunk != nullptr; chunk = child_->NextChunk()) {
+    for (size_t i = 0; i < chunk->GetSelectedCount(); i++, seq++) {
+      auto record = chunk->GetRecordView(arena, chunk->GetSelectedRow(i));
+      if (heap_.size() < limit_) {
+        auto slot = heap_.size();
+        Reserve(slot);
+        encoder_.Encode(record, Entry(slot));
+        Store(slot, record, seq);
+        heap_.push_back(slot);
+        std::push_heap(heap_.begin(), heap_.end(), less);
+        continue;
+      }
+      // the sequence of the record is after all the others, so it goes before the top only with a smaller key
+      Reserve(spare);
+      encoder_.Encode(record, Entry(spare));
+      if (std::memcmp(Entry(spare), Entry(heap_.front()), key_size_) >= 0) {
+        continue;
+      }
+      Store(spare, record, seq);
+      std::pop_heap(heap_.begin(), heap_.end(), less);
+      std::swap(heap_.back(), spare);
+      std::push_heap(heap_.begin(), heap_.end(), less);
+    }
+    arena.Reset();
+  }
+  std::sort_heap(heap_.begin(), heap_.end(), less);
+}
+
+auto TopNExecutorVec::FetchChunk() -> VectorChunkUptr
+{
+  auto chunk = std::make_unique<VectorChunk>(GetOutSchema());
+  while (!chunk->IsFull() && pos_ < heap_.size()) {
+    auto entry = Entry(heap_[pos_++]) + key_size_ + sizeof(size_t);
+    chunk->AppendRecord(RecordView(GetOutSchema(), entry + rec_len_, entry));
+  }
+  return chunk->GetRowCount() == 0 ? nullptr : std::move(chunk);
+}
+
+void TopNExecutorVec::Reserve(size_t slot)
+{
+  if ((slot + 1) * entry_size_ > entries_.size()) {
+    // the entries grow up to limit_ + 1 so that a large limit over a few records does not take the memory of all
+    entries_.resize(std::min(limit_ + 1, std::max({slot + 1, slot * 2, VECTOR_SIZE})) * entry_size_);
+  }
+}
+
+void TopNExecutorVec::Store(size_t slot, const RecordView &record, size_t seq)
+{
+  auto entry = Entry(slot) + key_size_;
+  std::memcpy(entry, &seq, sizeof(size_t));
+  entry += sizeof(size_t);
+  std::memcpy(entry, record.GetData(), rec_len_);
+  std::memcpy(entry + rec_len_, record.GetNullMap(), entry_size_ - key_size_ - sizeof(size_t) - rec_len_);
+}
+
+auto TopNExecutorVec::Less(size_t lhs, size_t rhs) const -> bool
+{
+  auto res = std::memcmp(Entry(lhs), Entry(rhs), key_size_);
+  if (res != 0) {
+    return res < 0;
+  }
+  size_t lseq, rseq;
+  std::memcpy(&lseq, Entry(lhs) + key_size_, sizeof(size_t));
+  std::memcpy(&rseq, Entry(rhs) + key_size_, sizeof(size_t));
+  return lseq < rseq;
+}
+
+}  // namespace njudb
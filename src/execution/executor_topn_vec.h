@@ -0,0 +1,74 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Vectorized top-n, the first limit records of the child in the order of the sort keys. The records are kept in
+ * a heap of at most limit entries of [normalized key][sequence][data][null map], whose top is the last of them in
+ * order, so each record of the child costs a key encoding and a memcmp with the top unless it is one of the first.
+ * Records with equal keys are returned in the order of the child, as a stable sort would.
+ */
+
+#ifndef NJUDB_EXECUTOR_TOPN_VEC_H
+#define NJUDB_EXECUTOR_TOPN_VEC_H
+
+#include <vector>
+
+#include "executor_abstract.h"
+#include "common/sort_key.h"
+
+namespace njudb {
+class TopNExecutorVec : public AbstractVecExecutor
+{
+public:
+  TopNExecutorVec(AbstractExecutorUptr child, RecordSchemaUptr key_schema, bool is_desc, size_t limit);
+
+  [[nodiscard]] auto GetOutSchema() const -> const RecordSchema * override { return child_->GetOutSchema(); }
+
+private:
+  void InitVec() override;
+
+  auto FetchChunk() -> VectorChunkUptr override;
+
+  // grow the entries to hold the one at slot
+  void Reserve(size_t slot);
+
+  // copy the record following its key, which has been encoded to the entry at slot
+  void Store(size_t slot, const RecordView &record, size_t seq);
+
+  [[nodiscard]] auto Entry(size_t slot) -> char * { return entries_.data() + slot * entry_size_; }
+
+  [[nodiscard]] auto Entry(size_t slot) const -> const char * { return entries_.data() + slot * entry_size_; }
+
+  // order of the entries at two slots, by the key and then by the sequence
+  [[nodiscard]] auto Less(size_t lhs, size_t rhs) const -> bool;
+
+private:
+  AbstractExecutorUptr child_;
+  RecordSchemaUptr     key_schema_;
+  size_t               limit_;
+  SortKeyEncoder       encoder_;
+  size_t               key_size_;
+  size_t               rec_len_;
+  size_t               entry_size_;
+
+  std::vector<char>   entries_;
+  std::vector<size_t> heap_;  // slots of the entries, sorted in order after InitVec
+  size_t              pos_{0};
+};
+}  // namespace njudb
+
+#endif  // NJUDB_EXECUTOR_TOPN_VEC_H
@@ -0,0 +1,512 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "external_sorter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <unistd.h>
+
+namespace njudb {
+
+namespace {
+
+// buckets smaller than it are sorted by std::sort instead of another radix pass
+constexpr size_t RADIX_SORT_THRESHOLD = 64;
+// a partition of the buffer has at least so many entries, smaller buffers are sorted by fewer workers
+constexpr size_t MIN_PARTITION_ENTRIES = 4096;
+
+std::atomic<size_t> sorter_fresh_id{0};
+
+/**
+ * MSD radix sort of the entries in [begin, end) by their key bytes in [depth, key_size)
+ * @param tmp scratch space of at least end - begin entries
+ */
+void RadixSort(const char **begin, const char **end, size_t depth, size_t key_size, const char **tmp)
+{
+  auto n = static_cast<size_t>(end - begin);
+  // skip the bytes shared by all the entries, e.g. the null bytes and the high bytes of small numbers
+  size_t count[256];
+  while (depth < key_size) {
+    if (n < RADIX_SORT_THRESHOLD) {
+      std::sort(begin, end, [depth, key_size](const char *lhs, const char *rhs) {
+        return std::memcmp(lhs + depth, rhs + depth, key_size - depth) < 0;
+      });
+      return;
+    }
+    std::fill(std::begin(count), std::end(count), 0);
+    for (auto it = begin; it != end; ++it) {
+      count[static_cast<unsigned char>((*it)[depth])]++;
+    }
+    if (count[static_cast<unsigned char>((*begin)[depth])] != n) {
+      break;
+    }
+    depth++;
+  }
+  if (depth == key_size) {
+    return;
+  }
+  size_t offset[256];
+  size_t sum = 0;
+  for (size_t b = 0; b < 256; b++) {
+    offset[b] = sum;
+    sum += count[b];
+  }
+  for (auto it = begin; it != end; ++it) {
+    tmp[offset[static_cast<unsigned char>((*it)[depth])]++] = *it;
+  }
+  std::copy(tmp, tmp + n, begin);
+  size_t start = 0;
+  for (size_t b = 0; b < 256; b++) {
+    if (count[b] > 1) {
+      RadixSort(begin + start, begin + start + count[b], depth + 1, key_size, tmp);
+    }
+    start += count[b];
+  }
+}
+
+/**
+ * Write the entries of a run through a buffer of a block
+ */
+class RunWriter
+{
+public:
+  RunWriter(const std::string &file_name, size_t entry_size)
+      : out_(file_name, std::ios::binary | std::ios::trunc), file_name_(file_name)
+  {
+    if (!out_.is_open()) {
+      NJUDB_THROW(NJUDB_FILE_NOT_OPEN, file_name);
+    }
+    block_.reserve(std::max(entry_size, SORT_RUN_BLOCK_SIZE / entry_size * entry_size));
+  }
+
+  void Append(const char *entry, size_t entry_size)
+  {
+    if (block_.size() + entry_size > block_.capacity()) {
+      Flush();
+    }
+    block_.insert(block_.end(), entry, entry + entry_size);
+  }
+
+  void Close()
+  {
+    Flush();
+    out_.close();
+    if (out_.fail()) {
+      NJUDB_THROW(NJUDB_FILE_WRITE_ERROR, file_name_);
+    }
+  }
+
+private:
+  void Flush()
+  {
+    out_.write(block_.data(), static_cast<std::streamsize>(block_.size()));
+    if (out_.fail()) {
+      NJUDB_THROW(NJUDB_FILE_WRITE_ERROR, file_name_);
+    }
+    block_.clear();
+  }
+
+  std::ofstream     out_;
+  std::string       file_name_;
+  std::vector<char> block_;
+};
+
+}  // namespace
+
+/**
+ * A sorted sequence of entries merged by the loser tree
+ */
+class ExternalSorter::MergeSource
+{
+public:
+  virtual ~MergeSource() = default;
+
+  /**
+   * @return the next entry, valid until the next call, nullptr at the end
+   */
+  virtual auto Next() -> const char * = 0;
+};
+
+namespace {
+
+class MemorySource : public ExternalSorter::MergeSource
+{
+public:
+  explicit MemorySource(const std::vector<const char *> &entries) : entries_(entries) {}
+
+  auto Next() -> const char * override { return pos_ < entries_.size() ? entries_[pos_++] : nullptr; }
+
+private:
+  const std::vector<const char *> &entries_;
+  size_t                           pos_{0};
+};
+
+/**
+ * Read a run block by block, the next block is read by a background task while the current one is consumed
+ */
+class RunReader : public ExternalSorter::MergeSource
+{
+public:
+  RunReader(const std::string &file_name, size_t entry_size, size_t block_size)
+      : in_(file_name, std::ios::binary), file_name_(file_name), entry_size_(entry_size)
+  {
+    if (!in_.is_open()) {
+      NJUDB_THROW(NJUDB_FILE_NOT_OPEN, file_name);
+    }
+    auto block_bytes = std::max(entry_size, block_size / entry_size * entry_size);
+    cur_.resize(block_bytes);
+    next_.resize(block_bytes);
+    cur_len_ = ReadBlock(cur_);
+    ReadAhead();
+  }
+
+  ~RunReader() override
+  {
+    if (next_len_.valid()) {
+      next_len_.wait();
+    }
+  }
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(RunReader)
+
+  auto Next() -> const char * override
+  {
+    if (pos_ + entry_size_ > cur_len_) {
+      if (!next_len_.valid()) {
+        return nullptr;
+      }
+      cur_len_ = next_len_.get();
+      std::swap(cur_, next_);
+      pos_ = 0;
+      if (cur_len_ < entry_size_) {
+        return nullptr;
+      }
+      ReadAhead();
+    }
+    auto entry = cur_.data() + pos_;
+    pos_ += entry_size_;
+    return entry;
+  }
+
+private:
+  auto ReadBlock(std::vector<char> &block) -> size_t
+  {
+    in_.read(block.data(), static_cast<std::streamsize>(block.size()));
+    if (in_.bad()) {
+      NJUDB_THROW(NJUDB_FILE_READ_ERROR, file_name_);
+    }
+    auto len = static_cast<size_t>(in_.gcount());
+    eof_     = len < block.size();
+    return len;
+  }
+
+  void ReadAhead()
+  {
+    if (!eof_) {
+      next_len_ = std::async(std::launch::async, [this] { return ReadBlock(next_); });
+    }
+  }
+
+  std::ifstream       in_;
+  std::string         file_name_;
+  size_t              entry_size_;
+  std::vector<char>   cur_;
+  std::vector<char>   next_;
+  size_t              cur_len_{0};
+  size_t              pos_{0};
+  bool                eof_{false};
+  std::future<size_t> next_len_;  // bytes read into next_
+};
+
+}  // namespace
+
+/**
+ * A loser tree over k sources: the leaves are the heads of the sources, every inner node keeps the loser of the match
+ * between its two subtrees and tree_[0] the overall winner. Replacing the head of the winner replays only the matches
+ * on the path from its leaf to the root, i.e. log(k) comparisons per entry. Ties are won by the source with the
+ * smaller index, and an exhausted source loses to any entry.
+ */
+class ExternalSorter::LoserTree
+{
+public:
+  LoserTree(std::vector<std::unique_ptr<MergeSource>> &sources, size_t key_size)
+      : sources_(sources), key_size_(key_size), heads_(sources.size()), tree_(std::max<size_t>(sources.size(), 1))
+  {
+    for (size_t i = 0; i < sources_.size(); i++) {
+      heads_[i] = sources_[i]->Next();
+    }
+    if (!sources_.empty()) {
+      tree_[0] = Build(1);
+    }
+  }
+
+  [[nodiscard]] auto Top() const -> const char * { return sources_.empty() ? nullptr : heads_[tree_[0]]; }
+
+  /**
+   * Replace the top by the next entry of its source
+   */
+  void Pop()
+  {
+    auto winner     = tree_[0];
+    heads_[winner] = sources_[winner]->Next();
+    for (auto node = (winner + sources_.size()) / 2; node > 0; node /= 2) {
+      if (Less(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+private:
+  // node i has children 2i and 2i+1, the leaf of source s is node k+s
+  auto Build(size_t node) -> size_t
+  {
+    if (node >= sources_.size()) {
+      return node - sources_.size();
+    }
+    auto left  = Build(2 * node);
+    auto right = Build(2 * node + 1);
+    if (Less(left, right)) {
+      tree_[node] = right;
+      return left;
+    }
+    tree_[node] = left;
+    return right;
+  }
+
+  [[nodiscard]] auto Less(size_t lhs, size_t rhs) const -> bool
+  {
+    if (heads_[lhs] == nullptr || heads_[rhs] == nullptr) {
+      return heads_[rhs] == nullptr && (heads_[lhs] != nullptr || lhs < rhs);
+    }
+    auto res = std::memcmp(heads_[lhs], heads_[rhs], key_size_);
+    return res < 0 || (res == 0 && lhs < rhs);
+  }
+
+  std::vector<std::unique_ptr<MergeSource>> &sources_;
+  size_t                                     key_size_;
+  std::vector<const char *>                  heads_;
+  std::vector<size_t>                        tree_;
+};
+
+ExternalSorter::ExternalSorter(const RecordSchema *schema, const RecordSchema *key_schema, bool is_desc,
+    size_t buffer_size, size_t thread_num, std::string tmp_dir)
+    : schema_(schema),
+      encoder_(schema, key_schema, is_desc),
+      key_size_(encoder_.GetKeySize()),
+      rec_len_(schema->GetRecordLength()),
+      entry_size_(key_size_ + rec_len_ + BITMAP_SIZE(schema->GetFieldCount())),
+      buffer_size_(buffer_size),
+      thread_num_(thread_num == 0 ? std::max(1U, std::thread::hardware_concurrency()) : thread_num),
+      tmp_dir_(std::move(tmp_dir)),
+      run_prefix_(fmt::format("ext_sort_{}_{}", getpid(), sorter_fresh_id++)),
+      max_entry_num_(std::max<size_t>(1, buffer_size / entry_size_))
+{}
+
+ExternalSorter::~ExternalSorter()
+{
+  // wait for the read-ahead of the runs before removing them
+  tree_ = nullptr;
+  sources_.clear();
+  for (const auto &run : runs_) {
+    std::error_code ec;
+    std::filesystem::remove(run, ec);
+  }
+}
+
+void ExternalSorter::Add(const RecordView &record)
+{
+  NJUDB_ASSERT(tree_ == nullptr, "records are added after Finish");
+  if (entry_num_ == max_entry_num_) {
+    Spill();
+  }
+  if ((entry_num_ + 1) * entry_size_ > buffer_.size()) {
+    // the buffer grows up to buffer_size_ so that a small sort does not take all of it
+    buffer_.resize(std::min(max_entry_num_, std::max<size_t>(entry_num_ * 2, VECTOR_SIZE)) * entry_size_);
+  }
+  auto entry = buffer_.data() + entry_num_ * entry_size_;
+  encoder_.Encode(record, entry);
+  std::memcpy(entry + key_size_, record.GetData(), rec_len_);
+  std::memcpy(entry + key_size_ + rec_len_, record.GetNullMap(), entry_size_ - key_size_ - rec_len_);
+  entry_num_++;
+}
+
+auto ExternalSorter::SortBuffer() -> std::vector<std::vector<const char *>>
+{
+  auto part_num = std::clamp<size_t>(entry_num_ / MIN_PARTITION_ENTRIES, 1, thread_num_);
+  std::vector<std::vector<const char *>> parts(part_num);
+  std::vector<std::future<void>>         tasks;
+  for (size_t p = 0; p < part_num; p++) {
+    auto begin = entry_num_ * p / part_num;
+    auto end   = entry_num_ * (p + 1) / part_num;
+    tasks.push_back(std::async(std::launch::async, [this, &part = parts[p], begin, end] {
+      part.resize(end - begin);
+      for (size_t i = begin; i < end; i++) {
+        part[i - begin] = buffer_.data() + i * entry_size_;
+      }
+      std::vector<const char *> tmp(part.size());
+      RadixSort(part.data(), part.data() + part.size(), 0, key_size_, tmp.data());
+    }));
+  }
+  for (auto &task : tasks) {
+    task.get();
+  }
+  return parts;
+}
+
+void ExternalSorter::Spill()
+{
+  if (entry_num_ == 0) {
+    return;
+  }
+  if (!std::filesystem::exists(tmp_dir_)) {
+    std::filesystem::create_directories(tmp_dir_);
+  }
+  auto parts = SortBuffer();
+  // each sorted partition is written as a run by its own worker
+  std::vector<std::string> files;
+  for (size_t p = 0; p < parts.size(); p++) {
+    files.push_back(NewRunFile());
+  }
+  std::vector<std::future<void>> tasks;
+  for (size_t p = 0; p < parts.size(); p++) {
+    tasks.push_back(std::async(std::launch::async, [this, &part = parts[p], &file = files[p]] {
+      RunWriter writer(file, entry_size_);
+      for (auto entry : part) {
+        writer.Append(entry, entry_size_);
+      }
+      writer.Close();
+    }));
+  }
+  for (auto &task : tasks) {
+    task.get();
+  }
+  spilled_run_num_ += files.size();
+  entry_num_ = 0;
+}
+
+auto ExternalSorter::NewRunFile() -> std::string
+{
+  auto file = FILE_NAME(tmp_dir_, fmt::format("{}_{}", run_prefix_, run_id_++), TMP_SUFFIX);
+  runs_.push_back(file);
+  return file;
+}
+
+auto ExternalSorter::GetReadBlockSize(size_t merge_num) const -> size_t
+{
+  // each reader holds two blocks, the readers of all the merges share the memory of the buffer
+  return std::clamp<size_t>(buffer_size_ / (2 * SORT_WAY_NUM * merge_num), entry_size_, SORT_RUN_BLOCK_SIZE);
+}
+
+void ExternalSorter::MergeRuns()
+{
+  while (runs_.size() > SORT_WAY_NUM) {
+    // merge groups of SORT_WAY_NUM runs into new runs, the groups are merged by the workers in parallel
+    std::vector<std::string> inputs;
+    inputs.swap(runs_);
+    auto group_num  = (inputs.size() + SORT_WAY_NUM - 1) / SORT_WAY_NUM;
+    auto block_size = GetReadBlockSize(std::min(group_num, thread_num_));
+    std::vector<std::string> outputs;
+    for (size_t g = 0; g < group_num; g++) {
+      outputs.push_back(NewRunFile());
+    }
+    try {
+      MergeGroups(inputs, outputs, block_size);
+    } catch (...) {
+      // the inputs are removed with the other runs
+      runs_.insert(runs_.end(), inputs.begin(), inputs.end());
+      throw;
+    }
+    for (const auto &run : inputs) {
+      std::error_code ec;
+      std::filesystem::remove(run, ec);
+    }
+  }
+}
+
+void ExternalSorter::MergeGroups(
+    const std::vector<std::string> &inputs, const std::vector<std::string> &outputs, size_t block_size)
+{
+  auto group_num = outputs.size();
+  for (size_t first = 0; first < group_num; first += thread_num_) {
+    std::vector<std::future<void>> tasks;
+    for (size_t g = first; g < std::min(group_num, first + thread_num_); g++) {
+      tasks.push_back(std::async(std::launch::async, [this, &inputs, &outputs, g, block_size] {
+        std::vector<std::unique_ptr<MergeSource>> readers;
+        for (size_t r = g * SORT_WAY_NUM; r < std::min(inputs.size(), (g + 1) * SORT_WAY_NUM); r++) {
+          readers.push_back(std::make_unique<RunReader>(inputs[r], entry_size_, block_size));
+        }
+        LoserTree tree(readers, key_size_);
+        RunWriter writer(outputs[g], entry_size_);
+        for (auto entry = tree.Top(); entry != nullptr; entry = tree.Top()) {
+          writer.Append(entry, entry_size_);
+          tree.Pop();
+        }
+        writer.Close();
+      }));
+    }
+    for (auto &task : tasks) {
+      task.get();
+    }
+  }
+}
+
+void ExternalSorter::Finish()
+{
+  NJUDB_ASSERT(tree_ == nullptr, "Finish is called twice");
+  if (runs_.empty()) {
+    partitions_ = SortBuffer();
+    for (const auto &part : partitions_) {
+      sources_.push_back(std::make_unique<MemorySource>(part));
+    }
+  } else {
+    Spill();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    MergeRuns();
+    for (const auto &run : runs_) {
+      sources_.push_back(std::make_unique<RunReader>(run, entry_size_, GetReadBlockSize(1)));
+    }
+  }
+  tree_        = std::make_unique<LoserTree>(sources_, key_size_);
+  pop_pending_ = false;
+}
+
+auto ExternalSorter::Next(RecordView &record) -> bool
+{
+  NJUDB_ASSERT(tree_ != nullptr, "Next is called before Finish");
+  // the entry returned last time stays valid until now
+  if (pop_pending_) {
+    tree_->Pop();
+  }
+  auto entry = tree_->Top();
+  if (entry == nullptr) {
+    pop_pending_ = false;
+    return false;
+  }
+  pop_pending_ = true;
+  record       = RecordView(schema_, entry + key_size_ + rec_len_, entry + key_size_);
+  return true;
+}
+
+}  // namespace njudb
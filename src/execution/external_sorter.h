@@ -0,0 +1,132 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+/**
+ * @brief A parallel external merge sort of records on their normalized keys (see SortKeyEncoder).
+ *
+ * Records are copied into a buffer of SORT_BUFFER_SIZE bytes as entries of [normalized key][data][null map]. When the
+ * buffer is full, it is split into one partition per worker thread, and each worker sorts its partition and spills it
+ * to a run file in large blocks. Partitions are sorted by an MSD radix sort on the key bytes, and small buckets fall
+ * back to std::sort by memcmp.
+ *
+ * Finish reduces the runs until at most SORT_WAY_NUM are left, merging groups of runs in parallel. Records are then
+ * returned by a loser tree merging the remaining runs, and each run reads its next block in the background while the
+ * current one is consumed. If nothing was spilled, the sorted partitions are merged in memory the same way.
+ */
+
+#ifndef NJUDB_EXTERNAL_SORTER_H
+#define NJUDB_EXTERNAL_SORTER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/sort_key.h"
+
+namespace njudb {
+
+class ExternalSorter
+{
+public:
+  /**
+   * @param schema schema of the records to sort
+   * @param key_schema the fields of schema to sort by
+   * @param buffer_size bytes of the in-memory buffer, a run is spilled each time it is full
+   * @param thread_num number of worker threads, 0 uses all the hardware threads
+   * @param tmp_dir directory of the run files
+   */
+  ExternalSorter(const RecordSchema *schema, const RecordSchema *key_schema, bool is_desc,
+      size_t buffer_size = SORT_BUFFER_SIZE, size_t thread_num = SORT_THREAD_NUM, std::string tmp_dir = TMP_DIR);
+
+  ~ExternalSorter();
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(ExternalSorter)
+
+  void Add(const RecordView &record);
+
+  /**
+   * Sort the records added, no record can be added after it
+   */
+  void Finish();
+
+  /**
+   * Get the next record in order after Finish
+   * @param record set to the record, which is valid until the next call
+   * @return false if there is no more record
+   */
+  auto Next(RecordView &record) -> bool;
+
+  /**
+   * @return the number of runs spilled to files, 0 if the records are sorted in memory
+   */
+  [[nodiscard]] auto GetSpilledRunCount() const -> size_t { return spilled_run_num_; }
+
+  [[nodiscard]] auto GetThreadNum() const -> size_t { return thread_num_; }
+
+  class MergeSource;
+  class LoserTree;
+
+private:
+  /**
+   * Sort the entries in the buffer, one partition by each worker
+   * @return the sorted partitions
+   */
+  auto SortBuffer() -> std::vector<std::vector<const char *>>;
+
+  void Spill();
+
+  void MergeRuns();
+
+  /**
+   * Merge each group of SORT_WAY_NUM runs in inputs to the run in outputs at the group index
+   */
+  void MergeGroups(
+      const std::vector<std::string> &inputs, const std::vector<std::string> &outputs, size_t block_size);
+
+  auto NewRunFile() -> std::string;
+
+  // bytes of a block of a run file read by one of the readers merging at the same time
+  [[nodiscard]] auto GetReadBlockSize(size_t merge_num) const -> size_t;
+
+  const RecordSchema *schema_;
+  SortKeyEncoder      encoder_;
+  size_t              key_size_;
+  size_t              rec_len_;
+  size_t              entry_size_;
+  size_t              buffer_size_;
+  size_t              thread_num_;
+  std::string         tmp_dir_;
+  std::string         run_prefix_;
+
+  std::vector<char> buffer_;
+  size_t            entry_num_{0};
+  size_t            max_entry_num_;
+
+  std::vector<std::string> runs_;
+  size_t                   run_id_{0};
+  size_t                   spilled_run_num_{0};
+
+  std::vector<std::vector<const char *>>    partitions_;  // sorted in memory when nothing is spilled
+  std::vector<std::unique_ptr<MergeSource>> sources_;
+  std::unique_ptr<LoserTree>                tree_;
+  bool                                      pop_pending_{false};  // the top has been returned by Next
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_EXTERNAL_SORTER_H
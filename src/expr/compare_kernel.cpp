@@ -0,0 +1,368 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "compare_kernel.h"
+
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
+#include "../../common/error.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NJUDB_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace njudb {
+
+namespace {
+
+template <typename T>
+auto Load(const char *src) -> T
+{
+  T value;
+  memcpy(&value, src, sizeof(T));
+  return value;
+}
+
+template <CompOp Op, typename T>
+auto Holds(const T &lhs, const T &rhs) -> bool
+{
+  if constexpr (Op == OP_EQ) {
+    return lhs == rhs;
+  } else if constexpr (Op == OP_NE) {
+    return lhs != rhs;
+  } else if constexpr (Op == OP_LT) {
+    return lhs < rhs;
+  } else if constexpr (Op == OP_LE) {
+    return lhs <= rhs;
+  } else if constexpr (Op == OP_GT) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+// the kernels are instantiated for each operator, so the switch on it is out of the loops
+template <typename F>
+void DispatchOp(CompOp op, F &&kernel)
+{
+  switch (op) {
+    case OP_EQ: return kernel(std::integral_constant<CompOp, OP_EQ>{});
+    case OP_NE: return kernel(std::integral_constant<CompOp, OP_NE>{});
+    case OP_LT: return kernel(std::integral_constant<CompOp, OP_LT>{});
+    case OP_LE: return kernel(std::integral_constant<CompOp, OP_LE>{});
+    case OP_GT: return kernel(std::integral_constant<CompOp, OP_GT>{});
+    case OP_GE: return kernel(std::integral_constant<CompOp, OP_GE>{});
+    default: NJUDB_THROW(NJUDB_UNSUPPORTED_OP, CompOpToString(op));
+  }
+}
+
+inline void SetBit(uint64_t *bitmap, size_t i) { bitmap[i / 64] |= uint64_t{1} << (i % 64); }
+
+/// scalar kernels, also used for the tails of the SIMD kernels
+
+template <CompOp Op, typename T>
+void CompareScalar(const char *data, size_t begin, size_t n, T value, uint64_t *bitmap)
+{
+  for (size_t i = begin; i < n; i++) {
+    if (Holds<Op>(Load<T>(data + i * sizeof(T)), value)) {
+      SetBit(bitmap, i);
+    }
+  }
+}
+
+template <CompOp Op>
+void CompareCharScalar(const char *data, size_t width, size_t n, const char *value, uint64_t *bitmap)
+{
+  for (size_t i = 0; i < n; i++) {
+    if (Holds<Op>(memcmp(data + i * width, value, width), 0)) {
+      SetBit(bitmap, i);
+    }
+  }
+}
+
+#ifdef NJUDB_SIMD_X86
+
+/// SSE kernels, 4 values or 16 bytes at a time
+
+// one bit for each 32-bit lane
+__attribute__((target("sse4.2"))) inline auto MaskSSE(__m128i cmp) -> uint32_t
+{
+  return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(cmp)));
+}
+
+template <CompOp Op>
+__attribute__((target("sse4.2"))) auto MaskIntSSE(__m128i lhs, __m128i rhs) -> uint32_t
+{
+  if constexpr (Op == OP_EQ) {
+    return MaskSSE(_mm_cmpeq_epi32(lhs, rhs));
+  } else if constexpr (Op == OP_NE) {
+    return MaskSSE(_mm_cmpeq_epi32(lhs, rhs)) ^ 0xF;
+  } else if constexpr (Op == OP_LT) {
+    return MaskSSE(_mm_cmpgt_epi32(rhs, lhs));
+  } else if constexpr (Op == OP_LE) {
+    return MaskSSE(_mm_cmpgt_epi32(lhs, rhs)) ^ 0xF;
+  } else if constexpr (Op == OP_GT) {
+    return MaskSSE(_mm_cmpgt_epi32(lhs, rhs));
+  } else {
+    return MaskSSE(_mm_cmpgt_epi32(rhs, lhs)) ^ 0xF;
+  }
+}
+
+template <CompOp Op>
+__attribute__((target("sse4.2"))) auto MaskFloatSSE(__m128 lhs, __m128 rhs) -> uint32_t
+{
+  if constexpr (Op == OP_EQ) {
+    return _mm_movemask_ps(_mm_cmpeq_ps(lhs, rhs));
+  } else if constexpr (Op == OP_NE) {
+    return _mm_movemask_ps(_mm_cmpneq_ps(lhs, rhs));
+  } else if constexpr (Op == OP_LT) {
+    return _mm_movemask_ps(_mm_cmplt_ps(lhs, rhs));
+  } else if constexpr (Op == OP_LE) {
+    return _mm_movemask_ps(_mm_cmple_ps(lhs, rhs));
+  } else if constexpr (Op == OP_GT) {
+    return _mm_movemask_ps(_mm_cmpgt_ps(lhs, rhs));
+  } else {
+    return _mm_movemask_ps(_mm_cmpge_ps(lhs, rhs));
+  }
+}
+
+template <CompOp Op>
+__attribute__((target("sse4.2"))) void CompareIntSSE(const char *data, size_t n, int32_t value, uint64_t *bitmap)
+{
+  auto   rhs = _mm_set1_epi32(value);
+  size_t i   = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto lhs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * sizeof(int32_t)));
+    bitmap[i / 64] |= static_cast<uint64_t>(MaskIntSSE<Op>(lhs, rhs)) << (i % 64);
+  }
+  CompareScalar<Op>(data, i, n, value, bitmap);
+}
+
+template <CompOp Op>
+__attribute__((target("sse4.2"))) void CompareFloatSSE(const char *data, size_t n, float value, uint64_t *bitmap)
+{
+  auto   rhs = _mm_set1_ps(value);
+  size_t i   = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto lhs = _mm_loadu_ps(reinterpret_cast<const float *>(data + i * sizeof(float)));
+    bitmap[i / 64] |= static_cast<uint64_t>(MaskFloatSSE<Op>(lhs, rhs)) << (i % 64);
+  }
+  CompareScalar<Op>(data, i, n, value, bitmap);
+}
+
+// memcmp of two strings of width bytes, the first differing byte is found 16 bytes at a time
+__attribute__((target("sse4.2"))) auto MemcmpSSE(const char *lhs, const char *rhs, size_t width) -> int
+{
+  size_t j = 0;
+  for (; j + 16 <= width; j += 16) {
+    auto l  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + j));
+    auto r  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + j));
+    auto eq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)));
+    if (eq != 0xFFFF) {
+      auto k = j + std::countr_one(eq);
+      return static_cast<int>(static_cast<uint8_t>(lhs[k])) - static_cast<int>(static_cast<uint8_t>(rhs[k]));
+    }
+  }
+  return j == width ? 0 : memcmp(lhs + j, rhs + j, width - j);
+}
+
+template <CompOp Op>
+__attribute__((target("sse4.2"))) void CompareCharSSE(
+    const char *data, size_t width, size_t n, const char *value, uint64_t *bitmap)
+{
+  for (size_t i = 0; i < n; i++) {
+    if (Holds<Op>(MemcmpSSE(data + i * width, value, width), 0)) {
+      SetBit(bitmap, i);
+    }
+  }
+}
+
+/// AVX2 kernels, 8 values or 32 bytes at a time
+
+__attribute__((target("avx2"))) inline auto MaskAVX2(__m256i cmp) -> uint32_t
+{
+  return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp)));
+}
+
+template <CompOp Op>
+__attribute__((target("avx2"))) auto MaskIntAVX2(__m256i lhs, __m256i rhs) -> uint32_t
+{
+  if constexpr (Op == OP_EQ) {
+    return MaskAVX2(_mm256_cmpeq_epi32(lhs, rhs));
+  } else if constexpr (Op == OP_NE) {
+    return MaskAVX2(_mm256_cmpeq_epi32(lhs, rhs)) ^ 0xFF;
+  } else if constexpr (Op == OP_LT) {
+    return MaskAVX2(_mm256_cmpgt_epi32(rhs, lhs));
+  } else if constexpr (Op == OP_LE) {
+    return MaskAVX2(_mm256_cmpgt_epi32(lhs, rhs)) ^ 0xFF;
+  } else if constexpr (Op == OP_GT) {
+    return MaskAVX2(_mm256_cmpgt_epi32(lhs, rhs));
+  } else {
+    return MaskAVX2(_mm256_cmpgt_epi32(rhs, lhs)) ^ 0xFF;
+  }
+}
+
+template <CompOp Op>
+__attribute__((target("avx2"))) auto MaskFloatAVX2(__m256 lhs, __m256 rhs) -> uint32_t
+{
+  // ordered predicates are false for NaN, only != is unordered, the same as the scalar operators
+  if constexpr (Op == OP_EQ) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_EQ_OQ));
+  } else if constexpr (Op == OP_NE) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_NEQ_UQ));
+  } else if constexpr (Op == OP_LT) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_LT_OQ));
+  } else if constexpr (Op == OP_LE) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_LE_OQ));
+  } else if constexpr (Op == OP_GT) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_GT_OQ));
+  } else {
+    return _mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_GE_OQ));
+  }
+}
+
+template <CompOp Op>
+__attribute__((target("avx2"))) void CompareIntAVX2(const char *data, size_t n, int32_t value, uint64_t *bitmap)
+{
+  auto   rhs = _mm256_set1_epi32(value);
+  size_t i   = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * sizeof(int32_t)));
+    bitmap[i / 64] |= static_cast<uint64_t>(MaskIntAVX2<Op>(lhs, rhs)) << (i % 64);
+  }
+  CompareScalar<Op>(data, i, n, value, bitmap);
+}
+
+template <CompOp Op>
+__attribute__((target("avx2"))) void CompareFloatAVX2(const char *data, size_t n, float value, uint64_t *bitmap)
+{
+  auto   rhs = _mm256_set1_ps(value);
+  size_t i   = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto lhs = _mm256_loadu_ps(reinterpret_cast<const float *>(data + i * sizeof(float)));
+    bitmap[i / 64] |= static_cast<uint64_t>(MaskFloatAVX2<Op>(lhs, rhs)) << (i % 64);
+  }
+  CompareScalar<Op>(data, i, n, value, bitmap);
+}
+
+__attribute__((target("avx2"))) auto MemcmpAVX2(const char *lhs, const char *rhs, size_t width) -> int
+{
+  size_t j = 0;
+  for (; j + 32 <= width; j += 32) {
+    auto l  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + j));
+    auto r  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + j));
+    auto eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+    if (eq != 0xFFFFFFFF) {
+      auto k = j + std::countr_one(eq);
+      return static_cast<int>(static_cast<uint8_t>(lhs[k])) - static_cast<int>(static_cast<uint8_t>(rhs[k]));
+    }
+  }
+  return j == width ? 0 : MemcmpSSE(lhs + j, rhs + j, width - j);
+}
+
+template <CompOp Op>
+__attribute__((target("avx2"))) void CompareCharAVX2(
+    const char *data, size_t width, size_t n, const char *value, uint64_t *bitmap)
+{
+  for (size_t i = 0; i < n; i++) {
+    if (Holds<Op>(MemcmpAVX2(data + i * width, value, width), 0)) {
+      SetBit(bitmap, i);
+    }
+  }
+}
+
+#endif
+
+inline void ClearBitmap(uint64_t *bitmap, size_t n) { memset(bitmap, 0, (n + 63) / 64 * sizeof(uint64_t)); }
+
+}  // namespace
+
+auto CompareKernel::GetLevel() -> SimdLevel
+{
+#ifdef NJUDB_SIMD_X86
+  static const SimdLevel level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SIMD_SSE4;
+    }
+    return SIMD_SCALAR;
+  }();
+  return level;
+#else
+  return SIMD_SCALAR;
+#endif
+}
+
+void CompareKernel::CompareInt(CompOp op, const char *data, size_t n, int32_t value, uint64_t *bitmap, SimdLevel level)
+{
+  ClearBitmap(bitmap, n);
+  DispatchOp(op, [&](auto cmp) {
+    constexpr CompOp Op = decltype(cmp)::value;
+#ifdef NJUDB_SIMD_X86
+    if (level == SIMD_AVX2) {
+      return CompareIntAVX2<Op>(data, n, value, bitmap);
+    }
+    if (level == SIMD_SSE4) {
+      return CompareIntSSE<Op>(data, n, value, bitmap);
+    }
+#endif
+    CompareScalar<Op>(data, 0, n, value, bitmap);
+  });
+}
+
+void CompareKernel::CompareFloat(CompOp op, const char *data, size_t n, float value, uint64_t *bitmap, SimdLevel level)
+{
+  ClearBitmap(bitmap, n);
+  DispatchOp(op, [&](auto cmp) {
+    constexpr CompOp Op = decltype(cmp)::value;
+#ifdef NJUDB_SIMD_X86
+    if (level == SIMD_AVX2) {
+      return CompareFloatAVX2<Op>(data, n, value, bitmap);
+    }
+    if (level == SIMD_SSE4) {
+      return CompareFloatSSE<Op>(data, n, value, bitmap);
+    }
+#endif
+    CompareScalar<Op>(data, 0, n, value, bitmap);
+  });
+}
+
+void CompareKernel::CompareChar(
+    CompOp op, const char *data, size_t width, size_t n, const char *value, uint64_t *bitmap, SimdLevel level)
+{
+  ClearBitmap(bitmap, n);
+  DispatchOp(op, [&](auto cmp) {
+    constexpr CompOp Op = decltype(cmp)::value;
+#ifdef NJUDB_SIMD_X86
+    if (level == SIMD_AVX2) {
+      return CompareCharAVX2<Op>(data, width, n, value, bitmap);
+    }
+    if (level == SIMD_SSE4) {
+      return CompareCharSSE<Op>(data, width, n, value, bitmap);
+    }
+#endif
+    CompareCharScalar<Op>(data, width, n, value, bitmap);
+  });
+}
+
+}  // namespace njudb
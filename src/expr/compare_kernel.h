@@ -0,0 +1,80 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_COMPARE_KERNEL_H
+#define NJUDB_COMPARE_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/types.h"
+
+namespace njudb {
+
+/**
+ * Instruction sets the compare kernels are compiled for, only x86-64 has the SIMD kernels, other targets fall back to
+ * the scalar loops
+ */
+enum SimdLevel
+{
+  SIMD_SCALAR,
+  SIMD_SSE4,
+  SIMD_AVX2
+};
+
+/**
+ * Kernels comparing a column of fixed-width values with a constant, bit i of the result bitmap is set iff
+ * "value i op constant" holds. The bitmap has (n + 63) / 64 words, the bits beyond n are cleared. The values are read
+ * unaligned, so a column can be compared in place in a page. Nulls are not known to the kernels, the caller masks them.
+ * The kernels are picked at runtime by the instruction sets the cpu supports, see GetLevel.
+ */
+class CompareKernel
+{
+public:
+  CompareKernel() = delete;
+
+  /**
+   * @return the best level supported by the cpu, detected once
+   */
+  static auto GetLevel() -> SimdLevel;
+
+  /**
+   * @param op one of OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE, NJUDB_UNSUPPORTED_OP is thrown for the others
+   * @param data n int32_t values
+   */
+  static void CompareInt(
+      CompOp op, const char *data, size_t n, int32_t value, uint64_t *bitmap, SimdLevel level = GetLevel());
+
+  /**
+   * NaN compares like the scalar operators, only OP_NE holds for it
+   * @param data n float values
+   */
+  static void CompareFloat(
+      CompOp op, const char *data, size_t n, float value, uint64_t *bitmap, SimdLevel level = GetLevel());
+
+  /**
+   * Compare zero-padded strings of width bytes byte by byte as unsigned chars, the same order as std::string
+   * @param data n strings of width bytes each
+   * @param value the constant zero-padded to width bytes
+   */
+  static void CompareChar(CompOp op, const char *data, size_t width, size_t n, const char *value, uint64_t *bitmap,
+      SimdLevel level = GetLevel());
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_COMPARE_KERNEL_H
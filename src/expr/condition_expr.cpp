@@ -21,8 +21,222 @@
 
 #include "condition_expr.h"
 
+#include <algorithm>
+#include <functional>
+
+#include "compare_kernel.h"
+
 namespace njudb {
 
+namespace {
+
+// readers of the typed value of a row, the typed loops below are instantiated with them
+
+template <typename T>
+struct TypedColumn
+{
+  const T *data_;
+  auto     operator()(uint32_t row) const -> T { return data_[row]; }
+};
+
+struct IntAsFloatColumn
+{
+  const int32_t *data_;
+  auto           operator()(uint32_t row) const -> float { return static_cast<float>(data_[row]); }
+};
+
+struct StringColumn
+{
+  const ColumnVector *col_;
+  auto                operator()(uint32_t row) const -> std::string_view { return col_->GetString(row); }
+};
+
+template <typename T>
+struct Constant
+{
+  T    value_;
+  auto operator()(uint32_t) const -> const T & { return value_; }
+};
+
+template <typename Pred>
+void SelectIf(std::vector<uint32_t> &sel, Pred pred)
+{
+  size_t n = 0;
+  for (auto row : sel) {
+    if (pred(row)) {
+      sel[n++] = row;
+    }
+  }
+  sel.resize(n);
+}
+
+template <typename L, typename R, typename Cmp>
+void SelectCompare(L lhs, R rhs, Cmp cmp, std::vector<uint32_t> &sel)
+{
+  SelectIf(sel, [&](uint32_t row) { return cmp(lhs(row), rhs(row)); });
+}
+
+// the switch on the operator is hoisted out of the loop over the rows
+template <typename L, typename R>
+void SelectCompare(CompOp op, L lhs, R rhs, std::vector<uint32_t> &sel)
+{
+  switch (op) {
+    case OP_EQ: return SelectCompare(lhs, rhs, std::equal_to<>(), sel);
+    case OP_NE: return SelectCompare(lhs, rhs, std::not_equal_to<>(), sel);
+    case OP_LT: return SelectCompare(lhs, rhs, std::less<>(), sel);
+    case OP_LE: return SelectCompare(lhs, rhs, std::less_equal<>(), sel);
+    case OP_GT: return SelectCompare(lhs, rhs, std::greater<>(), sel);
+    case OP_GE: return SelectCompare(lhs, rhs, std::greater_equal<>(), sel);
+    default: NJUDB_FATAL(CompOpToString(op));
+  }
+}
+
+// keep the rows whose bits are set in the bitmap of a compare kernel
+void SelectBits(std::vector<uint32_t> &sel, const std::vector<uint64_t> &bitmap)
+{
+  SelectIf(sel, [&bitmap](uint32_t row) { return ((bitmap[row / 64] >> (row % 64)) & 1) != 0; });
+}
+
+auto BitmapOf(const ColumnVector &col) -> std::vector<uint64_t>
+{
+  return std::vector<uint64_t>((col.GetSize() + 63) / 64);
+}
+
+auto IsString(FieldType type) -> bool { return type == TYPE_STRING || type == TYPE_VARCHAR; }
+
+auto CompareValues(CompOp op, ValueSptr lhs, ValueSptr rhs) -> bool
+{
+  if (op == OP_IN) {
+    return std::dynamic_pointer_cast<ArrayValue>(rhs)->Contains(lhs);
+  }
+  if (lhs->IsNull() || rhs->IsNull()) {
+    return CompOpOnNull(op, lhs->IsNull(), rhs->IsNull());
+  }
+  ValueFactory::AlignTypes(lhs, rhs);
+  switch (op) {
+    case OP_EQ: return *lhs == *rhs;
+    case OP_NE: return *lhs != *rhs;
+    case OP_LT: return *lhs < *rhs;
+    case OP_LE: return *lhs <= *rhs;
+    case OP_GT: return *lhs > *rhs;
+    case OP_GE: return *lhs >= *rhs;
+    default: NJUDB_FATAL(CompOpToString(op));
+  }
+}
+
+// whether the fields of the two types are compared by GetFieldCompareFn
+auto IsTyped(FieldType ltype, FieldType rtype) -> bool
+{
+  auto numeric = [](FieldType type) { return type == TYPE_INT || type == TYPE_FLOAT; };
+  return (IsString(ltype) && IsString(rtype)) || (numeric(ltype) && numeric(rtype)) ||
+         (ltype == TYPE_BOOL && rtype == TYPE_BOOL);
+}
+
+auto MatchOp(CompOp op, int res) -> bool
+{
+  switch (op) {
+    case OP_EQ: return res == 0;
+    case OP_NE: return res != 0;
+    case OP_LT: return res < 0;
+    case OP_LE: return res <= 0;
+    case OP_GT: return res > 0;
+    case OP_GE: return res >= 0;
+    default: NJUDB_FATAL(CompOpToString(op));
+  }
+}
+
+// compare a field with a constant read like a field of the constant type
+auto CompareWithValue(FieldType ltype, const char *lmem, size_t lsize, const Value &rhs) -> int
+{
+  auto compare = GetFieldCompareFn(ltype, rhs.GetType());
+  switch (rhs.GetType()) {
+    case TYPE_BOOL: {
+      auto value = dynamic_cast<const BoolValue &>(rhs).Get();
+      return compare(lmem, lsize, reinterpret_cast<const char *>(&value), sizeof(bool));
+    }
+    case TYPE_INT: {
+      auto value = dynamic_cast<const IntValue &>(rhs).Get();
+      return compare(lmem, lsize, reinterpret_cast<const char *>(&value), sizeof(int32_t));
+    }
+    case TYPE_FLOAT: {
+      auto value = dynamic_cast<const FloatValue &>(rhs).Get();
+      return compare(lmem, lsize, reinterpret_cast<const char *>(&value), sizeof(float));
+    }
+    default: {
+      const auto &value = dynamic_cast<const StringValue &>(rhs).Get();
+      return compare(lmem, lsize, value.data(), value.size());
+    }
+  }
+}
+
+// compare the rows of a column whose values are not null with a constant that is not null
+void SelectByValue(CompOp op, const ColumnVector &lcol, const ValueSptr &rhs, std::vector<uint32_t> &sel)
+{
+  auto ltype = lcol.GetType();
+  auto rtype = rhs->GetType();
+  // the whole column is compared by a SIMD kernel, the bitmap is then applied to the rows still selected
+  if (ltype == TYPE_INT && rtype == TYPE_INT) {
+    auto bitmap = BitmapOf(lcol);
+    CompareKernel::CompareInt(
+        op, lcol.GetData(), lcol.GetSize(), std::dynamic_pointer_cast<IntValue>(rhs)->Get(), bitmap.data());
+    return SelectBits(sel, bitmap);
+  }
+  if ((ltype == TYPE_INT || ltype == TYPE_FLOAT) && (rtype == TYPE_INT || rtype == TYPE_FLOAT)) {
+    float value = std::dynamic_pointer_cast<FloatValue>(ValueFactory::CastTo(rhs, TYPE_FLOAT))->Get();
+    if (ltype == TYPE_INT) {
+      return SelectCompare(
+          op, IntAsFloatColumn{reinterpret_cast<const int32_t *>(lcol.GetData())}, Constant<float>{value}, sel);
+    }
+    auto bitmap = BitmapOf(lcol);
+    CompareKernel::CompareFloat(op, lcol.GetData(), lcol.GetSize(), value, bitmap.data());
+    return SelectBits(sel, bitmap);
+  }
+  if (ltype == TYPE_BOOL && rtype == TYPE_BOOL) {
+    return SelectCompare(op,
+        TypedColumn<bool>{reinterpret_cast<const bool *>(lcol.GetData())},
+        Constant<bool>{std::dynamic_pointer_cast<BoolValue>(rhs)->Get()},
+        sel);
+  }
+  if (IsString(ltype) && IsString(rtype)) {
+    const auto &str = std::dynamic_pointer_cast<StringValue>(rhs)->Get();
+    if (str.size() > lcol.GetWidth()) {
+      return SelectCompare(op, StringColumn{&lcol}, Constant<std::string_view>{str}, sel);
+    }
+    // zero-padded strings compare as their padded bytes
+    std::string padded(str);
+    padded.resize(lcol.GetWidth(), '\0');
+    auto bitmap = BitmapOf(lcol);
+    CompareKernel::CompareChar(op, lcol.GetData(), lcol.GetWidth(), lcol.GetSize(), padded.data(), bitmap.data());
+    return SelectBits(sel, bitmap);
+  }
+  SelectIf(sel, [&](uint32_t row) { return CompareValues(op, lcol.GetValueAt(row), rhs); });
+}
+
+// compare the rows of two columns whose values are not null
+void SelectByColumn(CompOp op, const ColumnVector &lcol, const ColumnVector &rcol, std::vector<uint32_t> &sel)
+{
+  auto ltype = lcol.GetType();
+  auto rtype = rcol.GetType();
+  if (ltype == TYPE_INT && rtype == TYPE_INT) {
+    return SelectCompare(op,
+        TypedColumn<int32_t>{reinterpret_cast<const int32_t *>(lcol.GetData())},
+        TypedColumn<int32_t>{reinterpret_cast<const int32_t *>(rcol.GetData())},
+        sel);
+  }
+  if (ltype == TYPE_FLOAT && rtype == TYPE_FLOAT) {
+    return SelectCompare(op,
+        TypedColumn<float>{reinterpret_cast<const float *>(lcol.GetData())},
+        TypedColumn<float>{reinterpret_cast<const float *>(rcol.GetData())},
+        sel);
+  }
+  if (IsString(ltype) && IsString(rtype)) {
+    return SelectCompare(op, StringColumn{&lcol}, StringColumn{&rcol}, sel);
+  }
+  SelectIf(sel, [&](uint32_t row) { return CompareValues(op, lcol.GetValueAt(row), rcol.GetValueAt(row)); });
+}
+
+}  // namespace
+
 auto ConditionExpr::Eval(const ConditionVec &condition, const njudb::Record &record) -> bool
 {
   return std::all_of(
@@ -34,8 +248,28 @@ auto ConditionExpr::EvalCond(const Condition &condition, const njudb::Record &re
   // first get the lhs value according to condition
   auto idx = record.GetSchema()->GetRTFieldIndex(condition.GetLCol());
   NJUDB_ASSERT(idx != record.GetSchema()->GetFieldCount(), "Invalid field");
-  auto lhs = record.GetValueAt(idx);
   NJUDB_ASSERT(condition.GetRhsType() == kValue || condition.GetRhsType() == kColumn, "Invalid condition type");
+  // non-null fields of comparable types are compared in place without creating values
+  auto &lfield = record.GetSchema()->GetFieldAt(idx).field_;
+  if (condition.GetOp() != OP_IN && !record.IsNull(idx)) {
+    if (condition.GetRhsType() == kValue) {
+      const auto &rval = condition.GetRVal();
+      if (!rval->IsNull() && IsTyped(lfield.field_type_, rval->GetType())) {
+        return MatchOp(
+            condition.GetOp(), CompareWithValue(lfield.field_type_, record.GetField(idx), lfield.field_size_, *rval));
+      }
+    } else {
+      auto ridx = record.GetSchema()->GetRTFieldIndex(condition.GetRCol());
+      NJUDB_ASSERT(ridx != record.GetSchema()->GetFieldCount(), "Invalid field");
+      auto &rfield = record.GetSchema()->GetFieldAt(ridx).field_;
+      if (!record.IsNull(ridx) && IsTyped(lfield.field_type_, rfield.field_type_)) {
+        auto res = GetFieldCompareFn(lfield.field_type_, rfield.field_type_)(
+            record.GetField(idx), lfield.field_size_, record.GetField(ridx), rfield.field_size_);
+        return MatchOp(condition.GetOp(), res);
+      }
+    }
+  }
+  auto lhs = record.GetValueAt(idx);
   ValueSptr rhs;
   if (condition.GetRhsType() == kValue) {
     rhs = condition.GetRVal();
@@ -44,6 +278,9 @@ auto ConditionExpr::EvalCond(const Condition &condition, const njudb::Record &re
     NJUDB_ASSERT(idx != record.GetSchema()->GetFieldCount(), "Invalid field");
     rhs = record.GetValueAt(idx);
   }
+  if (condition.GetOp() != OP_IN && (lhs->IsNull() || rhs->IsNull())) {
+    return CompOpOnNull(condition.GetOp(), lhs->IsNull(), rhs->IsNull());
+  }
   ValueFactory::AlignTypes(lhs, rhs);
   switch (condition.GetOp()) {
     case OP_EQ: return *lhs == *rhs;
@@ -58,4 +295,62 @@ auto ConditionExpr::EvalCond(const Condition &condition, const njudb::Record &re
   // should never reach here
 }
 
-}  // namespace njudb
\ No newline at end of file
+void ConditionExpr::Select(const ConditionVec &condition, VectorChunk &chunk)
+{
+  auto sel = chunk.GetSelectedRows();
+  for (const auto &cond : condition) {
+    if (sel.empty()) {
+      break;
+    }
+    SelectCond(cond, chunk, sel);
+  }
+  chunk.SetSelection(std::move(sel));
+}
+
+void ConditionExpr::SelectCond(const Condition &condition, const VectorChunk &chunk, std::vector<uint32_t> &sel)
+{
+  auto idx = chunk.GetSchema()->GetRTFieldIndex(condition.GetLCol());
+  NJUDB_ASSERT(idx != chunk.GetColCount(), "Invalid field");
+  NJUDB_ASSERT(condition.GetRhsType() == kValue || condition.GetRhsType() == kColumn, "Invalid condition type");
+  const auto         &lcol = chunk.GetCol(idx);
+  auto                op   = condition.GetOp();
+  const ColumnVector *rcol = nullptr;
+  ValueSptr           rhs;
+  if (condition.GetRhsType() == kValue) {
+    rhs = condition.GetRVal();
+  } else {
+    auto r_idx = chunk.GetSchema()->GetRTFieldIndex(condition.GetRCol());
+    NJUDB_ASSERT(r_idx != chunk.GetColCount(), "Invalid field");
+    rcol = &chunk.GetCol(r_idx);
+  }
+  if (op == OP_IN || (rhs != nullptr && rhs->IsNull())) {
+    return SelectIf(sel, [&](uint32_t row) {
+      return CompareValues(op, lcol.GetValueAt(row), rhs != nullptr ? rhs : rcol->GetValueAt(row));
+    });
+  }
+  // the rows with a null operand are decided by CompOpOnNull and merged back after the typed loops
+  std::vector<uint32_t> null_rows;
+  SelectIf(sel, [&](uint32_t row) {
+    bool lnull = lcol.IsNull(row);
+    bool rnull = rcol != nullptr && rcol->IsNull(row);
+    if (lnull || rnull) {
+      if (CompOpOnNull(op, lnull, rnull)) {
+        null_rows.push_back(row);
+      }
+      return false;
+    }
+    return true;
+  });
+  if (rcol == nullptr) {
+    SelectByValue(op, lcol, rhs, sel);
+  } else {
+    SelectByColumn(op, lcol, *rcol, sel);
+  }
+  if (!null_rows.empty()) {
+    auto mid = sel.size();
+    sel.insert(sel.end(), null_rows.begin(), null_rows.end());
+    std::inplace_merge(sel.begin(), sel.begin() + static_cast<std::ptrdiff_t>(mid), sel.end());
+  }
+}
+
+}  // namespace njudb
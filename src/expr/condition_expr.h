@@ -23,7 +23,7 @@
 #define NJUDB_CONDITION_EXPR_H
 
 #include "common/condition.h"
-#include "common/record.h"
+#include "common/vector_chunk.h"
 
 namespace njudb {
 
@@ -35,8 +35,20 @@ public:
 
   static auto Eval(const ConditionVec &condition, const Record &record)-> bool;
 
+  /**
+   * Narrow the selection vector of the chunk to the rows that satisfy all the conditions. A column of INT, FLOAT, BOOL
+   * or strings compared with a value or a column of the same type is evaluated by a typed loop over the column, other
+   * conditions are evaluated value by value. Comparisons of INT, FLOAT and string columns with values use the SIMD
+   * kernels of CompareKernel. Nulls compare as in Eval, see CompOpOnNull.
+   * @param condition
+   * @param chunk
+   */
+  static void Select(const ConditionVec &condition, VectorChunk &chunk);
+
 private:
   static auto EvalCond(const Condition &condition, const Record &record) -> bool;
+
+  static void SelectCond(const Condition &condition, const VectorChunk &chunk, std::vector<uint32_t> &sel);
 };
 
 }  // namespace njudb
@@ -21,13 +21,77 @@
 
 #include "storage/storage.h"
 #include <iostream>
+#include "argparse/argparse.hpp"
 #include "system/system.h"
 
-int main()
+int main(int argc, char *argv[])
 {
+  argparse::ArgumentParser program("njudb");
+  program.add_argument("--buffer-pool-size")
+      .help("number of frames in the buffer pool")
+      .default_value(BUFFER_POOL_SIZE)
+      .scan<'u', size_t>();
+  program.add_argument("--buffer-pool-partitions")
+      .help("number of latch-sharded partitions of the buffer pool")
+      .default_value(BUFFER_POOL_PARTITIONS)
+      .scan<'u', size_t>();
+  program.add_argument("--flusher")
+      .help("write back dirty pages of the buffer pool in a background thread")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--flusher-dirty-ratio")
+      .help("ratio of dirty frames in the buffer pool that triggers the background flusher, in (0, 1]")
+      .default_value(FLUSHER_DIRTY_RATIO)
+      .scan<'g', double>();
+  program.add_argument("--fetch-extent")
+      .help("number of pages of the aligned extent loaded by a buffer pool miss, 1 loads the missing page only")
+      .default_value(size_t{1})
+      .scan<'u', size_t>();
+  program.add_argument("--direct-io")
+      .help("read and write pages with O_DIRECT, bypassing the os page cache")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--huge-page")
+      .help("back the buffer pool with huge pages")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--vectorized")
+      .help("run queries with the vectorized executors, which process a chunk of records at a time")
+      .default_value(false)
+      .implicit_value(true);
+
+  njudb::SystemOptions options;
+  try {
+    program.parse_args(argc, argv);
+    options.buffer_pool_size_       = program.get<size_t>("--buffer-pool-size");
+    options.buffer_pool_partitions_ = program.get<size_t>("--buffer-pool-partitions");
+    options.flusher_                = program.get<bool>("--flusher");
+    options.flusher_dirty_ratio_    = program.get<double>("--flusher-dirty-ratio");
+    options.fetch_extent_           = program.get<size_t>("--fetch-extent");
+    options.direct_io_              = program.get<bool>("--direct-io");
+    options.use_huge_page_          = program.get<bool>("--huge-page");
+    options.vectorized_             = program.get<bool>("--vectorized");
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+  if (options.buffer_pool_partitions_ == 0 || options.buffer_pool_partitions_ > options.buffer_pool_size_) {
+    std::cerr << "buffer pool partitions must be in [1, buffer pool size]" << std::endl;
+    return 1;
+  }
+  if (options.flusher_dirty_ratio_ <= 0 || options.flusher_dirty_ratio_ > 1) {
+    std::cerr << "flusher dirty ratio must be in (0, 1]" << std::endl;
+    return 1;
+  }
+  if (options.fetch_extent_ == 0) {
+    std::cerr << "fetch extent must be at least 1" << std::endl;
+    return 1;
+  }
+
   auto njudb_sys = njudb::SystemManager::GetInstance();
   NJUDB_LOG("Creating components");
-  njudb_sys->Init();
+  njudb_sys->Init(options);
   NJUDB_LOG("System Running");
   njudb_sys->Run();
 }
\ No newline at end of file
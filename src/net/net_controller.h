@@ -45,6 +45,8 @@ public:
   /// record will be stored until buffer is full and flush to socket
   void SendRec(int fd, const Record *rec);
 
+  void SendRec(int fd, const RecordView &rec);
+
   void SendRecFinish(int fd);
 
   void SendError(int fd, const std::string &error_msg);
@@ -71,7 +71,7 @@ auto Optimizer::PhysicalOptimize(std::shared_ptr<AbstractPlan> plan, DatabaseHan
     return agg;
   } else if (auto lim = std::dynamic_pointer_cast<LimitPlan>(plan)) {
     lim->child_ = PhysicalOptimize(lim->child_, db);
-    return lim;
+    return TryMakeTopN(lim);
   }
   return plan;
 }
@@ -287,6 +287,26 @@ auto Optimizer::TryEliminateSortWithIndex(
   return sort;  // Cannot optimize
 }
 
+auto Optimizer::TryMakeTopN(std::shared_ptr<LimitPlan> lim) -> std::shared_ptr<AbstractPlan>
+{
+  if (lim->limit_ > TOPN_MAX_LIMIT) {
+    return lim;
+  }
+  auto make_top_n = [&lim](const std::shared_ptr<SortPlan> &sort) {
+    return std::make_shared<TopNPlan>(sort->child_, std::move(sort->key_schema_), sort->is_desc_, lim->limit_);
+  };
+  // the planner puts the projection of the selected fields over the sort, the projection keeps the number of records
+  if (auto sort = std::dynamic_pointer_cast<SortPlan>(lim->child_)) {
+    return make_top_n(sort);
+  } else if (auto proj = std::dynamic_pointer_cast<ProjectPlan>(lim->child_)) {
+    if (auto proj_sort = std::dynamic_pointer_cast<SortPlan>(proj->child_)) {
+      proj->child_ = make_top_n(proj_sort);
+      return proj;
+    }
+  }
+  return lim;
+}
+
 auto Optimizer::TryEliminateSortWithIndexAndFilter(std::shared_ptr<SortPlan> sort, std::shared_ptr<FilterPlan> filter,
     std::shared_ptr<ScanPlan> scan, DatabaseHandle *db) -> std::shared_ptr<AbstractPlan>
 {
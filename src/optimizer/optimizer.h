@@ -88,6 +88,14 @@ private:
   auto TryEliminateSortWithIndexAndFilter(std::shared_ptr<SortPlan> sort, std::shared_ptr<FilterPlan> filter,
       std::shared_ptr<ScanPlan> scan, DatabaseHandle *db) -> std::shared_ptr<AbstractPlan>;
 
+  /**
+   * Try to replace a sort under the limit, possibly below a projection, with a TopNPlan, which keeps only the first
+   * records in a heap. Sorts eliminated by index scans and limits over TOPN_MAX_LIMIT are left as they are
+   * @param lim
+   * @return
+   */
+  auto TryMakeTopN(std::shared_ptr<LimitPlan> lim) -> std::shared_ptr<AbstractPlan>;
+
   /**
    * Check if an index can be used for ORDER BY
    * @param order_schema
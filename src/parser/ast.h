@@ -62,6 +62,9 @@ struct Explain : public TreeNode
 struct ShowTables : public TreeNode
 {};
 
+struct ShowBufferPool : public TreeNode
+{};
+
 struct TxnBegin : public TreeNode
 {};
 
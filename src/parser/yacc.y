@@ -32,8 +32,8 @@ using namespace ast;
 %define parse.error verbose
 
 // keywords
-%token EXPLAIN SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM OPEN DATABASE ON ASC AS ORDER GROUP BY SUM AVG MAX MIN COUNT IN STATIC_CHECKPOINT USING LOOP MERGE INDEX_BPTREE HASH_KWD
-WHERE HAVING UPDATE SET SELECT INT CHAR FLOAT BOOL INDEX AND JOIN INNER OUTER EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY ENABLE_NESTLOOP ENABLE_SORTMERGE STORAGE PAX NARY LIMIT
+%token EXPLAIN SHOW TABLES BUFFERPOOL CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM OPEN DATABASE ON ASC AS ORDER GROUP BY SUM AVG MAX MIN COUNT IN STATIC_CHECKPOINT USING LOOP MERGE INDEX_BPTREE HASH_KWD
+WHERE HAVING UPDATE SET SELECT INT CHAR VARCHAR FLOAT BOOL INDEX AND JOIN INNER OUTER EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY ENABLE_NESTLOOP ENABLE_SORTMERGE STORAGE PAX NARY COMPRESSED LIMIT
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -140,6 +140,10 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    | SHOW BUFFERPOOL
+    {
+        $$ = std::make_shared<ShowBufferPool>();
+    }
     | CREATE DATABASE IDENTIFIER
     {
         $$ = std::make_shared<CreateDatabase>($3);
@@ -189,6 +193,8 @@ optStorageModel:
     { $$ = NARY_MODEL; }
     | STORAGE '=' PAX
     { $$ = PAX_MODEL; }
+    | STORAGE '=' PAX COMPRESSED
+    { $$ = PAX_COMPRESSED_MODEL; }
     ;
 
 dml:
@@ -267,6 +273,10 @@ type:
     {
         $$ = std::make_shared<TypeLen>(TYPE_STRING, $3);
     }
+    |   VARCHAR '(' VALUE_INT ')'
+    {
+        $$ = std::make_shared<TypeLen>(TYPE_VARCHAR, $3);
+    }
     |   FLOAT
     {
         $$ = std::make_shared<TypeLen>(TYPE_FLOAT, sizeof(float));
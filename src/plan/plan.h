@@ -113,6 +113,14 @@ class ShowTablesPlan : public AbstractPlan
   auto ToString(int level) const -> std::string override { return fmt::format("{}ShowTablesPlan", TAB_STR(level)); }
 };
 
+class ShowBufferPoolPlan : public AbstractPlan
+{
+  auto ToString(int level) const -> std::string override
+  {
+    return fmt::format("{}ShowBufferPoolPlan", TAB_STR(level));
+  }
+};
+
 class CreateIndexPlan : public AbstractPlan
 {
 public:
@@ -301,6 +309,28 @@ public:
   bool                          is_desc_;
 };
 
+// the first limit_ records of SortPlan, made by the optimizer from LimitPlan over SortPlan
+class TopNPlan : public AbstractPlan
+{
+public:
+  TopNPlan(std::shared_ptr<AbstractPlan> child, RecordSchemaUptr key_schema, bool is_desc, size_t limit)
+      : child_(std::move(child)), key_schema_(std::move(key_schema)), is_desc_(is_desc), limit_(limit)
+  {}
+  auto ToString(int level) const -> std::string override
+  {
+    return fmt::format("{}TopNPlan <{}> [{}] <{}>\n{}",
+        TAB_STR(level),
+        key_schema_->ToString(),
+        is_desc_ ? "DESC" : "ASC",
+        fmt::format("limit to {}", limit_),
+        child_->ToString(level + 1));
+  }
+  std::shared_ptr<AbstractPlan> child_;
+  RecordSchemaUptr              key_schema_;
+  bool                          is_desc_;
+  size_t                        limit_;
+};
+
 class ProjectPlan : public AbstractPlan
 {
 public:
@@ -99,6 +99,10 @@ auto Planner::PlanAST(const std::shared_ptr<ast::TreeNode> &ast, DatabaseHandle
   if (const auto stab = std::dynamic_pointer_cast<ast::ShowTables>(ast)) {
     return std::make_shared<ShowTablesPlan>();
   }
+  /// show buffer pool
+  if (const auto sbp = std::dynamic_pointer_cast<ast::ShowBufferPool>(ast)) {
+    return std::make_shared<ShowBufferPoolPlan>();
+  }
   /// index related
   if (const auto cidx = std::dynamic_pointer_cast<ast::CreateIndex>(ast)) {
     auto schema = CreateIndexKeySchema(cidx->tab_name_, cidx->col_names_, db);
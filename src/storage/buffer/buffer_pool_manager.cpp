@@ -22,38 +22,271 @@
 #include "page_guard.h"
 #include "replacer/lru_replacer.h"
 #include "replacer/lru_k_replacer.h"
+#include "replacer/arc_replacer.h"
+#include "replacer/two_queue_replacer.h"
+#include "replacer/scan_ring_replacer.h"
 
 #include "../../../common/error.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <numeric>
+
 namespace njudb {
 
-BufferPoolManager::BufferPoolManager(DiskManager *disk_manager, njudb::LogManager *log_manager, size_t replacer_lru_k)
-    : disk_manager_(disk_manager), log_manager_(log_manager)
+namespace {
+
+/**
+ * Hands out a victim only after the frame is taken from FetchResidentPage with Frame::TryEvict, a victim that has been
+ * pinned without the latch in the meantime is skipped, the inner replacer takes it back for its page when it is pinned
+ * or unpinned again.
+ * Counts the victims handed out.
+ */
+class EvictionGuardReplacer : public Replacer
+{
+public:
+  EvictionGuardReplacer(std::unique_ptr<Replacer> replacer, Frame *frames, std::atomic<size_t> &evictions)
+      : replacer_(std::move(replacer)), frames_(frames), evictions_(evictions)
+  {}
+
+  auto Victim(frame_id_t *frame_id) -> bool override
+  {
+    while (replacer_->Victim(frame_id)) {
+      if (frames_[*frame_id].TryEvict()) {
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Pin(frame_id_t frame_id) override { replacer_->Pin(frame_id); }
+
+  void Unpin(frame_id_t frame_id) override { replacer_->Unpin(frame_id); }
+
+  void SetUseOnce(frame_id_t frame_id) override { replacer_->SetUseOnce(frame_id); }
+
+  auto Size() -> size_t override { return replacer_->Size(); }
+
+private:
+  std::unique_ptr<Replacer> replacer_;
+  Frame                    *frames_;
+  std::atomic<size_t>      &evictions_;
+};
+
+}  // namespace
+
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager, njudb::LogManager *log_manager, size_t replacer_lru_k,
+    size_t num_partitions, size_t pool_size, bool use_huge_page)
+    : disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      pool_size_(pool_size),
+      page_frame_lookup_(num_partitions > 1 ? 0 : pool_size),
+      disk_writes_base_(disk_manager->GetPageWriteCount())
 {
+  NJUDB_ASSERT(num_partitions > 0 && num_partitions <= pool_size,
+      fmt::format("invalid partition number {} for pool size {}", num_partitions, pool_size));
+  if (num_partitions > 1) {
+    // split the frames as evenly as possible, the first (pool_size % num_partitions) partitions get one more frame
+    partitions_.reserve(num_partitions);
+    for (size_t i = 0; i < num_partitions; i++) {
+      size_t part_size = pool_size / num_partitions + (i < pool_size % num_partitions ? 1 : 0);
+      partitions_.push_back(
+          std::make_unique<BufferPoolManager>(disk_manager, log_manager, replacer_lru_k, 1, part_size, use_huge_page));
+    }
+    pool_size_ = 0;
+    return;
+  }
+  // replacers see frame ids only, page-aware policies ask for the page held by a frame through the resolver
+  FramePageResolver resolver = [this](frame_id_t frame_id) {
+    auto *page = frames_[frame_id].GetPage();
+    return MakePageKey(page->GetFileId(), page->GetPageId());
+  };
+  std::unique_ptr<Replacer> replacer;
   if (REPLACER == "LRUReplacer") {
-    replacer_ = std::make_unique<LRUReplacer>();
+    replacer = std::make_unique<LRUReplacer>(pool_size_);
   } else if (REPLACER == "LRUKReplacer") {
-    replacer_ = std::make_unique<LRUKReplacer>(replacer_lru_k);
+    replacer = std::make_unique<LRUKReplacer>(replacer_lru_k, pool_size_);
+  } else if (REPLACER == "ARCReplacer") {
+    replacer = std::make_unique<ARCReplacer>(pool_size_, resolver);
+  } else if (REPLACER == "TwoQueueReplacer") {
+    replacer = std::make_unique<TwoQueueReplacer>(pool_size_, resolver);
   } else {
     NJUDB_FATAL("Unknown replacer: " + REPLACER);
   }
+  pool_memory_ = std::make_unique<PoolMemory>(pool_size_, use_huge_page);
+  frames_      = std::make_unique<Frame[]>(pool_size_);
+  replacer_    = std::make_unique<EvictionGuardReplacer>(
+      std::make_unique<ScanRingReplacer>(std::move(replacer), resolver), frames_.get(), evictions_);
   // init free_list_
-  for (frame_id_t i = 0; i < static_cast<int>(BUFFER_POOL_SIZE); i++) {
+  for (frame_id_t i = 0; i < static_cast<int>(pool_size_); i++) {
+    frames_[i].GetPage()->SetData(pool_memory_->GetFrameData(i));
     free_list_.push_back(i);
   }
 }
 
-auto BufferPoolManager::FetchPage(file_id_t fid, page_id_t pid) -> Page * { NJUDB_STUDENT_TODO(l1, t2); }
+BufferPoolManager::~BufferPoolManager() { StopFlusher(); }
 
-auto BufferPoolManager::UnpinPage(file_id_t fid, page_id_t pid, bool is_dirty) -> bool { NJUDB_STUDENT_TODO(l1, t2); }
+auto BufferPoolManager::FetchPage(file_id_t fid, page_id_t pid) -> Page *
+{
+  if (IsPartitioned()) {
+    auto *part = GetPartition(fid, pid);
+    // the extent spreads over the partitions, it is loaded by the whole pool
+    if (fetch_extent_ > 1 && part->page_frame_lookup_.Find(fid, pid) == INVALID_FRAME_ID) {
+      FetchExtent(fid, pid);
+    }
+    return part->FetchPage(fid, pid);
+  }
+  if (auto *page = FetchResidentPage(fid, pid); page != nullptr) {
+    return page;
+  }
+  if (fetch_extent_ > 1) {
+    FetchExtent(fid, pid);
+    // the page may have been evicted again before it is pinned, then it is loaded alone below
+    if (auto *page = FetchResidentPage(fid, pid); page != nullptr) {
+      return page;
+    }
+  }
+  NJUDB_STUDENT_TODO(l1, t2);
+}
 
-auto BufferPoolManager::DeletePage(file_id_t fid, page_id_t pid) -> bool { NJUDB_STUDENT_TODO(l1, t2); }
+auto BufferPoolManager::FetchPage(file_id_t fid, page_id_t pid, bool use_once) -> Page *
+{
+  if (IsPartitioned()) {
+    return GetPartition(fid, pid)->FetchPage(fid, pid, use_once);
+  }
+  if (!use_once) {
+    return FetchPage(fid, pid);
+  }
+  // a hit of a page that has been used before, e.g. a hot page that the scan passes by, keeps its place
+  bool  prefetched = false;
+  Page *page       = FetchResidentPage(fid, pid, &prefetched);
+  if (page != nullptr && !prefetched) {
+    return page;
+  }
+  if (page == nullptr) {
+    page = FetchPage(fid, pid);
+  }
+  std::scoped_lock lock(latch_);
+  auto             frame_id = page_frame_lookup_.Find(fid, pid);
+  // a page that is also pinned by someone else is shared, leave it to the replacement policy
+  if (frame_id != INVALID_FRAME_ID && frames_[frame_id].GetPinCount() == 1) {
+    replacer_->SetUseOnce(frame_id);
+  }
+  return page;
+}
 
-auto BufferPoolManager::DeleteAllPages(file_id_t fid) -> bool { NJUDB_STUDENT_TODO(l1, t2); }
+auto BufferPoolManager::UnpinPage(file_id_t fid, page_id_t pid, bool is_dirty) -> bool
+{
+  if (IsPartitioned()) {
+    return GetPartition(fid, pid)->UnpinPage(fid, pid, is_dirty);
+  }
+  NJUDB_STUDENT_TODO(l1, t2);
+}
 
-auto BufferPoolManager::FlushPage(file_id_t fid, page_id_t pid) -> bool { NJUDB_STUDENT_TODO(l1, t2); }
+auto BufferPoolManager::DeletePage(file_id_t fid, page_id_t pid) -> bool
+{
+  if (IsPartitioned()) {
+    return GetPartition(fid, pid)->DeletePage(fid, pid);
+  }
+  {
+    // take the frame from FetchResidentPage first, so that it is not pinned between the checks and the reset below
+    std::scoped_lock lock(latch_);
+    auto             frame_id = page_frame_lookup_.Find(fid, pid);
+    if (frame_id != INVALID_FRAME_ID && !frames_[frame_id].TryEvict()) {
+      return false;
+    }
+  }
+  NJUDB_STUDENT_TODO(l1, t2);
+}
 
-auto BufferPoolManager::FlushAllPages(file_id_t fid) -> bool { NJUDB_STUDENT_TODO(l1, t2); }
+auto BufferPoolManager::DeleteAllPages(file_id_t fid) -> bool
+{
+  std::scoped_lock round_lock(flush_round_latch_);
+  // the file is about to be closed, which unmaps it
+  UnmapFile(fid);
+  if (IsPartitioned()) {
+    bool all_deleted = true;
+    for (auto &part : partitions_) {
+      all_deleted = part->DeleteAllPages(fid) && all_deleted;
+    }
+    return all_deleted;
+  }
+  NJUDB_STUDENT_TODO(l1, t2);
+}
+
+auto BufferPoolManager::FlushPage(file_id_t fid, page_id_t pid) -> bool
+{
+  if (IsPartitioned()) {
+    return GetPartition(fid, pid)->FlushPage(fid, pid);
+  }
+  NJUDB_STUDENT_TODO(l1, t2);
+}
+
+auto BufferPoolManager::FlushAllPages(file_id_t fid) -> bool
+{
+  std::scoped_lock round_lock(flush_round_latch_);
+  auto             frames = CollectAllDirtyFrames(fid);
+  WriteBackFrames(frames);
+  if (IsPartitioned()) {
+    bool all_flushed = true;
+    for (auto &part : partitions_) {
+      all_flushed = part->FlushAllPages(fid) && all_flushed;
+    }
+    return all_flushed;
+  }
+  NJUDB_STUDENT_TODO(l1, t2);
+}
+
+void BufferPoolManager::FetchExtent(file_id_t fid, page_id_t pid)
+{
+  auto extent = std::min(fetch_extent_, std::max<size_t>(1, GetPoolSize() / 4));
+  if (extent <= 1) {
+    return;
+  }
+  auto first = pid - static_cast<page_id_t>(static_cast<size_t>(pid) % extent);
+  PrefetchRange(fid, first, extent);
+}
+
+auto BufferPoolManager::FetchResidentPage(file_id_t fid, page_id_t pid, bool *prefetched) -> Page *
+{
+  auto frame_id = page_frame_lookup_.FindPublished(fid, pid);
+  if (frame_id == INVALID_FRAME_ID && page_frame_lookup_.HasPending()) {
+    // the pages added by FetchPage are loaded once the latch is free
+    if (std::unique_lock lock(latch_, std::try_to_lock); lock.owns_lock()) {
+      page_frame_lookup_.PublishPending();
+      frame_id = page_frame_lookup_.FindPublished(fid, pid);
+    }
+  }
+  if (frame_id == INVALID_FRAME_ID) {
+    return nullptr;
+  }
+  auto &frame      = frames_[frame_id];
+  auto  prev_count = frame.TryPin();
+  if (prev_count == Frame::NO_PAGE) {
+    pin_waits_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  auto *page = frame.GetPage();
+  if (page->GetFileId() != fid || page->GetPageId() != pid) {
+    if (frame.Unpin() == 0) {
+      replacer_->Unpin(frame_id);
+    }
+    pin_waits_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  if (prev_count == 0) {
+    replacer_->Pin(frame_id);
+  }
+  auto first_pin = frame.TakePrefetched();
+  if (prefetched != nullptr) {
+    *prefetched = first_pin;
+  }
+  latch_free_hits_.fetch_add(1, std::memory_order_relaxed);
+  return page;
+}
 
 auto BufferPoolManager::GetAvailableFrame() -> frame_id_t { NJUDB_STUDENT_TODO(l1, t2); }
 
@@ -61,12 +294,19 @@ void BufferPoolManager::UpdateFrame(frame_id_t frame_id, file_id_t fid, page_id_
 
 auto BufferPoolManager::GetFrame(file_id_t fid, page_id_t pid) -> Frame *
 {
-  const auto it = page_frame_lookup_.find({fid, pid});
-  return it == page_frame_lookup_.end() ? nullptr : &frames_[it->second];
+  if (IsPartitioned()) {
+    return GetPartition(fid, pid)->GetFrame(fid, pid);
+  }
+  auto frame_id = page_frame_lookup_.Find(fid, pid);
+  return frame_id == INVALID_FRAME_ID ? nullptr : &frames_[frame_id];
 }
 
 auto BufferPoolManager::FetchPageRead(file_id_t fid, page_id_t pid) -> ReadPageGuard
 {
+  if (auto *page = GetMappedPage(fid, pid); page != nullptr) {
+    // nothing to unpin
+    return {nullptr, page, fid, pid};
+  }
   Page *page = FetchPage(fid, pid);
   return {this, page, fid, pid};
 }
@@ -77,4 +317,458 @@ auto BufferPoolManager::FetchPageWrite(file_id_t fid, page_id_t pid) -> WritePag
   return {this, page, fid, pid};
 }
 
+auto BufferPoolManager::MapFile(file_id_t fid) -> size_t
+{
+  // the mapping reads the file, so the pages modified in the pool must reach the file first
+  FlushAllPages(fid);
+  std::unique_lock lock(mapped_latch_);
+  mapped_pages_.erase(fid);
+  auto  page_num = disk_manager_->MapFile(fid);
+  auto &pages    = mapped_pages_.try_emplace(fid, page_num).first->second;
+  for (size_t i = 0; i < page_num; i++) {
+    auto pid = static_cast<page_id_t>(i);
+    // the mapping is read-only, writing to the data faults
+    pages[i].SetData(const_cast<char *>(disk_manager_->GetMappedPage(fid, pid)));
+    pages[i].SetFilePageId(fid, pid);
+  }
+  return page_num;
+}
+
+void BufferPoolManager::UnmapFile(file_id_t fid)
+{
+  std::unique_lock lock(mapped_latch_);
+  if (mapped_pages_.erase(fid) > 0) {
+    disk_manager_->UnmapFile(fid);
+  }
+}
+
+auto BufferPoolManager::GetMappedPage(file_id_t fid, page_id_t pid) -> Page *
+{
+  std::shared_lock lock(mapped_latch_);
+  auto             it = mapped_pages_.find(fid);
+  if (it == mapped_pages_.end() || pid < 0 || static_cast<size_t>(pid) >= it->second.size()) {
+    return nullptr;
+  }
+  return &it->second[pid];
+}
+
+auto BufferPoolManager::PrefetchRange(file_id_t fid, page_id_t first_pid, size_t n) -> size_t
+{
+  if (!IsPartitioned()) {
+    std::vector<page_id_t> pids(n);
+    std::iota(pids.begin(), pids.end(), first_pid);
+    return PrefetchPages(fid, pids);
+  }
+  // pages of a range are spread over all partitions, prefetch the share of each partition separately
+  std::unordered_map<BufferPoolManager *, std::vector<page_id_t>> part_pids;
+  for (size_t i = 0; i < n; i++) {
+    auto pid = first_pid + static_cast<page_id_t>(i);
+    part_pids[GetPartition(fid, pid)].push_back(pid);
+  }
+  auto loaded = n;
+  for (auto &[part, pids] : part_pids) {
+    auto part_loaded = part->PrefetchPages(fid, pids);
+    if (part_loaded < pids.size()) {
+      loaded = std::min(loaded, static_cast<size_t>(pids[part_loaded] - first_pid));
+    }
+  }
+  return loaded;
+}
+
+auto BufferPoolManager::PrefetchPages(file_id_t fid, const std::vector<page_id_t> &pids) -> size_t
+{
+  size_t                                        loaded = 0;
+  std::vector<std::pair<frame_id_t, page_id_t>> published;
+  std::vector<frame_id_t>                       held;
+  std::unordered_set<page_id_t>                 range(pids.begin(), pids.end());
+  // 5. the published pages stay pinned in the replacer until the end, so that the second round does not take them,
+  // and the resident pages of the range that were taken as victims are unpinned
+  auto release = [this, fid, &published, &held] {
+    std::scoped_lock lock(latch_);
+    for (auto frame_id : held) {
+      if (frames_[frame_id].Unpin() == 0) {
+        replacer_->Unpin(frame_id);
+      }
+    }
+    for (auto [frame_id, pid] : published) {
+      // a page fetched meanwhile is unpinned in the replacer by its UnpinPage, a deleted page is not ours anymore
+      if (page_frame_lookup_.Find(fid, pid) == frame_id && !frames_[frame_id].InUse()) {
+        replacer_->Unpin(frame_id);
+      }
+    }
+  };
+  try {
+    // a second round takes the dirty victims written back by the first
+    for (int round = 0; round < 2 && loaded < pids.size(); round++) {
+      // 1. under the latch, take a free frame or a clean victim for every page that is not in the pool. The loading
+      // frames are not in the page table, so no one reaches them until step 4. Dirty victims keep their pages and
+      // are pinned to be written back in step 2, they are taken by the next round. Victims holding pages of the range
+      // are kept until step 5.
+      std::vector<std::pair<frame_id_t, page_id_t>> loads;
+      std::vector<DirtyFrame>                       write_backs;
+      {
+        std::scoped_lock lock(latch_);
+        for (; loaded < pids.size(); loaded++) {
+          auto pid = pids[loaded];
+          if (page_frame_lookup_.Find(fid, pid) != INVALID_FRAME_ID) {
+            continue;
+          }
+          auto frame_id = TakeCleanFrame(fid, range, write_backs, held);
+          if (frame_id == INVALID_FRAME_ID) {
+            break;
+          }
+          frames_[frame_id].Reset();
+          frames_[frame_id].GetPage()->SetFilePageId(fid, pid);
+          replacer_->Pin(frame_id);
+          loads.emplace_back(frame_id, pid);
+        }
+      }
+      // 2. write back the dirty victims without the latch, they are readable in the pool meanwhile
+      WriteBackFrames(write_backs);
+      // 3. read runs of adjacent pages with one vectored read each, the single pages are read in one batch meanwhile
+      try {
+        ReadFrames(fid, loads);
+      } catch (...) {
+        std::scoped_lock lock(latch_);
+        for (auto [frame_id, pid] : loads) {
+          RecycleFrame(frame_id);
+        }
+        throw;
+      }
+      // 4. publish the loaded pages, a page loaded by someone else in the meantime is kept and the frame is freed
+      {
+        std::scoped_lock lock(latch_);
+        for (auto [frame_id, pid] : loads) {
+          if (page_frame_lookup_.Find(fid, pid) != INVALID_FRAME_ID) {
+            RecycleFrame(frame_id);
+            continue;
+          }
+          page_frame_lookup_.Insert(fid, pid, frame_id);
+          frames_[frame_id].SetLoaded();
+          frames_[frame_id].SetPrefetched();
+          published.emplace_back(frame_id, pid);
+          prefetches_++;
+        }
+      }
+      if (write_backs.empty()) {
+        break;
+      }
+    }
+  } catch (...) {
+    release();
+    throw;
+  }
+  release();
+  return loaded;
+}
+
+auto BufferPoolManager::TakeCleanFrame(file_id_t fid, const std::unordered_set<page_id_t> &range,
+    std::vector<DirtyFrame> &write_backs, std::vector<frame_id_t> &held) -> frame_id_t
+{
+  if (!free_list_.empty()) {
+    auto frame_id = free_list_.front();
+    free_list_.pop_front();
+    return frame_id;
+  }
+  frame_id_t frame_id;
+  while (replacer_->Victim(&frame_id)) {
+    auto &frame = frames_[frame_id];
+    auto *page  = frame.GetPage();
+    bool  keep  = page->GetFileId() == fid && range.count(page->GetPageId()) > 0;
+    if (!keep && !frame.IsDirty()) {
+      if (page->GetFileId() != INVALID_FILE_ID) {
+        page_frame_lookup_.Erase(page->GetFileId(), page->GetPageId());
+      }
+      return frame_id;
+    }
+    // keep the page in the pool pinned, until it is written back (see CollectDirtyFrames) or the prefetch is done
+    frame.SetLoaded();
+    frame.TryPin();
+    replacer_->Pin(frame_id);
+    if (keep) {
+      held.push_back(frame_id);
+    } else {
+      frame.SetDirty(false);
+      write_backs.push_back({this, frame_id, page->GetFileId(), page->GetPageId()});
+    }
+  }
+  return INVALID_FRAME_ID;
+}
+
+void BufferPoolManager::RecycleFrame(frame_id_t frame_id)
+{
+  // the frame is pinned in the replacer, once unpinned the empty frame is reused as a victim. Putting it on the free
+  // list as well would hand it out twice.
+  frames_[frame_id].Reset();
+  replacer_->Unpin(frame_id);
+}
+
+void BufferPoolManager::ReadFrames(file_id_t fid, const std::vector<std::pair<frame_id_t, page_id_t>> &loads)
+{
+  std::vector<PageIO>                                    reads;
+  std::vector<std::pair<page_id_t, std::vector<char *>>> runs;
+  for (size_t begin = 0, end; begin < loads.size(); begin = end) {
+    std::vector<char *> pages;
+    for (end = begin;
+         end < loads.size() && loads[end].second == loads[begin].second + static_cast<page_id_t>(end - begin);
+         end++) {
+      pages.push_back(frames_[loads[end].first].GetPage()->GetData());
+    }
+    if (pages.size() == 1) {
+      reads.push_back({IOType::READ, fid, loads[begin].second, pages.front()});
+    } else {
+      runs.emplace_back(loads[begin].second, std::move(pages));
+    }
+  }
+  auto futures = disk_manager_->SubmitPageIO(reads);
+  // wait for the batch before a failed read of a run leaves the frames to be reused
+  std::exception_ptr error;
+  try {
+    for (auto &[first_pid, pages] : runs) {
+      disk_manager_->ReadPages(fid, first_pid, pages);
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  for (auto &future : futures) {
+    try {
+      future.get();
+    } catch (...) {
+      error = error ? error : std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void BufferPoolManager::SetFetchExtent(size_t pages) { fetch_extent_ = std::max<size_t>(1, pages); }
+
+void BufferPoolManager::StartFlusher(double dirty_ratio, size_t interval_ms, size_t checkpoint_interval_ms)
+{
+  if (flusher_.joinable()) {
+    return;
+  }
+  flusher_stop_ = false;
+  flusher_      = std::thread(&BufferPoolManager::FlusherLoop, this, dirty_ratio, interval_ms, checkpoint_interval_ms);
+}
+
+void BufferPoolManager::StopFlusher()
+{
+  if (!flusher_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock lock(flusher_latch_);
+    flusher_stop_ = true;
+  }
+  flusher_cv_.notify_all();
+  flusher_.join();
+}
+
+void BufferPoolManager::FlusherLoop(double dirty_ratio, size_t interval_ms, size_t checkpoint_interval_ms)
+{
+  auto last_flush = std::chrono::steady_clock::now();
+  std::unique_lock lock(flusher_latch_);
+  while (!flusher_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return flusher_stop_; })) {
+    lock.unlock();
+    size_t dirty = 0;
+    if (IsPartitioned()) {
+      for (auto &part : partitions_) {
+        dirty += part->CountDirtyFrames();
+      }
+    } else {
+      dirty = CountDirtyFrames();
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (dirty > 0 && (static_cast<double>(dirty) >= dirty_ratio * static_cast<double>(GetPoolSize()) ||
+                         (checkpoint_interval_ms > 0 &&
+                             now - last_flush >= std::chrono::milliseconds(checkpoint_interval_ms)))) {
+      try {
+        FlushDirtyFrames();
+      } catch (NJUDBException_ &e) {
+        NJUDB_LOG_ERROR(fmt::format("background flush failed: {}", e.what()));
+      }
+      last_flush = now;
+    }
+    lock.lock();
+  }
+}
+
+auto BufferPoolManager::FlushDirtyFrames() -> size_t
+{
+  std::scoped_lock round_lock(flush_round_latch_);
+  auto             frames  = CollectAllDirtyFrames();
+  auto             written = WriteBackFrames(frames);
+  background_writes_ += written;
+  return written;
+}
+
+auto BufferPoolManager::CollectAllDirtyFrames(file_id_t fid) -> std::vector<DirtyFrame>
+{
+  std::vector<DirtyFrame> frames;
+  if (IsPartitioned()) {
+    for (auto &part : partitions_) {
+      part->CollectDirtyFrames(frames, fid);
+    }
+  } else {
+    CollectDirtyFrames(frames, fid);
+  }
+  return frames;
+}
+
+auto BufferPoolManager::WriteBackFrames(std::vector<DirtyFrame> &frames) -> size_t
+{
+  std::sort(frames.begin(), frames.end(), [](const DirtyFrame &a, const DirtyFrame &b) {
+    return a.fid_ != b.fid_ ? a.fid_ < b.fid_ : a.pid_ < b.pid_;
+  });
+
+  // aligned so that the copies can still be written with direct io
+  std::vector<char> staging(std::min(frames.size(), WRITE_BACK_MAX_PAGES) * PAGE_SIZE + DIRECT_IO_ALIGNMENT);
+  auto             *buffer = staging.data() + (DIRECT_IO_ALIGNMENT -
+                                                 reinterpret_cast<uintptr_t>(staging.data()) % DIRECT_IO_ALIGNMENT);
+
+  size_t written = 0;
+  for (size_t begin = 0, end; begin < frames.size(); begin = end) {
+    // extend the run while the next frame holds the next page of the same file
+    for (end = begin + 1; end < frames.size() && end - begin < WRITE_BACK_MAX_PAGES &&
+                          frames[end].fid_ == frames[begin].fid_ &&
+                          frames[end].pid_ == frames[begin].pid_ + static_cast<page_id_t>(end - begin);
+         end++) {}
+    // the dirty flag was cleared when the frame was collected, a write after the copy marks the page dirty again
+    std::vector<const char *> pages;
+    for (auto i = begin; i < end; i++) {
+      auto *page = frames[i].owner_->frames_[frames[i].frame_id_].GetPage();
+      auto *copy = buffer + (i - begin) * PAGE_SIZE;
+      {
+        std::scoped_lock page_latch(page->GetLatch());
+        memcpy(copy, page->GetData(), PAGE_SIZE);
+      }
+      pages.push_back(copy);
+    }
+    try {
+      disk_manager_->WritePages(frames[begin].fid_, frames[begin].pid_, pages);
+      written += pages.size();
+    } catch (NJUDBException_ &e) {
+      // the pages are still dirty
+      for (auto i = begin; i < end; i++) {
+        std::scoped_lock lock(frames[i].owner_->latch_);
+        frames[i].owner_->frames_[frames[i].frame_id_].SetDirty(true);
+      }
+      NJUDB_LOG_ERROR(fmt::format("write back failed: {}", e.what()));
+    }
+  }
+
+  // the frames were evictable before, put back the ones that have been victimized while they were pinned
+  for (const auto &frame : frames) {
+    if (frame.owner_->frames_[frame.frame_id_].Unpin() == 0) {
+      frame.owner_->replacer_->Unpin(frame.frame_id_);
+    }
+  }
+  return written;
+}
+
+void BufferPoolManager::CollectDirtyFrames(std::vector<DirtyFrame> &frames, file_id_t fid)
+{
+  std::scoped_lock lock(latch_);
+  for (frame_id_t i = 0; i < static_cast<frame_id_t>(pool_size_); i++) {
+    auto &frame = frames_[i];
+    auto *page  = frame.GetPage();
+    if (!frame.IsDirty() || frame.InUse() || page->GetFileId() == INVALID_FILE_ID) {
+      continue;
+    }
+    if (fid != INVALID_FILE_ID && page->GetFileId() != fid) {
+      continue;
+    }
+    // pinning only the frame keeps the position of the frame in the replacer
+    if (frame.TryPin() == Frame::NO_PAGE) {
+      continue;
+    }
+    frame.SetDirty(false);
+    frames.push_back({this, i, page->GetFileId(), page->GetPageId()});
+  }
+}
+
+auto BufferPoolManager::CountDirtyFrames() -> size_t
+{
+  std::scoped_lock lock(latch_);
+  size_t           dirty = 0;
+  for (size_t i = 0; i < pool_size_; i++) {
+    dirty += frames_[i].IsDirty() ? 1 : 0;
+  }
+  return dirty;
+}
+
+auto BufferPoolManager::GetWriteStats() const -> PageWriteStats
+{
+  size_t background = background_writes_.load();
+  size_t total      = disk_manager_->GetPageWriteCount() - disk_writes_base_;
+  return {total > background ? total - background : 0, background};
+}
+
+auto BufferPoolManager::GetStats() -> BufferPoolStats
+{
+  BufferPoolStats stats;
+  if (IsPartitioned()) {
+    for (auto &part : partitions_) {
+      part->CollectStats(stats);
+    }
+  } else {
+    CollectStats(stats);
+  }
+  stats.writes_ = GetWriteStats();
+  return stats;
+}
+
+void BufferPoolManager::CollectStats(BufferPoolStats &stats)
+{
+  std::unordered_map<file_id_t, size_t> residency;
+  {
+    std::scoped_lock lock(latch_);
+    for (size_t i = 0; i < pool_size_; i++) {
+      auto &frame = frames_[i];
+      auto  fid   = frame.GetPage()->GetFileId();
+      stats.hits_ += frame.GetPinHits();
+      stats.misses_ += frame.GetLoads();
+      if (fid != INVALID_FILE_ID) {
+        stats.resident_pages_++;
+        stats.dirty_pages_ += frame.IsDirty() ? 1 : 0;
+        residency[fid]++;
+      }
+    }
+  }
+  stats.pool_size_ += pool_size_;
+  stats.hits_ += latch_free_hits_.load();
+  stats.prefetches_ += prefetches_.load();
+  stats.evictions_ += evictions_.load();
+  stats.pin_waits_ += pin_waits_.load();
+  for (auto [fid, pages] : residency) {
+    std::string name;
+    try {
+      name = disk_manager_->GetFileName(fid);
+    } catch (NJUDBException_ &e) {
+      name = fmt::format("fid {}", fid);
+    }
+    stats.file_residency_[name] += pages;
+  }
+}
+
+auto BufferPoolManager::GetPoolSize() const -> size_t
+{
+  size_t pool_size = pool_size_;
+  for (const auto &part : partitions_) {
+    pool_size += part->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto BufferPoolManager::GetPartitionNum() const -> size_t { return IsPartitioned() ? partitions_.size() : 1; }
+
+auto BufferPoolManager::GetPartition(file_id_t fid, page_id_t pid) -> BufferPoolManager *
+{
+  // fibonacci hashing on the packed (fid, pid), plain xor maps (f, p) and (p, f) to the same partition
+  auto mix = (MakePageKey(fid, pid) * 0x9E3779B97F4A7C15ULL) >> 32;
+  return partitions_[mix % partitions_.size()].get();
+}
+
 }  // namespace njudb
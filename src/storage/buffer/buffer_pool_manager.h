@@ -22,56 +22,81 @@
 #ifndef NJUDB_BUFFER_POOL_MANAGER_H
 #define NJUDB_BUFFER_POOL_MANAGER_H
 
+#include <condition_variable>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <thread>
+#include <unordered_set>
 #include <vector>
-#include <array>
 #include "storage/disk/disk_manager.h"
 #include "log/log_manager.h"
 #include "replacer/replacer.h"
 #include "frame.h"
+#include "page_table.h"
+#include "pool_memory.h"
 #include "common/page.h"
 
 namespace njudb {
 
 class ReadPageGuard;
 class WritePageGuard;
-struct fid_pid_t
-{
-  file_id_t fid;
-  page_id_t pid;
 
-  bool operator==(const fid_pid_t &rhs) const { return fid == rhs.fid && pid == rhs.pid; }
+/**
+ * Page writes of a buffer pool, background writes are issued by the flusher, foreground writes are all other page writes
+ * through the disk manager since the pool was created, i.e. write-backs of evicted pages and explicit flushes
+ */
+struct PageWriteStats
+{
+  size_t foreground_writes_{0};
+  size_t background_writes_{0};
 };
-}  // namespace njudb
 
-namespace std {
-template <>
-struct hash<njudb::fid_pid_t>
+/**
+ * Counters of a buffer pool, summed over its partitions
+ */
+struct BufferPoolStats
 {
-  size_t operator()(const njudb::fid_pid_t &fp) const
-  {
-    return std::hash<table_id_t>()(fp.fid) ^ std::hash<frame_id_t>()(fp.pid);
-  }
+  size_t                        pool_size_{0};
+  size_t                        resident_pages_{0};
+  size_t                        dirty_pages_{0};
+  size_t                        hits_{0};        // fetches that found the page in the pool
+  size_t                        misses_{0};      // fetches that loaded the page from disk
+  size_t                        prefetches_{0};  // pages loaded ahead of time by PrefetchRange
+  size_t                        evictions_{0};   // victims taken from the replacer
+  size_t                        pin_waits_{0};   // fetches of a resident page that fell back to the latch
+  PageWriteStats                writes_;
+  std::map<std::string, size_t> file_residency_;  // file name -> number of resident pages
 };
-}  // namespace std
-
-namespace njudb {
 
 class BufferPoolManager
 {
 public:
-  explicit BufferPoolManager(DiskManager *disk_manager, LogManager *log_manager = nullptr, size_t replacer_lru_k = 0);
+  /**
+   * Create a buffer pool manager
+   * @param disk_manager
+   * @param log_manager
+   * @param replacer_lru_k k for LRUKReplacer, at least 1
+   * @param num_partitions if larger than 1, the pool is split into num_partitions independent partitions, each owns a
+   * slice of the frames, its own latch, free list, replacer and page table, pages are routed to partitions by the hash of
+   * fid_pid_t so that threads touching different pages rarely contend on the same latch
+   * @param pool_size number of frames in the pool (shared by all partitions)
+   * @param use_huge_page back the page buffers of the frames with huge pages if the os provides them
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager, LogManager *log_manager = nullptr, size_t replacer_lru_k = REPLACER_LRU_K,
+      size_t num_partitions = 1, size_t pool_size = BUFFER_POOL_SIZE, bool use_huge_page = false);
 
-  ~BufferPoolManager() = default;
+  ~BufferPoolManager();
 
   DISABLE_COPY_MOVE_AND_ASSIGN(BufferPoolManager)
 
   /**
-   * Fetch the requested page from disk.
+   * Fetch the requested page from disk. Pages that are in the pool are first pinned without the latch by
+   * FetchResidentPage, the steps below are taken only if that fails.
    * 1. grant the latch
-   * 2. check if the page is in the frame
+   * 2. check if the page is in the frame by looking up page_frame_lookup_
    * 3. if the page is not in the frame, GetAvailableFrame and UpdateFrame
    * 4. else pin the frame both in the buffer and the replacer and return the page
    * @param fid file that the page belongs to
@@ -80,6 +105,17 @@ public:
    */
   auto FetchPage(file_id_t fid, page_id_t pid) -> Page *;
 
+  /**
+   * Fetch the page with an access hint
+   * @param fid
+   * @param pid
+   * @param use_once the caller reads the page once and moves on (sequential scans), so the frame is reused before
+   * other frames after it is unpinned, see ScanRingReplacer. Only pages loaded for this call, or prefetched and not
+   * pinned since, are hinted, pages that were in use before keep their place in the replacement policy.
+   * @return the page
+   */
+  auto FetchPage(file_id_t fid, page_id_t pid, bool use_once) -> Page *;
+
   /**
    * Unpin the page indicating that it can be victimized
    * 1. grant the latch
@@ -125,9 +161,12 @@ public:
   auto FlushPage(file_id_t fid, page_id_t pid) -> bool;
 
   /**
-   * Flush all pages to disk
+   * Flush all pages of the file to disk, the dirty pages that are not pinned are written back first in page order,
+   * runs of adjacent pages with one vectored write each, the steps below flush the rest
+   * 1. collect the pages of the file in the pool under the latch
+   * 2. flush them one by one with FlushPage, which skips the pages that are not dirty
    * @param fid
-   * @return
+   * @return true if all pages are flushed successfully
    */
   auto FlushAllPages(file_id_t fid) -> bool;
 
@@ -137,7 +176,8 @@ public:
  auto GetFrame(file_id_t fid, page_id_t pid) -> Frame*;
 
   /**
-   * Fetch a page and return a ReadPageGuard for read-only access
+   * Fetch a page and return a ReadPageGuard for read-only access, if the file is mapped by MapFile and the page is
+   * covered by the mapping, the guard points into the mapping and unpins nothing
    * @param fid File ID
    * @param pid Page ID
    * @return ReadPageGuard for the page
@@ -152,13 +192,188 @@ public:
    */
   auto FetchPageWrite(file_id_t fid, page_id_t pid) -> WritePageGuard;
 
+  /**
+   * Load pages [first_pid, first_pid + n) of the file into the pool ahead of time, pages that are already in the pool
+   * are skipped. Only free frames and victims that are not dirty are taken, prefetching stops early instead of
+   * throwing NJUDB_NO_FREE_FRAME. Dirty victims stay in the pool while they are written back, and are taken in a second
+   * round. The pages are read in one batch without the latch, so all the reads are in flight together, and enter the
+   * page table once they are loaded. The loaded pages are left unpinned.
+   * @param fid
+   * @param first_pid
+   * @param n
+   * @return number of pages in [first_pid, first_pid + n) that are in the pool afterwards, counting from first_pid
+   * until the first page that could not be loaded
+   */
+  auto PrefetchRange(file_id_t fid, page_id_t first_pid, size_t n) -> size_t;
+
+  /**
+   * Set the number of pages loaded by a miss of FetchPage, the missing page and the pages of its aligned extent
+   * [pid - pid % pages, pid - pid % pages + pages) that are not in the pool are loaded by PrefetchRange, runs of
+   * adjacent pages with one vectored read each. The extent is capped by a quarter of the pool, 1 disables it.
+   * @param pages
+   */
+  void SetFetchExtent(size_t pages);
+
+  /**
+   * Serve the pages of a read-only file from a read-only memory mapping of it instead of the frames. The pages of the
+   * file in the pool are flushed first, afterwards FetchPageRead and GetMappedPage return pages that point into the
+   * mapping, they take no frame and need no unpin. Pages written through the pool are not seen in the mapping until
+   * they are flushed. Mapping a mapped file again remaps it to cover the pages appended since.
+   * @param fid
+   * @return number of pages covered by the mapping
+   */
+  auto MapFile(file_id_t fid) -> size_t;
+
+  /**
+   * Stop serving the file from its mapping, pages returned by GetMappedPage become invalid. Called by DeleteAllPages.
+   * @param fid
+   */
+  void UnmapFile(file_id_t fid);
+
+  /**
+   * @return the page in the mapping of the file, whose data must not be written, nullptr if the file is not mapped or
+   * the page is beyond the mapping
+   */
+  auto GetMappedPage(file_id_t fid, page_id_t pid) -> Page *;
+
+  /**
+   * Start the background flusher thread, it writes back dirty unpinned frames so that evictions rarely have to, see
+   * FlushDirtyFrames. Does nothing if the flusher is running.
+   * @param dirty_ratio write back once the ratio of dirty frames in the pool reaches it
+   * @param interval_ms how often the flusher checks the dirty ratio
+   * @param checkpoint_interval_ms write back at least this often regardless of the dirty ratio, 0 disables it
+   */
+  void StartFlusher(double dirty_ratio = FLUSHER_DIRTY_RATIO, size_t interval_ms = FLUSHER_INTERVAL_MS,
+      size_t checkpoint_interval_ms = FLUSHER_CHECKPOINT_INTERVAL_MS);
+
+  /**
+   * Stop the background flusher thread and wait for it to exit
+   */
+  void StopFlusher();
+
+  /**
+   * Write back all dirty frames that are not pinned in page order, runs of adjacent pages of a file are written with one
+   * vectored write. The frames are pinned only while they are being written, and the latch is not held during the
+   * writes. Also called by the flusher thread.
+   * @return number of pages written
+   */
+  auto FlushDirtyFrames() -> size_t;
+
+  [[nodiscard]] auto GetWriteStats() const -> PageWriteStats;
+
+  /**
+   * Collect the counters of the pool, the per-frame numbers are read under the latch of each partition
+   */
+  auto GetStats() -> BufferPoolStats;
+
+  [[nodiscard]] auto GetPoolSize() const -> size_t;
+
+  [[nodiscard]] auto GetPartitionNum() const -> size_t;
+
+private:
+  /// partitioned mode, public APIs are forwarded to the partition that owns the page
+
+  [[nodiscard]] inline auto IsPartitioned() const -> bool { return !partitions_.empty(); }
+
+  /**
+   * Get the partition that owns the page, the fid and pid are mixed before taking the modulo so that consecutive pages
+   * of a file are spread over all partitions
+   */
+  auto GetPartition(file_id_t fid, page_id_t pid) -> BufferPoolManager *;
+
+  /**
+   * Prefetch the given pages of the file into this (not partitioned) pool, see PrefetchRange
+   * @return number of leading pages in pids that are in the pool afterwards
+   */
+  auto PrefetchPages(file_id_t fid, const std::vector<page_id_t> &pids) -> size_t;
+
+  /// background flusher
+
+  struct DirtyFrame
+  {
+    BufferPoolManager *owner_;  // the pool or partition the frame belongs to
+    frame_id_t         frame_id_;
+    file_id_t          fid_;
+    page_id_t          pid_;
+  };
+
+  /**
+   * Pin the dirty unpinned frames of this (not partitioned) pool and clear their dirty flags
+   * @param frames
+   * @param fid collect only the frames of the file, INVALID_FILE_ID for all files
+   */
+  void CollectDirtyFrames(std::vector<DirtyFrame> &frames, file_id_t fid = INVALID_FILE_ID);
+
+  /**
+   * Collect the dirty unpinned frames of the whole pool (all partitions), see CollectDirtyFrames
+   */
+  auto CollectAllDirtyFrames(file_id_t fid = INVALID_FILE_ID) -> std::vector<DirtyFrame>;
+
+  /**
+   * Write the collected frames in page order, runs of adjacent pages of a file with one vectored write each, frames
+   * whose writes fail are marked dirty again. The frames stay readable and writable meanwhile, so each page is copied
+   * to a staging buffer under its latch and the copy is written. The frames are unpinned afterwards.
+   * @return number of pages written
+   */
+  auto WriteBackFrames(std::vector<DirtyFrame> &frames) -> size_t;
+
+  /**
+   * Take a free frame, or a victim that is not dirty and erase its page from page_frame_lookup_, called with the latch
+   * held.
+   * Victims met on the way that are dirty or hold a page of the range being prefetched stay in the pool pinned, the
+   * dirty ones are appended to write_backs for WriteBackFrames, the others to held.
+   * @return INVALID_FRAME_ID if the replacer has no more victims
+   */
+  auto TakeCleanFrame(file_id_t fid, const std::unordered_set<page_id_t> &range, std::vector<DirtyFrame> &write_backs,
+      std::vector<frame_id_t> &held) -> frame_id_t;
+
+  /**
+   * Give back a frame taken by TakeCleanFrame whose page is not loaded, called with the latch held
+   */
+  void RecycleFrame(frame_id_t frame_id);
+
+  /**
+   * Read the pages into their frames without the latch, see PrefetchRange
+   */
+  void ReadFrames(file_id_t fid, const std::vector<std::pair<frame_id_t, page_id_t>> &loads);
+
+  [[nodiscard]] auto CountDirtyFrames() -> size_t;
+
+  void FlusherLoop(double dirty_ratio, size_t interval_ms, size_t checkpoint_interval_ms);
+
+  /**
+   * Add the counters of this (not partitioned) pool to stats, except the write stats
+   */
+  void CollectStats(BufferPoolStats &stats);
+
 private:
   /// sub procedures used by public APIs, should not be locked by latch
 
+  /**
+   * Pin the page if it is in the pool without granting the latch
+   * 1. look up the frame in page_frame_lookup_, the lookup is lock free, the pages added by FetchPage are published
+   *    first if the latch is free, see PageTable
+   * 2. pin the frame with Frame::TryPin, which fails if the frame holds no page or is being replaced
+   * 3. the frame may have been reused between 1 and 2, unpin it and give up if it holds another page
+   * 4. pin the frame in the replacer if it was not pinned before, replacers have their own latches
+   * Frames that are pinned already are not pinned in the replacer again, so concurrent accesses to a pinned page are
+   * not recorded in the access history.
+   * @param[out] prefetched if given, set to whether the page was prefetched and not pinned since, see
+   * Frame::TakePrefetched
+   * @return the page, nullptr if the page must be fetched under the latch
+   */
+  auto FetchResidentPage(file_id_t fid, page_id_t pid, bool *prefetched = nullptr) -> Page *;
+
+  /**
+   * Load the extent of the page on a miss, see SetFetchExtent
+   */
+  void FetchExtent(file_id_t fid, page_id_t pid);
+
   /**
    * Get the available frame
    * 1. if the free list is not empty, get the frame id from the free list
-   * 2. else use the replacer to get the frame id
+   * 2. else use the replacer to get the frame id, the frame returned by the replacer can no longer be pinned by
+   *    FetchResidentPage
    * 3. if no frame can be evicted, throw NJUDB_NO_FREE_FRAME
    * @return the frame id
    */
@@ -177,13 +392,34 @@ private:
   void UpdateFrame(frame_id_t frame_id, file_id_t fid, page_id_t pid);
 
 private:
-  std::mutex                                latch_;
-  DiskManager                              *disk_manager_;
-  LogManager                               *log_manager_;
-  std::unique_ptr<Replacer>                 replacer_;
-  std::array<Frame, BUFFER_POOL_SIZE>       frames_;
-  std::list<frame_id_t>                     free_list_;
-  std::unordered_map<fid_pid_t, frame_id_t> page_frame_lookup_;
+  std::mutex                                      latch_;
+  DiskManager                                    *disk_manager_;
+  LogManager                                     *log_manager_;
+  std::unique_ptr<Replacer>                       replacer_;
+  size_t                                          pool_size_;
+  std::unique_ptr<PoolMemory>                     pool_memory_;  // page buffers of frames_
+  std::unique_ptr<Frame[]>                        frames_;
+  std::list<frame_id_t>                           free_list_;
+  PageTable                                       page_frame_lookup_;  // page -> frame, readable without the latch
+  size_t                                          fetch_extent_{1};    // pages loaded by a miss, set on the whole pool
+  // not empty only in partitioned mode, in which case the fields above are left unused
+  std::vector<std::unique_ptr<BufferPoolManager>> partitions_;
+  // serializes the write-back rounds with FlushAllPages and DeleteAllPages, so files are not closed under the flusher
+  std::mutex                                      flush_round_latch_;
+  std::thread                                     flusher_;
+  std::mutex                                      flusher_latch_;
+  std::condition_variable                         flusher_cv_;
+  bool                                            flusher_stop_{false};
+  size_t                                          disk_writes_base_{0};  // page writes of the disk manager at creation
+  std::atomic<size_t>                             background_writes_{0};
+  // statistics, hits and misses through the latch are counted by the frames
+  std::atomic<size_t>                             latch_free_hits_{0};
+  std::atomic<size_t>                             pin_waits_{0};
+  std::atomic<size_t>                             prefetches_{0};
+  std::atomic<size_t>                             evictions_{0};
+  // pages of the files served by MapFile, the data of the pages points into the mappings of the disk manager
+  std::shared_mutex                               mapped_latch_;
+  std::map<file_id_t, std::vector<Page>>          mapped_pages_;
 };
 
 }  // namespace njudb
@@ -22,12 +22,22 @@
 #ifndef NJUDB_FRAME_H
 #define NJUDB_FRAME_H
 
+#include <algorithm>
+#include <atomic>
 #include "common/types.h"
 #include "common/config.h"
 #include "common/page.h"
+
+/**
+ * Frame holds a page of the buffer pool. The pin count is atomic so that resident pages can be pinned without the
+ * latch of the buffer pool (see BufferPoolManager::FetchResidentPage). A frame that holds no page, or whose page is
+ * being replaced, has a pin count of NO_PAGE and refuses such optimistic pins.
+ */
 class Frame
 {
 public:
+  static constexpr int NO_PAGE = -1;
+
   Frame()  = default;
   ~Frame() = default;
 
@@ -35,33 +45,104 @@ public:
 
   [[nodiscard]] inline auto GetPage() -> Page * { return &page_; }
 
-  [[nodiscard]] inline auto InUse() const -> bool { return pin_count_ > 0; }
+  [[nodiscard]] inline auto InUse() const -> bool { return pin_count_.load() > 0; }
 
-  [[nodiscard]] inline auto IsDirty() const -> bool { return is_dirty_; }
+  [[nodiscard]] inline auto IsDirty() const -> bool { return is_dirty_.load(); }
 
-  inline void SetDirty(bool dirty) { is_dirty_ = dirty; }
+  inline void SetDirty(bool dirty) { is_dirty_.store(dirty); }
 
-  [[nodiscard]] inline auto GetPinCount() const -> int { return pin_count_; }
+  [[nodiscard]] inline auto GetPinCount() const -> int { return std::max(pin_count_.load(), 0); }
 
-  inline void Pin() { pin_count_++; }
+  /**
+   * Pin the frame, called with the latch of the buffer pool held, also makes a frame that holds no page pinnable
+   */
+  inline void Pin()
+  {
+    int count = pin_count_.load();
+    while (!pin_count_.compare_exchange_weak(count, count == NO_PAGE ? 1 : count + 1)) {}
+    (count == NO_PAGE ? loads_ : pin_hits_).fetch_add(1, std::memory_order_relaxed);
+  }
 
-  inline void Unpin()
+  /**
+   * Unpin the frame
+   * @return the pin count after unpinning
+   */
+  inline auto Unpin() -> int
   {
-    NJUDB_ASSERT(pin_count_ > 0, "Unpin a frame with pin_count = 0");
-    pin_count_--;
+    int count = pin_count_.fetch_sub(1);
+    NJUDB_ASSERT(count > 0, "Unpin a frame with pin_count = 0");
+    return count - 1;
   }
 
+  /**
+   * Pin the frame without the latch of the buffer pool, fails if the frame holds no page or is being replaced
+   * @return the pin count before pinning, or NO_PAGE if the frame is not pinned
+   */
+  inline auto TryPin() -> int
+  {
+    int count = pin_count_.load();
+    while (count != NO_PAGE) {
+      if (pin_count_.compare_exchange_weak(count, count + 1)) {
+        return count;
+      }
+    }
+    return NO_PAGE;
+  }
+
+  /**
+   * Take an unpinned frame for replacement, fails if the frame has been pinned by TryPin in the meantime
+   * @return true if no one can pin the frame until it is pinned again by the buffer pool
+   */
+  inline auto TryEvict() -> bool
+  {
+    int count = 0;
+    return pin_count_.compare_exchange_strong(count, NO_PAGE) || count == NO_PAGE;
+  }
+
+  /**
+   * Make a loaded frame pinnable without pinning it, used by prefetching
+   */
+  inline void SetLoaded()
+  {
+    int count = NO_PAGE;
+    pin_count_.compare_exchange_strong(count, 0);
+  }
+
+  /**
+   * Mark the page as loaded ahead of time by a prefetch, until TakePrefetched is called by its first pin
+   */
+  inline void SetPrefetched() { prefetched_.store(true); }
+
+  /**
+   * @return true if the page was prefetched and this is the first call since
+   */
+  inline auto TakePrefetched() -> bool { return prefetched_.exchange(false); }
+
+  /**
+   * @return number of Pin calls that found the page in the frame
+   */
+  [[nodiscard]] inline auto GetPinHits() const -> size_t { return pin_hits_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return number of Pin calls right after a page was loaded into the frame
+   */
+  [[nodiscard]] inline auto GetLoads() const -> size_t { return loads_.load(std::memory_order_relaxed); }
+
   inline void Reset()
   {
     page_.Clear();
-    is_dirty_  = false;
-    pin_count_ = 0;
+    is_dirty_.store(false);
+    pin_count_.store(NO_PAGE);
+    prefetched_.store(false);
   }
 
 private:
-  Page page_{};
-  bool is_dirty_{false};
-  int  pin_count_{0};
+  Page                page_{};
+  std::atomic<bool>   is_dirty_{false};  // also set by unpins of pages pinned without the latch
+  std::atomic<int>    pin_count_{NO_PAGE};
+  std::atomic<bool>   prefetched_{false};
+  std::atomic<size_t> pin_hits_{0};  // statistics, see BufferPoolManager::GetStats
+  std::atomic<size_t> loads_{0};
 };
 
 #endif  // NJUDB_FRAME_H
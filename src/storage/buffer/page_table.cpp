@@ -0,0 +1,220 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "page_table.h"
+#include "../../../common/error.h"
+
+namespace njudb {
+
+PageTable::PageTable(size_t frame_num) : capacity_(16)
+{
+  while (capacity_ < frame_num * 2) {
+    capacity_ <<= 1;
+  }
+  mask_  = capacity_ - 1;
+  slots_ = std::make_unique<Slot[]>(capacity_);
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].key_.store(EMPTY_KEY, std::memory_order_relaxed);
+    slots_[i].frame_id_.store(INVALID_FRAME_ID, std::memory_order_relaxed);
+    slots_[i].published_.store(false, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Find(file_id_t fid, page_id_t pid) const -> frame_id_t
+{
+  auto key = MakePageKey(fid, pid);
+  auto pos = Home(key);
+  for (size_t probe = 0; probe < capacity_; probe++, pos = (pos + 1) & mask_) {
+    auto slot_key = slots_[pos].key_.load(std::memory_order_acquire);
+    if (slot_key == EMPTY_KEY) {
+      return INVALID_FRAME_ID;
+    }
+    if (slot_key == key) {
+      auto frame_id = slots_[pos].frame_id_.load(std::memory_order_acquire);
+      // the slot may be rewritten between the two loads, the caller validates the frame anyway
+      return slots_[pos].key_.load(std::memory_order_acquire) == key ? frame_id : INVALID_FRAME_ID;
+    }
+  }
+  return INVALID_FRAME_ID;
+}
+
+auto PageTable::FindPublished(file_id_t fid, page_id_t pid) const -> frame_id_t
+{
+  auto key = MakePageKey(fid, pid);
+  auto pos = Home(key);
+  for (size_t probe = 0; probe < capacity_; probe++, pos = (pos + 1) & mask_) {
+    auto slot_key = slots_[pos].key_.load(std::memory_order_acquire);
+    if (slot_key == EMPTY_KEY) {
+      return INVALID_FRAME_ID;
+    }
+    if (slot_key == key) {
+      // the flag is cleared before the frame of the entry changes and set afterwards, see InsertSlot
+      auto frame_id  = slots_[pos].frame_id_.load(std::memory_order_acquire);
+      bool published = slots_[pos].published_.load(std::memory_order_acquire);
+      return published && slots_[pos].key_.load(std::memory_order_acquire) == key ? frame_id : INVALID_FRAME_ID;
+    }
+  }
+  return INVALID_FRAME_ID;
+}
+
+void PageTable::Insert(file_id_t fid, page_id_t pid, frame_id_t frame_id)
+{
+  InsertSlot(MakePageKey(fid, pid), frame_id, true);
+}
+
+void PageTable::InsertPending(file_id_t fid, page_id_t pid, frame_id_t frame_id)
+{
+  auto key = MakePageKey(fid, pid);
+  InsertSlot(key, frame_id, false);
+  pending_.push_back(key);
+  pending_num_.store(pending_.size(), std::memory_order_release);
+}
+
+auto PageTable::InsertSlot(page_key_t key, frame_id_t frame_id, bool published) -> std::pair<size_t, bool>
+{
+  auto pos = Home(key);
+  for (;; pos = (pos + 1) & mask_) {
+    auto slot_key = slots_[pos].key_.load(std::memory_order_relaxed);
+    if (slot_key == key) {
+      // hide the entry before the frame changes
+      slots_[pos].published_.store(false, std::memory_order_release);
+      slots_[pos].frame_id_.store(frame_id, std::memory_order_release);
+      slots_[pos].published_.store(published, std::memory_order_release);
+      return {pos, false};
+    }
+    if (slot_key == EMPTY_KEY) {
+      NJUDB_ASSERT(size_ < capacity_ / 2, "page table is full");
+      // publish the frame before the key, a reader that sees the key sees the frame
+      slots_[pos].frame_id_.store(frame_id, std::memory_order_release);
+      slots_[pos].published_.store(published, std::memory_order_release);
+      slots_[pos].key_.store(key, std::memory_order_release);
+      size_++;
+      return {pos, true};
+    }
+  }
+}
+
+void PageTable::PublishPending()
+{
+  for (auto key : pending_) {
+    if (auto pos = FindSlot(key); pos != capacity_) {
+      slots_[pos].published_.store(true, std::memory_order_release);
+    }
+  }
+  pending_.clear();
+  pending_num_.store(0, std::memory_order_release);
+}
+
+auto PageTable::FindSlot(page_key_t key) const -> size_t
+{
+  auto pos = Home(key);
+  for (size_t probe = 0; probe < capacity_; probe++, pos = (pos + 1) & mask_) {
+    auto slot_key = slots_[pos].key_.load(std::memory_order_relaxed);
+    if (slot_key == EMPTY_KEY) {
+      return capacity_;
+    }
+    if (slot_key == key) {
+      return pos;
+    }
+  }
+  return capacity_;
+}
+
+auto PageTable::find(const fid_pid_t &key) const -> Iterator
+{
+  return {*this, FindSlot(MakePageKey(key.fid, key.pid))};
+}
+
+auto PageTable::insert(const value_type &value) -> std::pair<Iterator, bool>
+{
+  auto pos = FindSlot(MakePageKey(value.first.fid, value.first.pid));
+  if (pos != capacity_) {
+    return {Iterator(*this, pos), false};
+  }
+  InsertPending(value.first.fid, value.first.pid, value.second);
+  return {find(value.first), true};
+}
+
+auto PageTable::emplace(const fid_pid_t &key, frame_id_t frame_id) -> std::pair<Iterator, bool>
+{
+  return insert({key, frame_id});
+}
+
+auto PageTable::erase(Iterator it) -> Iterator
+{
+  auto pos = it.pos_;
+  Erase(it->first.fid, it->first.pid);
+  return {*this, pos};
+}
+
+PageTable::Iterator::Iterator(const PageTable &table, size_t pos) : table_(&table), pos_(pos) { Settle(); }
+
+auto PageTable::Iterator::operator++() -> Iterator &
+{
+  pos_++;
+  Settle();
+  return *this;
+}
+
+void PageTable::Iterator::Settle()
+{
+  for (; pos_ < table_->capacity_; pos_++) {
+    auto key = table_->slots_[pos_].key_.load(std::memory_order_relaxed);
+    if (key != EMPTY_KEY) {
+      value_ = {{static_cast<file_id_t>(key >> 32), static_cast<page_id_t>(key & 0xFFFFFFFFULL)},
+          table_->slots_[pos_].frame_id_.load(std::memory_order_relaxed)};
+      return;
+    }
+  }
+}
+
+auto PageTable::Erase(file_id_t fid, page_id_t pid) -> bool
+{
+  auto key  = MakePageKey(fid, pid);
+  auto hole = Home(key);
+  for (;; hole = (hole + 1) & mask_) {
+    auto slot_key = slots_[hole].key_.load(std::memory_order_relaxed);
+    if (slot_key == EMPTY_KEY) {
+      return false;
+    }
+    if (slot_key == key) {
+      break;
+    }
+  }
+  // backward shift deletion: move every following entry whose home is not in (hole, pos] into the hole
+  for (auto pos = (hole + 1) & mask_;; pos = (pos + 1) & mask_) {
+    auto slot_key = slots_[pos].key_.load(std::memory_order_relaxed);
+    if (slot_key == EMPTY_KEY) {
+      break;
+    }
+    auto home = Home(slot_key);
+    if (((pos - home) & mask_) >= ((pos - hole) & mask_)) {
+      // a reader that passed the hole before the copy misses the moved entry, Find tolerates false misses
+      slots_[hole].frame_id_.store(slots_[pos].frame_id_.load(std::memory_order_relaxed), std::memory_order_release);
+      slots_[hole].published_.store(slots_[pos].published_.load(std::memory_order_relaxed), std::memory_order_release);
+      slots_[hole].key_.store(slot_key, std::memory_order_release);
+      hole = pos;
+    }
+  }
+  slots_[hole].key_.store(EMPTY_KEY, std::memory_order_release);
+  slots_[hole].frame_id_.store(INVALID_FRAME_ID, std::memory_order_release);
+  slots_[hole].published_.store(false, std::memory_order_release);
+  size_--;
+  return true;
+}
+
+}  // namespace njudb
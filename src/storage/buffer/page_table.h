@@ -0,0 +1,226 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_PAGE_TABLE_H
+#define NJUDB_PAGE_TABLE_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "common/types.h"
+#include "replacer/replacer.h"
+
+namespace njudb {
+
+/**
+ * Mix the bits of a page key, consecutive pages of a file and the same page of different files land on unrelated
+ * slots, unlike xor-ing the file id and the page id
+ */
+inline auto HashPageKey(page_key_t key) -> size_t
+{
+  // finalizer of murmurhash3
+  key ^= key >> 33;
+  key *= 0xFF51AFD7ED558CCDULL;
+  key ^= key >> 33;
+  key *= 0xC4CEB9FE1A85EC53ULL;
+  key ^= key >> 33;
+  return static_cast<size_t>(key);
+}
+
+struct fid_pid_t
+{
+  file_id_t fid;
+  page_id_t pid;
+
+  bool operator==(const fid_pid_t &rhs) const { return fid == rhs.fid && pid == rhs.pid; }
+};
+}  // namespace njudb
+
+namespace std {
+template <>
+struct hash<njudb::fid_pid_t>
+{
+  size_t operator()(const njudb::fid_pid_t &fp) const
+  {
+    return njudb::HashPageKey(njudb::MakePageKey(fp.fid, fp.pid));
+  }
+};
+}  // namespace std
+
+namespace njudb {
+
+/**
+ * PageTable maps the pages in a buffer pool to their frames with open addressing and linear probing.
+ * Find is lock free and may run concurrently with any other operation, Insert and Erase must be serialized by the
+ * caller (the latch of the buffer pool). A concurrent Find may miss a page that is being moved by Erase, or return a
+ * frame that has just been reused for another page, so callers must treat a miss as "look again under the latch" and
+ * validate the frame after pinning it.
+ * The capacity is fixed to at least twice the number of frames, so probing always ends at an empty slot.
+ *
+ * For the code that holds the latch the table also offers the interface of std::unordered_map<fid_pid_t, frame_id_t>
+ * (find, operator[], insert, erase...). Entries added through it may point to frames whose pages are still being read,
+ * so they are pending: FindPublished, which readers without the latch use, does not return them until PublishPending is
+ * called once the latch is released.
+ */
+class PageTable
+{
+public:
+  using value_type = std::pair<fid_pid_t, frame_id_t>;
+
+  /**
+   * Iterates over the entries in slot order, the entry is a copy, assign frames through operator[]
+   */
+  class Iterator
+  {
+  public:
+    Iterator(const PageTable &table, size_t pos);
+
+    auto operator*() -> value_type & { return value_; }
+    auto operator->() -> value_type * { return &value_; }
+    auto operator++() -> Iterator &;
+    auto operator==(const Iterator &rhs) const -> bool { return pos_ == rhs.pos_; }
+    auto operator!=(const Iterator &rhs) const -> bool { return pos_ != rhs.pos_; }
+
+  private:
+    friend class PageTable;
+
+    // move to the first entry at or after pos_
+    void Settle();
+
+    const PageTable *table_;
+    size_t           pos_;
+    value_type       value_{};
+  };
+
+  /**
+   * The frame of a page, returned by operator[], assigning it adds a pending entry
+   */
+  class FrameRef
+  {
+  public:
+    FrameRef(PageTable *table, fid_pid_t key) : table_(table), key_(key) {}
+
+    auto operator=(frame_id_t frame_id) -> FrameRef &
+    {
+      table_->InsertPending(key_.fid, key_.pid, frame_id);
+      return *this;
+    }
+
+    // INVALID_FRAME_ID if the page is not in the table
+    operator frame_id_t() const { return table_->Find(key_.fid, key_.pid); }  // NOLINT
+
+  private:
+    PageTable *table_;
+    fid_pid_t  key_;
+  };
+
+  explicit PageTable(size_t frame_num);
+
+  ~PageTable() = default;
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(PageTable)
+
+  /**
+   * @return the frame holding the page, INVALID_FRAME_ID if the page is not in the table
+   */
+  [[nodiscard]] auto Find(file_id_t fid, page_id_t pid) const -> frame_id_t;
+
+  /**
+   * Find for readers without the latch, pending entries are not returned
+   * @return the frame holding the page, INVALID_FRAME_ID if the page is not in the table or its entry is pending
+   */
+  [[nodiscard]] auto FindPublished(file_id_t fid, page_id_t pid) const -> frame_id_t;
+
+  /**
+   * Map the page to the frame, overwrite the frame if the page is already in the table. The entry is published, the
+   * page must be loaded in the frame.
+   */
+  void Insert(file_id_t fid, page_id_t pid, frame_id_t frame_id);
+
+  /**
+   * Remove the page from the table, the following entries of the probe sequence are shifted back so that no tombstone
+   * is left behind
+   * @return true if the page was in the table
+   */
+  auto Erase(file_id_t fid, page_id_t pid) -> bool;
+
+  [[nodiscard]] auto Size() const -> size_t { return size_; }
+
+  /**
+   * @return true if some entries are pending, can be called without the latch
+   */
+  [[nodiscard]] auto HasPending() const -> bool { return pending_num_.load(std::memory_order_acquire) > 0; }
+
+  /**
+   * Publish the pending entries, called with the latch held by a thread that has just acquired it, i.e. after the code
+   * that added them has released the latch
+   */
+  void PublishPending();
+
+  /// std::unordered_map interface, called with the latch held
+
+  [[nodiscard]] auto begin() const -> Iterator { return {*this, 0}; }
+  [[nodiscard]] auto end() const -> Iterator { return {*this, capacity_}; }
+  [[nodiscard]] auto find(const fid_pid_t &key) const -> Iterator;
+  [[nodiscard]] auto count(const fid_pid_t &key) const -> size_t { return find(key) != end() ? 1 : 0; }
+  [[nodiscard]] auto size() const -> size_t { return size_; }
+  [[nodiscard]] auto empty() const -> bool { return size_ == 0; }
+  auto               operator[](const fid_pid_t &key) -> FrameRef { return {this, key}; }
+  auto               insert(const value_type &value) -> std::pair<Iterator, bool>;
+  auto               emplace(const fid_pid_t &key, frame_id_t frame_id) -> std::pair<Iterator, bool>;
+  auto               erase(const fid_pid_t &key) -> size_t { return Erase(key.fid, key.pid) ? 1 : 0; }
+
+  /**
+   * Erase the entry, the following entries may be shifted into its slot, so the returned iterator points to the same
+   * slot, i.e. the next entry in slot order
+   */
+  auto erase(Iterator it) -> Iterator;
+
+private:
+  struct Slot
+  {
+    std::atomic<page_key_t> key_;
+    std::atomic<frame_id_t> frame_id_;
+    std::atomic<bool>       published_;
+  };
+
+  // file and page ids are never both invalid in a valid page
+  static constexpr page_key_t EMPTY_KEY = ~0ULL;
+
+  [[nodiscard]] inline auto Home(page_key_t key) const -> size_t { return HashPageKey(key) & mask_; }
+
+  /**
+   * @return the slot holding the key, capacity_ if the key is not in the table
+   */
+  [[nodiscard]] auto FindSlot(page_key_t key) const -> size_t;
+
+  auto InsertSlot(page_key_t key, frame_id_t frame_id, bool published) -> std::pair<size_t, bool>;
+
+  void InsertPending(file_id_t fid, page_id_t pid, frame_id_t frame_id);
+
+  size_t                  capacity_;
+  size_t                  mask_;
+  size_t                  size_{0};
+  std::unique_ptr<Slot[]> slots_;
+  std::vector<page_key_t> pending_;  // keys of the pending entries, some may have been erased since
+  std::atomic<size_t>     pending_num_{0};
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_PAGE_TABLE_H
@@ -0,0 +1,78 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "pool_memory.h"
+
+#include <sys/mman.h>
+
+#include "../../../common/error.h"
+
+namespace njudb {
+
+// size of a huge page on x86-64 and aarch64 with 4 KiB base pages
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+PoolMemory::PoolMemory(size_t frame_num, bool use_huge_page) : frame_num_(frame_num)
+{
+  mem_size_ = frame_num * PAGE_SIZE;
+  if (mem_size_ == 0) {
+    return;
+  }
+  void *mem = MAP_FAILED;
+  if (use_huge_page) {
+    // huge page mappings must be a multiple of the huge page size
+    mem_size_ = (mem_size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    mem = mmap(nullptr, mem_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    is_huge_page_ = mem != MAP_FAILED;
+#endif
+  }
+  if (mem == MAP_FAILED) {
+    // anonymous mappings are page aligned and zero filled
+    mem = mmap(nullptr, mem_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+      NJUDB_FATAL(fmt::format("failed to allocate {} bytes for the buffer pool", mem_size_));
+    }
+#ifdef MADV_HUGEPAGE
+    if (use_huge_page) {
+      // no explicit huge pages reserved by the os, ask for transparent huge pages instead
+      is_huge_page_ = madvise(mem, mem_size_, MADV_HUGEPAGE) == 0;
+    }
+#endif
+  }
+  if (use_huge_page && !is_huge_page_) {
+    NJUDB_LOG("huge pages are not available, the buffer pool falls back to normal pages");
+  }
+  mem_ = static_cast<char *>(mem);
+  // frames are read and written with direct io when files are opened in direct mode
+  NJUDB_ASSERT(reinterpret_cast<uintptr_t>(mem_) % DIRECT_IO_ALIGNMENT == 0, "frame memory is not aligned for direct io");
+}
+
+PoolMemory::~PoolMemory()
+{
+  if (mem_ != nullptr) {
+    munmap(mem_, mem_size_);
+  }
+}
+
+auto PoolMemory::GetFrameData(frame_id_t frame_id) const -> char *
+{
+  NJUDB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frame_num_, fmt::format("invalid frame id {}", frame_id));
+  return mem_ + static_cast<size_t>(frame_id) * PAGE_SIZE;
+}
+
+}  // namespace njudb
@@ -0,0 +1,64 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_POOL_MEMORY_H
+#define NJUDB_POOL_MEMORY_H
+
+#include "common/types.h"
+#include "common/config.h"
+#include "../../../common/micro.h"
+
+namespace njudb {
+
+/**
+ * PoolMemory is the backing memory of the frames in a buffer pool. All page buffers live in one anonymous mapping so
+ * that the pool can be sized at startup and every page buffer starts on an os page boundary. The mapping is optionally
+ * backed by huge pages, which cuts down TLB misses when the pool is large.
+ */
+class PoolMemory
+{
+public:
+  /**
+   * @param frame_num number of page buffers to allocate
+   * @param use_huge_page try to back the region with explicit huge pages first, then fall back to transparent huge
+   * pages, and finally to normal pages if neither is available
+   */
+  PoolMemory(size_t frame_num, bool use_huge_page = false);
+
+  ~PoolMemory();
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(PoolMemory)
+
+  /**
+   * @return the page buffer of the frame, its size is PAGE_SIZE and it is aligned to the os page size
+   */
+  [[nodiscard]] auto GetFrameData(frame_id_t frame_id) const -> char *;
+
+  [[nodiscard]] auto GetFrameNum() const -> size_t { return frame_num_; }
+
+  [[nodiscard]] auto IsHugePage() const -> bool { return is_huge_page_; }
+
+private:
+  char  *mem_{nullptr};
+  size_t mem_size_{0};
+  size_t frame_num_{0};
+  bool   is_huge_page_{false};
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_POOL_MEMORY_H
@@ -0,0 +1,199 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "arc_replacer.h"
+
+#include <algorithm>
+
+namespace njudb {
+
+ARCReplacer::ARCReplacer(size_t max_size, FramePageResolver resolver)
+    : max_size_(max_size), resolver_(std::move(resolver))
+{}
+
+auto ARCReplacer::Victim(frame_id_t *frame_id) -> bool
+{
+  std::scoped_lock lock(latch_);
+  if (cur_size_ == 0) {
+    return false;
+  }
+  bool prefer_t1 = !t1_.empty() && t1_.size() > p_;
+  if (!EvictFrom(!prefer_t1, frame_id)) {
+    EvictFrom(prefer_t1, frame_id);
+  }
+  TrimGhosts();
+  return true;
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id)
+{
+  std::scoped_lock lock(latch_);
+  auto key = PageOf(frame_id);
+  auto it  = frame_entries_.find(frame_id);
+  if (it != frame_entries_.end() && it->second.key_ != key) {
+    // the frame was reused, e.g. victimized or freed and taken from the free list, drop the old page
+    Forget(it);
+    it = frame_entries_.end();
+  }
+  if (it == frame_entries_.end()) {
+    Admit(frame_id, key);
+  } else if (it->second.evicted_) {
+    // the victim was pinned before the buffer pool could take it, it is not a new reference to the page
+    Reinsert(frame_id, it->second);
+  } else {
+    auto &entry = it->second;
+    if (entry.evictable_) {
+      entry.evictable_ = false;
+      cur_size_--;
+    }
+    if (last_pinned_ != frame_id) {
+      (entry.in_t2_ ? t2_ : t1_).erase(entry.pos_);
+      t2_.push_back(frame_id);
+      entry.in_t2_ = true;
+      entry.pos_   = std::prev(t2_.end());
+    }
+  }
+  last_pinned_ = frame_id;
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id)
+{
+  std::scoped_lock lock(latch_);
+  auto key = PageOf(frame_id);
+  auto it  = frame_entries_.find(frame_id);
+  if (it != frame_entries_.end() && it->second.key_ != key) {
+    Forget(it);
+    it = frame_entries_.end();
+  }
+  if (it == frame_entries_.end()) {
+    Admit(frame_id, key);
+    it = frame_entries_.find(frame_id);
+  } else if (it->second.evicted_) {
+    Reinsert(frame_id, it->second);
+  }
+  if (!it->second.evictable_) {
+    it->second.evictable_ = true;
+    cur_size_++;
+  }
+}
+
+auto ARCReplacer::Size() -> size_t
+{
+  std::scoped_lock lock(latch_);
+  return cur_size_;
+}
+
+auto ARCReplacer::GetTargetT1Size() -> size_t
+{
+  std::scoped_lock lock(latch_);
+  return p_;
+}
+
+auto ARCReplacer::PageOf(frame_id_t frame_id) const -> page_key_t
+{
+  return resolver_ ? resolver_(frame_id) : static_cast<page_key_t>(frame_id);
+}
+
+void ARCReplacer::Admit(frame_id_t frame_id, page_key_t key)
+{
+  bool in_t2 = false;
+  auto git   = ghost_entries_.find(key);
+  if (git != ghost_entries_.end()) {
+    // a ghost hit, the list the page was evicted from deserves more room
+    if (!git->second.in_b2_) {
+      p_ = std::min(max_size_, p_ + std::max<size_t>(1, b2_.size() / b1_.size()));
+      b1_.erase(git->second.pos_);
+    } else {
+      auto delta = std::max<size_t>(1, b1_.size() / b2_.size());
+      p_         = p_ > delta ? p_ - delta : 0;
+      b2_.erase(git->second.pos_);
+    }
+    ghost_entries_.erase(git);
+    in_t2 = true;
+  }
+  auto &list = in_t2 ? t2_ : t1_;
+  list.push_back(frame_id);
+  frame_entries_[frame_id] = {key, in_t2, false, false, std::prev(list.end())};
+  TrimGhosts();
+}
+
+auto ARCReplacer::EvictFrom(bool from_t2, frame_id_t *frame_id) -> bool
+{
+  auto &list = from_t2 ? t2_ : t1_;
+  auto  it   = std::find_if(list.begin(), list.end(), [this](frame_id_t fid) {
+    return frame_entries_[fid].evictable_;
+  });
+  if (it == list.end()) {
+    return false;
+  }
+  *frame_id   = *it;
+  auto &entry = frame_entries_[*it];
+  auto &ghost = from_t2 ? b2_ : b1_;
+  // a stale frame of a deleted page may share the key with a resident frame, keep a single ghost per page
+  if (auto git = ghost_entries_.find(entry.key_); git != ghost_entries_.end()) {
+    (git->second.in_b2_ ? b2_ : b1_).erase(git->second.pos_);
+  }
+  ghost.push_back(entry.key_);
+  ghost_entries_[entry.key_] = {from_t2, std::prev(ghost.end())};
+  // the entry is kept until the frame holds another page, the buffer pool may give up the victim before
+  entry.evicted_   = true;
+  entry.evictable_ = false;
+  list.erase(it);
+  cur_size_--;
+  if (last_pinned_ == *frame_id) {
+    last_pinned_ = INVALID_FRAME_ID;
+  }
+  return true;
+}
+
+void ARCReplacer::Reinsert(frame_id_t frame_id, FrameEntry &entry)
+{
+  if (auto git = ghost_entries_.find(entry.key_); git != ghost_entries_.end()) {
+    (git->second.in_b2_ ? b2_ : b1_).erase(git->second.pos_);
+    ghost_entries_.erase(git);
+  }
+  auto &list     = entry.in_t2_ ? t2_ : t1_;
+  entry.evicted_ = false;
+  list.push_back(frame_id);
+  entry.pos_ = std::prev(list.end());
+}
+
+void ARCReplacer::Forget(std::unordered_map<frame_id_t, FrameEntry>::iterator it)
+{
+  auto &entry = it->second;
+  if (!entry.evicted_) {
+    (entry.in_t2_ ? t2_ : t1_).erase(entry.pos_);
+    if (entry.evictable_) {
+      cur_size_--;
+    }
+  }
+  frame_entries_.erase(it);
+}
+
+void ARCReplacer::TrimGhosts()
+{
+  while (!b1_.empty() && t1_.size() + b1_.size() > max_size_) {
+    ghost_entries_.erase(b1_.front());
+    b1_.pop_front();
+  }
+  while (!b2_.empty() && t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * max_size_) {
+    ghost_entries_.erase(b2_.front());
+    b2_.pop_front();
+  }
+}
+
+}  // namespace njudb
@@ -0,0 +1,130 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_ARC_REPLACER_H
+#define NJUDB_ARC_REPLACER_H
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "replacer.h"
+
+namespace njudb {
+
+/**
+ * ARCReplacer implements Adaptive Replacement Cache (Megiddo & Modha, FAST'03).
+ * Resident frames are kept in two LRU lists, T1 holds pages referenced once, T2 holds pages referenced at least twice.
+ * Evicted pages leave ghost entries in B1 (from T1) and B2 (from T2). A miss that hits B1 means T1 was too small, a miss
+ * that hits B2 means T2 was too small, the target size p of T1 is adapted accordingly. A single large scan only goes
+ * through T1, so the frequently used pages in T2 survive it.
+ */
+class ARCReplacer : public Replacer
+{
+public:
+  /**
+   * @param max_size maximum number of frames, i.e. the size of the buffer pool
+   * @param resolver resolves the page held by a frame, if not given, frame ids are used as page keys and ghost hits
+   * can not be detected across frame reuse
+   */
+  explicit ARCReplacer(size_t max_size = BUFFER_POOL_SIZE, FramePageResolver resolver = nullptr);
+
+  ~ARCReplacer() override = default;
+
+  /**
+   * Evict the least recently used evictable frame from T1 if T1 is larger than its target size p, otherwise from T2,
+   * fall back to the other list if the chosen one has no evictable frame. The page of the victim is remembered in the
+   * ghost list B1 or B2. A victim that is pinned or unpinned again for its own page, e.g. by a latch-free hit before the
+   * buffer pool could take it, goes back to its list and its ghost is dropped.
+   */
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * Access the page in the frame and make the frame non-evictable.
+   * A new page enters T1, or T2 if it hits a ghost list, in which case p is adapted.
+   * A resident page moves to the MRU end of T2, repeated pins of the same frame without any other pin in between count
+   * as one reference.
+   */
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  /** @return target size of T1, used for test */
+  auto GetTargetT1Size() -> size_t;
+
+private:
+  struct FrameEntry
+  {
+    page_key_t                      key_;
+    bool                            in_t2_;
+    bool                            evictable_;
+    bool                            evicted_;  // handed out by Victim and not in T1 or T2, pos_ is invalid
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  struct GhostEntry
+  {
+    bool                            in_b2_;
+    std::list<page_key_t>::iterator pos_;
+  };
+
+  auto PageOf(frame_id_t frame_id) const -> page_key_t;
+
+  /**
+   * Admit a page that is not resident into the frame, adapting p on a ghost hit
+   */
+  void Admit(frame_id_t frame_id, page_key_t key);
+
+  /**
+   * Evict the least recently used evictable frame in the list
+   */
+  auto EvictFrom(bool from_t2, frame_id_t *frame_id) -> bool;
+
+  /**
+   * Put a victim that was pinned again before the buffer pool took it back to the MRU end of its list, dropping its
+   * ghost
+   */
+  void Reinsert(frame_id_t frame_id, FrameEntry &entry);
+
+  /**
+   * Drop the entry of a frame that holds another page now
+   */
+  void Forget(std::unordered_map<frame_id_t, FrameEntry>::iterator it);
+
+  /**
+   * Keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c
+   */
+  void TrimGhosts();
+
+  std::mutex                                 latch_;
+  std::list<frame_id_t>                      t1_;  // front is the LRU end
+  std::list<frame_id_t>                      t2_;
+  std::list<page_key_t>                      b1_;
+  std::list<page_key_t>                      b2_;
+  std::unordered_map<frame_id_t, FrameEntry> frame_entries_;
+  std::unordered_map<page_key_t, GhostEntry> ghost_entries_;
+  size_t                                     p_{0};         // target size of T1
+  size_t                                     cur_size_{0};  // number of evictable frames
+  size_t                                     max_size_;
+  frame_id_t                                 last_pinned_{INVALID_FRAME_ID};
+  FramePageResolver                          resolver_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_ARC_REPLACER_H
@@ -25,7 +25,15 @@
 
 namespace njudb {
 
-LRUKReplacer::LRUKReplacer(size_t k) : max_size_(BUFFER_POOL_SIZE), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t k, size_t max_size) : max_size_(max_size), k_(k)
+{
+  // the history ring of a frame keeps k timestamps
+  NJUDB_ASSERT(k_ >= 1, fmt::format("invalid k {} for LRUKReplacer", k_));
+  node_store_.reserve(max_size_);
+  for (size_t i = 0; i < max_size_; i++) {
+    node_store_.emplace_back(static_cast<frame_id_t>(i), k_);
+  }
+}
 
 auto LRUKReplacer::Victim(frame_id_t *frame_id) -> bool { NJUDB_STUDENT_TODO(l1, f1); }
 
@@ -21,36 +21,113 @@
 
 #ifndef NJUDB_LRU_K_REPLACER_H
 #define NJUDB_LRU_K_REPLACER_H
-#include <list>
 #include <mutex>
-#include <unordered_map>
+#include <set>
+#include <vector>
 #include "replacer.h"
 #include "../common/error.h"
 
 namespace njudb {
 
+/**
+ * LRUKReplacer evicts the frame whose backward k-distance is the largest, frames with less than k accesses have an
+ * infinite distance and are evicted first, ties among them are broken by their earliest access.
+ * All operations are O(log n) in the number of frames:
+ * - each frame keeps its last k access timestamps in a fixed-size ring buffer, so the oldest kept timestamp is the
+ *   earliest access of a frame with less than k accesses, or the k-th most recent access of a frame with k accesses
+ * - evictable frames are indexed by that timestamp in two ordered sets, one for frames with less than k accesses and
+ *   one for frames with k accesses, the victim is the first element of the first non-empty set
+ */
 class LRUKReplacer : public Replacer
 {
 public:
-  explicit LRUKReplacer(size_t k);
+  /**
+   * @param k number of accesses remembered per frame, at least 1
+   * @param max_size maximum number of frames, i.e. the size of the buffer pool
+   */
+  explicit LRUKReplacer(size_t k, size_t max_size = BUFFER_POOL_SIZE);
 
   ~LRUKReplacer() override = default;
 
+  /**
+   * Victimize the frame with the largest backward k-distance
+   * 1. grant the latch
+   * 2. take the first frame of less_k_set_, or of k_set_ if less_k_set_ is empty, return false if both are empty
+   * 3. remove the frame from the set, clear its history and make it non-evictable
+   * @param frame_id
+   * @return true if a victim frame was found, false otherwise
+   */
   auto Victim(frame_id_t *frame_id) -> bool override;
 
+  /**
+   * Record an access to the frame and make it non-evictable
+   * 1. grant the latch
+   * 2. if the frame is evictable, remove it from the set it is in, using the key before the access is recorded
+   * 3. add cur_ts_ to the history of the frame and advance cur_ts_
+   * @param frame_id
+   */
   void Pin(frame_id_t frame_id) override;
 
+  /**
+   * Make the frame evictable
+   * 1. grant the latch
+   * 2. if the frame is already evictable return
+   * 3. insert the frame into less_k_set_ or k_set_ according to the size of its history
+   * @param frame_id
+   */
   void Unpin(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
 private:
+  /**
+   * Fixed-size ring buffer keeping the last k timestamps of a frame
+   */
+  class HistoryRing
+  {
+  public:
+    HistoryRing() = default;
+
+    explicit HistoryRing(size_t k) : buf_(k) {}
+
+    void Push(timestamp_t ts)
+    {
+      buf_[head_] = ts;
+      head_       = (head_ + 1) % buf_.size();
+      if (size_ < buf_.size()) {
+        size_++;
+      }
+    }
+
+    /** @return the oldest timestamp kept, the ring must not be empty */
+    [[nodiscard]] auto Oldest() const -> timestamp_t
+    {
+      // head_ points to the slot to be overwritten next, which is the oldest one once the ring is full
+      return size_ < buf_.size() ? buf_[0] : buf_[head_];
+    }
+
+    [[nodiscard]] auto Size() const -> size_t { return size_; }
+
+    [[nodiscard]] auto Full() const -> bool { return size_ == buf_.size(); }
+
+    void Clear()
+    {
+      head_ = 0;
+      size_ = 0;
+    }
+
+  private:
+    std::vector<timestamp_t> buf_;
+    size_t                   head_{0};
+    size_t                   size_{0};
+  };
+
   class LRUKNode
   {
   public:
     LRUKNode() = default;
 
-    explicit LRUKNode(frame_id_t fid, size_t k) : fid_(fid), k(k), is_evictable_(false) {}
+    explicit LRUKNode(frame_id_t fid, size_t k) : history_(k), fid_(fid), k(k), is_evictable_(false) {}
 
     void AddHistory(timestamp_t ts) { NJUDB_STUDENT_TODO(l1, f1); }
 
@@ -65,24 +142,37 @@ private:
       NJUDB_STUDENT_TODO(l1, f1);
     }
 
+    /**
+     * Key of the node in less_k_set_ or k_set_, i.e. the oldest timestamp in the history
+     */
+    [[nodiscard]] auto GetSetKey() const -> std::pair<timestamp_t, frame_id_t> { return {history_.Oldest(), fid_}; }
+
+    [[nodiscard]] auto HasKHistory() const -> bool { return history_.Full(); }
+
+    void ClearHistory() { history_.Clear(); }
+
     [[nodiscard]] auto IsEvictable() const -> bool { NJUDB_STUDENT_TODO(l1, f1); }
 
     auto SetEvictable(bool set_evictable) -> void { NJUDB_STUDENT_TODO(l1, f1); }
 
   private:
-    std::list<timestamp_t> history_;
-    frame_id_t             fid_{INVALID_FRAME_ID};
-    size_t                 k{};
-    bool                   is_evictable_{};
+    HistoryRing history_;
+    frame_id_t  fid_{INVALID_FRAME_ID};
+    size_t      k{};
+    bool        is_evictable_{};
   };
 
 private:
-  std::unordered_map<frame_id_t, LRUKNode> node_store_;  // frame_id -> LRUKNode
-  size_t                                   cur_ts_{0};
-  size_t                                   cur_size_{0};  // number of evictable frames
-  size_t                                   max_size_;     // maximum number of frames that can be stored
-  size_t                                   k_;            // k for LRU-k
-  std::mutex                               latch_;        // mutex for curr_size_, node_store_, and curr_timestamp_
+  std::vector<LRUKNode> node_store_;  // frame_id -> LRUKNode, a node with empty history is not tracked
+  // evictable frames with less than k accesses ordered by their earliest access
+  std::set<std::pair<timestamp_t, frame_id_t>> less_k_set_;
+  // evictable frames with k accesses ordered by their k-th most recent access, the first has the largest distance
+  std::set<std::pair<timestamp_t, frame_id_t>> k_set_;
+  size_t                                       cur_ts_{0};
+  size_t                                       cur_size_{0};  // number of evictable frames
+  size_t                                       max_size_;     // maximum number of frames that can be stored
+  size_t                                       k_;            // k for LRU-k
+  std::mutex                                   latch_;        // mutex for the fields above
 };
 }  // namespace njudb
 
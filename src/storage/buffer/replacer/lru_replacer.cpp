@@ -24,7 +24,7 @@
 #include "../common/error.h"
 namespace njudb {
 
-LRUReplacer::LRUReplacer() : cur_size_(0), max_size_(BUFFER_POOL_SIZE) {}
+LRUReplacer::LRUReplacer(size_t max_size) : cur_size_(0), max_size_(max_size) {}
 
 auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { NJUDB_STUDENT_TODO(l1, t1); }
 
@@ -34,8 +34,9 @@ class LRUReplacer : public Replacer
 public:
   /**
    * Create a new LRUReplacer.
+   * @param max_size maximum number of frames that can be stored, i.e. the size of the buffer pool
    */
-  explicit LRUReplacer();
+  explicit LRUReplacer(size_t max_size = BUFFER_POOL_SIZE);
 
   /**
    * Destroys the LRUReplacer.
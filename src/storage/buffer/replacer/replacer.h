@@ -22,10 +22,26 @@
 #ifndef NJU_DBCOURSE_REPLACER_H
 #define NJU_DBCOURSE_REPLACER_H
 
+#include <functional>
 #include "common/types.h"
+#include "common/config.h"
 
 namespace njudb {
 
+/// identifies a page of a file, used by replacers that remember pages after their frames are reused
+typedef uint64_t page_key_t;
+
+inline auto MakePageKey(file_id_t fid, page_id_t pid) -> page_key_t
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(fid)) << 32) | static_cast<uint32_t>(pid);
+}
+
+/**
+ * Tells a replacer which page a frame holds. The buffer pool updates a frame before pinning it in the replacer, so
+ * the page returned inside Pin is the page being accessed.
+ */
+using FramePageResolver = std::function<page_key_t(frame_id_t)>;
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -56,6 +72,13 @@ public:
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Hint that the page in the (pinned) frame is read once, e.g. by a sequential scan, so its frame should be reused
+   * before other frames once it is unpinned. Replacers without scan handling ignore it.
+   * @param frame_id
+   */
+  virtual void SetUseOnce(frame_id_t frame_id) {}
 };
 
 }  // namespace njudb
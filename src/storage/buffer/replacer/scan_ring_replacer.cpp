@@ -0,0 +1,86 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "scan_ring_replacer.h"
+
+namespace njudb {
+
+ScanRingReplacer::ScanRingReplacer(std::unique_ptr<Replacer> replacer, FramePageResolver resolver)
+    : replacer_(std::move(replacer)), resolver_(std::move(resolver))
+{}
+
+auto ScanRingReplacer::Victim(frame_id_t *frame_id) -> bool
+{
+  std::scoped_lock lock(latch_);
+  if (!ring_.empty()) {
+    // the frame stays pinned in the wrapped replacer, the buffer pool pins it again for the new page
+    *frame_id = ring_.front();
+    ring_.pop_front();
+    once_entries_.erase(*frame_id);
+    return true;
+  }
+  if (!replacer_->Victim(frame_id)) {
+    return false;
+  }
+  once_entries_.erase(*frame_id);
+  return true;
+}
+
+void ScanRingReplacer::Pin(frame_id_t frame_id)
+{
+  std::scoped_lock lock(latch_);
+  if (auto it = once_entries_.find(frame_id); it != once_entries_.end()) {
+    if (it->second.in_ring_) {
+      ring_.erase(it->second.pos_);
+      it->second.in_ring_ = false;
+    }
+    if (it->second.key_ != resolver_(frame_id)) {
+      once_entries_.erase(it);
+    }
+  }
+  replacer_->Pin(frame_id);
+}
+
+void ScanRingReplacer::Unpin(frame_id_t frame_id)
+{
+  std::scoped_lock lock(latch_);
+  auto it = once_entries_.find(frame_id);
+  if (it == once_entries_.end()) {
+    replacer_->Unpin(frame_id);
+    return;
+  }
+  if (!it->second.in_ring_) {
+    ring_.push_back(frame_id);
+    it->second.in_ring_ = true;
+    it->second.pos_     = std::prev(ring_.end());
+  }
+}
+
+auto ScanRingReplacer::Size() -> size_t
+{
+  std::scoped_lock lock(latch_);
+  return ring_.size() + replacer_->Size();
+}
+
+void ScanRingReplacer::SetUseOnce(frame_id_t frame_id)
+{
+  std::scoped_lock lock(latch_);
+  auto &entry = once_entries_[frame_id];
+  entry.key_  = resolver_(frame_id);
+}
+
+}  // namespace njudb
@@ -0,0 +1,74 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_SCAN_RING_REPLACER_H
+#define NJUDB_SCAN_RING_REPLACER_H
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "replacer.h"
+
+namespace njudb {
+
+/**
+ * ScanRingReplacer wraps the replacer chosen by REPLACER and adds the "use once" scan hint on top of it.
+ * A frame marked by SetUseOnce is kept out of the wrapped replacer when it is unpinned and goes to a FIFO ring instead,
+ * Victim takes frames from the ring first. A sequential scan thus keeps recycling the few frames it has just released
+ * instead of pushing the working set of other queries (e.g. B+ tree internal pages) out of the pool.
+ * The hint sticks to the page until its frame is reused for another page.
+ */
+class ScanRingReplacer : public Replacer
+{
+public:
+  /**
+   * @param replacer the wrapped replacer
+   * @param resolver resolves the page held by a frame, used to tell when a marked frame holds another page
+   */
+  ScanRingReplacer(std::unique_ptr<Replacer> replacer, FramePageResolver resolver);
+
+  ~ScanRingReplacer() override = default;
+
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void SetUseOnce(frame_id_t frame_id) override;
+
+private:
+  struct OnceEntry
+  {
+    page_key_t                      key_;
+    bool                            in_ring_;
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  std::mutex                                latch_;
+  std::unique_ptr<Replacer>                 replacer_;
+  std::list<frame_id_t>                     ring_;  // evictable use-once frames, front is released first
+  std::unordered_map<frame_id_t, OnceEntry> once_entries_;
+  FramePageResolver                         resolver_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_SCAN_RING_REPLACER_H
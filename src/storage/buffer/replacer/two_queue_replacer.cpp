@@ -0,0 +1,175 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "two_queue_replacer.h"
+
+#include <algorithm>
+
+namespace njudb {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t max_size, FramePageResolver resolver)
+    : max_size_(max_size),
+      kin_(std::max<size_t>(1, max_size / 4)),
+      kout_(std::max<size_t>(1, max_size / 2)),
+      resolver_(std::move(resolver))
+{}
+
+auto TwoQueueReplacer::Victim(frame_id_t *frame_id) -> bool
+{
+  std::scoped_lock lock(latch_);
+  if (cur_size_ == 0) {
+    return false;
+  }
+  bool prefer_am = a1in_.size() <= kin_;
+  if (!EvictFrom(prefer_am, frame_id)) {
+    EvictFrom(!prefer_am, frame_id);
+  }
+  return true;
+}
+
+void TwoQueueReplacer::Pin(frame_id_t frame_id)
+{
+  std::scoped_lock lock(latch_);
+  auto key = PageOf(frame_id);
+  auto it  = frame_entries_.find(frame_id);
+  if (it != frame_entries_.end() && it->second.key_ != key) {
+    // the frame was reused, e.g. victimized or freed and taken from the free list, drop the old page
+    Forget(it);
+    it = frame_entries_.end();
+  }
+  if (it == frame_entries_.end()) {
+    Admit(frame_id, key);
+    return;
+  }
+  auto &entry = it->second;
+  if (entry.evicted_) {
+    // the victim was pinned before the buffer pool could take it, it is not a new reference to the page
+    Reinsert(frame_id, entry);
+    return;
+  }
+  if (entry.evictable_) {
+    entry.evictable_ = false;
+    cur_size_--;
+  }
+  if (entry.in_am_) {
+    am_.erase(entry.pos_);
+    am_.push_back(frame_id);
+    entry.pos_ = std::prev(am_.end());
+  }
+}
+
+void TwoQueueReplacer::Unpin(frame_id_t frame_id)
+{
+  std::scoped_lock lock(latch_);
+  auto key = PageOf(frame_id);
+  auto it  = frame_entries_.find(frame_id);
+  if (it != frame_entries_.end() && it->second.key_ != key) {
+    Forget(it);
+    it = frame_entries_.end();
+  }
+  if (it == frame_entries_.end()) {
+    Admit(frame_id, key);
+    it = frame_entries_.find(frame_id);
+  } else if (it->second.evicted_) {
+    Reinsert(frame_id, it->second);
+  }
+  if (!it->second.evictable_) {
+    it->second.evictable_ = true;
+    cur_size_++;
+  }
+}
+
+auto TwoQueueReplacer::Size() -> size_t
+{
+  std::scoped_lock lock(latch_);
+  return cur_size_;
+}
+
+auto TwoQueueReplacer::PageOf(frame_id_t frame_id) const -> page_key_t
+{
+  return resolver_ ? resolver_(frame_id) : static_cast<page_key_t>(frame_id);
+}
+
+void TwoQueueReplacer::Admit(frame_id_t frame_id, page_key_t key)
+{
+  bool in_am = false;
+  if (auto git = ghost_entries_.find(key); git != ghost_entries_.end()) {
+    a1out_.erase(git->second);
+    ghost_entries_.erase(git);
+    in_am = true;
+  }
+  auto &queue = in_am ? am_ : a1in_;
+  queue.push_back(frame_id);
+  frame_entries_[frame_id] = {key, in_am, false, false, std::prev(queue.end())};
+}
+
+auto TwoQueueReplacer::EvictFrom(bool from_am, frame_id_t *frame_id) -> bool
+{
+  auto &queue = from_am ? am_ : a1in_;
+  auto  it    = std::find_if(queue.begin(), queue.end(), [this](frame_id_t fid) {
+    return frame_entries_[fid].evictable_;
+  });
+  if (it == queue.end()) {
+    return false;
+  }
+  *frame_id = *it;
+  if (!from_am) {
+    // only pages leaving A1in are remembered, pages leaving Am had their chance
+    auto key = frame_entries_[*it].key_;
+    if (ghost_entries_.find(key) == ghost_entries_.end()) {
+      a1out_.push_back(key);
+      ghost_entries_[key] = std::prev(a1out_.end());
+    }
+    if (a1out_.size() > kout_) {
+      ghost_entries_.erase(a1out_.front());
+      a1out_.pop_front();
+    }
+  }
+  // the entry is kept until the frame holds another page, the buffer pool may give up the victim before
+  auto &entry      = frame_entries_[*it];
+  entry.evicted_   = true;
+  entry.evictable_ = false;
+  queue.erase(it);
+  cur_size_--;
+  return true;
+}
+
+void TwoQueueReplacer::Reinsert(frame_id_t frame_id, FrameEntry &entry)
+{
+  if (auto git = ghost_entries_.find(entry.key_); git != ghost_entries_.end()) {
+    a1out_.erase(git->second);
+    ghost_entries_.erase(git);
+  }
+  auto &queue    = entry.in_am_ ? am_ : a1in_;
+  entry.evicted_ = false;
+  queue.push_back(frame_id);
+  entry.pos_ = std::prev(queue.end());
+}
+
+void TwoQueueReplacer::Forget(std::unordered_map<frame_id_t, FrameEntry>::iterator it)
+{
+  auto &entry = it->second;
+  if (!entry.evicted_) {
+    (entry.in_am_ ? am_ : a1in_).erase(entry.pos_);
+    if (entry.evictable_) {
+      cur_size_--;
+    }
+  }
+  frame_entries_.erase(it);
+}
+
+}  // namespace njudb
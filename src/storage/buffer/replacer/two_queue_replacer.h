@@ -0,0 +1,105 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_TWO_QUEUE_REPLACER_H
+#define NJUDB_TWO_QUEUE_REPLACER_H
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "replacer.h"
+
+namespace njudb {
+
+/**
+ * TwoQueueReplacer implements the full version of 2Q (Johnson & Shasha, VLDB'94).
+ * A new page enters the FIFO queue A1in, re-references while it stays there are treated as correlated and do not
+ * promote it. When a page is evicted from A1in its key is remembered in the ghost queue A1out, a page that is accessed
+ * again while it is in A1out is hot and goes to the LRU queue Am. Pages touched once by a scan never reach Am.
+ */
+class TwoQueueReplacer : public Replacer
+{
+public:
+  /**
+   * @param max_size maximum number of frames, i.e. the size of the buffer pool, A1in holds a quarter of it and A1out
+   * remembers half of it
+   * @param resolver resolves the page held by a frame, if not given, frame ids are used as page keys
+   */
+  explicit TwoQueueReplacer(size_t max_size = BUFFER_POOL_SIZE, FramePageResolver resolver = nullptr);
+
+  ~TwoQueueReplacer() override = default;
+
+  /**
+   * Evict the oldest evictable frame of A1in if A1in exceeds its share, otherwise the least recently used evictable
+   * frame of Am, fall back to the other queue if the chosen one has no evictable frame. A victim that is pinned or
+   * unpinned again for its own page, e.g. by a latch-free hit before the buffer pool could take it, goes back to its
+   * queue and is not remembered in A1out.
+   */
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * Access the page in the frame and make the frame non-evictable.
+   * A new page goes to Am if it is in A1out, otherwise to A1in. A resident page in Am moves to its MRU end.
+   */
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+private:
+  struct FrameEntry
+  {
+    page_key_t                      key_;
+    bool                            in_am_;
+    bool                            evictable_;
+    bool                            evicted_;  // handed out by Victim and not in a queue, pos_ is invalid
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  auto PageOf(frame_id_t frame_id) const -> page_key_t;
+
+  void Admit(frame_id_t frame_id, page_key_t key);
+
+  auto EvictFrom(bool from_am, frame_id_t *frame_id) -> bool;
+
+  /**
+   * Put a victim that was pinned again before the buffer pool took it back to the end of its queue, dropping its ghost
+   */
+  void Reinsert(frame_id_t frame_id, FrameEntry &entry);
+
+  /**
+   * Drop the entry of a frame that holds another page now
+   */
+  void Forget(std::unordered_map<frame_id_t, FrameEntry>::iterator it);
+
+  std::mutex                                                      latch_;
+  std::list<frame_id_t>                                           a1in_;  // front is the oldest
+  std::list<frame_id_t>                                           am_;    // front is the LRU end
+  std::list<page_key_t>                                           a1out_;
+  std::unordered_map<frame_id_t, FrameEntry>                      frame_entries_;
+  std::unordered_map<page_key_t, std::list<page_key_t>::iterator> ghost_entries_;
+  size_t                                                          cur_size_{0};  // number of evictable frames
+  size_t                                                          max_size_;
+  size_t                                                          kin_;   // share of A1in
+  size_t                                                          kout_;  // capacity of A1out
+  FramePageResolver                                               resolver_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_TWO_QUEUE_REPLACER_H
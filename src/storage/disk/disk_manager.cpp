@@ -21,12 +21,19 @@
 
 #include <filesystem>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include "disk_manager.h"
 #include "../../common/config.h"
 #include "../../../common/error.h"
 
 namespace njudb {
+
+DiskManager::DiskManager(bool direct_io) : direct_io_(direct_io), io_backend_(IOBackend::Create()) {}
+
+DiskManager::~DiskManager() = default;
+
 void DiskManager::CreateFile(const std::string &fname)
 {
   if (FileExists(fname)) {
@@ -50,10 +57,13 @@ void DiskManager::DestroyFile(const std::string &fname)
   }
 }
 
-auto DiskManager::OpenFile(const std::string &fname) -> file_id_t
+auto DiskManager::OpenFile(const std::string &fname) -> file_id_t { return OpenFile(fname, direct_io_); }
+
+auto DiskManager::OpenFile(const std::string &fname, bool direct_io) -> file_id_t
 {
   if (!FileExists(fname))
     NJUDB_THROW(NJUDB_FILE_NOT_EXISTS, fname);
+  std::unique_lock lock(latch_);
   if (name_fid_map_.find(fname) != name_fid_map_.end()) {
     NJUDB_THROW(NJUDB_FILE_REOPEN, fname);
   } else {
@@ -63,58 +73,230 @@ auto DiskManager::OpenFile(const std::string &fname) -> file_id_t
     }
     name_fid_map_.insert(std::make_pair(fname, fd));
     fid_name_map_.insert(std::make_pair(fd, fname));
+    if (direct_io) {
+      // fails with EINVAL on file systems without direct io support, e.g. tmpfs
+      int direct_fd = open(fname.c_str(), O_RDWR | O_DIRECT);
+      if (direct_fd != -1) {
+        direct_fds_.insert(std::make_pair(fd, direct_fd));
+      }
+    }
     return fd;
   }
 }
 
 void DiskManager::CloseFile(file_id_t fid)
 {
+  std::unique_lock lock(latch_);
   if (fid_name_map_.find(fid) == fid_name_map_.end()) {
     NJUDB_THROW(NJUDB_FILE_NOT_OPEN, fmt::format("fid: {}", fid));
   } else {
+    UnmapFileLocked(fid);
     name_fid_map_.erase(fid_name_map_[fid]);
     fid_name_map_.erase(fid);
+    if (auto it = direct_fds_.find(fid); it != direct_fds_.end()) {
+      close(it->second);
+      direct_fds_.erase(it);
+    }
     close(fid);
   }
 }
 
-void DiskManager::WritePage(file_id_t fid, page_id_t page_id, const char *data)
+auto DiskManager::AllocatePage(file_id_t fid, size_t &page_num, size_t &extent_end) -> page_id_t
+{
+  auto page_id = static_cast<page_id_t>(page_num);
+  if (page_num >= extent_end) {
+    // the first extent also holds the file header page
+    auto end = (page_num / EXTENT_PAGES + 1) * EXTENT_PAGES;
+    PreallocatePages(fid, page_id, end - page_num);
+    extent_end = end;
+  }
+  page_num++;
+  return page_id;
+}
+
+void DiskManager::PreallocatePages(file_id_t fid, page_id_t first_pid, size_t n)
+{
+  NJUDB_ASSERT(IsOpen(fid), fmt::format("fid: {}", fid));
+  // keep the size so that the pages beyond the written ones still read as zeros and the file is not mapped past them
+  int ret = fallocate(fid,
+      FALLOC_FL_KEEP_SIZE,
+      static_cast<off_t>(first_pid) * static_cast<off_t>(PAGE_SIZE),
+      static_cast<off_t>(n * PAGE_SIZE));
+  if (ret != 0 && errno != EOPNOTSUPP && errno != ENOSYS) {
+    NJUDB_THROW(NJUDB_FILE_WRITE_ERROR, fmt::format("fallocate fid: {}, errno: {}", fid, errno));
+  }
+}
+
+auto DiskManager::MapFile(file_id_t fid) -> size_t
+{
+  std::unique_lock lock(latch_);
+  if (fid_name_map_.find(fid) == fid_name_map_.end()) {
+    NJUDB_THROW(NJUDB_FILE_NOT_OPEN, fmt::format("fid: {}", fid));
+  }
+  UnmapFileLocked(fid);
+  struct stat st{};
+  if (fstat(fid, &st) != 0) {
+    NJUDB_THROW(NJUDB_FILE_READ_ERROR, fmt::format("fstat fid: {}, errno: {}", fid, errno));
+  }
+  // a partial page at the end of file is read through the pool, which fills the rest with zeros
+  auto size = static_cast<size_t>(st.st_size) / PAGE_SIZE * PAGE_SIZE;
+  if (size == 0) {
+    return 0;
+  }
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fid, 0);
+  if (addr == MAP_FAILED) {
+    NJUDB_THROW(NJUDB_FILE_READ_ERROR, fmt::format("mmap fid: {}, errno: {}", fid, errno));
+  }
+  madvise(addr, size, MADV_SEQUENTIAL);
+  mapped_files_[fid] = {static_cast<char *>(addr), size};
+  return size / PAGE_SIZE;
+}
+
+void DiskManager::UnmapFile(file_id_t fid)
+{
+  std::unique_lock lock(latch_);
+  UnmapFileLocked(fid);
+}
+
+void DiskManager::UnmapFileLocked(file_id_t fid)
+{
+  if (auto it = mapped_files_.find(fid); it != mapped_files_.end()) {
+    munmap(it->second.first, it->second.second);
+    mapped_files_.erase(it);
+  }
+}
+
+auto DiskManager::GetMappedPage(file_id_t fid, page_id_t page_id) -> const char *
+{
+  std::shared_lock lock(latch_);
+  auto             it = mapped_files_.find(fid);
+  if (it == mapped_files_.end() || page_id < 0 || static_cast<size_t>(page_id) >= it->second.second / PAGE_SIZE) {
+    return nullptr;
+  }
+  return it->second.first + static_cast<size_t>(page_id) * PAGE_SIZE;
+}
+
+auto DiskManager::IsDirectIO(file_id_t fid) -> bool
+{
+  std::shared_lock lock(latch_);
+  return direct_fds_.find(fid) != direct_fds_.end();
+}
+
+auto DiskManager::IsOpen(file_id_t fid) -> bool
 {
+  std::shared_lock lock(latch_);
+  return fid_name_map_.find(fid) != fid_name_map_.end();
+}
+
+auto DiskManager::GetPageFd(file_id_t fid, const char *data) -> std::pair<int, bool>
+{
+  // the descriptor is returned by value, the io itself runs without the latch
+  std::shared_lock lock(latch_);
   NJUDB_ASSERT(fid_name_map_.find(fid) != fid_name_map_.end(), fmt::format("fid: {}", fid));
-  lseek(fid, static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE), SEEK_SET);
-  if (write(fid, data, PAGE_SIZE) != PAGE_SIZE) {
-    NJUDB_THROW(
-        NJUDB_FILE_WRITE_ERROR, fmt::format("fid: {}, page_id: {}", fid, page_id));
+  auto it = direct_fds_.find(fid);
+  // page offsets and sizes are aligned, only the buffer needs to be checked
+  if (it != direct_fds_.end() && IsDirectIOAligned(data)) {
+    return {it->second, true};
   }
+  return {fid, false};
+}
+
+auto DiskManager::MakePageRequest(IOType type, file_id_t fid, page_id_t page_id, char *data) -> IORequest
+{
+  auto [fd, direct] = GetPageFd(fid, data);
+  return {type, fd, data, PAGE_SIZE, static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE), direct};
+}
+
+void DiskManager::WritePage(file_id_t fid, page_id_t page_id, const char *data)
+{
+  IOBackend::DoSyncIO(MakePageRequest(IOType::WRITE, fid, page_id, const_cast<char *>(data)));
+  page_writes_++;
+}
+
+void DiskManager::WritePages(file_id_t fid, page_id_t first_pid, const std::vector<const char *> &pages)
+{
+  auto [fd, direct] = GetPageFd(fid, pages.empty() ? nullptr : pages.front());
+  std::vector<iovec> iov;
+  iov.reserve(pages.size());
+  for (const auto *page : pages) {
+    direct = direct && IsDirectIOAligned(page);
+    iov.push_back({const_cast<char *>(page), PAGE_SIZE});
+  }
+  IOBackend::DoSyncVectorIO(IOType::WRITE,
+      direct ? fd : fid,
+      iov,
+      static_cast<off_t>(first_pid) * static_cast<off_t>(PAGE_SIZE),
+      direct);
+  page_writes_ += pages.size();
 }
 
 void DiskManager::ReadPage(file_id_t fid, page_id_t page_id, char *data)
 {
-  NJUDB_ASSERT(fid_name_map_.find(fid) != fid_name_map_.end(), fmt::format("fid: {}", fid));
-  lseek(fid, static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE), SEEK_SET);
-  if (read(fid, data, PAGE_SIZE) < 0) {
-    NJUDB_THROW(
-        NJUDB_FILE_READ_ERROR, fmt::format("fid: {}, page_id: {}", fid, page_id));
+  IOBackend::DoSyncIO(MakePageRequest(IOType::READ, fid, page_id, data));
+}
+
+void DiskManager::ReadPages(file_id_t fid, page_id_t first_pid, const std::vector<char *> &pages)
+{
+  auto [fd, direct] = GetPageFd(fid, pages.empty() ? nullptr : pages.front());
+  std::vector<iovec> iov;
+  iov.reserve(pages.size());
+  for (auto *page : pages) {
+    direct = direct && IsDirectIOAligned(page);
+    iov.push_back({page, PAGE_SIZE});
+  }
+  IOBackend::DoSyncVectorIO(IOType::READ,
+      direct ? fd : fid,
+      iov,
+      static_cast<off_t>(first_pid) * static_cast<off_t>(PAGE_SIZE),
+      direct);
+}
+
+auto DiskManager::WritePageAsync(file_id_t fid, page_id_t page_id, const char *data) -> std::future<void>
+{
+  auto futures = io_backend_->Submit({MakePageRequest(IOType::WRITE, fid, page_id, const_cast<char *>(data))});
+  page_writes_++;
+  return std::move(futures.front());
+}
+
+auto DiskManager::ReadPageAsync(file_id_t fid, page_id_t page_id, char *data) -> std::future<void>
+{
+  auto futures = io_backend_->Submit({MakePageRequest(IOType::READ, fid, page_id, data)});
+  return std::move(futures.front());
+}
+
+auto DiskManager::SubmitPageIO(const std::vector<PageIO> &ios) -> std::vector<std::future<void>>
+{
+  std::vector<IORequest> requests;
+  requests.reserve(ios.size());
+  for (const auto &io : ios) {
+    requests.push_back(MakePageRequest(io.type_, io.fid_, io.pid_, io.data_));
+    page_writes_ += io.type_ == IOType::WRITE ? 1 : 0;
   }
+  return io_backend_->Submit(requests);
 }
 
 void DiskManager::ReadFile(file_id_t fid, char *data, size_t size, size_t offset, int type)
 {
-  NJUDB_ASSERT(fid_name_map_.find(fid) != fid_name_map_.end(), "File not Opened");
-  lseek(fid, static_cast<off_t>(offset), type);
-  if(read(fid, data, size) < 0) {
+  NJUDB_ASSERT(IsOpen(fid), "File not Opened");
+  off_t pos = lseek(fid, static_cast<off_t>(offset), type);
+  if (pos < 0) {
     NJUDB_THROW(NJUDB_FILE_READ_ERROR, fmt::format("fid: {}", fid));
   }
+  IOBackend::DoSyncIO({IOType::READ, fid, data, size, pos});
+  // keep the file position consistent for the following SEEK_CUR calls
+  lseek(fid, pos + static_cast<off_t>(size), SEEK_SET);
 }
 
 void DiskManager::WriteFile(file_id_t fid, const char *data, size_t size, int type, int off)
 {
-  NJUDB_ASSERT(fid_name_map_.find(fid) != fid_name_map_.end(), "File not Opened");
+  NJUDB_ASSERT(IsOpen(fid), "File not Opened");
   NJUDB_ASSERT(type == SEEK_CUR || type == SEEK_SET || type == SEEK_END, "Invalid Type");
-  lseek(fid, off, type);
-  if(write(fid, data, size) < 0) {
+  off_t pos = lseek(fid, off, type);
+  if (pos < 0) {
     NJUDB_THROW(NJUDB_FILE_WRITE_ERROR, fmt::format("fid: {}", fid));
   }
+  IOBackend::DoSyncIO({IOType::WRITE, fid, const_cast<char *>(data), size, pos});
+  lseek(fid, pos + static_cast<off_t>(size), SEEK_SET);
 }
 
 void DiskManager::WriteLog(const std::string &log_file, const std::string &log_string) {}
@@ -123,7 +305,8 @@ void DiskManager::ReadLog(const std::string &log_file, std::string &log_string)
 
 auto DiskManager::GetFileId(const std::string &fname) -> file_id_t
 {
-  auto it = name_fid_map_.find(fname);
+  std::shared_lock lock(latch_);
+  auto             it = name_fid_map_.find(fname);
   if (it != name_fid_map_.end()) {
     return it->second;
   } else {
@@ -133,7 +316,8 @@ auto DiskManager::GetFileId(const std::string &fname) -> file_id_t
 
 auto DiskManager::GetFileName(file_id_t fid) -> std::string
 {
-  auto it = fid_name_map_.find(fid);
+  std::shared_lock lock(latch_);
+  auto             it = fid_name_map_.find(fid);
   if (it != fid_name_map_.end()) {
     return it->second;
   } else {
@@ -22,19 +22,40 @@
 #ifndef NJU_DBCOURSE_DISK_MANAGER_H
 #define NJU_DBCOURSE_DISK_MANAGER_H
 
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <future>
+#include <memory>
+#include <shared_mutex>
 #include <unordered_map>
+#include <vector>
 #include "common/types.h"
+#include "common/config.h"
+#include "io_backend.h"
 
 namespace njudb {
+
+/**
+ * A page read or write handed to the io backend, data is a buffer of PAGE_SIZE bytes
+ */
+struct PageIO
+{
+  IOType    type_{IOType::READ};
+  file_id_t fid_{INVALID_FILE_ID};
+  page_id_t pid_{INVALID_PAGE_ID};
+  char     *data_{nullptr};
+};
+
 class DiskManager
 {
 public:
-  DiskManager() = default;
+  /**
+   * @param direct_io open files in direct io mode by default, see OpenFile
+   */
+  explicit DiskManager(bool direct_io = false);
 
-  ~DiskManager() = default;
+  ~DiskManager();
 
   /**
    * Create a file named file_name and close it immediately
@@ -56,16 +77,112 @@ public:
    */
   auto OpenFile(const std::string &fname) -> file_id_t;
 
+  /**
+   * Open the file, in direct io mode page reads and writes bypass the os page cache: the file is opened a second time
+   * with O_DIRECT, pages whose buffers are aligned to DIRECT_IO_ALIGNMENT (e.g. the frames of the buffer pool) go
+   * through that descriptor, while unaligned page buffers and ReadFile/WriteFile, whose offsets and sizes are not
+   * aligned, keep using the returned descriptor. Falls back to buffered io if the file system does not support O_DIRECT.
+   * @param fname
+   * @param direct_io
+   * @return the file id
+   */
+  auto OpenFile(const std::string &fname, bool direct_io) -> file_id_t;
+
+  /**
+   * @return true if page io of the file bypasses the os page cache
+   */
+  auto IsDirectIO(file_id_t fid) -> bool;
+
+  static auto IsDirectIOAligned(const void *buf) -> bool
+  {
+    return reinterpret_cast<uintptr_t>(buf) % DIRECT_IO_ALIGNMENT == 0;
+  }
+
   /**
    * Close the file given table id, and remove related information from structures
    * @param tab_name
    */
   void CloseFile(file_id_t fid);
 
+  /**
+   * Allocate page page_num at the end of the file. Files grow by extents of EXTENT_PAGES pages aligned to
+   * EXTENT_PAGES, an extent is preallocated with fallocate when the first page of it is allocated, so the pages
+   * allocated one after another are adjacent on disk and the file metadata is not changed by every new page.
+   * @param fid
+   * @param page_num number of pages of the file, incremented
+   * @param extent_end pages before it are preallocated, kept in the file header, updated when an extent is allocated
+   * @return the allocated page id
+   */
+  auto AllocatePage(file_id_t fid, size_t &page_num, size_t &extent_end) -> page_id_t;
+
+  /**
+   * Preallocate pages [first_pid, first_pid + n) on disk without changing the file size, reads of them still return
+   * zeros. Does nothing if the file system does not support it.
+   */
+  void PreallocatePages(file_id_t fid, page_id_t first_pid, size_t n);
+
+  /**
+   * Map the file into memory read-only and hint the os that it is read sequentially, so that pages can be read straight
+   * from the os page cache without being copied. Mapping a mapped file again remaps it to cover the pages appended
+   * since, the previous mapping becomes invalid.
+   * @param fid
+   * @return number of pages covered by the mapping
+   */
+  auto MapFile(file_id_t fid) -> size_t;
+
+  /**
+   * Unmap the file if it is mapped, pages returned by GetMappedPage become invalid
+   * @param fid
+   */
+  void UnmapFile(file_id_t fid);
+
+  /**
+   * @return the page in the mapping of the file, nullptr if the file is not mapped or the page is beyond the mapping
+   */
+  auto GetMappedPage(file_id_t fid, page_id_t page_id) -> const char *;
+
   void WritePage(file_id_t fid, page_id_t page_id, const char *data);
 
+  /**
+   * Read a page, the part beyond the end of file is filled with zeros
+   */
   void ReadPage(file_id_t fid, page_id_t page_id, char *data);
 
+  /**
+   * Read consecutive pages [first_pid, first_pid + pages.size()) with vectored reads, the part beyond the end of file
+   * is filled with zeros
+   * @param fid
+   * @param first_pid
+   * @param pages buffers of PAGE_SIZE bytes in page order
+   */
+  void ReadPages(file_id_t fid, page_id_t first_pid, const std::vector<char *> &pages);
+
+  /**
+   * Write consecutive pages [first_pid, first_pid + pages.size()) with vectored writes
+   * @param fid
+   * @param first_pid
+   * @param pages buffers of PAGE_SIZE bytes in page order
+   */
+  void WritePages(file_id_t fid, page_id_t first_pid, const std::vector<const char *> &pages);
+
+  /**
+   * Asynchronous version of WritePage, data must stay valid until the future is ready
+   */
+  auto WritePageAsync(file_id_t fid, page_id_t page_id, const char *data) -> std::future<void>;
+
+  /**
+   * Asynchronous version of ReadPage, data must stay valid until the future is ready
+   */
+  auto ReadPageAsync(file_id_t fid, page_id_t page_id, char *data) -> std::future<void>;
+
+  /**
+   * Submit a batch of page reads and writes to the io backend at once, with io_uring this is a single syscall,
+   * so many page misses or dirty page write-backs can be in flight together
+   * @param ios
+   * @return futures in the same order as ios
+   */
+  auto SubmitPageIO(const std::vector<PageIO> &ios) -> std::vector<std::future<void>>;
+
   void ReadFile(file_id_t fid, char *data, size_t size, size_t offset, int type);
 
   /**
@@ -87,9 +204,37 @@ public:
 
   static auto FileExists(const std::string &fname) -> bool;
 
+  [[nodiscard]] auto GetIOBackendName() const -> const char * { return io_backend_->GetName(); }
+
+  /**
+   * @return number of pages written through the page interfaces since the disk manager was created
+   */
+  [[nodiscard]] auto GetPageWriteCount() const -> size_t { return page_writes_.load(); }
+
 private:
-  std::unordered_map<std::string, file_id_t> name_fid_map_;
-  std::unordered_map<file_id_t, std::string> fid_name_map_;
+  auto MakePageRequest(IOType type, file_id_t fid, page_id_t page_id, char *data) -> IORequest;
+
+  /**
+   * @return the O_DIRECT descriptor of the file if the page buffer can use it, otherwise the file id
+   */
+  auto GetPageFd(file_id_t fid, const char *data) -> std::pair<int, bool>;
+
+  auto IsOpen(file_id_t fid) -> bool;
+
+  /**
+   * Unmap the file if it is mapped, called with the latch held exclusively
+   */
+  void UnmapFileLocked(file_id_t fid);
+
+  bool                                                     direct_io_;
+  std::unique_ptr<IOBackend>                               io_backend_;
+  std::atomic<size_t>                                      page_writes_{0};
+  // guards the maps below, page io of concurrent threads only reads them, opening, closing and mapping files write them
+  std::shared_mutex                                        latch_;
+  std::unordered_map<file_id_t, int>                       direct_fds_;  // file id -> O_DIRECT descriptor of the file
+  std::unordered_map<file_id_t, std::pair<char *, size_t>> mapped_files_;  // file id -> read-only mapping, length
+  std::unordered_map<std::string, file_id_t>               name_fid_map_;
+  std::unordered_map<file_id_t, std::string>               fid_name_map_;
 };
 
 }  // namespace njudb
@@ -0,0 +1,330 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "io_backend.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <unistd.h>
+#ifdef NJUDB_USE_IO_URING
+#include <liburing.h>
+#endif
+
+#include "../../../common/error.h"
+
+namespace njudb {
+
+[[noreturn]] static void ThrowIOError(const IORequest &request, int err)
+{
+  auto msg = fmt::format("fd: {}, offset: {}, size: {}, {}", request.fd_, request.offset_, request.size_, strerror(err));
+  if (request.type_ == IOType::READ) {
+    NJUDB_THROW(NJUDB_FILE_READ_ERROR, msg);
+  }
+  NJUDB_THROW(NJUDB_FILE_WRITE_ERROR, msg);
+}
+
+void IOBackend::DoSyncIO(const IORequest &request)
+{
+  size_t done = 0;
+  while (done < request.size_) {
+    auto    offset = request.offset_ + static_cast<off_t>(done);
+    ssize_t ret    = request.type_ == IOType::READ
+                         ? pread(request.fd_, request.buf_ + done, request.size_ - done, offset)
+                         : pwrite(request.fd_, request.buf_ + done, request.size_ - done, offset);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ThrowIOError(request, errno);
+    }
+    if (ret == 0) {
+      if (request.type_ == IOType::READ) {
+        // end of file, the rest of the page has never been written
+        memset(request.buf_ + done, 0, request.size_ - done);
+        return;
+      }
+      ThrowIOError(request, EIO);
+    }
+    done += static_cast<size_t>(ret);
+    if (request.direct_ && request.type_ == IOType::READ && done < request.size_) {
+      memset(request.buf_ + done, 0, request.size_ - done);
+      return;
+    }
+  }
+}
+
+void IOBackend::DoSyncVectorIO(IOType type, int fd, std::vector<iovec> &iov, off_t offset, bool direct)
+{
+  size_t first = 0;
+  while (first < iov.size()) {
+    auto   cnt      = std::min(iov.size() - first, static_cast<size_t>(IOV_MAX));
+    size_t expected = 0;
+    for (size_t i = first; i < first + cnt; i++) {
+      expected += iov[i].iov_len;
+    }
+    ssize_t ret = type == IOType::READ ? preadv(fd, &iov[first], static_cast<int>(cnt), offset)
+                                       : pwritev(fd, &iov[first], static_cast<int>(cnt), offset);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ThrowIOError({type, fd, static_cast<char *>(iov[first].iov_base), expected, offset, direct}, errno);
+    }
+    if (ret == 0 && type == IOType::WRITE) {
+      ThrowIOError({type, fd, static_cast<char *>(iov[first].iov_base), expected, offset, direct}, EIO);
+    }
+    offset += ret;
+    // drop the buffers that are done and trim the one that is partially done
+    auto done = static_cast<size_t>(ret);
+    while (first < iov.size() && done >= iov[first].iov_len) {
+      done -= iov[first].iov_len;
+      first++;
+    }
+    if (done > 0) {
+      iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + done;
+      iov[first].iov_len -= done;
+    }
+    if (type == IOType::READ && (ret == 0 || (direct && static_cast<size_t>(ret) < expected))) {
+      // end of file, the rest of the pages have never been written
+      for (; first < iov.size(); first++) {
+        memset(iov[first].iov_base, 0, iov[first].iov_len);
+      }
+      return;
+    }
+  }
+}
+
+/// ThreadPoolIOBackend
+
+ThreadPoolIOBackend::ThreadPoolIOBackend(size_t thread_num)
+{
+  workers_.reserve(thread_num);
+  for (size_t i = 0; i < thread_num; i++) {
+    workers_.emplace_back(&ThreadPoolIOBackend::WorkerLoop, this);
+  }
+}
+
+ThreadPoolIOBackend::~ThreadPoolIOBackend()
+{
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+auto ThreadPoolIOBackend::Submit(const std::vector<IORequest> &requests) -> std::vector<std::future<void>>
+{
+  std::vector<std::future<void>> futures;
+  futures.reserve(requests.size());
+  {
+    std::scoped_lock lock(latch_);
+    for (const auto &request : requests) {
+      tasks_.push_back({request, {}});
+      futures.push_back(tasks_.back().promise_.get_future());
+    }
+  }
+  cv_.notify_all();
+  return futures;
+}
+
+void ThreadPoolIOBackend::WorkerLoop()
+{
+  while (true) {
+    Task task;
+    {
+      std::unique_lock lock(latch_);
+      cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      // drain the queue before stopping so that no future is left unsatisfied
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    try {
+      DoSyncIO(task.request_);
+      task.promise_.set_value();
+    } catch (...) {
+      task.promise_.set_exception(std::current_exception());
+    }
+  }
+}
+
+/// IOUringBackend
+
+#ifdef NJUDB_USE_IO_URING
+
+/**
+ * io_uring backend, the submitter prepares one sqe per request and enters the kernel once per batch, a reaper thread
+ * waits for completions and fulfills the futures. Short transfers are finished synchronously by the reaper.
+ */
+class IOUringBackend : public IOBackend
+{
+public:
+  explicit IOUringBackend(size_t queue_depth) : depth_(queue_depth)
+  {
+    valid_ = io_uring_queue_init(static_cast<unsigned>(queue_depth), &ring_, 0) == 0;
+    if (valid_) {
+      reaper_ = std::thread(&IOUringBackend::ReapLoop, this);
+    }
+  }
+
+  ~IOUringBackend() override
+  {
+    if (!valid_) {
+      return;
+    }
+    {
+      std::unique_lock lock(latch_);
+      cv_.wait(lock, [this] { return inflight_ == 0; });
+      // a nop without user data tells the reaper to quit
+      io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+      io_uring_prep_nop(sqe);
+      io_uring_sqe_set_data(sqe, nullptr);
+      io_uring_submit(&ring_);
+    }
+    reaper_.join();
+    io_uring_queue_exit(&ring_);
+  }
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(IOUringBackend)
+
+  [[nodiscard]] auto IsValid() const -> bool { return valid_; }
+
+  auto Submit(const std::vector<IORequest> &requests) -> std::vector<std::future<void>> override
+  {
+    std::vector<std::future<void>> futures;
+    futures.reserve(requests.size());
+    std::unique_lock lock(latch_);
+    for (const auto &request : requests) {
+      if (inflight_ >= depth_) {
+        // push what we have prepared so far, then wait for the reaper to make room
+        io_uring_submit(&ring_);
+        cv_.wait(lock, [this] { return inflight_ < depth_; });
+      }
+      io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+      if (sqe == nullptr) {
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+      }
+      auto *op = new Operation{request, {}};
+      futures.push_back(op->promise_.get_future());
+      if (request.type_ == IOType::READ) {
+        io_uring_prep_read(sqe, request.fd_, request.buf_, static_cast<unsigned>(request.size_), request.offset_);
+      } else {
+        io_uring_prep_write(sqe, request.fd_, request.buf_, static_cast<unsigned>(request.size_), request.offset_);
+      }
+      io_uring_sqe_set_data(sqe, op);
+      inflight_++;
+    }
+    io_uring_submit(&ring_);
+    return futures;
+  }
+
+  [[nodiscard]] auto GetName() const -> const char * override { return "io_uring"; }
+
+private:
+  struct Operation
+  {
+    IORequest          request_;
+    std::promise<void> promise_;
+  };
+
+  void ReapLoop()
+  {
+    while (true) {
+      io_uring_cqe *cqe = nullptr;
+      int           ret = io_uring_wait_cqe(&ring_, &cqe);
+      if (ret == -EINTR) {
+        continue;
+      }
+      NJUDB_ASSERT(ret == 0, fmt::format("io_uring_wait_cqe failed: {}", strerror(-ret)));
+      auto *op  = static_cast<Operation *>(io_uring_cqe_get_data(cqe));
+      int   res = cqe->res;
+      io_uring_cqe_seen(&ring_, cqe);
+      if (op == nullptr) {
+        return;
+      }
+      Complete(op, res);
+      {
+        std::scoped_lock lock(latch_);
+        inflight_--;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  static void Complete(Operation *op, int res)
+  {
+    auto &request = op->request_;
+    try {
+      if (res == -EINTR || res == -EAGAIN) {
+        // nothing has been transferred, do it synchronously
+        DoSyncIO(request);
+      } else if (res < 0) {
+        ThrowIOError(request, -res);
+      } else if (res == 0 && request.type_ == IOType::READ) {
+        // end of file, the page has never been written
+        memset(request.buf_, 0, request.size_);
+      } else if (static_cast<size_t>(res) < request.size_) {
+        // a short transfer is not necessarily the end of file, finish it synchronously, pread tells the end of file
+        // apart. The rest of a direct request is not aligned, so it is done again from the start
+        IORequest rest = request;
+        if (!request.direct_) {
+          rest.buf_ += res;
+          rest.size_ -= static_cast<size_t>(res);
+          rest.offset_ += static_cast<off_t>(res);
+        }
+        DoSyncIO(rest);
+      }
+      op->promise_.set_value();
+    } catch (...) {
+      op->promise_.set_exception(std::current_exception());
+    }
+    delete op;
+  }
+
+  io_uring                 ring_{};
+  bool                     valid_{false};
+  size_t                   depth_;
+  size_t                   inflight_{0};  // number of prepared sqes whose completion is not reaped yet
+  std::mutex               latch_;        // serializes the submission queue and protects inflight_
+  std::condition_variable  cv_;
+  std::thread              reaper_;
+};
+
+#endif
+
+auto IOBackend::Create(size_t queue_depth) -> std::unique_ptr<IOBackend>
+{
+#ifdef NJUDB_USE_IO_URING
+  auto backend = std::make_unique<IOUringBackend>(queue_depth);
+  if (backend->IsValid()) {
+    return backend;
+  }
+  NJUDB_LOG("io_uring is not available, fall back to the thread pool io backend");
+#endif
+  return std::make_unique<ThreadPoolIOBackend>();
+}
+
+}  // namespace njudb
@@ -0,0 +1,135 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_IO_BACKEND_H
+#define NJUDB_IO_BACKEND_H
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "common/types.h"
+#include "../../../common/micro.h"
+
+namespace njudb {
+
+enum class IOType
+{
+  READ,
+  WRITE
+};
+
+/**
+ * A positional read or write of size_ bytes at offset_ of the file fd_.
+ * A read that reaches the end of file fills the rest of buf_ with zeros, so pages that are allocated but never written
+ * read as empty pages.
+ * If direct_ is set, fd_ is opened with O_DIRECT and buf_, size_ and offset_ are aligned to DIRECT_IO_ALIGNMENT, a
+ * short read can only mean the end of file, since the rest could not be read at an unaligned offset anyway.
+ */
+struct IORequest
+{
+  IOType type_{IOType::READ};
+  int    fd_{-1};
+  char  *buf_{nullptr};
+  size_t size_{0};
+  off_t  offset_{0};
+  bool   direct_{false};
+};
+
+/**
+ * IOBackend executes IORequests asynchronously. Requests handed to Submit in one call are issued together, the caller
+ * waits on the returned futures, a failed request stores an NJUDBException_ in its future.
+ * The buffers of a request must stay valid until its future is ready.
+ */
+class IOBackend
+{
+public:
+  virtual ~IOBackend() = default;
+
+  /**
+   * Submit a batch of requests
+   * @param requests
+   * @return futures in the same order as requests
+   */
+  virtual auto Submit(const std::vector<IORequest> &requests) -> std::vector<std::future<void>> = 0;
+
+  [[nodiscard]] virtual auto GetName() const -> const char * = 0;
+
+  /**
+   * Create the io_uring backend if njudb is built with liburing and the kernel allows it, otherwise fall back to the
+   * thread pool backend
+   * @param queue_depth max number of requests in flight
+   */
+  static auto Create(size_t queue_depth = 64) -> std::unique_ptr<IOBackend>;
+
+  /**
+   * Synchronous pread/pwrite loop that keeps going on short reads/writes and EINTR, throws on failure
+   */
+  static void DoSyncIO(const IORequest &request);
+
+  /**
+   * Synchronous preadv/pwritev loop over buffers that cover consecutive bytes starting at offset, handles short
+   * transfers, EINTR and the end of file like DoSyncIO
+   * @param type
+   * @param fd
+   * @param iov buffers in file order, consumed by the call
+   * @param offset
+   * @param direct fd is opened with O_DIRECT, see IORequest
+   */
+  static void DoSyncVectorIO(IOType type, int fd, std::vector<iovec> &iov, off_t offset, bool direct = false);
+};
+
+/**
+ * Fallback backend, a fixed number of worker threads take requests from a shared queue and run them with pread/pwrite
+ */
+class ThreadPoolIOBackend : public IOBackend
+{
+public:
+  explicit ThreadPoolIOBackend(size_t thread_num = 4);
+
+  ~ThreadPoolIOBackend() override;
+
+  DISABLE_COPY_MOVE_AND_ASSIGN(ThreadPoolIOBackend)
+
+  auto Submit(const std::vector<IORequest> &requests) -> std::vector<std::future<void>> override;
+
+  [[nodiscard]] auto GetName() const -> const char * override { return "thread pool"; }
+
+private:
+  void WorkerLoop();
+
+  struct Task
+  {
+    IORequest          request_;
+    std::promise<void> promise_;
+  };
+
+  std::mutex               latch_;
+  std::condition_variable  cv_;
+  std::deque<Task>         tasks_;
+  bool                     stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_IO_BACKEND_H
@@ -0,0 +1,407 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "column_codec.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "expr/compare_kernel.h"
+
+namespace njudb {
+
+static auto ReadU16(const char *src) -> uint16_t
+{
+  uint16_t v;
+  memcpy(&v, src, sizeof(uint16_t));
+  return v;
+}
+
+static void AppendBytes(std::vector<char> &out, const void *src, size_t n)
+{
+  out.insert(out.end(), static_cast<const char *>(src), static_cast<const char *>(src) + n);
+}
+
+static void AppendU16(std::vector<char> &out, size_t v)
+{
+  auto u16 = static_cast<uint16_t>(v);
+  AppendBytes(out, &u16, sizeof(uint16_t));
+}
+
+/**
+ * Append the codes packed in width bits each
+ */
+static void AppendPacked(std::vector<char> &out, const std::vector<uint32_t> &codes, uint8_t width)
+{
+  auto begin = out.size();
+  out.resize(begin + (codes.size() * width + 7) / 8, 0);
+  auto *dst = reinterpret_cast<uint8_t *>(out.data() + begin);
+  for (size_t i = 0; i < codes.size(); i++) {
+    uint64_t bits = codes[i];
+    size_t   bit  = i * width;
+    for (size_t done = 0; done < width; done += 8 - (bit + done) % 8) {
+      dst[(bit + done) / 8] |= static_cast<uint8_t>((bits >> done) << ((bit + done) % 8));
+    }
+  }
+}
+
+static auto ReadPacked(const char *src, size_t idx, uint8_t width) -> uint32_t
+{
+  if (width == 0) {
+    return 0;
+  }
+  size_t   bit   = idx * width;
+  size_t   first = bit / 8;
+  size_t   last  = (bit + width + 7) / 8;
+  uint64_t v     = 0;
+  for (size_t b = first; b < last; b++) {
+    v |= static_cast<uint64_t>(static_cast<uint8_t>(src[b])) << (8 * (b - first));
+  }
+  return static_cast<uint32_t>((v >> (bit % 8)) & ((uint64_t{1} << width) - 1));
+}
+
+static void EncodePlain(size_t size, const char *values, const std::vector<bool> &nulls, std::vector<char> &out)
+{
+  auto begin = out.size();
+  out.resize(begin + nulls.size() * size, 0);
+  for (size_t i = 0; i < nulls.size(); i++) {
+    if (!nulls[i]) {
+      memcpy(out.data() + begin + i * size, values + i * size, size);
+    }
+  }
+}
+
+// | dict num | dict entries | code width | codes |
+static auto EncodeDict(size_t size, const char *values, const std::vector<bool> &nulls, std::vector<char> &out) -> bool
+{
+  std::unordered_map<std::string, uint32_t> dict;
+  std::vector<uint32_t>                     codes(nulls.size(), 0);
+  std::vector<size_t>                       entries;
+  for (size_t i = 0; i < nulls.size(); i++) {
+    if (nulls[i]) {
+      continue;
+    }
+    auto [it, inserted] = dict.try_emplace(std::string(values + i * size, size), static_cast<uint32_t>(dict.size()));
+    if (inserted) {
+      entries.push_back(i);
+    }
+    codes[i] = it->second;
+  }
+  if (dict.size() > UINT16_MAX) {
+    return false;
+  }
+  auto width = static_cast<uint8_t>(std::bit_width(dict.empty() ? 0 : dict.size() - 1));
+  AppendU16(out, dict.size());
+  for (auto i : entries) {
+    AppendBytes(out, values + i * size, size);
+  }
+  AppendBytes(out, &width, sizeof(uint8_t));
+  AppendPacked(out, codes, width);
+  return true;
+}
+
+// | base | offset width | offsets |
+static void EncodeFrameOfRef(const char *values, const std::vector<bool> &nulls, std::vector<char> &out)
+{
+  int32_t min = 0;
+  int32_t max = 0;
+  bool    any = false;
+  for (size_t i = 0; i < nulls.size(); i++) {
+    if (nulls[i]) {
+      continue;
+    }
+    int32_t v;
+    memcpy(&v, values + i * sizeof(int32_t), sizeof(int32_t));
+    min = any ? std::min(min, v) : v;
+    max = any ? std::max(max, v) : v;
+    any = true;
+  }
+  std::vector<uint32_t> offsets(nulls.size(), 0);
+  for (size_t i = 0; i < nulls.size(); i++) {
+    if (!nulls[i]) {
+      int32_t v;
+      memcpy(&v, values + i * sizeof(int32_t), sizeof(int32_t));
+      offsets[i] = static_cast<uint32_t>(static_cast<int64_t>(v) - min);
+    }
+  }
+  auto width = static_cast<uint8_t>(std::bit_width(static_cast<uint64_t>(static_cast<int64_t>(max) - min)));
+  AppendBytes(out, &min, sizeof(int32_t));
+  AppendBytes(out, &width, sizeof(uint8_t));
+  AppendPacked(out, offsets, width);
+}
+
+// | run num | run length, run value | ... |, a null value extends the run before it
+static void EncodeRunLength(size_t size, const char *values, const std::vector<bool> &nulls, std::vector<char> &out)
+{
+  std::vector<std::pair<size_t, size_t>> runs;  // length and position of the value
+  for (size_t i = 0; i < nulls.size(); i++) {
+    bool extend = !runs.empty() && runs.back().first < UINT16_MAX &&
+                  (nulls[i] || memcmp(values + runs.back().second * size, values + i * size, size) == 0);
+    if (extend) {
+      runs.back().first++;
+    } else {
+      runs.emplace_back(1, i);
+    }
+  }
+  AppendU16(out, runs.size());
+  std::vector<char> zeros(size, 0);
+  for (auto &[len, pos] : runs) {
+    AppendU16(out, len);
+    AppendBytes(out, nulls[pos] ? zeros.data() : values + pos * size, size);
+  }
+}
+
+void ColumnEncoder::Encode(
+    FieldType type, size_t size, const char *values, const std::vector<bool> &nulls, std::vector<char> &out)
+{
+  NJUDB_ASSERT(nulls.size() <= UINT16_MAX, fmt::format("too many values: {}", nulls.size()));
+  // encode the column in every applicable encoding and keep the smallest one
+  std::vector<std::pair<ColumnEncoding, std::vector<char>>> candidates;
+  candidates.emplace_back(kPlain, std::vector<char>());
+  EncodePlain(size, values, nulls, candidates.back().second);
+  candidates.emplace_back(kRunLength, std::vector<char>());
+  EncodeRunLength(size, values, nulls, candidates.back().second);
+  if (type == TYPE_STRING) {
+    candidates.emplace_back(kDict, std::vector<char>());
+    if (!EncodeDict(size, values, nulls, candidates.back().second)) {
+      candidates.pop_back();
+    }
+  } else if (type == TYPE_INT) {
+    candidates.emplace_back(kFrameOfRef, std::vector<char>());
+    EncodeFrameOfRef(values, nulls, candidates.back().second);
+  }
+  auto &best = *std::min_element(candidates.begin(), candidates.end(),
+      [](const auto &a, const auto &b) { return a.second.size() < b.second.size(); });
+
+  out.push_back(static_cast<char>(best.first));
+  std::vector<uint16_t> null_runs{0};
+  for (size_t i = 0; i < nulls.size(); i++) {
+    // a run of the other kind begins, or the run is too long for its length
+    if (nulls[i] != (null_runs.size() % 2 == 0) || null_runs.back() == UINT16_MAX) {
+      if (null_runs.back() == UINT16_MAX) {
+        null_runs.push_back(0);
+      }
+      null_runs.push_back(0);
+    }
+    null_runs.back()++;
+  }
+  AppendU16(out, null_runs.size());
+  AppendBytes(out, null_runs.data(), null_runs.size() * sizeof(uint16_t));
+  out.insert(out.end(), best.second.begin(), best.second.end());
+}
+
+ColumnReader::ColumnReader(FieldType type, size_t size, size_t n, const char *src)
+    : type_(type), size_(size), n_(n), encoding_(static_cast<ColumnEncoding>(src[0])), nulls_(n, false)
+{
+  const char *cursor  = src + sizeof(uint8_t);
+  auto        run_num = ReadU16(cursor);
+  size_t      idx     = 0;
+  cursor += sizeof(uint16_t);
+  for (size_t r = 0; r < run_num; r++) {
+    auto len = ReadU16(cursor + r * sizeof(uint16_t));
+    if (r % 2 == 1) {
+      std::fill(nulls_.begin() + idx, nulls_.begin() + idx + len, true);
+    }
+    idx += len;
+  }
+  NJUDB_ASSERT(idx == n, fmt::format("null runs cover {} of {} values", idx, n));
+  payload_ = cursor + run_num * sizeof(uint16_t);
+
+  size_t payload_size = 0;
+  switch (encoding_) {
+    case kPlain: payload_size = n * size; break;
+    case kDict: {
+      auto dict_num = ReadU16(payload_);
+      dict_         = payload_ + sizeof(uint16_t);
+      width_        = static_cast<uint8_t>(dict_[dict_num * size]);
+      codes_        = dict_ + dict_num * size + sizeof(uint8_t);
+      payload_size  = static_cast<size_t>(codes_ - payload_) + (n * width_ + 7) / 8;
+      break;
+    }
+    case kFrameOfRef: {
+      memcpy(&base_, payload_, sizeof(int32_t));
+      width_       = static_cast<uint8_t>(payload_[sizeof(int32_t)]);
+      codes_       = payload_ + sizeof(int32_t) + sizeof(uint8_t);
+      payload_size = static_cast<size_t>(codes_ - payload_) + (n * width_ + 7) / 8;
+      break;
+    }
+    case kRunLength: {
+      auto value_run_num = ReadU16(payload_);
+      run_ends_.reserve(value_run_num);
+      for (size_t r = 0; r < value_run_num; r++) {
+        auto len = ReadU16(payload_ + sizeof(uint16_t) + r * (sizeof(uint16_t) + size));
+        run_ends_.push_back((run_ends_.empty() ? 0 : run_ends_.back()) + len);
+      }
+      payload_size = sizeof(uint16_t) + value_run_num * (sizeof(uint16_t) + size);
+      break;
+    }
+    default: NJUDB_FATAL(fmt::format("unknown column encoding {}", static_cast<int>(encoding_)));
+  }
+  encoded_size_ = static_cast<size_t>(payload_ - src) + payload_size;
+}
+
+auto ColumnReader::Code(size_t idx) const -> uint32_t { return ReadPacked(codes_, idx, width_); }
+
+auto ColumnReader::RunValue(size_t run) const -> const char *
+{
+  return payload_ + sizeof(uint16_t) + run * (sizeof(uint16_t) + size_) + sizeof(uint16_t);
+}
+
+void ColumnReader::Get(size_t idx, char *dst) const
+{
+  NJUDB_ASSERT(idx < n_, "index out of range");
+  switch (encoding_) {
+    case kPlain: memcpy(dst, payload_ + idx * size_, size_); break;
+    case kDict: memcpy(dst, dict_ + Code(idx) * size_, size_); break;
+    case kFrameOfRef: {
+      auto v = static_cast<int32_t>(static_cast<int64_t>(base_) + Code(idx));
+      memcpy(dst, &v, sizeof(int32_t));
+      break;
+    }
+    case kRunLength: {
+      auto run = std::upper_bound(run_ends_.begin(), run_ends_.end(), idx) - run_ends_.begin();
+      memcpy(dst, RunValue(run), size_);
+      break;
+    }
+  }
+}
+
+auto ColumnReader::GetValue(size_t idx) const -> ValueSptr
+{
+  if (nulls_[idx]) {
+    return ValueFactory::CreateNullValue(type_);
+  }
+  // one more byte to terminate strings that fill the field
+  std::vector<char> buf(size_ + 1, 0);
+  Get(idx, buf.data());
+  return ValueFactory::CreateValue(type_, buf.data(), size_);
+}
+
+template <typename T>
+static auto Compare(CompOp op, T lhs, T rhs) -> bool
+{
+  switch (op) {
+    case OP_EQ: return lhs == rhs;
+    case OP_NE: return lhs != rhs;
+    case OP_LT: return lhs < rhs;
+    case OP_GT: return lhs > rhs;
+    case OP_LE: return lhs <= rhs;
+    case OP_GE: return lhs >= rhs;
+    default: NJUDB_THROW(NJUDB_UNSUPPORTED_OP, fmt::format("{}", CompOpToString(op)));
+  }
+}
+
+void ColumnReader::Select(CompOp op, const ValueSptr &rhs, std::vector<bool> &sel) const
+{
+  NJUDB_ASSERT(sel.size() == n_, fmt::format("selection size {} != {}", sel.size(), n_));
+  if (rhs->IsNull()) {
+    for (size_t i = 0; i < n_; i++) {
+      sel[i] = sel[i] && CompOpOnNull(op, nulls_[i], true);
+    }
+    return;
+  }
+  // a null value is compared with a value that is not null
+  bool null_match = CompOpOnNull(op, true, false);
+  switch (encoding_) {
+    case kDict: {
+      // evaluate the predicate once for each distinct value
+      auto              dict_num = ReadU16(payload_);
+      std::vector<bool> match(dict_num);
+      std::vector<char> buf(size_ + 1, 0);
+      for (size_t c = 0; c < dict_num; c++) {
+        memcpy(buf.data(), dict_ + c * size_, size_);
+        match[c] = EvalCompOp(op, ValueFactory::CreateValue(type_, buf.data(), size_), rhs);
+      }
+      for (size_t i = 0; i < n_; i++) {
+        sel[i] = sel[i] && (nulls_[i] ? null_match : match[Code(i)]);
+      }
+      return;
+    }
+    case kRunLength: {
+      // evaluate the predicate once for each run
+      std::vector<char> buf(size_ + 1, 0);
+      size_t            begin = 0;
+      for (size_t run = 0; run < run_ends_.size(); run++) {
+        memcpy(buf.data(), RunValue(run), size_);
+        bool match = EvalCompOp(op, ValueFactory::CreateValue(type_, buf.data(), size_), rhs);
+        for (size_t i = begin; i < run_ends_[run]; i++) {
+          sel[i] = sel[i] && (nulls_[i] ? null_match : match);
+        }
+        begin = run_ends_[run];
+      }
+      return;
+    }
+    case kPlain: {
+      // the values are compared in place by the SIMD kernels
+      std::vector<uint64_t> bitmap((n_ + 63) / 64);
+      auto                  rtype = rhs->GetType();
+      if (type_ == TYPE_INT && rtype == TYPE_INT) {
+        CompareKernel::CompareInt(op, payload_, n_, std::dynamic_pointer_cast<IntValue>(rhs)->Get(), bitmap.data());
+      } else if (type_ == TYPE_FLOAT && (rtype == TYPE_INT || rtype == TYPE_FLOAT)) {
+        auto value = std::dynamic_pointer_cast<FloatValue>(ValueFactory::CastTo(rhs, TYPE_FLOAT))->Get();
+        CompareKernel::CompareFloat(op, payload_, n_, value, bitmap.data());
+      } else if (type_ == TYPE_STRING && rtype == TYPE_STRING &&
+                 std::dynamic_pointer_cast<StringValue>(rhs)->Get().size() <= size_) {
+        std::string value = std::dynamic_pointer_cast<StringValue>(rhs)->Get();
+        value.resize(size_, '\0');
+        CompareKernel::CompareChar(op, payload_, size_, n_, value.data(), bitmap.data());
+      } else {
+        break;
+      }
+      for (size_t i = 0; i < n_; i++) {
+        sel[i] = sel[i] && (nulls_[i] ? null_match : ((bitmap[i / 64] >> (i % 64)) & 1) != 0);
+      }
+      return;
+    }
+    case kFrameOfRef:
+      if (rhs->GetType() == TYPE_INT) {
+        // compare the offsets with the offset of the constant, the values are never rebuilt
+        auto target = static_cast<int64_t>(std::dynamic_pointer_cast<IntValue>(rhs)->Get()) - base_;
+        for (size_t i = 0; i < n_; i++) {
+          sel[i] = sel[i] && (nulls_[i] ? null_match : Compare<int64_t>(op, Code(i), target));
+        }
+        return;
+      }
+      break;
+    default: break;
+  }
+  for (size_t i = 0; i < n_; i++) {
+    sel[i] = sel[i] && (nulls_[i] ? null_match : EvalCompOp(op, GetValue(i), rhs));
+  }
+}
+
+auto EvalCompOp(CompOp op, ValueSptr lhs, ValueSptr rhs) -> bool
+{
+  if (lhs->IsNull() || rhs->IsNull()) {
+    return CompOpOnNull(op, lhs->IsNull(), rhs->IsNull());
+  }
+  ValueFactory::AlignTypes(lhs, rhs);
+  switch (op) {
+    case OP_EQ: return *lhs == *rhs;
+    case OP_NE: return *lhs != *rhs;
+    case OP_LT: return *lhs < *rhs;
+    case OP_GT: return *lhs > *rhs;
+    case OP_LE: return *lhs <= *rhs;
+    case OP_GE: return *lhs >= *rhs;
+    default: NJUDB_THROW(NJUDB_UNSUPPORTED_OP, fmt::format("{}", CompOpToString(op)));
+  }
+}
+
+}  // namespace njudb
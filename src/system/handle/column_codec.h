@@ -0,0 +1,125 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_COLUMN_CODEC_H
+#define NJUDB_COLUMN_CODEC_H
+
+#include <cstdint>
+#include <vector>
+
+#include "common/value.h"
+
+namespace njudb {
+
+/**
+ * Page-level encodings of a column in a compressed PAX page
+ * kPlain: the values at full width
+ * kDict: a dictionary of the distinct values and a bit-packed code for every value, for low-cardinality strings
+ * kFrameOfRef: the minimum of the values and a bit-packed offset from it for every value, for integers
+ * kRunLength: runs of equal values, for booleans and sorted or repetitive columns
+ */
+enum ColumnEncoding : uint8_t
+{
+  kPlain = 0,
+  kDict,
+  kFrameOfRef,
+  kRunLength
+};
+
+/**
+ * Encode the n values of a column, an encoded column is
+ * | encoding | null runs | payload |
+ * null runs are the lengths of the runs of non-null and null values in turn, starting with a run of non-null values.
+ * The smallest encoding that applies to the column type is chosen, null values do not take part in the choice.
+ */
+class ColumnEncoder
+{
+public:
+  ColumnEncoder() = delete;
+  DISABLE_COPY_MOVE_AND_ASSIGN(ColumnEncoder);
+
+  /**
+   * @param type
+   * @param size field size
+   * @param values n values of size bytes each
+   * @param nulls null flag of every value
+   * @param out the encoded column is appended to it
+   */
+  static void Encode(FieldType type, size_t size, const char *values, const std::vector<bool> &nulls,
+      std::vector<char> &out);
+};
+
+/**
+ * Read an encoded column in place, values are accessed by position without decoding the whole column and predicates
+ * are evaluated on the encoded values: once per dictionary entry or run, and on the offsets for frame of reference
+ */
+class ColumnReader
+{
+public:
+  ColumnReader(FieldType type, size_t size, size_t n, const char *src);
+
+  /**
+   * @return bytes of the encoded column
+   */
+  [[nodiscard]] auto GetEncodedSize() const -> size_t { return encoded_size_; }
+
+  [[nodiscard]] auto GetEncoding() const -> ColumnEncoding { return encoding_; }
+
+  [[nodiscard]] auto IsNull(size_t idx) const -> bool { return nulls_[idx]; }
+
+  /**
+   * Copy the value at idx to dst, size bytes are written
+   */
+  void Get(size_t idx, char *dst) const;
+
+  [[nodiscard]] auto GetValue(size_t idx) const -> ValueSptr;
+
+  /**
+   * Unset the positions in sel whose value does not satisfy "value op rhs", nulls compare as in CompOpOnNull
+   * @param op one of OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE
+   * @param rhs
+   * @param sel one flag for each value
+   */
+  void Select(CompOp op, const ValueSptr &rhs, std::vector<bool> &sel) const;
+
+private:
+  [[nodiscard]] auto Code(size_t idx) const -> uint32_t;
+
+  [[nodiscard]] auto RunValue(size_t run) const -> const char *;
+
+  FieldType             type_;
+  size_t                size_;
+  size_t                n_;
+  ColumnEncoding        encoding_;
+  std::vector<bool>     nulls_;
+  size_t                encoded_size_{0};
+  const char           *payload_{nullptr};
+  const char           *dict_{nullptr};   // dictionary entries
+  int32_t               base_{0};         // frame of reference
+  uint8_t               width_{0};        // bits of a dictionary code or an offset
+  const char           *codes_{nullptr};  // packed dictionary codes or offsets
+  std::vector<uint32_t> run_ends_;        // end position of every run
+};
+
+/**
+ * @return whether "lhs op rhs" holds, int and float are compared as float, nulls compare as in CompOpOnNull
+ */
+auto EvalCompOp(CompOp op, ValueSptr lhs, ValueSptr rhs) -> bool;
+
+}  // namespace njudb
+
+#endif  // NJUDB_COLUMN_CODEC_H
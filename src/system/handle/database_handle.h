@@ -66,6 +66,8 @@ public:
 
   auto GetAllTables() -> std::unordered_map<table_id_t, std::unique_ptr<TableHandle>> & { return tables_; }
 
+  [[nodiscard]] auto GetBufferPoolManager() const -> BufferPoolManager * { return tbl_mgr_->GetBufferPoolManager(); }
+
   ~DatabaseHandle() = default;
 
 public:
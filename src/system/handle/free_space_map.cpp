@@ -0,0 +1,110 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "free_space_map.h"
+
+#include <bit>
+
+namespace njudb {
+
+static constexpr size_t WORD_BITS = 64;
+
+FreeSpaceMap::FreeSpaceMap(size_t capacity) : capacity_(capacity) {}
+
+void FreeSpaceMap::Update(page_id_t page_id, size_t used)
+{
+  std::scoped_lock lock(latch_);
+  auto             idx = static_cast<size_t>(page_id);
+  if (idx >= page_num_) {
+    page_num_ = idx + 1;
+    free_.resize((page_num_ + WORD_BITS - 1) / WORD_BITS, 0);
+    roomy_.resize(free_.size(), 0);
+    space_.resize(page_num_, 0);
+  }
+  bool was_free  = (free_[idx / WORD_BITS] >> (idx % WORD_BITS) & 1) != 0;
+  bool was_roomy = (roomy_[idx / WORD_BITS] >> (idx % WORD_BITS) & 1) != 0;
+  bool is_free   = used < capacity_;
+  bool is_roomy  = used * 2 <= capacity_;
+  space_[idx]    = is_free ? capacity_ - used : 0;
+  SetBit(free_, idx, is_free);
+  SetBit(roomy_, idx, is_roomy);
+  free_num_  = free_num_ + is_free - was_free;
+  roomy_num_ = roomy_num_ + is_roomy - was_roomy;
+}
+
+auto FreeSpaceMap::FindPage(size_t hint, size_t need) -> page_id_t
+{
+  std::scoped_lock lock(latch_);
+  if (free_num_ == 0) {
+    return INVALID_PAGE_ID;
+  }
+  auto start = hint % page_num_;
+  if (roomy_num_ > 0 && need * 2 <= capacity_) {
+    // every roomy page has enough space
+    auto idx = FindSet(roomy_, start);
+    return idx == page_num_ ? INVALID_PAGE_ID : static_cast<page_id_t>(idx);
+  }
+  // visit the pages with free space one after another until one has enough
+  auto idx = start;
+  for (size_t visited = 0; visited < free_num_; visited++) {
+    idx = FindSet(free_, idx);
+    if (idx == page_num_) {
+      break;
+    }
+    if (space_[idx] >= need) {
+      return static_cast<page_id_t>(idx);
+    }
+    idx = (idx + 1) % page_num_;
+  }
+  return INVALID_PAGE_ID;
+}
+
+auto FreeSpaceMap::GetPageNum() -> size_t
+{
+  std::scoped_lock lock(latch_);
+  return page_num_;
+}
+
+auto FreeSpaceMap::FindSet(const std::vector<uint64_t> &bits, size_t start) const -> size_t
+{
+  // skip the words with no bit set, the bits before start in the first word are visited again at the end
+  auto word_num = bits.size();
+  for (size_t i = 0; i <= word_num; i++) {
+    auto w    = (start / WORD_BITS + i) % word_num;
+    auto word = bits[w];
+    if (i == 0) {
+      word &= ~uint64_t{0} << (start % WORD_BITS);
+    }
+    if (word != 0) {
+      auto idx = w * WORD_BITS + static_cast<size_t>(std::countr_zero(word));
+      // bits beyond page_num_ are never set
+      return idx;
+    }
+  }
+  return page_num_;
+}
+
+void FreeSpaceMap::SetBit(std::vector<uint64_t> &bits, size_t idx, bool value)
+{
+  if (value) {
+    bits[idx / WORD_BITS] |= uint64_t{1} << (idx % WORD_BITS);
+  } else {
+    bits[idx / WORD_BITS] &= ~(uint64_t{1} << (idx % WORD_BITS));
+  }
+}
+
+}  // namespace njudb
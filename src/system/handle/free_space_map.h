@@ -0,0 +1,83 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_FREE_SPACE_MAP_H
+#define NJUDB_FREE_SPACE_MAP_H
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "common/types.h"
+
+namespace njudb {
+
+/**
+ * Free space map of a heap table, it records how full every data page is so that an insert finds a page with an empty
+ * slot without following a chain of free pages. The space of a page is counted in slots for fixed-length records and
+ * in bytes for slotted pages. Two bitmaps are kept over the pages: pages with free space and roomy pages, which have
+ * at least half of the space free. A search takes roomy pages first and starts from a position chosen by the caller,
+ * so concurrent inserters spread over different pages and nearly full pages left by deletes are only used once there
+ * is no roomier page.
+ */
+class FreeSpaceMap
+{
+public:
+  explicit FreeSpaceMap(size_t capacity);
+
+  /**
+   * Record the space used in the page, the map grows to cover the page
+   * @param page_id
+   * @param used number of records, or bytes for slotted pages
+   */
+  void Update(page_id_t page_id, size_t used);
+
+  /**
+   * Find a page with enough free space
+   * @param hint the search starts from page hint % number of pages and wraps around
+   * @param need the free space required
+   * @return the page id, INVALID_PAGE_ID if no page has enough space
+   */
+  auto FindPage(size_t hint = 0, size_t need = 1) -> page_id_t;
+
+  /**
+   * @return the number of pages covered by the map
+   */
+  auto GetPageNum() -> size_t;
+
+  [[nodiscard]] auto GetCapacity() const -> size_t { return capacity_; }
+
+private:
+  /**
+   * @return the first set bit at or after start, wrapping around, page_num_ if there is none
+   */
+  auto FindSet(const std::vector<uint64_t> &bits, size_t start) const -> size_t;
+
+  static void SetBit(std::vector<uint64_t> &bits, size_t idx, bool value);
+
+  std::mutex            latch_;
+  size_t                capacity_;
+  size_t                page_num_{0};
+  size_t                free_num_{0};   // pages with free space
+  size_t                roomy_num_{0};  // pages with at least half of the space free
+  std::vector<uint64_t> free_;
+  std::vector<uint64_t> roomy_;
+  std::vector<size_t>   space_;  // free space of every page
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_FREE_SPACE_MAP_H
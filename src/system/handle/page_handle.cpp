@@ -20,8 +20,13 @@
 //
 
 #include "page_handle.h"
+
+#include <algorithm>
+
 #include "../../../common/error.h"
 #include "storage/buffer/buffer_pool_manager.h"
+#include "storage/buffer/page_guard.h"
+#include "storage/disk/disk_manager.h"
 
 namespace njudb {
 PageHandle::PageHandle(const TableHeader *tab_hdr, Page *page, char *bit_map, char *slots_mem)
@@ -92,4 +97,603 @@ auto PAXPageHandle::ReadChunk(const RecordSchema *chunk_schema) -> ChunkUptr
   NJUDB_STUDENT_TODO(l1, f2);
   return std::make_unique<Chunk>(chunk_schema, std::move(col_arrs));
 }
+
+/// slotted page
+static_assert(PAGE_SIZE <= UINT16_MAX, "offsets in a slotted page are 2 bytes");
+// slot num and heap begin
+static constexpr size_t SLOT_HEADER_SIZE = 2 * sizeof(uint16_t);
+// offset and length of a record
+static constexpr size_t SLOT_ENTRY_SIZE = 2 * sizeof(uint16_t);
+// heap begin of an overflow page, never the heap begin of a slotted page
+static constexpr uint16_t OVERFLOW_PAGE_MARK = 1;
+// length of a VARCHAR value moved to overflow pages, followed by the first overflow page and the actual length
+static constexpr uint16_t VARCHAR_OVERFLOW  = UINT16_MAX;
+static constexpr size_t   OVERFLOW_REF_SIZE = sizeof(uint16_t) + sizeof(page_id_t) + sizeof(uint32_t);
+
+// the slot header follows the bitmap and is aligned to 2 bytes
+static auto SlotHeaderOffset(const TableHeader *tab_hdr) -> size_t
+{
+  return (PAGE_HEADER_SIZE + tab_hdr->bitmap_size_ + 1) & ~size_t{1};
+}
+
+// every record keeps at least the space of its values moved to overflow pages (a value that stays inline is not longer
+// than its overflow reference), so that an update always fits in the space of the record it replaces
+static auto ReservedSize(const RecordSchema *schema) -> size_t
+{
+  return BITMAP_SIZE(schema->GetFieldCount()) + schema->GetFixedLength() +
+         schema->GetVarFieldCount() * OVERFLOW_REF_SIZE;
+}
+
+PageAllocator::PageAllocator(DiskManager *disk_manager, file_id_t fid, TableHeader *tab_hdr)
+    : disk_manager_(disk_manager), fid_(fid), tab_hdr_(tab_hdr)
+{}
+
+auto PageAllocator::AllocatePage() -> page_id_t
+{
+  std::scoped_lock lock(latch_);
+  return disk_manager_->AllocatePage(fid_, tab_hdr_->page_num_, tab_hdr_->extent_end_);
+}
+
+OverflowStore::OverflowStore(
+    BufferPoolManager *buffer_pool_manager, PageAllocator *allocator, file_id_t fid, TableHeader *tab_hdr)
+    : buffer_pool_manager_(buffer_pool_manager), allocator_(allocator), fid_(fid), tab_hdr_(tab_hdr)
+{}
+
+auto OverflowStore::GetPageCapacity() const -> size_t
+{
+  return PAGE_SIZE - SlotHeaderOffset(tab_hdr_) - SLOT_HEADER_SIZE - sizeof(uint32_t);
+}
+
+auto OverflowStore::Write(const char *data, size_t size) -> page_id_t
+{
+  std::scoped_lock lock(latch_);
+  auto             capacity = GetPageCapacity();
+  auto             page_ids = std::vector<page_id_t>(std::max<size_t>(1, (size + capacity - 1) / capacity));
+  for (auto &page_id : page_ids) {
+    page_id = AllocatePage();
+  }
+  size_t written = 0;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    auto      guard = buffer_pool_manager_->FetchPageWrite(fid_, page_ids[i]);
+    auto     *dst   = guard.GetMutableData();
+    page_id_t next  = i + 1 < page_ids.size() ? page_ids[i + 1] : INVALID_PAGE_ID;
+    auto      len   = static_cast<uint32_t>(std::min(capacity, size - written));
+    auto      mark  = OVERFLOW_PAGE_MARK;
+    // an empty bitmap and no record, scans and inserts never visit the page
+    memset(dst, 0, PAGE_SIZE);
+    memcpy(dst + PAGE_NEXT_FREE_PAGE_ID_OFFSET, &next, sizeof(page_id_t));
+    dst += SlotHeaderOffset(tab_hdr_);
+    memcpy(dst + sizeof(uint16_t), &mark, sizeof(uint16_t));
+    memcpy(dst + SLOT_HEADER_SIZE, &len, sizeof(uint32_t));
+    memcpy(dst + SLOT_HEADER_SIZE + sizeof(uint32_t), data + written, len);
+    written += len;
+  }
+  return page_ids.front();
+}
+
+void OverflowStore::Read(page_id_t page_id, char *data, size_t size)
+{
+  size_t read = 0;
+  while (read < size) {
+    NJUDB_ASSERT(page_id != INVALID_PAGE_ID, fmt::format("overflow chain ends at {} of {} bytes", read, size));
+    auto        guard = buffer_pool_manager_->FetchPageRead(fid_, page_id);
+    const char *src   = guard.GetData();
+    uint32_t    len;
+    memcpy(&page_id, src + PAGE_NEXT_FREE_PAGE_ID_OFFSET, sizeof(page_id_t));
+    src += SlotHeaderOffset(tab_hdr_);
+    memcpy(&len, src + SLOT_HEADER_SIZE, sizeof(uint32_t));
+    len = std::min<uint32_t>(len, size - read);
+    memcpy(data + read, src + SLOT_HEADER_SIZE + sizeof(uint32_t), len);
+    read += len;
+  }
+}
+
+void OverflowStore::Free(page_id_t page_id)
+{
+  std::scoped_lock lock(latch_);
+  while (page_id != INVALID_PAGE_ID) {
+    auto      guard = buffer_pool_manager_->FetchPageWrite(fid_, page_id);
+    auto     *dst   = guard.GetMutableData();
+    page_id_t next;
+    memcpy(&next, dst + PAGE_NEXT_FREE_PAGE_ID_OFFSET, sizeof(page_id_t));
+    memcpy(dst + PAGE_NEXT_FREE_PAGE_ID_OFFSET, &tab_hdr_->free_overflow_page_, sizeof(page_id_t));
+    tab_hdr_->free_overflow_page_ = page_id;
+    page_id                       = next;
+  }
+}
+
+auto OverflowStore::AllocatePage() -> page_id_t
+{
+  auto page_id = tab_hdr_->free_overflow_page_;
+  if (page_id == INVALID_PAGE_ID) {
+    return allocator_->AllocatePage();
+  }
+  auto guard = buffer_pool_manager_->FetchPageRead(fid_, page_id);
+  memcpy(&tab_hdr_->free_overflow_page_, guard.GetData() + PAGE_NEXT_FREE_PAGE_ID_OFFSET, sizeof(page_id_t));
+  return page_id;
+}
+
+SlottedPageHandle::SlottedPageHandle(
+    const TableHeader *tab_hdr, Page *page, const RecordSchema *schema, OverflowStore *overflow)
+    : PageHandle(tab_hdr, page, page->GetData() + PAGE_HEADER_SIZE, page->GetData() + SlotHeaderOffset(tab_hdr)),
+      schema_(schema),
+      overflow_(overflow)
+{}
+
+void SlottedPageHandle::WriteSlot(size_t slot_id, const char *null_map, const char *data, bool update)
+{
+  NJUDB_ASSERT(slot_id < tab_hdr_->rec_per_page_, "slot_id out of range");
+  NJUDB_ASSERT(BitMap::GetBit(bitmap_, slot_id) == update, fmt::format("update: {}", update));
+  if (HeapBegin() == 0) {
+    // a fresh page
+    SlotNum()   = 0;
+    HeapBegin() = static_cast<uint16_t>(PAGE_SIZE);
+  }
+  // the space of the old record is reused by the update, and the directory grows to cover the slot
+  size_t slot_num    = std::max<size_t>(SlotNum(), slot_id + 1);
+  size_t avail       = GetFreeSpace() + (update ? SlotEntry(slot_id)[1] : 0);
+  size_t dir_grow    = (slot_num - SlotNum()) * SLOT_ENTRY_SIZE;
+  size_t inline_size = VARCHAR_INLINE_SIZE;
+  size_t reserved    = ReservedSize(schema_);
+  size_t size        = std::max(EncodedSize(schema_, null_map, data, inline_size), reserved);
+  if (size + dir_grow > avail) {
+    // keep only the values that are not longer than their overflow references in the page, the record then takes the
+    // reserved size, which an update always has
+    inline_size = OVERFLOW_REF_SIZE - sizeof(uint16_t);
+    size        = std::max(EncodedSize(schema_, null_map, data, inline_size), reserved);
+    if (size + dir_grow > avail) {
+      NJUDB_THROW(NJUDB_RECLEN_ERROR, fmt::format("record: {}, free space: {}", size + dir_grow, avail));
+    }
+  }
+  // the bytes beyond the encoded record are zeros
+  auto rec = std::make_unique<char[]>(size);
+  Encode(null_map, data, inline_size, rec.get());
+  if (update) {
+    auto *entry = SlotEntry(slot_id);
+    FreeOverflow(page_->GetData() + entry[0]);
+    entry[0] = 0;
+    entry[1] = 0;
+  }
+  auto dir_end = SlotHeaderOffset(tab_hdr_) + SLOT_HEADER_SIZE + slot_num * SLOT_ENTRY_SIZE;
+  if (HeapBegin() < dir_end + size) {
+    Compact();
+  }
+  for (size_t i = SlotNum(); i < slot_num; i++) {
+    SlotEntry(i)[0] = 0;
+    SlotEntry(i)[1] = 0;
+  }
+  SlotNum() = static_cast<uint16_t>(slot_num);
+  HeapBegin() -= static_cast<uint16_t>(size);
+  memcpy(page_->GetData() + HeapBegin(), rec.get(), size);
+  SlotEntry(slot_id)[0] = HeapBegin();
+  SlotEntry(slot_id)[1] = static_cast<uint16_t>(size);
+}
+
+void SlottedPageHandle::ReadSlot(size_t slot_id, char *null_map, char *data)
+{
+  NJUDB_ASSERT(slot_id < SlotNum(), "slot_id out of range");
+  NJUDB_ASSERT(BitMap::GetBit(bitmap_, slot_id) == true, "slot is empty");
+  Decode(page_->GetData() + SlotEntry(slot_id)[0], null_map, data);
+}
+
+auto SlottedPageHandle::ReadChunk(const RecordSchema *chunk_schema) -> ChunkUptr
+{
+  std::vector<ArrayValueSptr> col_arrs;
+  std::vector<size_t>         field_idx;
+  col_arrs.reserve(chunk_schema->GetFieldCount());
+  field_idx.reserve(chunk_schema->GetFieldCount());
+  for (const auto &field : chunk_schema->GetFields()) {
+    col_arrs.push_back(ValueFactory::CreateArrayValue());
+    field_idx.push_back(schema_->GetRTFieldIndex(field));
+  }
+  auto null_map = std::make_unique<char[]>(tab_hdr_->nullmap_size_);
+  auto data     = std::make_unique<char[]>(tab_hdr_->rec_size_);
+  for (size_t slot_id = 0; slot_id < SlotNum(); slot_id++) {
+    if (!BitMap::GetBit(bitmap_, slot_id)) {
+      continue;
+    }
+    ReadSlot(slot_id, null_map.get(), data.get());
+    Record record(schema_, null_map.get(), data.get(), INVALID_RID);
+    for (size_t i = 0; i < field_idx.size(); i++) {
+      col_arrs[i]->Append(record.GetValueAt(field_idx[i]));
+    }
+  }
+  return std::make_unique<Chunk>(chunk_schema, std::move(col_arrs));
+}
+
+void SlottedPageHandle::ClearSlot(size_t slot_id)
+{
+  NJUDB_ASSERT(slot_id < SlotNum(), "slot_id out of range");
+  auto *entry = SlotEntry(slot_id);
+  if (entry[1] > 0) {
+    FreeOverflow(page_->GetData() + entry[0]);
+  }
+  entry[0] = 0;
+  entry[1] = 0;
+  // empty slots at the end of the directory are given back to the free space
+  while (SlotNum() > 0 && SlotEntry(SlotNum() - 1)[1] == 0) {
+    SlotNum()--;
+  }
+}
+
+auto SlottedPageHandle::GetUsedSpace() -> size_t
+{
+  if (HeapBegin() == OVERFLOW_PAGE_MARK || page_->GetRecordNum() >= tab_hdr_->rec_per_page_) {
+    return GetCapacity(tab_hdr_);
+  }
+  return GetCapacity(tab_hdr_) - GetFreeSpace();
+}
+
+auto SlottedPageHandle::GetCapacity(const TableHeader *tab_hdr) -> size_t
+{
+  return PAGE_SIZE - SlotHeaderOffset(tab_hdr) - SLOT_HEADER_SIZE;
+}
+
+auto SlottedPageHandle::GetRecordSpace(const RecordSchema *schema, const char *null_map, const char *data) -> size_t
+{
+  return std::max(EncodedSize(schema, null_map, data, VARCHAR_INLINE_SIZE), ReservedSize(schema)) + SLOT_ENTRY_SIZE;
+}
+
+auto SlottedPageHandle::GetMinRecordSpace(const RecordSchema *schema) -> size_t
+{
+  return ReservedSize(schema) + SLOT_ENTRY_SIZE;
+}
+
+auto SlottedPageHandle::GetMaxRecordSpace(const RecordSchema *schema) -> size_t
+{
+  size_t size = BITMAP_SIZE(schema->GetFieldCount()) + schema->GetFixedLength();
+  for (size_t i = 0; i < schema->GetFieldCount(); i++) {
+    if (schema->IsVarField(i)) {
+      size += sizeof(uint16_t) + std::min(schema->GetFieldAt(i).field_.field_size_, VARCHAR_INLINE_SIZE);
+    }
+  }
+  return std::max(size, ReservedSize(schema)) + SLOT_ENTRY_SIZE;
+}
+
+auto SlottedPageHandle::GetMaxSlotNum(const RecordSchema *schema) -> size_t
+{
+  // n = slot num, PAGE_HDR_SIZE + BITMAP_SIZE(n) + 1 byte of alignment + SLOT_HEADER_SIZE + n * min_rec_space <= PAGE_SIZE
+  return (BITMAP_WIDTH * (PAGE_SIZE - PAGE_HEADER_SIZE - 1 - SLOT_HEADER_SIZE - 1) + 1) /
+         (1 + GetMinRecordSpace(schema) * BITMAP_WIDTH);
+}
+
+auto SlottedPageHandle::EncodedSize(
+    const RecordSchema *schema, const char *null_map, const char *data, size_t inline_size) -> size_t
+{
+  size_t size = BITMAP_SIZE(schema->GetFieldCount()) + schema->GetFixedLength();
+  for (size_t i = 0; i < schema->GetFieldCount(); i++) {
+    if (!schema->IsVarField(i)) {
+      continue;
+    }
+    size_t len = 0;
+    if (!BitMap::GetBit(null_map, i)) {
+      len = strnlen(data + schema->GetFieldOffset(i), schema->GetFieldAt(i).field_.field_size_);
+    }
+    size += len > inline_size ? OVERFLOW_REF_SIZE : sizeof(uint16_t) + len;
+  }
+  return size;
+}
+
+void SlottedPageHandle::Encode(const char *null_map, const char *data, size_t inline_size, char *dst)
+{
+  memcpy(dst, null_map, tab_hdr_->nullmap_size_);
+  dst += tab_hdr_->nullmap_size_;
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    if (!schema_->IsVarField(i)) {
+      memcpy(dst, data + schema_->GetFieldOffset(i), schema_->GetFieldAt(i).field_.field_size_);
+      dst += schema_->GetFieldAt(i).field_.field_size_;
+    }
+  }
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    if (!schema_->IsVarField(i)) {
+      continue;
+    }
+    const char *value = data + schema_->GetFieldOffset(i);
+    uint16_t    len   = 0;
+    if (!BitMap::GetBit(null_map, i)) {
+      len = static_cast<uint16_t>(strnlen(value, schema_->GetFieldAt(i).field_.field_size_));
+    }
+    if (len > inline_size) {
+      auto page_id  = overflow_->Write(value, len);
+      auto full_len = static_cast<uint32_t>(len);
+      memcpy(dst, &VARCHAR_OVERFLOW, sizeof(uint16_t));
+      memcpy(dst + sizeof(uint16_t), &page_id, sizeof(page_id_t));
+      memcpy(dst + sizeof(uint16_t) + sizeof(page_id_t), &full_len, sizeof(uint32_t));
+      dst += OVERFLOW_REF_SIZE;
+    } else {
+      memcpy(dst, &len, sizeof(uint16_t));
+      memcpy(dst + sizeof(uint16_t), value, len);
+      dst += sizeof(uint16_t) + len;
+    }
+  }
+}
+
+void SlottedPageHandle::Decode(const char *src, char *null_map, char *data)
+{
+  memcpy(null_map, src, tab_hdr_->nullmap_size_);
+  src += tab_hdr_->nullmap_size_;
+  memset(data, 0, tab_hdr_->rec_size_);
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    if (!schema_->IsVarField(i)) {
+      memcpy(data + schema_->GetFieldOffset(i), src, schema_->GetFieldAt(i).field_.field_size_);
+      src += schema_->GetFieldAt(i).field_.field_size_;
+    }
+  }
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    if (!schema_->IsVarField(i)) {
+      continue;
+    }
+    uint16_t len;
+    memcpy(&len, src, sizeof(uint16_t));
+    if (len == VARCHAR_OVERFLOW) {
+      page_id_t page_id;
+      uint32_t  full_len;
+      memcpy(&page_id, src + sizeof(uint16_t), sizeof(page_id_t));
+      memcpy(&full_len, src + sizeof(uint16_t) + sizeof(page_id_t), sizeof(uint32_t));
+      overflow_->Read(page_id, data + schema_->GetFieldOffset(i), full_len);
+      src += OVERFLOW_REF_SIZE;
+    } else {
+      memcpy(data + schema_->GetFieldOffset(i), src + sizeof(uint16_t), len);
+      src += sizeof(uint16_t) + len;
+    }
+  }
+}
+
+void SlottedPageHandle::FreeOverflow(const char *src)
+{
+  src += tab_hdr_->nullmap_size_ + schema_->GetFixedLength();
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    if (!schema_->IsVarField(i)) {
+      continue;
+    }
+    uint16_t len;
+    memcpy(&len, src, sizeof(uint16_t));
+    if (len == VARCHAR_OVERFLOW) {
+      page_id_t page_id;
+      memcpy(&page_id, src + sizeof(uint16_t), sizeof(page_id_t));
+      overflow_->Free(page_id);
+      src += OVERFLOW_REF_SIZE;
+    } else {
+      src += sizeof(uint16_t) + len;
+    }
+  }
+}
+
+void SlottedPageHandle::Compact()
+{
+  std::vector<uint16_t *> entries;
+  for (size_t i = 0; i < SlotNum(); i++) {
+    if (SlotEntry(i)[1] > 0) {
+      entries.push_back(SlotEntry(i));
+    }
+  }
+  // records are moved towards the end of the page one by one from the last one, so none is overwritten
+  std::sort(entries.begin(), entries.end(), [](const uint16_t *a, const uint16_t *b) { return a[0] > b[0]; });
+  size_t end = PAGE_SIZE;
+  for (auto *entry : entries) {
+    end -= entry[1];
+    memmove(page_->GetData() + end, page_->GetData() + entry[0], entry[1]);
+    entry[0] = static_cast<uint16_t>(end);
+  }
+  HeapBegin() = static_cast<uint16_t>(end);
+}
+
+auto SlottedPageHandle::GetFreeSpace() -> size_t
+{
+  size_t used = SlotNum() * SLOT_ENTRY_SIZE;
+  for (size_t i = 0; i < SlotNum(); i++) {
+    used += SlotEntry(i)[1];
+  }
+  return GetCapacity(tab_hdr_) - used;
+}
+
+auto SlottedPageHandle::SlotNum() -> uint16_t & { return *reinterpret_cast<uint16_t *>(slots_mem_); }
+
+auto SlottedPageHandle::HeapBegin() -> uint16_t &
+{
+  return *reinterpret_cast<uint16_t *>(slots_mem_ + sizeof(uint16_t));
+}
+
+auto SlottedPageHandle::SlotEntry(size_t slot_id) -> uint16_t *
+{
+  return reinterpret_cast<uint16_t *>(slots_mem_ + SLOT_HEADER_SIZE + slot_id * SLOT_ENTRY_SIZE);
+}
+
+/// compressed pax page
+CompressedPAXPageHandle::CompressedPAXPageHandle(const TableHeader *tab_hdr, Page *page, const RecordSchema *schema)
+    : PageHandle(tab_hdr, page, page->GetData() + PAGE_HEADER_SIZE, page->GetData() + SlotHeaderOffset(tab_hdr)),
+      schema_(schema)
+{}
+
+void CompressedPAXPageHandle::WriteSlot(size_t slot_id, const char *null_map, const char *data, bool update)
+{
+  NJUDB_ASSERT(slot_id < tab_hdr_->rec_per_page_, "slot_id out of range");
+  NJUDB_ASSERT(BitMap::GetBit(bitmap_, slot_id) == update, fmt::format("update: {}", update));
+  std::vector<std::vector<char>> values;
+  std::vector<std::vector<bool>> nulls;
+  Decode(values, nulls, tab_hdr_->rec_per_page_);
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    auto size         = schema_->GetFieldAt(i).field_.field_size_;
+    nulls[i][slot_id] = BitMap::GetBit(null_map, i);
+    memcpy(values[i].data() + slot_id * size, data + schema_->GetFieldOffset(i), size);
+  }
+  auto capacity = GetCapacity(tab_hdr_);
+  auto limit    = update ? capacity : capacity - std::min(capacity, COMPRESSED_PAX_RESERVE);
+  if (!Encode(values, nulls, limit)) {
+    NJUDB_THROW(NJUDB_RECLEN_ERROR, fmt::format("page {} is full", page_->GetPageId()));
+  }
+}
+
+void CompressedPAXPageHandle::ReadSlot(size_t slot_id, char *null_map, char *data)
+{
+  NJUDB_ASSERT(slot_id < tab_hdr_->rec_per_page_, "slot_id out of range");
+  NJUDB_ASSERT(BitMap::GetBit(bitmap_, slot_id) == true, "slot is empty");
+  auto readers = GetReaders();
+  NJUDB_ASSERT(!readers.empty(), "page is empty");
+  memset(null_map, 0, tab_hdr_->nullmap_size_);
+  memset(data, 0, tab_hdr_->rec_size_);
+  for (size_t i = 0; i < readers.size(); i++) {
+    if (readers[i].IsNull(slot_id)) {
+      BitMap::SetBit(null_map, i, true);
+    } else {
+      readers[i].Get(slot_id, data + schema_->GetFieldOffset(i));
+    }
+  }
+}
+
+auto CompressedPAXPageHandle::ReadChunk(const RecordSchema *chunk_schema) -> ChunkUptr
+{
+  return ReadChunk(chunk_schema, {});
+}
+
+auto CompressedPAXPageHandle::ReadChunk(const RecordSchema *chunk_schema, const ConditionVec &conds) -> ChunkUptr
+{
+  std::vector<ArrayValueSptr> col_arrs;
+  std::vector<size_t>         field_idx;
+  col_arrs.reserve(chunk_schema->GetFieldCount());
+  field_idx.reserve(chunk_schema->GetFieldCount());
+  for (const auto &field : chunk_schema->GetFields()) {
+    col_arrs.push_back(ValueFactory::CreateArrayValue());
+    field_idx.push_back(schema_->GetRTFieldIndex(field));
+  }
+  auto readers = GetReaders();
+  if (readers.empty()) {
+    return std::make_unique<Chunk>(chunk_schema, std::move(col_arrs));
+  }
+  auto sel = Select(readers, conds);
+  // only the selected values are decoded
+  for (size_t slot_id = 0; slot_id < sel.size(); slot_id++) {
+    if (!sel[slot_id]) {
+      continue;
+    }
+    for (size_t i = 0; i < field_idx.size(); i++) {
+      col_arrs[i]->Append(readers[field_idx[i]].GetValue(slot_id));
+    }
+  }
+  return std::make_unique<Chunk>(chunk_schema, std::move(col_arrs));
+}
+
+void CompressedPAXPageHandle::ReadVector(
+    const std::vector<size_t> &field_idx, const ConditionVec &conds, VectorChunk &chunk)
+{
+  NJUDB_ASSERT(field_idx.size() == chunk.GetColCount(), "Field count mismatch");
+  auto readers = GetReaders();
+  if (readers.empty()) {
+    return;
+  }
+  auto sel = Select(readers, conds);
+  // decode column by column, so that the reader of a column stays hot
+  for (size_t i = 0; i < field_idx.size(); i++) {
+    const auto &reader = readers[field_idx[i]];
+    auto       &col    = chunk.GetCol(i);
+    for (size_t slot_id = 0; slot_id < sel.size(); slot_id++) {
+      if (!sel[slot_id]) {
+        continue;
+      }
+      bool  is_null = reader.IsNull(slot_id);
+      char *dst     = col.AppendSlot(is_null);
+      if (!is_null) {
+        reader.Get(slot_id, dst);
+      }
+    }
+  }
+}
+
+void CompressedPAXPageHandle::ClearSlot(size_t slot_id)
+{
+  NJUDB_ASSERT(slot_id < tab_hdr_->rec_per_page_, "slot_id out of range");
+  std::vector<std::vector<char>> values;
+  std::vector<std::vector<bool>> nulls;
+  Decode(values, nulls, slot_id);
+  // dropping a value hardly ever takes more space, if it does the value is dropped by the next write of the page
+  Encode(values, nulls, GetCapacity(tab_hdr_));
+}
+
+auto CompressedPAXPageHandle::GetCapacity(const TableHeader *tab_hdr) -> size_t
+{
+  return PAGE_SIZE - SlotHeaderOffset(tab_hdr) - sizeof(uint16_t);
+}
+
+void CompressedPAXPageHandle::Decode(
+    std::vector<std::vector<char>> &values, std::vector<std::vector<bool>> &nulls, size_t dead_slot)
+{
+  auto slot_num = tab_hdr_->rec_per_page_;
+  auto readers  = GetReaders();
+  values.resize(schema_->GetFieldCount());
+  nulls.resize(schema_->GetFieldCount());
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    auto size = schema_->GetFieldAt(i).field_.field_size_;
+    values[i].assign(slot_num * size, 0);
+    nulls[i].assign(slot_num, true);
+    if (readers.empty()) {
+      continue;
+    }
+    for (size_t slot_id = 0; slot_id < slot_num; slot_id++) {
+      if (slot_id != dead_slot && BitMap::GetBit(bitmap_, slot_id) && !readers[i].IsNull(slot_id)) {
+        nulls[i][slot_id] = false;
+        readers[i].Get(slot_id, values[i].data() + slot_id * size);
+      }
+    }
+  }
+}
+
+auto CompressedPAXPageHandle::Encode(
+    const std::vector<std::vector<char>> &values, const std::vector<std::vector<bool>> &nulls, size_t limit) -> bool
+{
+  std::vector<char> encoded;
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    auto &field = schema_->GetFieldAt(i).field_;
+    ColumnEncoder::Encode(field.field_type_, field.field_size_, values[i].data(), nulls[i], encoded);
+    if (encoded.size() > limit) {
+      return false;
+    }
+  }
+  memcpy(slots_mem_ + sizeof(uint16_t), encoded.data(), encoded.size());
+  EncodedSize() = static_cast<uint16_t>(encoded.size());
+  return true;
+}
+
+auto CompressedPAXPageHandle::GetReaders() -> std::vector<ColumnReader>
+{
+  std::vector<ColumnReader> readers;
+  if (EncodedSize() == 0) {
+    return readers;
+  }
+  readers.reserve(schema_->GetFieldCount());
+  const char *src = slots_mem_ + sizeof(uint16_t);
+  for (const auto &field : schema_->GetFields()) {
+    readers.emplace_back(field.field_.field_type_, field.field_.field_size_, tab_hdr_->rec_per_page_, src);
+    src += readers.back().GetEncodedSize();
+  }
+  return readers;
+}
+
+auto CompressedPAXPageHandle::Select(const std::vector<ColumnReader> &readers, const ConditionVec &conds)
+    -> std::vector<bool>
+{
+  std::vector<bool> sel(tab_hdr_->rec_per_page_);
+  for (size_t slot_id = 0; slot_id < sel.size(); slot_id++) {
+    sel[slot_id] = BitMap::GetBit(bitmap_, slot_id);
+  }
+  for (const auto &cond : conds) {
+    auto lhs = schema_->GetRTFieldIndex(cond.GetLCol());
+    NJUDB_ASSERT(lhs < readers.size(), fmt::format("field {} not in table", cond.GetLCol().ToString()));
+    if (cond.GetRhsType() == kValue) {
+      readers[lhs].Select(cond.GetOp(), cond.GetRVal(), sel);
+      continue;
+    }
+    if (cond.GetRhsType() != kColumn) {
+      NJUDB_THROW(NJUDB_UNSUPPORTED_OP, cond.ToString());
+    }
+    auto rhs = schema_->GetRTFieldIndex(cond.GetRCol());
+    NJUDB_ASSERT(rhs < readers.size(), fmt::format("field {} not in table", cond.GetRCol().ToString()));
+    for (size_t slot_id = 0; slot_id < sel.size(); slot_id++) {
+      sel[slot_id] = sel[slot_id] &&
+                     EvalCompOp(cond.GetOp(), readers[lhs].GetValue(slot_id), readers[rhs].GetValue(slot_id));
+    }
+  }
+  return sel;
+}
+
+auto CompressedPAXPageHandle::EncodedSize() -> uint16_t & { return *reinterpret_cast<uint16_t *>(slots_mem_); }
 }  // namespace njudb
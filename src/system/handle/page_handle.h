@@ -22,11 +22,19 @@
 #ifndef NJUDB_PAGE_HANDLE_H
 #define NJUDB_PAGE_HANDLE_H
 
+#include <mutex>  // NOLINT
+
+#include "common/condition.h"
 #include "common/meta.h"
 #include "common/page.h"
 #include "common/record.h"
+#include "common/vector_chunk.h"
+#include "column_codec.h"
 
 namespace njudb {
+class DiskManager;
+class BufferPoolManager;
+
 class PageHandle
 {
 public:
@@ -47,6 +55,13 @@ public:
 
   virtual auto ReadChunk(const RecordSchema *chunk_schema) -> ChunkUptr;
 
+  /**
+   * Called before the record in the slot is deleted, page handles that pack the records release its space here, the
+   * bitmap is left to the caller
+   * @param slot_id
+   */
+  virtual void ClearSlot(size_t slot_id) {}
+
   virtual ~PageHandle() = default;
 
   [[nodiscard]] auto GetPage() -> Page * { return page_; }
@@ -103,6 +118,265 @@ private:
   const std::vector<size_t> &offsets_;
 };
 
+/**
+ * Allocates the pages of a table at the end of the file. The data pages and the overflow pages are both taken from it,
+ * so TableHeader::page_num_ and TableHeader::extent_end_ are only changed under its latch.
+ */
+class PageAllocator
+{
+public:
+  PageAllocator() = delete;
+
+  PageAllocator(DiskManager *disk_manager, file_id_t fid, TableHeader *tab_hdr);
+
+  /**
+   * @return a new page at the end of the file, see DiskManager::AllocatePage
+   */
+  auto AllocatePage() -> page_id_t;
+
+private:
+  DiskManager *disk_manager_;
+  file_id_t    fid_;
+  TableHeader *tab_hdr_;
+  std::mutex   latch_;
+};
+
+/**
+ * Overflow pages of a table with VARCHAR fields, they hold the values that are too long to stay in a slotted page. A
+ * value is written to a chain of pages linked by the next page id in the page header, every page is
+ * | page header | empty bitmap | OVERFLOW_PAGE_MARK | length | bytes |, the empty bitmap keeps the scans away from it.
+ * Freed pages are kept in a list headed by TableHeader::free_overflow_page_ and reused by later values.
+ */
+class OverflowStore
+{
+public:
+  OverflowStore() = delete;
+
+  OverflowStore(BufferPoolManager *buffer_pool_manager, PageAllocator *allocator, file_id_t fid, TableHeader *tab_hdr);
+
+  /**
+   * Write the value into a new chain of overflow pages
+   * @param data
+   * @param size
+   * @return the first page of the chain
+   */
+  auto Write(const char *data, size_t size) -> page_id_t;
+
+  /**
+   * Read the value stored in the chain
+   * @param page_id the first page of the chain
+   * @param data
+   * @param size
+   */
+  void Read(page_id_t page_id, char *data, size_t size);
+
+  /**
+   * Move the pages of the chain to the free list
+   * @param page_id the first page of the chain
+   */
+  void Free(page_id_t page_id);
+
+  /**
+   * @return the number of value bytes an overflow page holds
+   */
+  [[nodiscard]] auto GetPageCapacity() const -> size_t;
+
+private:
+  /**
+   * Take a page from the free list, or a new page from the allocator if the list is empty
+   */
+  auto AllocatePage() -> page_id_t;
+
+  BufferPoolManager *buffer_pool_manager_;
+  PageAllocator     *allocator_;
+  file_id_t          fid_;
+  TableHeader       *tab_hdr_;
+  std::mutex         latch_;  // guards the free list
+};
+
+/**
+ * Page handle of a table with VARCHAR fields, the records are stored at their actual lengths in a slotted page
+ * | page header | bitmap | slot num | heap begin | slot directory | free space | record heap |
+ * The slot directory grows from the front and keeps the offset and the length of the record in every slot, and the
+ * record heap grows from the end of the page. A record in the heap is
+ * | null map | fields that are not VARCHAR | VARCHAR field 1 | ... | VARCHAR field k |
+ * the fields that are not VARCHAR are stored at full width in schema order, followed by the VARCHAR values, each is
+ * a 2-byte length and the bytes. A value longer than VARCHAR_INLINE_SIZE is written to overflow pages and replaced by
+ * VARCHAR_OVERFLOW, the first overflow page and the length of the value. A record is padded to the size it has with
+ * all its VARCHAR values longer than the reference moved out, so that an update never has to leave its slot. Holes left
+ * by deleted and updated records are reclaimed by compacting the heap when the free space in the middle is not
+ * contiguous enough.
+ */
+class SlottedPageHandle : public PageHandle
+{
+public:
+  SlottedPageHandle() = delete;
+
+  SlottedPageHandle(const TableHeader *tab_hdr, Page *page, const RecordSchema *schema, OverflowStore *overflow);
+
+  /**
+   * Write a record to the slot, if the record does not fit in the page, all but the shortest VARCHAR values are moved
+   * to overflow pages. A record takes at least the space it needs in that form, so an update always fits in place, an
+   * insert throws NJUDB_RECLEN_ERROR if the record does not fit in the page.
+   */
+  void WriteSlot(size_t slot_id, const char *null_map, const char *data, bool update) override;
+
+  void ReadSlot(size_t slot_id, char *null_map, char *data) override;
+
+  auto ReadChunk(const RecordSchema *chunk_schema) -> ChunkUptr override;
+
+  /**
+   * Release the space of the record in the slot and the overflow pages of its values
+   */
+  void ClearSlot(size_t slot_id) override;
+
+  /**
+   * @return bytes used by the slot directory and the records, a full page for overflow pages
+   */
+  auto GetUsedSpace() -> size_t;
+
+  /**
+   * @return bytes of a page available to the slot directory and the records
+   */
+  static auto GetCapacity(const TableHeader *tab_hdr) -> size_t;
+
+  /**
+   * @return bytes needed to insert the record into a page, including its slot directory entry
+   */
+  static auto GetRecordSpace(const RecordSchema *schema, const char *null_map, const char *data) -> size_t;
+
+  /**
+   * @return bytes needed to insert the shortest record, which still keeps the space of its VARCHAR values moved to
+   * overflow pages
+   */
+  static auto GetMinRecordSpace(const RecordSchema *schema) -> size_t;
+
+  /**
+   * @return bytes needed to insert the longest record, the values longer than VARCHAR_INLINE_SIZE are not counted
+   * since they are moved to overflow pages
+   */
+  static auto GetMaxRecordSpace(const RecordSchema *schema) -> size_t;
+
+  /**
+   * @return the number of slots of a page, as many as the shortest records fill the page
+   */
+  static auto GetMaxSlotNum(const RecordSchema *schema) -> size_t;
+
+private:
+  /**
+   * @return the length of the record encoded with the values longer than inline_size moved to overflow pages
+   */
+  static auto EncodedSize(const RecordSchema *schema, const char *null_map, const char *data, size_t inline_size)
+      -> size_t;
+
+  void Encode(const char *null_map, const char *data, size_t inline_size, char *dst);
+
+  void Decode(const char *src, char *null_map, char *data);
+
+  /**
+   * Free the overflow pages referenced by the encoded record
+   */
+  void FreeOverflow(const char *src);
+
+  /**
+   * Move the records to the end of the page so that the free space is contiguous
+   */
+  void Compact();
+
+  auto GetFreeSpace() -> size_t;
+
+  auto SlotNum() -> uint16_t &;
+
+  auto HeapBegin() -> uint16_t &;
+
+  auto SlotEntry(size_t slot_id) -> uint16_t *;
+
+  const RecordSchema *schema_;
+  OverflowStore      *overflow_;
+};
+
+/**
+ * Page handle of the compressed PAX model, the columns of all slots are encoded one after another
+ * | page header | bitmap | encoded size | column 1 | ... | column m |
+ * every column is encoded by ColumnEncoder with the encoding that takes the least space, and the values of the empty
+ * slots are encoded as null. A page has COMPRESSED_PAX_SLOT_FACTOR times the slots of a PAX page, how many of them are
+ * used depends on how well the columns compress, WriteSlot throws NJUDB_RECLEN_ERROR when the page is full.
+ * Writing a slot encodes the whole page again, so the model trades write cost for pages that hold more records and
+ * scans that evaluate predicates on the encoded columns.
+ */
+class CompressedPAXPageHandle : public PageHandle
+{
+public:
+  CompressedPAXPageHandle() = delete;
+
+  CompressedPAXPageHandle(const TableHeader *tab_hdr, Page *page, const RecordSchema *schema);
+
+  /**
+   * Write a record to the slot, an insert fails unless COMPRESSED_PAX_RESERVE bytes of the page are still free after
+   * it, an update only needs the record to fit
+   */
+  void WriteSlot(size_t slot_id, const char *null_map, const char *data, bool update) override;
+
+  void ReadSlot(size_t slot_id, char *null_map, char *data) override;
+
+  auto ReadChunk(const RecordSchema *chunk_schema) -> ChunkUptr override;
+
+  /**
+   * Read the records that satisfy all the conditions, the conditions compare the fields of the table with values or
+   * with each other, comparisons with values are evaluated on the encoded columns
+   * @param chunk_schema
+   * @param conds
+   * @return
+   */
+  auto ReadChunk(const RecordSchema *chunk_schema, const ConditionVec &conds) -> ChunkUptr;
+
+  /**
+   * Append the records that satisfy all the conditions to the columns of a vectorized chunk, the values are decoded
+   * into the columns in place without building a value object for each of them
+   * @param field_idx the field of the table read into each column of the chunk
+   * @param conds
+   * @param chunk
+   */
+  void ReadVector(const std::vector<size_t> &field_idx, const ConditionVec &conds, VectorChunk &chunk);
+
+  /**
+   * Encode the values of the slot as null to release their space
+   */
+  void ClearSlot(size_t slot_id) override;
+
+  /**
+   * @return bytes of a page available to the encoded columns
+   */
+  static auto GetCapacity(const TableHeader *tab_hdr) -> size_t;
+
+private:
+  /**
+   * Decode all columns of the page, the values of the empty slots and dead_slot are set to null
+   */
+  void Decode(std::vector<std::vector<char>> &values, std::vector<std::vector<bool>> &nulls, size_t dead_slot);
+
+  /**
+   * Encode the columns and write them to the page if they take no more than limit bytes
+   * @return whether the columns are written
+   */
+  auto Encode(const std::vector<std::vector<char>> &values, const std::vector<std::vector<bool>> &nulls, size_t limit)
+      -> bool;
+
+  /**
+   * @return a reader of every column, empty if nothing is written to the page yet
+   */
+  auto GetReaders() -> std::vector<ColumnReader>;
+
+  /**
+   * @return a flag for each slot, whether the slot holds a record that satisfies all the conditions
+   */
+  auto Select(const std::vector<ColumnReader> &readers, const ConditionVec &conds) -> std::vector<bool>;
+
+  auto EncodedSize() -> uint16_t &;
+
+  const RecordSchema *schema_;
+};
+
 DEFINE_UNIQUE_PTR(PageHandle);
 }  // namespace njudb
 
@@ -20,6 +20,9 @@
 //
 
 #include "table_handle.h"
+
+#include <algorithm>
+#include <thread>
 namespace njudb {
 
 TableHandle::TableHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, table_id_t table_id,
@@ -29,7 +32,11 @@ TableHandle::TableHandle(DiskManager *disk_manager, BufferPoolManager *buffer_po
       disk_manager_(disk_manager),
       buffer_pool_manager_(buffer_pool_manager),
       schema_(std::move(schema)),
-      storage_model_(storage_model)
+      storage_model_(storage_model),
+      fsm_(schema_->HasVarField() ? SlottedPageHandle::GetCapacity(&tab_hdr_) : tab_hdr_.rec_per_page_),
+      allocator_(disk_manager, table_id, &tab_hdr_),
+      overflow_(buffer_pool_manager, &allocator_, table_id, &tab_hdr_),
+      zone_map_(schema_.get())
 {
   // set table id for table handle;
   schema_->SetTableId(table_id_);
@@ -48,55 +55,455 @@ auto TableHandle::GetRecord(const RID &rid) -> RecordUptr
 
 auto TableHandle::GetChunk(page_id_t pid, const RecordSchema *chunk_schema) -> ChunkUptr { NJUDB_STUDENT_TODO(l1, f2); }
 
-auto TableHandle::InsertRecord(const Record &record) -> RID { NJUDB_STUDENT_TODO(l1, t3); }
+static auto EvalCondition(const RecordSchema &schema, const Record &record, const Condition &cond) -> bool
+{
+  auto lhs = record.GetValueAt(schema.GetRTFieldIndex(cond.GetLCol()));
+  switch (cond.GetRhsType()) {
+    case kValue: return EvalCompOp(cond.GetOp(), lhs, cond.GetRVal());
+    case kColumn: return EvalCompOp(cond.GetOp(), lhs, record.GetValueAt(schema.GetRTFieldIndex(cond.GetRCol())));
+    default: NJUDB_THROW(NJUDB_UNSUPPORTED_OP, cond.ToString());
+  }
+}
+
+auto TableHandle::GetChunk(page_id_t pid, const RecordSchema *chunk_schema, const ConditionVec &conds) -> ChunkUptr
+{
+  if (!PageMayMatch(pid, conds)) {
+    std::vector<ArrayValueSptr> col_arrs(chunk_schema->GetFieldCount());
+    std::generate(col_arrs.begin(), col_arrs.end(), [] { return ValueFactory::CreateArrayValue(); });
+    return std::make_unique<Chunk>(chunk_schema, std::move(col_arrs));
+  }
+  auto pg_hdl = FetchPageHandle(pid, true);
+  if (storage_model_ == PAX_COMPRESSED_MODEL && !schema_->HasVarField()) {
+    try {
+      auto chunk = static_cast<CompressedPAXPageHandle *>(pg_hdl.get())->ReadChunk(chunk_schema, conds);
+      UnpinPageHandle(pid, false);
+      return chunk;
+    } catch (NJUDBException_ &) {
+      UnpinPageHandle(pid, false);
+      throw;
+    }
+  }
+  std::vector<ArrayValueSptr> col_arrs;
+  std::vector<size_t>         field_idx;
+  col_arrs.reserve(chunk_schema->GetFieldCount());
+  field_idx.reserve(chunk_schema->GetFieldCount());
+  for (const auto &field : chunk_schema->GetFields()) {
+    col_arrs.push_back(ValueFactory::CreateArrayValue());
+    field_idx.push_back(schema_->GetRTFieldIndex(field));
+  }
+  auto null_map = std::make_unique<char[]>(tab_hdr_.nullmap_size_);
+  auto data     = std::make_unique<char[]>(tab_hdr_.rec_size_);
+  try {
+    for (size_t slot_id = 0; slot_id < tab_hdr_.rec_per_page_; slot_id++) {
+      if (!BitMap::GetBit(pg_hdl->GetBitmap(), slot_id)) {
+        continue;
+      }
+      pg_hdl->ReadSlot(slot_id, null_map.get(), data.get());
+      Record record(schema_.get(), null_map.get(), data.get(), {pid, static_cast<slot_id_t>(slot_id)});
+      if (!std::all_of(conds.begin(), conds.end(),
+              [&](const Condition &cond) { return EvalCondition(*schema_, record, cond); })) {
+        continue;
+      }
+      for (size_t i = 0; i < field_idx.size(); i++) {
+        col_arrs[i]->Append(record.GetValueAt(field_idx[i]));
+      }
+    }
+  } catch (NJUDBException_ &) {
+    UnpinPageHandle(pid, false);
+    throw;
+  }
+  UnpinPageHandle(pid, false);
+  return std::make_unique<Chunk>(chunk_schema, std::move(col_arrs));
+}
+
+auto TableHandle::ReadVector(page_id_t pid, const ConditionVec &conds, VectorChunk &chunk) -> bool
+{
+  if (!PageMayMatch(pid, conds)) {
+    return true;
+  }
+  std::vector<size_t> field_idx;
+  field_idx.reserve(chunk.GetColCount());
+  for (const auto &field : chunk.GetSchema()->GetFields()) {
+    field_idx.push_back(schema_->GetRTFieldIndex(field));
+  }
+  auto pg_hdl = FetchPageHandle(pid, true);
+  if (storage_model_ == PAX_COMPRESSED_MODEL && !schema_->HasVarField()) {
+    try {
+      static_cast<CompressedPAXPageHandle *>(pg_hdl.get())->ReadVector(field_idx, conds, chunk);
+    } catch (NJUDBException_ &) {
+      UnpinPageHandle(pid, false);
+      throw;
+    }
+    UnpinPageHandle(pid, false);
+    return true;
+  }
+  auto null_map = std::make_unique<char[]>(tab_hdr_.nullmap_size_);
+  auto data     = std::make_unique<char[]>(tab_hdr_.rec_size_);
+  try {
+    for (size_t slot_id = 0; slot_id < tab_hdr_.rec_per_page_; slot_id++) {
+      if (!BitMap::GetBit(pg_hdl->GetBitmap(), slot_id)) {
+        continue;
+      }
+      pg_hdl->ReadSlot(slot_id, null_map.get(), data.get());
+      for (size_t i = 0; i < field_idx.size(); i++) {
+        chunk.GetCol(i).Append(data.get() + schema_->GetFieldOffset(field_idx[i]),
+            BitMap::GetBit(null_map.get(), field_idx[i]));
+      }
+    }
+  } catch (NJUDBException_ &) {
+    UnpinPageHandle(pid, false);
+    throw;
+  }
+  UnpinPageHandle(pid, false);
+  return conds.empty();
+}
+
+auto TableHandle::InsertRecord(const Record &record) -> RID
+{
+  CheckWritable();
+  if (IsPacked()) {
+    return InsertPackedRecord(record);
+  }
+  // the page is forgotten in the zone map by CreatePageHandle
+  ZoneMap::WriteGuard zone_guard(zone_map_);
+  NJUDB_STUDENT_TODO(l1, t3);
+}
 
 void TableHandle::InsertRecord(const RID &rid, const Record &record)
 {
+  CheckWritable();
   if (rid.PageID() == INVALID_PAGE_ID) {
     NJUDB_THROW(NJUDB_PAGE_MISS, fmt::format("Page: {}", rid.PageID()));
   }
+  if (IsPacked()) {
+    InsertPackedRecord(rid, record);
+    return;
+  }
+  ZoneMap::WriteGuard zone_guard(zone_map_);
+  zone_map_.Forget(rid.PageID());
+  NJUDB_STUDENT_TODO(l1, t3);
+}
+
+void TableHandle::DeleteRecord(const RID &rid)
+{
+  CheckWritable();
+  if (IsPacked()) {
+    DeletePackedRecord(rid);
+    return;
+  }
+  ZoneMap::WriteGuard zone_guard(zone_map_);
+  zone_map_.Forget(rid.PageID());
   NJUDB_STUDENT_TODO(l1, t3);
 }
 
-void TableHandle::DeleteRecord(const RID &rid) { NJUDB_STUDENT_TODO(l1, t3); }
+void TableHandle::UpdateRecord(const RID &rid, const Record &record)
+{
+  CheckWritable();
+  if (IsPacked()) {
+    UpdatePackedRecord(rid, record);
+    return;
+  }
+  ZoneMap::WriteGuard zone_guard(zone_map_);
+  zone_map_.Forget(rid.PageID());
+  NJUDB_STUDENT_TODO(l1, t3);
+}
 
-void TableHandle::UpdateRecord(const RID &rid, const Record &record) { NJUDB_STUDENT_TODO(l1, t3); }
+auto TableHandle::InsertPackedRecord(const Record &record) -> RID
+{
+  size_t need = 1;
+  if (schema_->HasVarField()) {
+    need = SlottedPageHandle::GetRecordSpace(schema_.get(), record.GetNullMap(), record.GetData());
+  }
+  while (true) {
+    auto pg_hdl  = FindPageHandle(need);
+    auto page_id = pg_hdl->GetPage()->GetPageId();
+    // the free space map reserves nothing, inserters that found the same page take its slots one after another
+    std::unique_lock page_latch(pg_hdl->GetPage()->GetLatch());
+    auto             slot_id = BitMap::FindFirst(pg_hdl->GetBitmap(), tab_hdr_.rec_per_page_, 0, false);
+    if (slot_id >= tab_hdr_.rec_per_page_) {
+      // the last slot was taken after the page was found
+      fsm_.Update(page_id, fsm_.GetCapacity());
+      page_latch.unlock();
+      UnpinPageHandle(page_id, false);
+      continue;
+    }
+    try {
+      pg_hdl->WriteSlot(slot_id, record.GetNullMap(), record.GetData(), false);
+    } catch (NJUDBException_ &e) {
+      bool retry = e.type_ == NJUDB_RECLEN_ERROR && pg_hdl->GetPage()->GetRecordNum() > 0;
+      if (retry) {
+        // the page is fuller than the free space map knows, slotted pages record the space they really have, the
+        // records of a compressed page no longer fit its space although it has empty slots, so the page is full
+        if (schema_->HasVarField()) {
+          UpdateFreeSpace(*pg_hdl);
+        } else {
+          fsm_.Update(page_id, fsm_.GetCapacity());
+        }
+      }
+      page_latch.unlock();
+      UnpinPageHandle(page_id, true);
+      if (retry) {
+        continue;
+      }
+      throw;
+    }
+    BitMap::SetBit(pg_hdl->GetBitmap(), slot_id, true);
+    pg_hdl->GetPage()->SetRecordNum(pg_hdl->GetPage()->GetRecordNum() + 1);
+    UpdateFreeSpace(*pg_hdl);
+    UpdateZoneMap(*pg_hdl, &record);
+    page_latch.unlock();
+    UnpinPageHandle(page_id, true);
+    return {page_id, static_cast<slot_id_t>(slot_id)};
+  }
+}
 
-auto TableHandle::FetchPageHandle(page_id_t page_id) -> PageHandleUptr
+void TableHandle::InsertPackedRecord(const RID &rid, const Record &record)
 {
-  auto page = buffer_pool_manager_->FetchPage(table_id_, page_id);
+  auto             pg_hdl = FetchPageHandle(rid.PageID());
+  std::unique_lock page_latch(pg_hdl->GetPage()->GetLatch());
+  if (BitMap::GetBit(pg_hdl->GetBitmap(), rid.SlotID())) {
+    page_latch.unlock();
+    UnpinPageHandle(rid.PageID(), false);
+    NJUDB_THROW(NJUDB_RECORD_EXISTS, fmt::format("Page: {}, Slot: {}", rid.PageID(), rid.SlotID()));
+  }
+  try {
+    pg_hdl->WriteSlot(rid.SlotID(), record.GetNullMap(), record.GetData(), false);
+  } catch (NJUDBException_ &) {
+    page_latch.unlock();
+    UnpinPageHandle(rid.PageID(), true);
+    throw;
+  }
+  BitMap::SetBit(pg_hdl->GetBitmap(), rid.SlotID(), true);
+  pg_hdl->GetPage()->SetRecordNum(pg_hdl->GetPage()->GetRecordNum() + 1);
+  UpdateFreeSpace(*pg_hdl);
+  UpdateZoneMap(*pg_hdl, &record);
+  page_latch.unlock();
+  UnpinPageHandle(rid.PageID(), true);
+}
+
+void TableHandle::DeletePackedRecord(const RID &rid)
+{
+  auto             pg_hdl = FetchPageHandle(rid.PageID());
+  std::unique_lock page_latch(pg_hdl->GetPage()->GetLatch());
+  if (!BitMap::GetBit(pg_hdl->GetBitmap(), rid.SlotID())) {
+    page_latch.unlock();
+    UnpinPageHandle(rid.PageID(), false);
+    NJUDB_THROW(NJUDB_RECORD_MISS, fmt::format("Page: {}, Slot: {}", rid.PageID(), rid.SlotID()));
+  }
+  pg_hdl->ClearSlot(rid.SlotID());
+  BitMap::SetBit(pg_hdl->GetBitmap(), rid.SlotID(), false);
+  pg_hdl->GetPage()->SetRecordNum(pg_hdl->GetPage()->GetRecordNum() - 1);
+  UpdateFreeSpace(*pg_hdl);
+  UpdateZoneMap(*pg_hdl, nullptr);
+  page_latch.unlock();
+  UnpinPageHandle(rid.PageID(), true);
+}
+
+void TableHandle::UpdatePackedRecord(const RID &rid, const Record &record)
+{
+  auto             pg_hdl = FetchPageHandle(rid.PageID());
+  std::unique_lock page_latch(pg_hdl->GetPage()->GetLatch());
+  if (!BitMap::GetBit(pg_hdl->GetBitmap(), rid.SlotID())) {
+    page_latch.unlock();
+    UnpinPageHandle(rid.PageID(), false);
+    NJUDB_THROW(NJUDB_RECORD_MISS, fmt::format("Page: {}, Slot: {}", rid.PageID(), rid.SlotID()));
+  }
+  try {
+    pg_hdl->WriteSlot(rid.SlotID(), record.GetNullMap(), record.GetData(), true);
+  } catch (NJUDBException_ &) {
+    page_latch.unlock();
+    UnpinPageHandle(rid.PageID(), true);
+    throw;
+  }
+  UpdateFreeSpace(*pg_hdl);
+  UpdateZoneMap(*pg_hdl, &record);
+  page_latch.unlock();
+  UnpinPageHandle(rid.PageID(), true);
+}
+
+void TableHandle::SetReadOnly(bool read_only)
+{
+  if (read_only) {
+    buffer_pool_manager_->MapFile(table_id_);
+  } else {
+    buffer_pool_manager_->UnmapFile(table_id_);
+  }
+  read_only_ = read_only;
+}
+
+auto TableHandle::IsReadOnly() const -> bool { return read_only_; }
+
+auto TableHandle::FetchPageHandle(page_id_t page_id, bool use_once) -> PageHandleUptr
+{
+  if (read_only_) {
+    if (auto page = buffer_pool_manager_->GetMappedPage(table_id_, page_id); page != nullptr) {
+      return WrapPageHandle(page);
+    }
+  }
+  auto page = buffer_pool_manager_->FetchPage(table_id_, page_id, use_once);
   return WrapPageHandle(page);
 }
 
-auto TableHandle::CreatePageHandle() -> PageHandleUptr
+void TableHandle::UnpinPageHandle(page_id_t page_id, bool is_dirty)
+{
+  if (read_only_ && buffer_pool_manager_->GetMappedPage(table_id_, page_id) != nullptr) {
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(table_id_, page_id, is_dirty);
+}
+
+auto TableHandle::IsPacked() const -> bool
+{
+  return schema_->HasVarField() || storage_model_ == PAX_COMPRESSED_MODEL;
+}
+
+void TableHandle::CheckWritable() const
+{
+  if (read_only_) {
+    NJUDB_THROW(NJUDB_UNSUPPORTED_OP, fmt::format("table {} is read-only", GetTableName()));
+  }
+}
+
+auto TableHandle::CreatePageHandle(size_t need) -> PageHandleUptr
+{
+  auto pg_hdl = FindPageHandle(need);
+  zone_map_.Forget(pg_hdl->GetPage()->GetPageId());
+  return pg_hdl;
+}
+
+auto TableHandle::FindPageHandle(size_t need) -> PageHandleUptr
 {
-  if (tab_hdr_.first_free_page_ == INVALID_PAGE_ID) {
+  std::call_once(fsm_built_, &TableHandle::BuildFreeSpaceMap, this);
+  // concurrent inserters start searching from different pages
+  auto page_id = fsm_.FindPage(std::hash<std::thread::id>{}(std::this_thread::get_id()), need);
+  if (page_id == INVALID_PAGE_ID) {
     return CreateNewPageHandle();
   }
-  auto page = buffer_pool_manager_->FetchPage(table_id_, tab_hdr_.first_free_page_);
+  auto page = buffer_pool_manager_->FetchPage(table_id_, page_id);
   return WrapPageHandle(page);
 }
 
 auto TableHandle::CreateNewPageHandle() -> PageHandleUptr
 {
-  auto page_id = static_cast<page_id_t>(tab_hdr_.page_num_);
-  tab_hdr_.page_num_++;
-  auto page   = buffer_pool_manager_->FetchPage(table_id_, page_id);
-  auto pg_hdl = WrapPageHandle(page);
-  page->SetNextFreePageId(tab_hdr_.first_free_page_);
-  tab_hdr_.first_free_page_ = page_id;
-  return pg_hdl;
+  auto page_id = allocator_.AllocatePage();
+  auto page    = buffer_pool_manager_->FetchPage(table_id_, page_id);
+  fsm_.Update(page_id, 0);
+  zone_map_.Reset(page_id);
+  return WrapPageHandle(page);
+}
+
+void TableHandle::BuildFreeSpaceMap()
+{
+  // page 0 is the file header
+  for (page_id_t page_id = FILE_HEADER_PAGE_ID + 1; page_id < static_cast<page_id_t>(tab_hdr_.page_num_); page_id++) {
+    auto pg_hdl = FetchPageHandle(page_id, true);
+    UpdateFreeSpace(*pg_hdl);
+    UnpinPageHandle(page_id, false);
+  }
+}
+
+void TableHandle::UpdateFreeSpace(PageHandle &pg_hdl)
+{
+  auto *page = pg_hdl.GetPage();
+  if (schema_->HasVarField()) {
+    fsm_.Update(page->GetPageId(), static_cast<SlottedPageHandle &>(pg_hdl).GetUsedSpace());
+  } else {
+    fsm_.Update(page->GetPageId(), page->GetRecordNum());
+  }
+}
+
+void TableHandle::UpdateZoneMap(PageHandle &pg_hdl, const Record *record)
+{
+  auto *page = pg_hdl.GetPage();
+  if (record != nullptr) {
+    zone_map_.Add(page->GetPageId(), *record);
+  } else if (page->GetRecordNum() == 0) {
+    zone_map_.Reset(page->GetPageId());
+  }
+}
+
+void TableHandle::RecordZone(page_id_t page_id)
+{
+  auto null_map = std::make_unique<char[]>(tab_hdr_.nullmap_size_);
+  auto data     = std::make_unique<char[]>(tab_hdr_.rec_size_);
+  auto pg_hdl   = FetchPageHandle(page_id);
+  // packed writers add to the zone under the page latch, they can not slip in between the reset and the adds, the
+  // other writers hold a ZoneMap::WriteGuard
+  std::unique_lock page_latch(pg_hdl->GetPage()->GetLatch());
+  if (!zone_map_.BeginRecord(page_id)) {
+    page_latch.unlock();
+    UnpinPageHandle(page_id, false);
+    return;
+  }
+  try {
+    for (size_t slot_id = 0; slot_id < tab_hdr_.rec_per_page_; slot_id++) {
+      if (BitMap::GetBit(pg_hdl->GetBitmap(), slot_id)) {
+        pg_hdl->ReadSlot(slot_id, null_map.get(), data.get());
+        zone_map_.Add(page_id, Record(schema_.get(), null_map.get(), data.get(), INVALID_RID));
+      }
+    }
+  } catch (NJUDBException_ &) {
+    zone_map_.Forget(page_id);
+    page_latch.unlock();
+    UnpinPageHandle(page_id, false);
+    throw;
+  }
+  page_latch.unlock();
+  UnpinPageHandle(page_id, false);
 }
 
 auto TableHandle::WrapPageHandle(Page *page) -> PageHandleUptr
 {
+  // records with VARCHAR fields are stored in slotted pages whatever the storage model is
+  if (schema_->HasVarField()) {
+    return std::make_unique<SlottedPageHandle>(&tab_hdr_, page, schema_.get(), &overflow_);
+  }
   switch (storage_model_) {
     case StorageModel::NARY_MODEL: return std::make_unique<NAryPageHandle>(&tab_hdr_, page);
     case StorageModel::PAX_MODEL: return std::make_unique<PAXPageHandle>(&tab_hdr_, page, schema_.get(), field_offset_);
+    case StorageModel::PAX_COMPRESSED_MODEL:
+      return std::make_unique<CompressedPAXPageHandle>(&tab_hdr_, page, schema_.get());
     default: NJUDB_FATAL("Unknown storage model");
   }
 }
 
+void TableHandle::ReadAhead(page_id_t page_id)
+{
+  if (page_id == ra_last_page_) {
+    return;
+  }
+  if (read_only_ && buffer_pool_manager_->GetMappedPage(table_id_, page_id) != nullptr) {
+    // the mapping is read ahead by the os, it is advised to be read sequentially
+    return;
+  }
+  auto max_window = std::max<size_t>(1, std::min(READ_AHEAD_MAX_PAGES, buffer_pool_manager_->GetPoolSize() / 4));
+  if (page_id != ra_last_page_ + 1) {
+    // a new scan or a jump, restart with a small window
+    ra_window_   = std::min(READ_AHEAD_INIT_PAGES, max_window);
+    ra_end_page_ = page_id;
+  } else if (ra_end_page_ - page_id > static_cast<page_id_t>(ra_window_ / 2)) {
+    // more than half of the window is still ahead of the scan
+    ra_last_page_ = page_id;
+    return;
+  } else {
+    ra_window_ = std::min(ra_window_ * 2, max_window);
+  }
+  ra_last_page_ = page_id;
+
+  auto first = std::max(ra_end_page_, page_id);
+  auto last  = std::min(page_id + static_cast<page_id_t>(ra_window_), static_cast<page_id_t>(tab_hdr_.page_num_));
+  if (first >= last) {
+    return;
+  }
+  auto wanted = static_cast<size_t>(last - first);
+  auto loaded = buffer_pool_manager_->PrefetchRange(table_id_, first, wanted);
+  ra_end_page_ = first + static_cast<page_id_t>(loaded);
+  if (loaded < wanted) {
+    // the pool is too busy to hold the window, back off
+    ra_window_ = std::max<size_t>(1, ra_window_ / 2);
+  }
+}
+
 auto TableHandle::GetTableId() const -> table_id_t { return table_id_; }
 
 auto TableHandle::GetTableHeader() const -> const TableHeader & { return tab_hdr_; }
@@ -111,41 +518,76 @@ auto TableHandle::GetTableName() const -> std::string
 
 auto TableHandle::GetStorageModel() const -> StorageModel { return storage_model_; }
 
-auto TableHandle::GetFirstRID() -> RID
+auto TableHandle::GetFirstRID(const ConditionVec &conds) -> RID
 {
   auto page_id = FILE_HEADER_PAGE_ID + 1;
   while (page_id < static_cast<page_id_t>(tab_hdr_.page_num_)) {
-    auto pg_hdl = FetchPageHandle(page_id);
+    if (!PageMayMatch(page_id, conds)) {
+      page_id++;
+      continue;
+    }
+    ReadAhead(page_id);
+    auto pg_hdl = FetchPageHandle(page_id, true);
     auto id     = BitMap::FindFirst(pg_hdl->GetBitmap(), tab_hdr_.rec_per_page_, 0, true);
     if (id != tab_hdr_.rec_per_page_) {
-      buffer_pool_manager_->UnpinPage(table_id_, page_id, false);
+      UnpinPageHandle(page_id, false);
       return {page_id, static_cast<slot_id_t>(id)};
     }
-    buffer_pool_manager_->UnpinPage(table_id_, page_id, false);
+    UnpinPageHandle(page_id, false);
     page_id++;
   }
   return INVALID_RID;
 }
 
-auto TableHandle::GetNextRID(const RID &rid) -> RID
+auto TableHandle::GetFirstRID() -> RID { return GetFirstRID(ConditionVec{}); }
+
+auto TableHandle::GetNextRID(const RID &rid) -> RID { return GetNextRID(rid, ConditionVec{}); }
+
+auto TableHandle::GetNextRID(const RID &rid, const ConditionVec &conds) -> RID
 {
   auto page_id = rid.PageID();
   auto slot_id = rid.SlotID();
   while (page_id < static_cast<page_id_t>(tab_hdr_.page_num_)) {
-    auto pg_hdl = FetchPageHandle(page_id);
+    if (page_id != rid.PageID() && !PageMayMatch(page_id, conds)) {
+      page_id++;
+      continue;
+    }
+    ReadAhead(page_id);
+    auto pg_hdl = FetchPageHandle(page_id, true);
     slot_id = static_cast<slot_id_t>(BitMap::FindFirst(pg_hdl->GetBitmap(), tab_hdr_.rec_per_page_, slot_id + 1, true));
     if (slot_id == static_cast<slot_id_t>(tab_hdr_.rec_per_page_)) {
-      buffer_pool_manager_->UnpinPage(table_id_, page_id, false);
+      UnpinPageHandle(page_id, false);
       page_id++;
       slot_id = -1;
     } else {
-      buffer_pool_manager_->UnpinPage(table_id_, page_id, false);
+      UnpinPageHandle(page_id, false);
       return {page_id, static_cast<slot_id_t>(slot_id)};
     }
   }
   return INVALID_RID;
 }
 
+auto TableHandle::PageMayMatch(page_id_t page_id, const ConditionVec &conds) -> bool
+{
+  if (conds.empty()) {
+    return true;
+  }
+  if (!zone_map_.IsRecorded(page_id)) {
+    RecordZone(page_id);
+  }
+  return zone_map_.MayMatch(page_id, conds);
+}
+
+void TableHandle::LoadZoneMap(const char *src, size_t size)
+{
+  zone_map_.Deserialize(src, size);
+}
+
+auto TableHandle::SaveZoneMap() const -> std::vector<char>
+{
+  return zone_map_.Serialize();
+}
+
 auto TableHandle::HasField(const std::string &field_name) const -> bool
 {
   return schema_->HasField(table_id_, field_name);
@@ -27,6 +27,8 @@
 #include "common/page.h"
 #include "storage/storage.h"
 #include "page_handle.h"
+#include "free_space_map.h"
+#include "zone_map.h"
 
 namespace njudb {
 
@@ -46,29 +48,53 @@ public:
    * 1. fetch the page handle by rid
    * 2. check if there is a record in the slot using bitmap, if not, unpin the page and throw NJUDB_RECORD_MISS
    * 3. read the record from the slot using page handle
-   * 4. unpin the page
+   * 4. unpin the page using UnpinPageHandle
    * @param rid
    * @return record
    */
   auto GetRecord(const RID &rid) -> RecordUptr;
 
   /**
-   * Get a chunk in page using record schema indicating which columns should be loaded
+   * Get a chunk in page using record schema indicating which columns should be loaded, the page is fetched by
+   * FetchPageHandle and unpinned by UnpinPageHandle
    * @param pid
    * @param chunk_schema
    * @return
    */
   auto GetChunk(page_id_t pid, const RecordSchema *chunk_schema) -> ChunkUptr;
 
+  /**
+   * Get a chunk of the records in page that satisfy all the conditions, the conditions compare the fields of the table
+   * with values or with each other. Pages of the compressed PAX model evaluate them on the encoded columns, records of
+   * other pages are read and filtered one by one. Pages excluded by the zone map are not read.
+   * @param pid
+   * @param chunk_schema
+   * @param conds
+   * @return
+   */
+  auto GetChunk(page_id_t pid, const RecordSchema *chunk_schema, const ConditionVec &conds) -> ChunkUptr;
+
+  /**
+   * Append the records in page to the columns of a vectorized chunk, the fields read are those of the chunk schema. The
+   * values are copied as raw bytes, no value object is built for them. Only compressed PAX pages evaluate the
+   * conditions, on the encoded columns; the records of other pages are appended unfiltered and left to the caller.
+   * Pages excluded by the zone map are not read.
+   * @param pid
+   * @param conds
+   * @param chunk
+   * @return whether the records appended satisfy all the conditions
+   */
+  auto ReadVector(page_id_t pid, const ConditionVec &conds, VectorChunk &chunk) -> bool;
+
   /**
    * Insert a record into the table
    * 1. create a page handle using CreatePageHandle
    * 2. get an empty slot in the page
    * 3. write the record into the slot
    * 4. update the bitmap and the number of records in the page header
-   * 5. if the page is full after inserting the record, update the first free page id in the file header and set the
-   * next page id of the current page
+   * 5. update the free space map of the page using UpdateFreeSpace
    * 6. unpin the page
+   * records of tables with VARCHAR fields or the compressed PAX model are inserted by InsertPackedRecord
    * @param record
    * @return rid of the inserted record
    */
@@ -88,9 +114,9 @@ public:
    * Delete the record by rid
    * 1. if the slot is empty, unpin the page and throw NJUDB_RECORD_MISS
    * 2. update the bitmap and the number of records in the page header
-   * 3. if the page is not full after deleting the record, update the first free page id in the file header and the next
-   * page id in the page header
+   * 3. update the free space map of the page using UpdateFreeSpace
    * 4. unpin the page
+   * records of tables with VARCHAR fields or the compressed PAX model are deleted by DeletePackedRecord
    * @param rid
    */
   void DeleteRecord(const RID &rid);
@@ -100,6 +126,7 @@ public:
    * 1. if the slot is empty, unpin the page and throw NJUDB_RECORD_MISS
    * 2. write slot
    * 3. unpin the page
+   * records of tables with VARCHAR fields or the compressed PAX model are updated by UpdatePackedRecord
    * @param rid
    * @param record
    */
@@ -115,32 +142,136 @@ public:
 
   [[nodiscard]] auto GetStorageModel() const -> StorageModel;
 
+  /**
+   * Get the first record of the table, the pages that can not satisfy the conditions according to the zone map are
+   * skipped, the records returned are not checked against the conditions
+   * @param conds pushed-down conditions of the scan
+   * @return INVALID_RID if there is no record
+   */
+  [[nodiscard]] auto GetFirstRID(const ConditionVec &conds) -> RID;
+
+  [[nodiscard]] auto GetNextRID(const RID &rid, const ConditionVec &conds) -> RID;
+
+  // the scans without conditions, kept as overloads for the executors of the gold libraries of the labs
   [[nodiscard]] auto GetFirstRID() -> RID;
 
   [[nodiscard]] auto GetNextRID(const RID &rid) -> RID;
 
+  /**
+   * Check the zone of the page, a page whose zone is unknown is read to record it first. Inserting, deleting and
+   * updating records of tables that are not packed forget the zone of the page written, the zone is recorded again
+   * when a scan next checks the page and no such write is in progress.
+   * @return false if no record in the page can satisfy all the conditions according to the zone map
+   */
+  [[nodiscard]] auto PageMayMatch(page_id_t page_id, const ConditionVec &conds) -> bool;
+
+  /**
+   * Load the zone map saved by SaveZoneMap when the table was closed
+   */
+  void LoadZoneMap(const char *src, size_t size);
+
+  /**
+   * @return the serialized zone map
+   */
+  [[nodiscard]] auto SaveZoneMap() const -> std::vector<char>;
+
   [[nodiscard]] auto HasField(const std::string &field_name) const -> bool;
 
+  /**
+   * Flag the table read-only or writable. The pages of a read-only table are read from a read-only memory mapping of
+   * the table file (see BufferPoolManager::MapFile) without being copied into the buffer pool, and inserting, deleting
+   * or updating records throws NJUDB_UNSUPPORTED_OP.
+   * @param read_only
+   */
+  void SetReadOnly(bool read_only);
+
+  [[nodiscard]] auto IsReadOnly() const -> bool;
+
 private:
   /**
    * Fetch the page handle by page id
    * @param page_id
+   * @param use_once hint the buffer pool that the page is visited once by a scan
    * @return
    */
-  auto FetchPageHandle(page_id_t page_id) -> PageHandleUptr;
+  auto FetchPageHandle(page_id_t page_id, bool use_once = false) -> PageHandleUptr;
+
+  /**
+   * Unpin the page fetched by FetchPageHandle, pages read from the mapping of a read-only table are not pinned
+   * @param page_id
+   * @param is_dirty
+   */
+  void UnpinPageHandle(page_id_t page_id, bool is_dirty);
+
+  void CheckWritable() const;
 
   /**
-   * Create a page handle that has at least one empty slot
+   * Create a page handle that has at least one empty slot, the page is found in the free space map, a new page is
+   * created if all pages are full. The zone of the page is forgotten as the caller writes to it.
+   * @param need bytes needed by the record in a slotted page, see SlottedPageHandle::GetRecordSpace
    * @return
    */
-  auto CreatePageHandle() -> PageHandleUptr;
+  auto CreatePageHandle(size_t need = 1) -> PageHandleUptr;
 
   /**
-   * Create a fresh new page handle
+   * Find a page handle like CreatePageHandle and keep its zone, for callers that update the zone map themselves
+   */
+  auto FindPageHandle(size_t need) -> PageHandleUptr;
+
+  /**
+   * Create a fresh new page handle at the end of the file, the page is allocated by the allocator shared with the
+   * overflow pages and its zone is recorded empty
    * @return
    */
   auto CreateNewPageHandle() -> PageHandleUptr;
 
+  /**
+   * Fill the free space map with the number of records of every page, done once before the first insert
+   */
+  void BuildFreeSpaceMap();
+
+  /**
+   * Record the space used in the page in the free space map, the number of records for fixed-length records and
+   * compressed PAX pages and the bytes used for slotted pages
+   * @param pg_hdl
+   */
+  void UpdateFreeSpace(PageHandle &pg_hdl);
+
+  /**
+   * Widen the zone of the page with the record written to it, or clear the zone if the page is empty after a delete
+   * @param pg_hdl
+   * @param record the record written, nullptr for a delete
+   */
+  void UpdateZoneMap(PageHandle &pg_hdl, const Record *record);
+
+  /**
+   * Record the zone of the page from the records in it, the zone stays unknown while a write holds a
+   * ZoneMap::WriteGuard
+   * @param page_id
+   */
+  void RecordZone(page_id_t page_id);
+
+  /**
+   * @return whether the records are packed in slotted pages or compressed PAX pages, in which the number of records a
+   * page holds depends on the records
+   */
+  [[nodiscard]] auto IsPacked() const -> bool;
+
+  /**
+   * Insert, delete and update the records of a table with packed pages, they follow the steps of InsertRecord,
+   * DeleteRecord and UpdateRecord. A slotted page needs the space of the record to find a page and releases the space
+   * and the overflow pages of a deleted record. A page that turns out to be full when the record is written is marked
+   * full in the free space map and the insert moves on to another page. The slot and the bitmap are written under the
+   * latch of the page, concurrent inserters may find the same page in the free space map.
+   */
+  auto InsertPackedRecord(const Record &record) -> RID;
+
+  void InsertPackedRecord(const RID &rid, const Record &record);
+
+  void DeletePackedRecord(const RID &rid);
+
+  void UpdatePackedRecord(const RID &rid, const Record &record);
+
   /**
    * Wrap the page handle according to the storage model
    * @param page
@@ -148,6 +279,13 @@ private:
    */
   auto WrapPageHandle(Page *page) -> PageHandleUptr;
 
+  /**
+   * Called by the scan before visiting a page, prefetches the pages after it through the buffer pool. The window
+   * grows while the pages are visited one after another, and shrinks when the pool can not hold the whole window.
+   * @param page_id
+   */
+  void ReadAhead(page_id_t page_id);
+
 private:
   TableHeader tab_hdr_;
   table_id_t  table_id_;
@@ -157,6 +295,20 @@ private:
 
   RecordSchemaUptr schema_;
   StorageModel     storage_model_;
+  bool             read_only_{false};
+
+  // fill levels of the data pages, built by the first insert
+  FreeSpaceMap   fsm_;
+  std::once_flag fsm_built_;
+
+  // new data pages and overflow pages
+  PageAllocator allocator_;
+
+  // long VARCHAR values of the slotted pages
+  OverflowStore overflow_;
+
+  // value ranges of the data pages, loaded when the table is opened and recorded by scans for unknown pages
+  ZoneMap zone_map_;
 
   /// field below is available when storage model is pax
   // field offsets is the offset of each field stored in page
@@ -169,6 +321,11 @@ private:
   // ...
   // | field_m_1, field_m_2, ... , field_m_n |
   std::vector<size_t> field_offset_;
+
+  /// read-ahead state of the sequential scan
+  page_id_t ra_last_page_{INVALID_PAGE_ID};  // the page visited last
+  page_id_t ra_end_page_{INVALID_PAGE_ID};   // pages before it have been prefetched
+  size_t    ra_window_{0};
 };
 
 DEFINE_UNIQUE_PTR(TableHandle);
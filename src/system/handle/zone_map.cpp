@@ -0,0 +1,260 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "zone_map.h"
+
+#include <cstring>
+
+#include "column_codec.h"
+
+namespace njudb {
+
+static constexpr size_t UNTRACKED = SIZE_MAX;
+
+ZoneMap::ZoneMap(const RecordSchema *schema) : schema_(schema), col_idx_(schema->GetFieldCount(), UNTRACKED)
+{
+  for (size_t i = 0; i < schema_->GetFieldCount(); i++) {
+    auto &field = schema_->GetFieldAt(i).field_;
+    if (field.field_type_ == TYPE_VARCHAR) {
+      continue;
+    }
+    col_idx_[i] = field_idx_.size();
+    field_idx_.push_back(i);
+    offsets_.push_back(zone_len_);
+    zone_len_ += field.field_size_;
+  }
+}
+
+void ZoneMap::Add(page_id_t page_id, const Record &record)
+{
+  std::scoped_lock lock(latch_);
+  auto            &zone = GetZone(page_id);
+  if (!zone.recorded_) {
+    return;
+  }
+  for (size_t col = 0; col < field_idx_.size(); col++) {
+    auto value = record.GetValueAt(field_idx_[col]);
+    if (value->IsNull()) {
+      zone.null_num_[col]++;
+      continue;
+    }
+    auto        size = schema_->GetFieldAt(field_idx_[col]).field_.field_size_;
+    const auto *src  = record.GetData() + schema_->GetFieldOffset(field_idx_[col]);
+    if (!zone.has_value_[col] || *value < *GetValue(zone.min_, col)) {
+      memcpy(zone.min_.data() + offsets_[col], src, size);
+    }
+    if (!zone.has_value_[col] || *value > *GetValue(zone.max_, col)) {
+      memcpy(zone.max_.data() + offsets_[col], src, size);
+    }
+    zone.has_value_[col] = 1;
+  }
+}
+
+void ZoneMap::Reset(page_id_t page_id)
+{
+  std::scoped_lock lock(latch_);
+  ClearZone(GetZone(page_id));
+}
+
+void ZoneMap::Forget(page_id_t page_id)
+{
+  std::scoped_lock lock(latch_);
+  GetZone(page_id).recorded_ = false;
+}
+
+auto ZoneMap::BeginRecord(page_id_t page_id) -> bool
+{
+  std::scoped_lock lock(latch_);
+  if (writers_ > 0) {
+    return false;
+  }
+  ClearZone(GetZone(page_id));
+  return true;
+}
+
+ZoneMap::WriteGuard::WriteGuard(ZoneMap &zone_map) : zone_map_(zone_map)
+{
+  std::scoped_lock lock(zone_map_.latch_);
+  zone_map_.writers_++;
+}
+
+ZoneMap::WriteGuard::~WriteGuard()
+{
+  std::scoped_lock lock(zone_map_.latch_);
+  zone_map_.writers_--;
+}
+
+auto ZoneMap::IsRecorded(page_id_t page_id) -> bool
+{
+  std::scoped_lock lock(latch_);
+  return static_cast<size_t>(page_id) < zones_.size() && zones_[page_id].recorded_;
+}
+
+auto ZoneMap::MayMatch(page_id_t page_id, const ConditionVec &conds) -> bool
+{
+  std::scoped_lock lock(latch_);
+  if (static_cast<size_t>(page_id) >= zones_.size() || !zones_[page_id].recorded_) {
+    return true;
+  }
+  auto &zone = zones_[page_id];
+  for (const auto &cond : conds) {
+    if (cond.GetRhsType() != kValue) {
+      continue;
+    }
+    auto field = schema_->GetRTFieldIndex(cond.GetLCol());
+    if (field == schema_->GetFieldCount() || col_idx_[field] == UNTRACKED) {
+      continue;
+    }
+    auto  col = col_idx_[field];
+    auto  op  = cond.GetOp();
+    auto  rhs = cond.GetRVal();
+    if (op != OP_EQ && op != OP_NE && op != OP_LT && op != OP_LE && op != OP_GT && op != OP_GE) {
+      continue;
+    }
+    if (zone.null_num_[col] > 0 && CompOpOnNull(op, true, rhs->IsNull())) {
+      continue;
+    }
+    if (!zone.has_value_[col]) {
+      return false;
+    }
+    if (rhs->IsNull()) {
+      if (CompOpOnNull(op, false, true)) {
+        continue;
+      }
+      return false;
+    }
+    if (!RangeMayMatch(op, GetValue(zone.min_, col), GetValue(zone.max_, col), rhs)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ZoneMap::GetMinValue(page_id_t page_id, size_t field_idx) -> ValueSptr
+{
+  std::scoped_lock lock(latch_);
+  auto            &zone = GetZone(page_id);
+  auto             col  = col_idx_[field_idx];
+  if (col == UNTRACKED || !zone.recorded_ || !zone.has_value_[col]) {
+    return ValueFactory::CreateNullValue(schema_->GetFieldAt(field_idx).field_.field_type_);
+  }
+  return GetValue(zone.min_, col);
+}
+
+auto ZoneMap::GetMaxValue(page_id_t page_id, size_t field_idx) -> ValueSptr
+{
+  std::scoped_lock lock(latch_);
+  auto            &zone = GetZone(page_id);
+  auto             col  = col_idx_[field_idx];
+  if (col == UNTRACKED || !zone.recorded_ || !zone.has_value_[col]) {
+    return ValueFactory::CreateNullValue(schema_->GetFieldAt(field_idx).field_.field_type_);
+  }
+  return GetValue(zone.max_, col);
+}
+
+auto ZoneMap::GetNullCount(page_id_t page_id, size_t field_idx) -> size_t
+{
+  std::scoped_lock lock(latch_);
+  auto            &zone = GetZone(page_id);
+  auto             col  = col_idx_[field_idx];
+  return col == UNTRACKED || !zone.recorded_ ? 0 : zone.null_num_[col];
+}
+
+auto ZoneMap::Serialize() const -> std::vector<char>
+{
+  std::scoped_lock  lock(latch_);
+  std::vector<char> out;
+  auto              append = [&out](const void *src, size_t size) {
+    out.insert(out.end(), static_cast<const char *>(src), static_cast<const char *>(src) + size);
+  };
+  auto page_num = static_cast<uint32_t>(zones_.size());
+  append(&page_num, sizeof(uint32_t));
+  for (const auto &zone : zones_) {
+    append(&zone.recorded_, sizeof(bool));
+    if (zone.recorded_) {
+      append(zone.has_value_.data(), zone.has_value_.size());
+      append(zone.null_num_.data(), zone.null_num_.size() * sizeof(uint32_t));
+      append(zone.min_.data(), zone_len_);
+      append(zone.max_.data(), zone_len_);
+    }
+  }
+  return out;
+}
+
+void ZoneMap::Deserialize(const char *src, size_t size)
+{
+  std::scoped_lock lock(latch_);
+  const char      *end  = src + size;
+  auto             read = [&src, end](void *dst, size_t n) {
+    NJUDB_ASSERT(src + n <= end, "zone map is truncated");
+    memcpy(dst, src, n);
+    src += n;
+  };
+  uint32_t page_num;
+  read(&page_num, sizeof(uint32_t));
+  zones_.assign(page_num, Zone());
+  for (auto &zone : zones_) {
+    read(&zone.recorded_, sizeof(bool));
+    if (zone.recorded_) {
+      ClearZone(zone);
+      read(zone.has_value_.data(), zone.has_value_.size());
+      read(zone.null_num_.data(), zone.null_num_.size() * sizeof(uint32_t));
+      read(zone.min_.data(), zone_len_);
+      read(zone.max_.data(), zone_len_);
+    }
+  }
+}
+
+auto ZoneMap::GetZone(page_id_t page_id) -> Zone &
+{
+  auto idx = static_cast<size_t>(page_id);
+  if (idx >= zones_.size()) {
+    zones_.resize(idx + 1);
+  }
+  return zones_[idx];
+}
+
+void ZoneMap::ClearZone(Zone &zone) const
+{
+  zone.recorded_ = true;
+  zone.has_value_.assign(field_idx_.size(), 0);
+  zone.null_num_.assign(field_idx_.size(), 0);
+  // one more byte to terminate strings that fill the last field
+  zone.min_.assign(zone_len_ + 1, 0);
+  zone.max_.assign(zone_len_ + 1, 0);
+}
+
+auto ZoneMap::GetValue(const std::vector<char> &bound, size_t col) const -> ValueSptr
+{
+  auto &field = schema_->GetFieldAt(field_idx_[col]).field_;
+  return ValueFactory::CreateValue(field.field_type_, bound.data() + offsets_[col], field.field_size_);
+}
+
+auto ZoneMap::RangeMayMatch(CompOp op, const ValueSptr &min, const ValueSptr &max, const ValueSptr &rhs) -> bool
+{
+  switch (op) {
+    case OP_EQ: return EvalCompOp(OP_LE, min, rhs) && EvalCompOp(OP_GE, max, rhs);
+    case OP_NE: return !(EvalCompOp(OP_EQ, min, rhs) && EvalCompOp(OP_EQ, max, rhs));
+    case OP_LT:
+    case OP_LE: return EvalCompOp(op, min, rhs);
+    case OP_GT:
+    case OP_GE: return EvalCompOp(op, max, rhs);
+    default: return true;
+  }
+}
+
+}  // namespace njudb
@@ -0,0 +1,150 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#ifndef NJUDB_ZONE_MAP_H
+#define NJUDB_ZONE_MAP_H
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/condition.h"
+#include "common/record.h"
+
+namespace njudb {
+
+/**
+ * Zone map of a heap table, it keeps for every data page and every column the minimum and the maximum of the values
+ * written to the page and the number of null values, so that a scan skips the pages whose values can not satisfy its
+ * conditions. A zone only widens as records are written and is cleared when the page becomes empty, so it may be
+ * wider than the values left in the page but never narrower, and the null count is an upper bound. Pages that have
+ * never been recorded or have been forgotten are unknown and never skipped, they are recorded again by clearing their
+ * zone and adding every record of the page. VARCHAR columns are not tracked.
+ */
+class ZoneMap
+{
+public:
+  explicit ZoneMap(const RecordSchema *schema);
+
+  /**
+   * Widen the zone of the page with the values of the record, an unknown page stays unknown
+   * @param page_id
+   * @param record a record written to the page
+   */
+  void Add(page_id_t page_id, const Record &record);
+
+  /**
+   * Clear the zone of an empty page, the page is known to hold no values
+   * @param page_id
+   */
+  void Reset(page_id_t page_id);
+
+  /**
+   * Make the zone of the page unknown, for a page written without its records being added
+   * @param page_id
+   */
+  void Forget(page_id_t page_id);
+
+  /**
+   * Clear the zone of the page to record it from the records in the page, unless a WriteGuard is held
+   * @param page_id
+   * @return false if the zone is left unknown
+   */
+  auto BeginRecord(page_id_t page_id) -> bool;
+
+  auto IsRecorded(page_id_t page_id) -> bool;
+
+  /**
+   * @param page_id
+   * @param conds conditions on the fields of the table, the ones that compare a field with a value are checked,
+   * nulls compare as in CompOpOnNull
+   * @return false if no record of the page can satisfy all the conditions
+   */
+  auto MayMatch(page_id_t page_id, const ConditionVec &conds) -> bool;
+
+  /**
+   * @return the minimum of the column in the page, a null value if the page has no value of it or is unknown
+   */
+  auto GetMinValue(page_id_t page_id, size_t field_idx) -> ValueSptr;
+
+  auto GetMaxValue(page_id_t page_id, size_t field_idx) -> ValueSptr;
+
+  auto GetNullCount(page_id_t page_id, size_t field_idx) -> size_t;
+
+  /**
+   * | page num | page 1 | ... | page n |, a page is
+   * | recorded | has value of each column | null count of each column | minimums | maximums |
+   * the fields after recorded are left out for unknown pages
+   */
+  auto Serialize() const -> std::vector<char>;
+
+  void Deserialize(const char *src, size_t size);
+
+  /**
+   * Held through a write whose records are not added to the zones, the writer forgets the page it writes. No zone is
+   * recorded while a guard is held, so a zone can not be recorded from a page in the middle of the write.
+   */
+  class WriteGuard
+  {
+  public:
+    explicit WriteGuard(ZoneMap &zone_map);
+
+    ~WriteGuard();
+
+    WriteGuard(const WriteGuard &)                     = delete;
+    auto operator=(const WriteGuard &) -> WriteGuard & = delete;
+
+  private:
+    ZoneMap &zone_map_;
+  };
+
+private:
+  struct Zone
+  {
+    bool                  recorded_{false};
+    std::vector<uint8_t>  has_value_;
+    std::vector<uint32_t> null_num_;
+    std::vector<char>     min_;
+    std::vector<char>     max_;
+  };
+
+  /**
+   * @return the zone of the page, the map grows to cover the page
+   */
+  auto GetZone(page_id_t page_id) -> Zone &;
+
+  void ClearZone(Zone &zone) const;
+
+  auto GetValue(const std::vector<char> &bound, size_t col) const -> ValueSptr;
+
+  /**
+   * @return false if no value in [min, max] satisfies "value op rhs"
+   */
+  static auto RangeMayMatch(CompOp op, const ValueSptr &min, const ValueSptr &max, const ValueSptr &rhs) -> bool;
+
+  const RecordSchema *schema_;
+  mutable std::mutex  latch_;
+  std::vector<size_t> field_idx_;  // schema index of every tracked column
+  std::vector<size_t> col_idx_;    // tracked column of every field, UNTRACKED for VARCHAR fields
+  std::vector<size_t> offsets_;    // offset of the tracked columns in min_ and max_
+  size_t              zone_len_{0};
+  size_t              writers_{0};  // number of WriteGuard held
+  std::vector<Zone>   zones_;
+};
+
+}  // namespace njudb
+
+#endif  // NJUDB_ZONE_MAP_H
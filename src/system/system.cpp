@@ -31,7 +31,7 @@
 namespace njudb {
 SystemManager::SystemManager() = default;
 
-void SystemManager::Init()
+void SystemManager::Init(const SystemOptions &options)
 {
   // change working directory to the bin directory
   if (!std::filesystem::exists(DATA_DIR)) {
@@ -39,15 +39,24 @@ void SystemManager::Init()
   }
   std::filesystem::current_path(DATA_DIR);
 
-  disk_manager_        = std::make_unique<DiskManager>();
+  disk_manager_        = std::make_unique<DiskManager>(options.direct_io_);
   log_manager_         = std::make_unique<LogManager>(disk_manager_.get());
-  buffer_pool_manager_ = std::make_unique<BufferPoolManager>(disk_manager_.get(), log_manager_.get(), REPLACER_LRU_K);
+  buffer_pool_manager_ = std::make_unique<BufferPoolManager>(disk_manager_.get(),
+      log_manager_.get(),
+      REPLACER_LRU_K,
+      options.buffer_pool_partitions_,
+      options.buffer_pool_size_,
+      options.use_huge_page_);
+  buffer_pool_manager_->SetFetchExtent(options.fetch_extent_);
+  if (options.flusher_) {
+    buffer_pool_manager_->StartFlusher(options.flusher_dirty_ratio_);
+  }
   recovery_            = std::make_unique<Recovery>(disk_manager_.get(), buffer_pool_manager_.get());
   table_manager_       = std::make_unique<TableManager>(disk_manager_.get(), buffer_pool_manager_.get());
   index_manager_       = std::make_unique<IndexManager>(disk_manager_.get(), buffer_pool_manager_.get());
   parser_              = std::make_unique<Parser>();
   planner_             = std::make_unique<Planner>();
-  executor_            = std::make_unique<Executor>();
+  executor_            = std::make_unique<Executor>(options.vectorized_);
   optimizer_           = std::make_unique<Optimizer>();
   txn_manager_         = std::make_unique<TxnManager>(log_manager_.get());
   net_controller_      = std::make_unique<NetController>();
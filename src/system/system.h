@@ -34,6 +34,21 @@
 
 namespace njudb {
 
+/**
+ * @brief startup options of the njudb server
+ */
+struct SystemOptions
+{
+  size_t buffer_pool_size_{BUFFER_POOL_SIZE};              // number of frames in the buffer pool
+  size_t buffer_pool_partitions_{BUFFER_POOL_PARTITIONS};  // number of latch-sharded partitions of the buffer pool
+  bool   use_huge_page_{false};                            // back the buffer pool with huge pages
+  bool   flusher_{false};                                  // run the background flusher of the buffer pool
+  double flusher_dirty_ratio_{FLUSHER_DIRTY_RATIO};        // dirty ratio that triggers the background flusher
+  size_t fetch_extent_{1};                                 // pages loaded by a buffer pool miss, 1 loads the page only
+  bool   direct_io_{false};                                // page io bypasses the os page cache
+  bool   vectorized_{false};                               // queries are run by the vectorized executors
+};
+
 /**
  * @brief SystemManager is the main entry point for the system.
  * It manages all the components of njudb,
@@ -50,7 +65,7 @@ public:
 
   void DropDatabase(const std::string &db_name);
 
-  void Init();
+  void Init(const SystemOptions &options = {});
 
   void Run();
 
@@ -20,29 +20,79 @@
 //
 
 #include "table_manager.h"
+
+#include <algorithm>
+#include <filesystem>
+
 #include "common/page.h"
 
 namespace njudb {
+
+namespace {
+// layout of the table header before it had a magic and a version, the files were formatted with 4 KiB pages
+struct LegacyTableHeader
+{
+  size_t    page_num_;
+  page_id_t first_free_page_;  // replaced by the free space map, which is built from the pages
+  size_t    rec_num_;
+  size_t    rec_size_;
+  size_t    rec_per_page_;
+  size_t    field_num_;
+  size_t    bitmap_size_;
+  size_t    nullmap_size_;
+};
+
+auto UpgradeLegacyHeader(const LegacyTableHeader &legacy) -> TableHeader
+{
+  TableHeader header;
+  header.page_num_     = legacy.page_num_;
+  header.rec_num_      = legacy.rec_num_;
+  header.rec_size_     = legacy.rec_size_;
+  header.rec_per_page_ = legacy.rec_per_page_;
+  header.field_num_    = legacy.field_num_;
+  header.bitmap_size_  = legacy.bitmap_size_;
+  header.nullmap_size_ = legacy.nullmap_size_;
+  header.page_size_    = 4096;
+  header.extent_end_   = legacy.page_num_;
+  return header;
+}
+}  // namespace
+
 void TableManager::CreateTable(
     const std::string &db_name, const std::string &table_name, const RecordSchema &schema, StorageModel storage_model)
 {
-  if (schema.GetRecordLength() > MAX_REC_SIZE || schema.GetRecordLength() < 1) {
+  auto max_rec_size = schema.HasVarField() ? VARCHAR_REC_SIZE : MAX_REC_SIZE;
+  if (schema.GetRecordLength() > max_rec_size || schema.GetRecordLength() < 1) {
     NJUDB_THROW(NJUDB_RECLEN_ERROR, fmt::format("{}", schema.GetRecordLength()));
   }
+  if (schema.HasVarField()) {
+    // the longest record kept in a slotted page must fit in an empty page
+    TableHeader slotted_header;
+    slotted_header.bitmap_size_ = BITMAP_SIZE(SlottedPageHandle::GetMaxSlotNum(&schema));
+    if (SlottedPageHandle::GetMaxRecordSpace(&schema) > SlottedPageHandle::GetCapacity(&slotted_header)) {
+      NJUDB_THROW(NJUDB_RECLEN_ERROR, fmt::format("{}", SlottedPageHandle::GetMaxRecordSpace(&schema)));
+    }
+  }
 
   // 1. create and open table file
   DiskManager::CreateFile(FILE_NAME(db_name, table_name, TAB_SUFFIX));
   auto table_file = disk_manager_->OpenFile(FILE_NAME(db_name, table_name, TAB_SUFFIX));
   // 2. prepare table header
   TableHeader table_header;
-  table_header.page_num_        = 1;
-  table_header.first_free_page_ = INVALID_PAGE_ID;
-  table_header.rec_num_         = 0;
-  table_header.rec_size_        = schema.GetRecordLength();
-  table_header.nullmap_size_    = BITMAP_SIZE(schema.GetFieldCount());
+  table_header.page_num_     = 1;
+  table_header.rec_num_      = 0;
+  table_header.page_size_    = PAGE_SIZE;
+  table_header.rec_size_     = schema.GetRecordLength();
+  table_header.nullmap_size_ = BITMAP_SIZE(schema.GetFieldCount());
   // n = rec_per_page, PAGE_HDR_SIZE + BITMAP_SIZE(n) + n * (rec_size + nullmap_size) <= PAGE_SIZE
   table_header.rec_per_page_ = (BITMAP_WIDTH * (PAGE_SIZE - PAGE_HEADER_SIZE - 1) + 1) /
                                (1 + (table_header.rec_size_ + table_header.nullmap_size_) * BITMAP_WIDTH);
+  if (schema.HasVarField()) {
+    table_header.rec_per_page_ = SlottedPageHandle::GetMaxSlotNum(&schema);
+  } else if (storage_model == PAX_COMPRESSED_MODEL) {
+    // the encoded columns decide how many of the slots are used
+    table_header.rec_per_page_ = std::min<size_t>(table_header.rec_per_page_ * COMPRESSED_PAX_SLOT_FACTOR, UINT16_MAX);
+  }
   table_header.field_num_   = schema.GetFieldCount();
   table_header.bitmap_size_ = BITMAP_SIZE(table_header.rec_per_page_);
   // 3. write table header to the zero page
@@ -54,6 +104,9 @@ void TableManager::CreateTable(
 void TableManager::DropTable(const std::string &db_name, const std::string &table_name)
 {
   DiskManager::DestroyFile(FILE_NAME(db_name, table_name, TAB_SUFFIX));
+  if (DiskManager::FileExists(FILE_NAME(db_name, table_name, ZMP_SUFFIX))) {
+    DiskManager::DestroyFile(FILE_NAME(db_name, table_name, ZMP_SUFFIX));
+  }
 }
 
 TableHandleUptr TableManager::OpenTable(
@@ -67,12 +120,53 @@ TableHandleUptr TableManager::OpenTable(
   char            *cursor = file_hdr_data;
   memcpy(&header, cursor, sizeof(TableHeader));
   cursor += sizeof(TableHeader);
+  bool upgrade = header.magic_ != TABLE_FILE_MAGIC;
+  if (upgrade) {
+    LegacyTableHeader legacy;
+    memcpy(&legacy, file_hdr_data, sizeof(LegacyTableHeader));
+    header = UpgradeLegacyHeader(legacy);
+    cursor = file_hdr_data + sizeof(LegacyTableHeader);
+  } else if (header.version_ > TABLE_FILE_VERSION) {
+    delete[] file_hdr_data;
+    disk_manager_->CloseFile(table_file);
+    NJUDB_THROW(NJUDB_UNSUPPORTED_OP,
+        fmt::format("table {} has file format version {}, but njudb reads versions up to {}",
+            table_name, header.version_, TABLE_FILE_VERSION));
+  }
+  if (header.page_size_ != PAGE_SIZE) {
+    delete[] file_hdr_data;
+    disk_manager_->CloseFile(table_file);
+    NJUDB_THROW(NJUDB_UNSUPPORTED_OP,
+        fmt::format("table {} uses page size {}, but njudb is built with page size {}",
+            table_name, header.page_size_, PAGE_SIZE));
+  }
   // parse field schemas, field is arranged as a formatted string:
   // field_name1:field_type1:field_size1:field_name2:field_type2:field_size2:...
   schema = std::make_unique<RecordSchema>();
   cursor += schema->Deserialize(cursor);
+  if (upgrade) {
+    // the header grew, the schema is moved after it
+    memset(file_hdr_data, 0, PAGE_SIZE);
+    memcpy(file_hdr_data, &header, sizeof(TableHeader));
+    NJUDB_ASSERT(sizeof(TableHeader) + schema->SerializeSize() <= PAGE_SIZE, "schema does not fit in the header page");
+    schema->Serialize(file_hdr_data + sizeof(TableHeader));
+    disk_manager_->WritePage(table_file, FILE_HEADER_PAGE_ID, file_hdr_data);
+  }
   delete[] file_hdr_data;
-  return std::make_unique<TableHandle>(disk_manager_, buffer_pool_manager_, table_file, header, schema, storage_model);
+  auto table_handle =
+      std::make_unique<TableHandle>(disk_manager_, buffer_pool_manager_, table_file, header, schema, storage_model);
+  // the zone map file is removed once loaded, a table that is not closed properly records its zones again in scans
+  auto zone_map_file = FILE_NAME(db_name, table_name, ZMP_SUFFIX);
+  if (DiskManager::FileExists(zone_map_file)) {
+    auto size = std::filesystem::file_size(zone_map_file);
+    auto data = std::make_unique<char[]>(size);
+    auto fid  = disk_manager_->OpenFile(zone_map_file);
+    disk_manager_->ReadFile(fid, data.get(), size, 0, SEEK_SET);
+    disk_manager_->CloseFile(fid);
+    DiskManager::DestroyFile(zone_map_file);
+    table_handle->LoadZoneMap(data.get(), size);
+  }
+  return table_handle;
 }
 
 void TableManager::CloseTable(const std::string &db_name, const TableHandle &table_handle)
@@ -83,7 +177,16 @@ void TableManager::CloseTable(const std::string &db_name, const TableHandle &tab
   buffer_pool_manager_->FlushAllPages(table_handle.GetTableId());
   // delete all pages
   buffer_pool_manager_->DeleteAllPages(table_handle.GetTableId());
-  // 3. close table file
+  // 3. save the zone map next to the table file
+  auto zone_map = table_handle.SaveZoneMap();
+  if (!zone_map.empty()) {
+    auto zone_map_file = FILE_NAME(db_name, table_handle.GetTableName(), ZMP_SUFFIX);
+    DiskManager::CreateFile(zone_map_file);
+    auto fid = disk_manager_->OpenFile(zone_map_file);
+    disk_manager_->WriteFile(fid, zone_map.data(), zone_map.size(), SEEK_SET);
+    disk_manager_->CloseFile(fid);
+  }
+  // 4. close table file
   disk_manager_->CloseFile(table_handle.GetTableId());
 }
 
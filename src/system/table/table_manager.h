@@ -46,6 +46,8 @@ public:
 
   auto GetTableId(const std::string &db_name, const std::string &table_name) -> table_id_t;
 
+  [[nodiscard]] auto GetBufferPoolManager() const -> BufferPoolManager * { return buffer_pool_manager_; }
+
 private:
   void WriteTableHeader(table_id_t tid, const TableHeader &header, const RecordSchema &schema);
 
@@ -0,0 +1,183 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "common/record_comparator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace njudb;
+
+[[maybe_unused]] constexpr size_t REC_NUM = 100000;
+
+static auto GenSchema(table_id_t tid) -> RecordSchemaUptr
+{
+  std::vector<RTField> fields(3);
+  fields[0].field_ = {.table_id_ = tid, .field_name_ = "id", .field_size_ = sizeof(int), .field_type_ = TYPE_INT};
+  fields[1].field_ = {.table_id_ = tid, .field_name_ = "name", .field_size_ = 8, .field_type_ = TYPE_STRING};
+  fields[2].field_ = {
+      .table_id_ = tid, .field_name_ = "weight", .field_size_ = sizeof(float), .field_type_ = TYPE_FLOAT};
+  return std::make_unique<RecordSchema>(fields);
+}
+
+static auto GenRecords(const RecordSchema &schema, size_t num) -> std::vector<RecordUptr>
+{
+  std::mt19937             gen(0);
+  std::vector<RecordUptr>  records;
+  const char              *names[] = {"", "a", "ab", "abc", "b", "ba", "zzzzzzz"};
+  for (size_t i = 0; i < num; i++) {
+    std::vector<ValueSptr> values;
+    values.emplace_back(gen() % 17 == 0 ? ValueFactory::CreateNullValue(TYPE_INT)
+                                        : ValueFactory::CreateIntValue(static_cast<int>(gen() % 20) - 10));
+    auto name = names[gen() % 7];
+    values.emplace_back(gen() % 13 == 0 ? ValueFactory::CreateNullValue(TYPE_STRING)
+                                        : ValueFactory::CreateStringValue(name, strlen(name)));
+    values.emplace_back(ValueFactory::CreateFloatValue(static_cast<float>(gen() % 9) / 2 - 2));
+    records.push_back(std::make_unique<Record>(&schema, values, INVALID_RID));
+  }
+  return records;
+}
+
+// the comparison through values, the reference of the typed one
+static auto ValueCompare(const Record &lhs, const Record &rhs, const std::vector<size_t> &keys) -> int
+{
+  for (auto idx : keys) {
+    auto lval = lhs.GetValueAt(idx);
+    auto rval = rhs.GetValueAt(idx);
+    if (lval->IsNull() && rval->IsNull()) {
+      continue;
+    }
+    if (lval->IsNull() || rval->IsNull()) {
+      return lval->IsNull() ? -1 : 1;
+    }
+    if (*lval < *rval) {
+      return -1;
+    }
+    if (*lval > *rval) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+TEST(RecordComparatorTest, Compare)
+{
+  auto schema     = GenSchema(0);
+  auto key_schema = std::make_unique<RecordSchema>(std::vector<RTField>{schema->GetFieldAt(1), schema->GetFieldAt(0)});
+  auto records    = GenRecords(*schema, 2000);
+
+  RecordComparator all_cmp(schema.get());
+  RecordComparator key_cmp(schema.get(), key_schema.get());
+  for (size_t i = 0; i + 1 < records.size(); i++) {
+    auto &lhs = *records[i];
+    auto &rhs = *records[i + 1];
+    ASSERT_EQ(all_cmp.Compare(lhs, rhs), ValueCompare(lhs, rhs, {0, 1, 2})) << lhs.ToString() << rhs.ToString();
+    ASSERT_EQ(Record::Compare(lhs, rhs), ValueCompare(lhs, rhs, {0, 1, 2}));
+    ASSERT_EQ(key_cmp.Compare(lhs, rhs), ValueCompare(lhs, rhs, {1, 0}));
+    ASSERT_EQ(key_cmp.Compare(lhs, lhs), 0);
+  }
+}
+
+TEST(RecordComparatorTest, JoinKeys)
+{
+  // an INT key of the left joins a FLOAT key of the right
+  auto lschema = GenSchema(0);
+  auto rschema = GenSchema(1);
+  auto lkey    = std::make_unique<RecordSchema>(std::vector<RTField>{lschema->GetFieldAt(0)});
+  auto rkey    = std::make_unique<RecordSchema>(std::vector<RTField>{rschema->GetFieldAt(2)});
+  auto lrecs   = GenRecords(*lschema, 500);
+  auto rrecs   = GenRecords(*rschema, 500);
+
+  RecordComparator cmp(lschema.get(), lkey.get(), rschema.get(), rkey.get());
+  RecordHasher     lhash(lschema.get(), lkey.get());
+  RecordHasher     rhash(rschema.get(), rkey.get());
+  size_t           matches = 0;
+  for (auto &lrec : lrecs) {
+    for (auto &rrec : rrecs) {
+      auto res = cmp.Compare(*lrec, *rrec);
+      if (lrec->IsNull(0)) {
+        ASSERT_EQ(res, -1);
+        continue;
+      }
+      auto lval = static_cast<float>(std::dynamic_pointer_cast<IntValue>(lrec->GetValueAt(0))->Get());
+      auto rval = std::dynamic_pointer_cast<FloatValue>(rrec->GetValueAt(2))->Get();
+      ASSERT_EQ(res, lval < rval ? -1 : (lval > rval ? 1 : 0));
+      if (res == 0) {
+        ASSERT_EQ(lhash.Hash(*lrec), rhash.Hash(*rrec));
+        matches++;
+      }
+    }
+  }
+  ASSERT_GT(matches, 0);
+}
+
+TEST(RecordComparatorTest, PersistedHash)
+{
+  // HashIndex places its keys by Record::Hash, which hashes every field that is not null by its own type
+  auto        schema = GenSchema(0);
+  std::string name("ab", 2);
+  auto        rec    = Record(schema.get(),
+      {ValueFactory::CreateIntValue(7), ValueFactory::CreateStringValue(name.data(), name.size()),
+          ValueFactory::CreateFloatValue(1.5F)},
+      INVALID_RID);
+  name.resize(8, '\0');
+  ASSERT_EQ(rec.Hash(), std::hash<int32_t>{}(7) ^ std::hash<std::string>{}(name) ^ std::hash<float>{}(1.5F));
+  auto null_rec = Record(schema.get(),
+      {ValueFactory::CreateNullValue(TYPE_INT), ValueFactory::CreateNullValue(TYPE_STRING),
+          ValueFactory::CreateFloatValue(1.5F)},
+      INVALID_RID);
+  ASSERT_EQ(null_rec.Hash(), std::hash<float>{}(1.5F));
+}
+
+TEST(RecordComparatorTest, SortThroughput)
+{
+  auto schema     = GenSchema(0);
+  auto key_schema = std::make_unique<RecordSchema>(std::vector<RTField>{schema->GetFieldAt(1), schema->GetFieldAt(2)});
+  auto records    = GenRecords(*schema, REC_NUM);
+  std::vector<const Record *> by_value, by_type;
+  for (auto &rec : records) {
+    by_value.push_back(rec.get());
+  }
+  by_type = by_value;
+
+  auto start = std::chrono::steady_clock::now();
+  std::stable_sort(by_value.begin(), by_value.end(), [&](const Record *lhs, const Record *rhs) {
+    return Record::Compare(Record(key_schema.get(), *lhs), Record(key_schema.get(), *rhs)) < 0;
+  });
+  auto mid = std::chrono::steady_clock::now();
+  RecordComparator cmp(schema.get(), key_schema.get());
+  std::stable_sort(by_type.begin(), by_type.end(),
+      [&cmp](const Record *lhs, const Record *rhs) { return cmp.Compare(*lhs, *rhs) < 0; });
+  auto end = std::chrono::steady_clock::now();
+  ASSERT_EQ(by_value, by_type);
+  std::cout << fmt::format("sort {} records, key records: {:.1f} ms, typed comparator: {:.1f} ms",
+                   REC_NUM,
+                   std::chrono::duration<double, std::milli>(mid - start).count(),
+                   std::chrono::duration<double, std::milli>(end - mid).count())
+            << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
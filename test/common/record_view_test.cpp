@@ -0,0 +1,122 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "common/arena.h"
+#include "common/record.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace njudb;
+
+[[maybe_unused]] constexpr size_t REC_NUM = 10000;
+
+static auto GenSchema(table_id_t tid) -> RecordSchemaUptr
+{
+  std::vector<RTField> fields(3);
+  fields[0].field_ = {.table_id_ = tid, .field_name_ = "id", .field_size_ = sizeof(int), .field_type_ = TYPE_INT};
+  fields[1].field_ = {.table_id_ = tid, .field_name_ = "name", .field_size_ = 13, .field_type_ = TYPE_STRING};
+  fields[2].field_ = {
+      .table_id_ = tid, .field_name_ = "weight", .field_size_ = sizeof(float), .field_type_ = TYPE_FLOAT};
+  return std::make_unique<RecordSchema>(fields);
+}
+
+static auto GenRecord(const RecordSchema &schema, int id) -> RecordUptr
+{
+  std::vector<ValueSptr> values;
+  values.emplace_back(ValueFactory::CreateIntValue(id));
+  auto name = std::to_string(id * 7);
+  values.emplace_back(id % 5 == 0 ? ValueFactory::CreateNullValue(TYPE_STRING)
+                                  : ValueFactory::CreateStringValue(name.c_str(), name.size()));
+  values.emplace_back(ValueFactory::CreateFloatValue(static_cast<float>(id) / 4));
+  return std::make_unique<Record>(&schema, values, INVALID_RID);
+}
+
+static void CheckSame(const RecordView &view, const Record &rec)
+{
+  ASSERT_EQ(view.GetSchema(), rec.GetSchema());
+  ASSERT_EQ(memcmp(view.GetData(), rec.GetData(), rec.GetSchema()->GetRecordLength()), 0);
+  ASSERT_EQ(memcmp(view.GetNullMap(), rec.GetNullMap(), BITMAP_SIZE(rec.GetSchema()->GetFieldCount())), 0);
+  ASSERT_EQ(view.ToString(), rec.ToString());
+}
+
+TEST(ArenaTest, Allocate)
+{
+  Arena arena(1024);
+  ASSERT_EQ(arena.GetReservedBytes(), 0);
+  for (size_t i = 1; i < 200; i++) {
+    auto align = size_t{1} << (i % 5);
+    auto mem   = arena.Allocate(i, align);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(mem) % align, 0);
+    memset(mem, static_cast<int>(i), i);
+  }
+  // a request larger than a block takes a block of its own
+  auto big = arena.Allocate(4096);
+  memset(big, 0, 4096);
+  auto reserved = arena.GetReservedBytes();
+  ASSERT_GE(reserved, arena.GetUsedBytes());
+
+  arena.Reset();
+  ASSERT_EQ(arena.GetUsedBytes(), 0);
+  ASSERT_LT(arena.GetReservedBytes(), reserved);
+  // the first block is reused
+  arena.Allocate(16);
+  ASSERT_EQ(arena.GetReservedBytes(), 1024);
+}
+
+TEST(RecordViewTest, Build)
+{
+  auto  left_schema  = GenSchema(0);
+  auto  right_schema = GenSchema(1);
+  auto  fields       = left_schema->GetFields();
+  auto &right_fields = right_schema->GetFields();
+  fields.insert(fields.end(), right_fields.begin(), right_fields.end());
+  auto concat_schema = std::make_unique<RecordSchema>(fields);
+  auto proj_schema =
+      std::make_unique<RecordSchema>(std::vector<RTField>{left_schema->GetFieldAt(2), left_schema->GetFieldAt(1)});
+
+  Arena arena;
+  for (size_t i = 0; i < REC_NUM; i++) {
+    auto left  = GenRecord(*left_schema, static_cast<int>(i));
+    auto right = GenRecord(*right_schema, static_cast<int>(REC_NUM - i));
+
+    RecordView view = *left;
+    ASSERT_EQ(view.IsNull(1), i % 5 == 0);
+    ASSERT_EQ(view.GetValueAt(0)->ToString(), left->GetValueAt(0)->ToString());
+
+    auto copy = RecordView::Copy(arena, view);
+    CheckSame(copy, *left);
+    CheckSame(RecordView::Project(arena, proj_schema.get(), copy), Record(proj_schema.get(), *left));
+    CheckSame(RecordView::Concat(arena, concat_schema.get(), copy, *right), Record(concat_schema.get(), *left, *right));
+    CheckSame(RecordView::MakeNull(arena, right_schema.get()), Record(right_schema.get()));
+    ASSERT_TRUE(*copy.ToRecord() == *left);
+    // the records built for one chunk are released together
+    if (i % 100 == 99) {
+      arena.Reset();
+    }
+  }
+  // all the records fit in the first block
+  ASSERT_EQ(arena.GetReservedBytes(), ARENA_BLOCK_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
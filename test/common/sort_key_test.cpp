@@ -0,0 +1,106 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "common/record_comparator.h"
+#include "common/sort_key.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace njudb;
+
+[[maybe_unused]] constexpr size_t REC_NUM = 5000;
+
+static auto GenSchema() -> RecordSchemaUptr
+{
+  std::vector<RTField> fields(4);
+  fields[0].field_ = {.table_id_ = 0, .field_name_ = "id", .field_size_ = sizeof(int), .field_type_ = TYPE_INT};
+  fields[1].field_ = {.table_id_ = 0, .field_name_ = "name", .field_size_ = 8, .field_type_ = TYPE_STRING};
+  fields[2].field_ = {.table_id_ = 0, .field_name_ = "weight", .field_size_ = sizeof(float), .field_type_ = TYPE_FLOAT};
+  fields[3].field_ = {.table_id_ = 0, .field_name_ = "flag", .field_size_ = sizeof(bool), .field_type_ = TYPE_BOOL};
+  return std::make_unique<RecordSchema>(fields);
+}
+
+static auto GenRecords(const RecordSchema &schema) -> std::vector<RecordUptr>
+{
+  std::mt19937            gen(0);
+  std::vector<RecordUptr> records;
+  const char             *names[] = {"", "a", "ab", "abc", "b", "ba", "\xe4\xb8\xad"};
+  const int               ints[]  = {INT32_MIN, -100, -1, 0, 1, 100, INT32_MAX};
+  const float             floats[] = {-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 2.5f, 1e30f};
+  for (size_t i = 0; i < REC_NUM; i++) {
+    std::vector<ValueSptr> values;
+    values.emplace_back(gen() % 11 == 0 ? ValueFactory::CreateNullValue(TYPE_INT)
+                                        : ValueSptr(ValueFactory::CreateIntValue(ints[gen() % 7])));
+    auto name = names[gen() % 7];
+    values.emplace_back(gen() % 13 == 0 ? ValueFactory::CreateNullValue(TYPE_STRING)
+                                        : ValueSptr(ValueFactory::CreateStringValue(name, strlen(name))));
+    values.emplace_back(gen() % 7 == 0 ? ValueFactory::CreateNullValue(TYPE_FLOAT)
+                                       : ValueSptr(ValueFactory::CreateFloatValue(floats[gen() % 7])));
+    values.emplace_back(ValueFactory::CreateBoolValue(gen() % 2 == 0));
+    records.push_back(std::make_unique<Record>(&schema, values, INVALID_RID));
+  }
+  return records;
+}
+
+static auto Sign(int res) -> int { return res < 0 ? -1 : (res > 0 ? 1 : 0); }
+
+TEST(SortKeyTest, Order)
+{
+  auto schema     = GenSchema();
+  auto key_schema = std::make_unique<RecordSchema>(
+      std::vector<RTField>{schema->GetFieldAt(2), schema->GetFieldAt(1), schema->GetFieldAt(0), schema->GetFieldAt(3)});
+  auto records = GenRecords(*schema);
+
+  SortKeyEncoder   asc(schema.get(), key_schema.get());
+  SortKeyEncoder   desc(schema.get(), key_schema.get(), true);
+  RecordComparator cmp(schema.get(), key_schema.get());
+  ASSERT_EQ(asc.GetKeySize(), 4 + key_schema->GetRecordLength());
+  for (size_t i = 0; i + 1 < records.size(); i++) {
+    auto &lhs = *records[i];
+    auto &rhs = *records[i + 1];
+    auto  res = cmp.Compare(lhs, rhs);
+    ASSERT_EQ(Sign(asc.Compare(asc.Encode(lhs).data(), asc.Encode(rhs).data())), res)
+        << lhs.ToString() << rhs.ToString();
+    ASSERT_EQ(Sign(desc.Compare(desc.Encode(lhs).data(), desc.Encode(rhs).data())), -res)
+        << lhs.ToString() << rhs.ToString();
+  }
+}
+
+TEST(SortKeyTest, Decode)
+{
+  auto schema  = GenSchema();
+  auto records = GenRecords(*schema);
+  for (bool is_desc : {false, true}) {
+    SortKeyEncoder encoder(schema.get(), is_desc);
+    for (auto &rec : records) {
+      // all but -0.0, which is stored as 0.0, are decoded to the same bytes
+      auto decoded = encoder.Decode(encoder.Encode(*rec).data());
+      ASSERT_EQ(Record::Compare(*decoded, *rec), 0) << rec->ToString();
+      ASSERT_EQ(memcmp(decoded->GetNullMap(), rec->GetNullMap(), BITMAP_SIZE(schema->GetFieldCount())), 0);
+      ASSERT_EQ(memcmp(decoded->GetData(), rec->GetData(), schema->GetFieldOffset(2)), 0);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
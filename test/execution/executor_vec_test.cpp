@@ -0,0 +1,481 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "../config.h"
+#include "common/types.h"
+#include "execution/executor_defs.h"
+#include "expr/condition_expr.h"
+#include "storage/storage.h"
+#include "system/handle/table_handle.h"
+#include "system/table/table_manager.h"
+
+#include <map>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+using namespace njudb;
+
+// a tuple-at-a-time executor returning the given records, the vectorized executors read it through NextChunk
+class ValuesExecutor : public AbstractExecutor
+{
+public:
+  ValuesExecutor(const RecordSchema *schema, std::vector<RecordUptr> records)
+      : AbstractExecutor(Basic), schema_(schema), records_(std::move(records))
+  {}
+
+  void Init() override
+  {
+    pos_ = 0;
+    Load();
+  }
+
+  void Next() override
+  {
+    pos_++;
+    Load();
+  }
+
+  [[nodiscard]] auto IsEnd() const -> bool override { return pos_ >= records_.size(); }
+
+  [[nodiscard]] auto GetOutSchema() const -> const RecordSchema * override { return schema_; }
+
+private:
+  void Load() { record_ = IsEnd() ? nullptr : std::make_unique<Record>(*records_[pos_]); }
+
+  const RecordSchema     *schema_;
+  std::vector<RecordUptr> records_;
+  size_t                  pos_{0};
+};
+
+static const char *cities[] = {"nanjing", "beijing", "shanghai", "suzhou", "hangzhou"};
+
+auto GenRecord(const RecordSchema &schema, int id) -> RecordUptr
+{
+  std::vector<ValueSptr> values;
+  values.emplace_back(ValueFactory::CreateIntValue(id));
+  auto city = cities[rand() % 5];
+  values.emplace_back(ValueFactory::CreateStringValue(city, strlen(city)));
+  values.emplace_back(ValueFactory::CreateIntValue(rand() % 100));
+  values.emplace_back(rand() % 10 == 0 ? ValueFactory::CreateNullValue(TYPE_FLOAT)
+                                       : ValueFactory::CreateFloatValue(static_cast<float>(rand() % 1000) / 8));
+  return std::make_unique<Record>(&schema, values, INVALID_RID);
+}
+
+auto GenSchema(table_id_t tid) -> RecordSchemaUptr
+{
+  std::vector<RTField> fields(4);
+  fields[0].field_ = {.table_id_ = tid, .field_name_ = "id", .field_size_ = sizeof(int), .field_type_ = TYPE_INT};
+  fields[1].field_ = {.table_id_ = tid, .field_name_ = "city", .field_size_ = 16, .field_type_ = TYPE_STRING};
+  fields[2].field_ = {.table_id_ = tid, .field_name_ = "score", .field_size_ = sizeof(int), .field_type_ = TYPE_INT};
+  fields[3].field_ = {
+      .table_id_ = tid, .field_name_ = "weight", .field_size_ = sizeof(float), .field_type_ = TYPE_FLOAT};
+  return std::make_unique<RecordSchema>(fields);
+}
+
+auto AggField(const RTField &field, AggType type) -> RTField
+{
+  RTField agg   = field;
+  agg.is_agg_   = true;
+  agg.agg_type_ = type;
+  if (type == AGG_COUNT || type == AGG_COUNT_STAR) {
+    agg.field_.field_type_ = TYPE_INT;
+    agg.field_.field_size_ = sizeof(int);
+  }
+  return agg;
+}
+
+auto CountRows(AbstractExecutor &executor) -> size_t
+{
+  size_t rows = 0;
+  executor.Init();
+  for (auto chunk = executor.NextChunk(); chunk != nullptr; chunk = executor.NextChunk()) {
+    EXPECT_LE(chunk->GetRowCount(), VECTOR_SIZE);
+    rows += chunk->GetSelectedCount();
+  }
+  return rows;
+}
+
+TEST(ExecutorVec, ScanFilterProjection)
+{
+  auto        disk_manager        = std::make_unique<DiskManager>();
+  auto        buffer_pool_manager = std::make_unique<BufferPoolManager>(disk_manager.get(), nullptr);
+  auto        table_manager       = std::make_unique<TableManager>(disk_manager.get(), buffer_pool_manager.get());
+  std::string table_name          = "executor_vec_scan";
+  if (!std::filesystem::exists(TEST_DIR))
+    std::filesystem::create_directory(TEST_DIR);
+  if (std::filesystem::exists(FILE_NAME(TEST_DIR, table_name, TAB_SUFFIX)))
+    std::filesystem::remove(FILE_NAME(TEST_DIR, table_name, TAB_SUFFIX));
+  auto tbl_schema = GenSchema(0);
+  table_manager->CreateTable(TEST_DIR, table_name, *tbl_schema, PAX_COMPRESSED_MODEL);
+  auto tbl     = table_manager->OpenTable(TEST_DIR, table_name, PAX_COMPRESSED_MODEL);
+  auto &schema = tbl->GetSchema();
+  std::vector<RecordUptr> records;
+  for (int i = 0; i < 5000; ++i) {
+    records.push_back(GenRecord(schema, i));
+    tbl->InsertRecord(*records.back());
+  }
+  ASSERT_EQ(CountRows(*std::make_unique<SeqScanExecutorVec>(tbl.get())), records.size());
+
+  ValueSptr city   = ValueFactory::CreateStringValue("suzhou", 6);
+  ValueSptr score  = ValueFactory::CreateIntValue(60);
+  ValueSptr weight = ValueFactory::CreateIntValue(50);
+  size_t    in_city = 0, expected = 0;
+  for (auto &record : records) {
+    in_city += *record->GetValueAt(1) == *city ? 1 : 0;
+    auto w = record->GetValueAt(3);
+    expected += *record->GetValueAt(2) >= *score && !w->IsNull() && *w < *ValueFactory::CreateFloatValue(50) ? 1 : 0;
+  }
+  // conditions pushed down to the scan and evaluated by the filter, an INT value compared with a FLOAT column
+  ASSERT_EQ(CountRows(*std::make_unique<SeqScanExecutorVec>(
+                tbl.get(), ConditionVec{Condition(OP_EQ, schema.GetFieldAt(1), city)})),
+      in_city);
+  ConditionVec conds = {Condition(OP_GE, schema.GetFieldAt(2), score), Condition(OP_LT, schema.GetFieldAt(3), weight)};
+  ASSERT_EQ(CountRows(*std::make_unique<FilterExecutorVec>(std::make_unique<SeqScanExecutorVec>(tbl.get()), conds)),
+      expected);
+
+  // the projection keeps the selection of the filter, records are walked through one by one by a tuple parent
+  auto proj_schema = std::make_unique<RecordSchema>(std::vector<RTField>{schema.GetFieldAt(2), schema.GetFieldAt(0)});
+  auto proj        = std::make_unique<ProjectionExecutorVec>(
+      std::make_unique<FilterExecutorVec>(std::make_unique<SeqScanExecutorVec>(tbl.get()), conds),
+      std::move(proj_schema));
+  size_t rows = 0;
+  for (proj->Init(); !proj->IsEnd(); proj->Next()) {
+    auto rec = proj->GetRecord();
+    ASSERT_EQ(rec->GetSchema()->GetFieldCount(), 2);
+    ASSERT_TRUE(*rec->GetValueAt(0) >= *score);
+    auto id = std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(1))->Get();
+    ASSERT_TRUE(*records[id]->GetValueAt(2) == *rec->GetValueAt(0));
+    rows++;
+  }
+  ASSERT_EQ(rows, expected);
+
+  // nulls compare as in the tuple engine: a null weight is not equal to 50, and only a null equals a null
+  ValueSptr null_weight = ValueFactory::CreateNullValue(TYPE_FLOAT);
+  ConditionVec null_conds  = {Condition(OP_NE, schema.GetFieldAt(3), weight),
+       Condition(OP_EQ, schema.GetFieldAt(3), null_weight),
+       Condition(OP_NE, schema.GetFieldAt(3), schema.GetFieldAt(0))};
+  for (const auto &cond : null_conds) {
+    auto matched = static_cast<size_t>(std::count_if(
+        records.begin(), records.end(), [&cond](const RecordUptr &rec) { return ConditionExpr::Eval({cond}, *rec); }));
+    ASSERT_EQ(CountRows(*std::make_unique<FilterExecutorVec>(
+                  std::make_unique<SeqScanExecutorVec>(tbl.get()), ConditionVec{cond})),
+        matched);
+    ASSERT_EQ(CountRows(*std::make_unique<SeqScanExecutorVec>(tbl.get(), ConditionVec{cond})), matched);
+  }
+  table_manager->CloseTable(TEST_DIR, *tbl);
+  table_manager->DropTable(TEST_DIR, table_name);
+}
+
+TEST(ExecutorVec, Aggregate)
+{
+  auto                    schema = GenSchema(1);
+  std::vector<RecordUptr> records;
+  for (int i = 0; i < 5000; ++i) {
+    records.push_back(GenRecord(*schema, i));
+  }
+  struct Expected
+  {
+    int   count{0}, weight_count{0}, score_sum{0}, id_min{INT32_MAX};
+    float weight_max{0};
+  };
+  std::map<std::string, Expected> expected;
+  for (auto &record : records) {
+    auto &e = expected[std::dynamic_pointer_cast<StringValue>(record->GetValueAt(1))->Get()];
+    e.count++;
+    e.score_sum += std::dynamic_pointer_cast<IntValue>(record->GetValueAt(2))->Get();
+    e.id_min = std::min(e.id_min, std::dynamic_pointer_cast<IntValue>(record->GetValueAt(0))->Get());
+    if (!record->GetValueAt(3)->IsNull()) {
+      auto w         = std::dynamic_pointer_cast<FloatValue>(record->GetValueAt(3))->Get();
+      e.weight_max   = e.weight_count == 0 ? w : std::max(e.weight_max, w);
+      e.weight_count++;
+    }
+  }
+
+  auto group_schema = std::make_unique<RecordSchema>(std::vector<RTField>{schema->GetFieldAt(1)});
+  auto agg_schema   = std::make_unique<RecordSchema>(std::vector<RTField>{
+      AggField(schema->GetFieldAt(0), AGG_COUNT_STAR),
+      AggField(schema->GetFieldAt(3), AGG_COUNT),
+      AggField(schema->GetFieldAt(2), AGG_SUM),
+      AggField(schema->GetFieldAt(0), AGG_MIN),
+      AggField(schema->GetFieldAt(3), AGG_MAX),
+      AggField(schema->GetFieldAt(2), AGG_AVG)});
+  auto values       = std::make_unique<ValuesExecutor>(schema.get(), std::move(records));
+  auto agg = std::make_unique<AggregateExecutorVec>(std::move(values), std::move(agg_schema), std::move(group_schema));
+  size_t groups = 0;
+  for (agg->Init(); !agg->IsEnd(); agg->Next()) {
+    auto  rec = agg->GetRecord();
+    auto &e   = expected.at(std::dynamic_pointer_cast<StringValue>(rec->GetValueAt(0))->Get());
+    ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(1))->Get(), e.count);
+    ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(2))->Get(), e.weight_count);
+    ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(3))->Get(), e.score_sum);
+    ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(4))->Get(), e.id_min);
+    ASSERT_EQ(std::dynamic_pointer_cast<FloatValue>(rec->GetValueAt(5))->Get(), e.weight_max);
+    ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(6))->Get(), e.score_sum / e.count);
+    groups++;
+  }
+  ASSERT_EQ(groups, expected.size());
+
+  // without group fields there is exactly one group, even for an empty input
+  auto empty = std::make_unique<ValuesExecutor>(schema.get(), std::vector<RecordUptr>{});
+  auto count = std::make_unique<AggregateExecutorVec>(std::move(empty),
+      std::make_unique<RecordSchema>(std::vector<RTField>{
+          AggField(schema->GetFieldAt(0), AGG_COUNT_STAR), AggField(schema->GetFieldAt(2), AGG_SUM)}),
+      std::make_unique<RecordSchema>(std::vector<RTField>{}));
+  count->Init();
+  ASSERT_FALSE(count->IsEnd());
+  ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(count->GetRecord()->GetValueAt(0))->Get(), 0);
+  ASSERT_TRUE(count->GetRecord()->GetValueAt(1)->IsNull());
+  count->Next();
+  ASSERT_TRUE(count->IsEnd());
+}
+
+TEST(ExecutorVec, AggregatePAXScan)
+{
+  auto        disk_manager        = std::make_unique<DiskManager>();
+  auto        buffer_pool_manager = std::make_unique<BufferPoolManager>(disk_manager.get(), nullptr);
+  auto        table_manager       = std::make_unique<TableManager>(disk_manager.get(), buffer_pool_manager.get());
+  std::string table_name          = "executor_vec_agg";
+  if (!std::filesystem::exists(TEST_DIR))
+    std::filesystem::create_directory(TEST_DIR);
+  if (std::filesystem::exists(FILE_NAME(TEST_DIR, table_name, TAB_SUFFIX)))
+    std::filesystem::remove(FILE_NAME(TEST_DIR, table_name, TAB_SUFFIX));
+  auto tbl_schema = GenSchema(3);
+  table_manager->CreateTable(TEST_DIR, table_name, *tbl_schema, PAX_COMPRESSED_MODEL);
+  auto  tbl    = table_manager->OpenTable(TEST_DIR, table_name, PAX_COMPRESSED_MODEL);
+  auto &schema = tbl->GetSchema();
+  struct Expected
+  {
+    int   count{0}, score_sum{0};
+    float weight_sum{0};
+  };
+  ValueSptr                       score = ValueFactory::CreateIntValue(60);
+  std::map<std::string, Expected> expected;
+  for (int i = 0; i < 8000; ++i) {
+    auto record = GenRecord(schema, i);
+    tbl->InsertRecord(*record);
+    if (*record->GetValueAt(2) < *score) {
+      continue;
+    }
+    auto &e = expected[std::dynamic_pointer_cast<StringValue>(record->GetValueAt(1))->Get()];
+    e.count++;
+    e.score_sum += std::dynamic_pointer_cast<IntValue>(record->GetValueAt(2))->Get();
+    if (!record->GetValueAt(3)->IsNull()) {
+      e.weight_sum += std::dynamic_pointer_cast<FloatValue>(record->GetValueAt(3))->Get();
+    }
+  }
+
+  // the columns are decoded from the pages straight into the chunks, the condition is evaluated on the encoded pages
+  ConditionVec conds = {Condition(OP_GE, schema.GetFieldAt(2), score)};
+  auto         scan  = std::make_unique<SeqScanExecutorVec>(tbl.get(), conds);
+  auto agg  = std::make_unique<AggregateExecutorVec>(std::move(scan),
+      std::make_unique<RecordSchema>(std::vector<RTField>{AggField(schema.GetFieldAt(0), AGG_COUNT_STAR),
+          AggField(schema.GetFieldAt(2), AGG_SUM),
+          AggField(schema.GetFieldAt(3), AGG_SUM)}),
+      std::make_unique<RecordSchema>(std::vector<RTField>{schema.GetFieldAt(1)}));
+  size_t groups = 0;
+  for (agg->Init(); !agg->IsEnd(); agg->Next()) {
+    auto  rec = agg->GetRecord();
+    auto &e   = expected.at(std::dynamic_pointer_cast<StringValue>(rec->GetValueAt(0))->Get());
+    ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(1))->Get(), e.count);
+    ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(2))->Get(), e.score_sum);
+    ASSERT_FLOAT_EQ(std::dynamic_pointer_cast<FloatValue>(rec->GetValueAt(3))->Get(), e.weight_sum);
+    groups++;
+  }
+  ASSERT_EQ(groups, expected.size());
+  table_manager->CloseTable(TEST_DIR, *tbl);
+  table_manager->DropTable(TEST_DIR, table_name);
+}
+
+TEST(ExecutorVec, HashJoin)
+{
+  auto                    schema = GenSchema(1);
+  std::vector<RecordUptr> records;
+  std::map<std::string, size_t> city_count;
+  for (int i = 0; i < 3000; ++i) {
+    records.push_back(GenRecord(*schema, i));
+    city_count[std::dynamic_pointer_cast<StringValue>(records.back()->GetValueAt(1))->Get()]++;
+  }
+  // every city but the last has a province, nanjing has two
+  std::vector<RTField> fields(2);
+  fields[0].field_ = {.table_id_ = 2, .field_name_ = "city", .field_size_ = 10, .field_type_ = TYPE_STRING};
+  fields[1].field_ = {.table_id_ = 2, .field_name_ = "province", .field_size_ = 10, .field_type_ = TYPE_STRING};
+  auto                    province_schema = std::make_unique<RecordSchema>(fields);
+  std::vector<std::string> provinces      = {"jiangsu", "beijing", "shanghai", "jiangsu"};
+  auto make_right = [&]() {
+    std::vector<RecordUptr> rows;
+    for (size_t i = 0; i < provinces.size(); i++) {
+      std::vector<ValueSptr> values = {ValueFactory::CreateStringValue(cities[i], strlen(cities[i])),
+          ValueFactory::CreateStringValue(provinces[i].c_str(), provinces[i].size())};
+      rows.push_back(std::make_unique<Record>(province_schema.get(), values, INVALID_RID));
+    }
+    std::vector<ValueSptr> values = {
+        ValueFactory::CreateStringValue("nanjing", 7), ValueFactory::CreateStringValue("jiangsu", 7)};
+    rows.push_back(std::make_unique<Record>(province_schema.get(), values, INVALID_RID));
+    return std::make_unique<ValuesExecutor>(province_schema.get(), std::move(rows));
+  };
+  auto make_left = [&]() {
+    std::vector<RecordUptr> rows;
+    for (auto &record : records) {
+      rows.push_back(std::make_unique<Record>(*record));
+    }
+    return std::make_unique<ValuesExecutor>(schema.get(), std::move(rows));
+  };
+  auto key_schema = [](const RTField &field) { return std::make_unique<RecordSchema>(std::vector<RTField>{field}); };
+
+  size_t inner = city_count["nanjing"] * 2 + city_count["beijing"] + city_count["shanghai"] + city_count["suzhou"];
+  auto   join  = std::make_unique<HashJoinExecutorVec>(INNER_JOIN, make_left(), make_right(),
+      key_schema(schema->GetFieldAt(1)), key_schema(fields[1]), ConditionVec{});
+  // the key of the right side is the province, only beijing and shanghai match
+  ASSERT_EQ(CountRows(*join), city_count["beijing"] + city_count["shanghai"]);
+  join = std::make_unique<HashJoinExecutorVec>(INNER_JOIN, make_left(), make_right(),
+      key_schema(schema->GetFieldAt(1)), key_schema(fields[0]), ConditionVec{});
+  ASSERT_EQ(CountRows(*join), inner);
+
+  // the join conditions filter the pairs, an outer join pads the records left without a pair
+  ValueSptr score = ValueFactory::CreateIntValue(50);
+  size_t    low   = 0;
+  for (auto &record : records) {
+    low += *record->GetValueAt(2) < *score ? 1 : 0;
+  }
+  join = std::make_unique<HashJoinExecutorVec>(OUTER_JOIN, make_left(), make_right(),
+      key_schema(schema->GetFieldAt(1)), key_schema(fields[0]),
+      ConditionVec{Condition(OP_LT, schema->GetFieldAt(2), score)});
+  size_t padded = 0, paired = 0;
+  for (join->Init(); !join->IsEnd(); join->Next()) {
+    auto rec = join->GetRecord();
+    if (rec->GetValueAt(4)->IsNull()) {
+      ASSERT_TRUE(rec->GetValueAt(5)->IsNull());
+      padded++;
+    } else {
+      ASSERT_TRUE(*rec->GetValueAt(1) == *rec->GetValueAt(4));
+      ASSERT_TRUE(*rec->GetValueAt(2) < *score);
+      paired++;
+    }
+  }
+  size_t low_paired = 0, low_unmatched = 0;
+  for (auto &record : records) {
+    auto c = std::dynamic_pointer_cast<StringValue>(record->GetValueAt(1))->Get();
+    if (*record->GetValueAt(2) < *score) {
+      low_paired += c == "nanjing" ? 2 : (c == "hangzhou" ? 0 : 1);
+      low_unmatched += c == "hangzhou" ? 1 : 0;
+    }
+  }
+  ASSERT_EQ(paired, low_paired);
+  ASSERT_EQ(padded, records.size() - low + low_unmatched);
+}
+
+TEST(ExecutorVec, Sort)
+{
+  auto                    schema = GenSchema(1);
+  std::vector<RecordUptr> records;
+  for (int i = 0; i < 20000; ++i) {
+    records.push_back(GenRecord(*schema, i));
+  }
+  auto make_child = [&]() {
+    std::vector<RecordUptr> rows;
+    for (auto &record : records) {
+      rows.push_back(std::make_unique<Record>(*record));
+    }
+    return std::make_unique<ValuesExecutor>(schema.get(), std::move(rows));
+  };
+  // order by weight, city, nulls first, records with equal keys may come in any order
+  std::vector<RTField> key_fields = {schema->GetFieldAt(3), schema->GetFieldAt(1)};
+  RecordSchema         key_schema(key_fields);
+  RecordComparator     key_cmp(schema.get(), &key_schema);
+
+  for (bool is_desc : {false, true}) {
+    std::vector<const Record *> expected;
+    for (auto &record : records) {
+      expected.push_back(record.get());
+    }
+    std::stable_sort(expected.begin(), expected.end(), [&](const Record *l, const Record *r) {
+      return is_desc ? key_cmp.Compare(*r, *l) < 0 : key_cmp.Compare(*l, *r) < 0;
+    });
+    // an 8KB buffer spills hundreds of runs, which are merged in several levels
+    for (size_t buffer_size : {SORT_BUFFER_SIZE, static_cast<size_t>(8 * 1024)}) {
+      for (size_t thread_num : {1, 4}) {
+        SortExecutorVec sort(
+            make_child(), std::make_unique<RecordSchema>(key_fields), is_desc, buffer_size, thread_num);
+        std::vector<bool> seen(records.size(), false);
+        size_t            row = 0;
+        for (sort.Init(); !sort.IsEnd(); sort.Next()) {
+          auto rec = sort.GetRecord();
+          ASSERT_LT(row, expected.size());
+          ASSERT_EQ(key_cmp.Compare(*rec, *expected[row]), 0);
+          auto id = std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(0))->Get();
+          ASSERT_FALSE(seen[id]);
+          seen[id] = true;
+          ASSERT_EQ(Record::Compare(*rec, *records[id]), 0);
+          row++;
+        }
+        ASSERT_EQ(row, records.size());
+        if (buffer_size == SORT_BUFFER_SIZE) {
+          ASSERT_EQ(sort.GetSpilledRunCount(), 0);
+        } else {
+          ASSERT_GT(sort.GetSpilledRunCount(), SORT_WAY_NUM * SORT_WAY_NUM);
+        }
+      }
+    }
+  }
+}
+
+TEST(ExecutorVec, TopN)
+{
+  auto                    schema = GenSchema(1);
+  std::vector<RecordUptr> records;
+  for (int i = 0; i < 5000; ++i) {
+    records.push_back(GenRecord(*schema, i));
+  }
+  auto make_child = [&]() {
+    std::vector<RecordUptr> rows;
+    for (auto &record : records) {
+      rows.push_back(std::make_unique<Record>(*record));
+    }
+    return std::make_unique<ValuesExecutor>(schema.get(), std::move(rows));
+  };
+  std::vector<RTField> key_fields = {schema->GetFieldAt(2), schema->GetFieldAt(3)};
+  RecordSchema         key_schema(key_fields);
+  RecordComparator     key_cmp(schema.get(), &key_schema);
+
+  for (bool is_desc : {false, true}) {
+    std::vector<int> expected(records.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(), [&](int l, int r) {
+      return is_desc ? key_cmp.Compare(*records[r], *records[l]) < 0 : key_cmp.Compare(*records[l], *records[r]) < 0;
+    });
+    // the records with equal keys come in the order of the child, the same as a stable sort
+    for (size_t limit : {0, 1, 10, 1500, 5000, 8000}) {
+      TopNExecutorVec top_n(make_child(), std::make_unique<RecordSchema>(key_fields), is_desc, limit);
+      size_t          row = 0;
+      for (top_n.Init(); !top_n.IsEnd(); top_n.Next()) {
+        auto rec = top_n.GetRecord();
+        ASSERT_LT(row, expected.size());
+        ASSERT_EQ(std::dynamic_pointer_cast<IntValue>(rec->GetValueAt(0))->Get(), expected[row]);
+        ASSERT_EQ(Record::Compare(*rec, *records[expected[row]]), 0);
+        row++;
+      }
+      ASSERT_EQ(row, std::min(limit, records.size()));
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
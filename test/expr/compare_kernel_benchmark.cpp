@@ -0,0 +1,64 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "expr/compare_kernel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+[[maybe_unused]] constexpr size_t VALUE_NUM = 1 << 20;
+[[maybe_unused]] constexpr int    ROUNDS    = 20;
+
+static auto GetBit(const std::vector<uint64_t> &bitmap, size_t i) -> bool { return (bitmap[i / 64] >> (i % 64)) & 1; }
+
+TEST(CompareKernelBenchmark, IntThroughput)
+{
+  std::vector<int32_t> values(VALUE_NUM);
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = static_cast<int32_t>(i % 1000);
+  }
+  std::vector<uint64_t> bitmap(values.size() / 64);
+  for (auto level : {njudb::SIMD_SCALAR, njudb::SIMD_SSE4, njudb::SIMD_AVX2}) {
+    if (level > njudb::CompareKernel::GetLevel()) {
+      continue;
+    }
+    std::fill(bitmap.begin(), bitmap.end(), 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+      njudb::CompareKernel::CompareInt(
+          OP_LT, reinterpret_cast<const char *>(values.data()), values.size(), 500, bitmap.data(), level);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << fmt::format("level: {}, int compare throughput: {:.0f} M values/s",
+                     static_cast<int>(level),
+                     ROUNDS * values.size() / elapsed / 1e6)
+              << std::endl;
+    ASSERT_TRUE(GetBit(bitmap, 499));
+    ASSERT_FALSE(GetBit(bitmap, 500));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,150 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "expr/compare_kernel.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// odd, so that the tails of the SIMD loops are covered
+[[maybe_unused]] constexpr size_t VALUE_NUM = 1027;
+[[maybe_unused]] constexpr size_t STR_SIZE  = 40;
+
+static const CompOp ops[] = {OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE};
+
+static auto GetBit(const std::vector<uint64_t> &bitmap, size_t i) -> bool { return (bitmap[i / 64] >> (i % 64)) & 1; }
+
+template <typename T>
+static auto Expected(CompOp op, T lhs, T rhs) -> bool
+{
+  switch (op) {
+    case OP_EQ: return lhs == rhs;
+    case OP_NE: return lhs != rhs;
+    case OP_LT: return lhs < rhs;
+    case OP_LE: return lhs <= rhs;
+    case OP_GT: return lhs > rhs;
+    default: return lhs >= rhs;
+  }
+}
+
+// the levels the cpu can run, all of them must agree with the scalar operators
+static auto Levels() -> std::vector<njudb::SimdLevel>
+{
+  std::vector<njudb::SimdLevel> levels;
+  for (auto level : {njudb::SIMD_SCALAR, njudb::SIMD_SSE4, njudb::SIMD_AVX2}) {
+    if (level <= njudb::CompareKernel::GetLevel()) {
+      levels.push_back(level);
+    }
+  }
+  return levels;
+}
+
+TEST(CompareKernelTest, Int)
+{
+  std::mt19937         gen(0);
+  std::vector<int32_t> values(VALUE_NUM);
+  for (auto &v : values) {
+    v = static_cast<int32_t>(gen() % 200) - 100;
+  }
+  values[3] = INT32_MIN;
+  values[4] = INT32_MAX;
+  // read from an odd address like a column in a page
+  std::vector<char> data(VALUE_NUM * sizeof(int32_t) + 1);
+  memcpy(data.data() + 1, values.data(), VALUE_NUM * sizeof(int32_t));
+  std::vector<uint64_t> bitmap((VALUE_NUM + 63) / 64, ~uint64_t{0});
+  for (auto level : Levels()) {
+    for (auto op : ops) {
+      for (int32_t rhs : {-100, 0, 17, INT32_MIN, INT32_MAX}) {
+        njudb::CompareKernel::CompareInt(op, data.data() + 1, VALUE_NUM, rhs, bitmap.data(), level);
+        for (size_t i = 0; i < VALUE_NUM; i++) {
+          ASSERT_EQ(GetBit(bitmap, i), Expected(op, values[i], rhs)) << level << " " << CompOpToString(op) << " " << i;
+        }
+        // the bits beyond the values are cleared
+        ASSERT_EQ(bitmap.back() >> (VALUE_NUM % 64), 0);
+      }
+    }
+  }
+}
+
+TEST(CompareKernelTest, Float)
+{
+  std::mt19937       gen(1);
+  std::vector<float> values(VALUE_NUM);
+  for (auto &v : values) {
+    v = static_cast<float>(gen() % 1000) / 8 - 60;
+  }
+  values[5] = NAN;
+  values[6] = -0.0f;
+  values[7] = INFINITY;
+  std::vector<uint64_t> bitmap((VALUE_NUM + 63) / 64);
+  for (auto level : Levels()) {
+    for (auto op : ops) {
+      for (float rhs : {0.0f, 12.5f, -60.0f, INFINITY, NAN}) {
+        njudb::CompareKernel::CompareFloat(
+            op, reinterpret_cast<const char *>(values.data()), VALUE_NUM, rhs, bitmap.data(), level);
+        for (size_t i = 0; i < VALUE_NUM; i++) {
+          ASSERT_EQ(GetBit(bitmap, i), Expected(op, values[i], rhs)) << level << " " << CompOpToString(op) << " " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(CompareKernelTest, Char)
+{
+  std::mt19937      gen(2);
+  const char       *words[] = {"nanjing", "nanjing university", "beijing", "", "\xe5\x8d\x97\xe4\xba\xac", "nan"};
+  std::vector<char> data(VALUE_NUM * STR_SIZE, 0);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    auto word = words[gen() % 6];
+    memcpy(data.data() + i * STR_SIZE, word, strlen(word));
+  }
+  // a value that differs from the constant only in its last byte
+  memset(data.data(), 'a', STR_SIZE);
+  for (size_t width : {STR_SIZE, size_t{20}, size_t{16}, size_t{7}}) {
+    std::vector<uint64_t> bitmap((VALUE_NUM * STR_SIZE / width + 63) / 64);
+    for (auto level : Levels()) {
+      for (auto op : ops) {
+        for (auto rhs : {"nanjing", "nanjinh", "", "\xe5\x8d\x97", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab"}) {
+          if (strlen(rhs) > width) {
+            continue;
+          }
+          std::vector<char> value(width, 0);
+          memcpy(value.data(), rhs, strlen(rhs));
+          // the same bytes as strings of width bytes
+          njudb::CompareKernel::CompareChar(op, data.data(), width, VALUE_NUM * STR_SIZE / width, value.data(),
+              bitmap.data(), level);
+          for (size_t i = 0; i < VALUE_NUM * STR_SIZE / width; i++) {
+            std::string lhs(data.data() + i * width, width);
+            ASSERT_EQ(GetBit(bitmap, i), Expected(op, lhs, std::string(value.data(), width)))
+                << level << " " << CompOpToString(op) << " " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,12 +15,17 @@
  - along with this program.  If not, see <https://www.gnu.org/licenses/>.
  -----------------------------------------------------------------------------*/
 #include "storage/buffer/buffer_pool_manager.h"
+#include "storage/buffer/page_guard.h"
 #include "storage/buffer/replacer/lru_replacer.h"
 #include "../config.h"
 
+#include <fcntl.h>
+#include <unistd.h>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <ctime>
+#include <random>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -437,6 +442,589 @@ TEST(BufferPoolManagerTest, MultiThread)
   }
 }
 
+TEST(BufferPoolManagerTest, Stats)
+{
+  try {
+    njudb::DiskManager::CreateFile("test_stats.tbl");
+  } catch (njudb::NJUDBException_ &e) {
+    njudb::DiskManager::DestroyFile("test_stats.tbl");
+    njudb::DiskManager::CreateFile("test_stats.tbl");
+  }
+  njudb::DiskManager       disk_manager{};
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, 4);
+  auto                     fd = disk_manager.OpenFile("test_stats.tbl");
+
+  // 8 misses, the last 4 of them evict the first 4 pages, which are dirty
+  for (page_id_t pid = 0; pid < 8; ++pid) {
+    buffer_pool_manager.FetchPage(fd, pid);
+    buffer_pool_manager.UnpinPage(fd, pid, pid < 4);
+  }
+  // 4 hits
+  for (page_id_t pid = 4; pid < 8; ++pid) {
+    buffer_pool_manager.FetchPage(fd, pid);
+    buffer_pool_manager.UnpinPage(fd, pid, false);
+  }
+  auto stats = buffer_pool_manager.GetStats();
+  ASSERT_EQ(stats.pool_size_, 4);
+  ASSERT_EQ(stats.resident_pages_, 4);
+  ASSERT_EQ(stats.dirty_pages_, 0);
+  ASSERT_EQ(stats.misses_, 8);
+  ASSERT_EQ(stats.hits_, 4);
+  ASSERT_EQ(stats.evictions_, 4);
+  ASSERT_EQ(stats.writes_.foreground_writes_, 4);
+  ASSERT_EQ(stats.writes_.background_writes_, 0);
+  ASSERT_EQ(stats.file_residency_.size(), 1);
+  ASSERT_EQ(stats.file_residency_["test_stats.tbl"], 4);
+
+  buffer_pool_manager.DeleteAllPages(fd);
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_stats.tbl");
+}
+
+TEST(BufferPoolManagerTest, MappedFile)
+{
+  try {
+    njudb::DiskManager::CreateFile("test_mapped.tbl");
+  } catch (njudb::NJUDBException_ &e) {
+    njudb::DiskManager::DestroyFile("test_mapped.tbl");
+    njudb::DiskManager::CreateFile("test_mapped.tbl");
+  }
+  njudb::DiskManager       disk_manager{};
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, 4);
+  auto                     fd = disk_manager.OpenFile("test_mapped.tbl");
+
+  // half of the pages are still dirty in the pool when the file is mapped
+  for (page_id_t pid = 0; pid < 8; ++pid) {
+    auto *page = buffer_pool_manager.FetchPage(fd, pid);
+    memcpy(page->GetData(), &pid, sizeof(pid));
+    buffer_pool_manager.UnpinPage(fd, pid, true);
+  }
+  ASSERT_EQ(buffer_pool_manager.MapFile(fd), 8);
+  auto misses = buffer_pool_manager.GetStats().misses_;
+  for (page_id_t pid = 0; pid < 8; ++pid) {
+    auto guard = buffer_pool_manager.FetchPageRead(fd, pid);
+    ASSERT_EQ(guard.GetData(), disk_manager.GetMappedPage(fd, pid));
+    ASSERT_EQ(*reinterpret_cast<const page_id_t *>(guard.GetData()), pid);
+  }
+  ASSERT_EQ(buffer_pool_manager.GetStats().misses_, misses);
+
+  // pages beyond the mapping are read through the pool
+  {
+    auto guard = buffer_pool_manager.FetchPageRead(fd, 8);
+    ASSERT_EQ(buffer_pool_manager.GetMappedPage(fd, 8), nullptr);
+    ASSERT_EQ(guard.GetPage(), buffer_pool_manager.GetFrame(fd, 8)->GetPage());
+  }
+  ASSERT_EQ(buffer_pool_manager.GetFrame(fd, 8)->GetPinCount(), 0);
+
+  buffer_pool_manager.UnmapFile(fd);
+  ASSERT_EQ(buffer_pool_manager.GetMappedPage(fd, 0), nullptr);
+  ASSERT_EQ(disk_manager.GetMappedPage(fd, 0), nullptr);
+
+  buffer_pool_manager.DeleteAllPages(fd);
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_mapped.tbl");
+}
+
+TEST(BufferPoolManagerTest, ExtentFetch)
+{
+  try {
+    njudb::DiskManager::CreateFile("test_extent.tbl");
+  } catch (njudb::NJUDBException_ &e) {
+    njudb::DiskManager::DestroyFile("test_extent.tbl");
+    njudb::DiskManager::CreateFile("test_extent.tbl");
+  }
+  njudb::DiskManager       disk_manager{};
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, 16);
+  auto                     fd = disk_manager.OpenFile("test_extent.tbl");
+
+  for (page_id_t pid = 0; pid < 8; ++pid) {
+    auto *page = buffer_pool_manager.FetchPage(fd, pid);
+    memcpy(page->GetData(), &pid, sizeof(pid));
+    buffer_pool_manager.UnpinPage(fd, pid, true);
+  }
+  // the dirty pages are written in one run
+  auto writes = disk_manager.GetPageWriteCount();
+  ASSERT_TRUE(buffer_pool_manager.FlushAllPages(fd));
+  ASSERT_EQ(disk_manager.GetPageWriteCount(), writes + 8);
+  ASSERT_EQ(buffer_pool_manager.GetStats().dirty_pages_, 0);
+  buffer_pool_manager.DeleteAllPages(fd);
+
+  // a miss on page 5 loads the extent [4, 8)
+  buffer_pool_manager.SetFetchExtent(4);
+  auto *page = buffer_pool_manager.FetchPage(fd, 5);
+  ASSERT_EQ(*reinterpret_cast<page_id_t *>(page->GetData()), 5);
+  for (page_id_t pid = 0; pid < 8; ++pid) {
+    ASSERT_EQ(buffer_pool_manager.GetFrame(fd, pid) != nullptr, pid >= 4) << pid;
+  }
+  ASSERT_EQ(buffer_pool_manager.GetFrame(fd, 5)->GetPinCount(), 1);
+  ASSERT_EQ(buffer_pool_manager.GetFrame(fd, 4)->GetPinCount(), 0);
+  buffer_pool_manager.UnpinPage(fd, 5, false);
+  for (page_id_t pid = 4; pid < 8; ++pid) {
+    page = buffer_pool_manager.FetchPage(fd, pid);
+    ASSERT_EQ(*reinterpret_cast<page_id_t *>(page->GetData()), pid);
+    buffer_pool_manager.UnpinPage(fd, pid, false);
+  }
+  ASSERT_EQ(buffer_pool_manager.GetStats().prefetches_, 4);
+
+  buffer_pool_manager.DeleteAllPages(fd);
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_extent.tbl");
+}
+
+TEST(BufferPoolManagerTest, UseOnceHint)
+{
+  try {
+    njudb::DiskManager::CreateFile("test_use_once.tbl");
+  } catch (njudb::NJUDBException_ &e) {
+    njudb::DiskManager::DestroyFile("test_use_once.tbl");
+    njudb::DiskManager::CreateFile("test_use_once.tbl");
+  }
+  for (size_t extent : {1, 4}) {
+    njudb::DiskManager       disk_manager{};
+    njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, 8);
+    auto                     fd = disk_manager.OpenFile("test_use_once.tbl");
+    // pages [0, 4) are hot, a scan over [0, 16) passes by them
+    for (page_id_t pid = 0; pid < 4; ++pid) {
+      buffer_pool_manager.FetchPage(fd, pid);
+      buffer_pool_manager.UnpinPage(fd, pid, false);
+    }
+    // the prefetched pages of the scan are loaded for it, so they are hinted at their first pin as well
+    buffer_pool_manager.SetFetchExtent(extent);
+    for (page_id_t pid = 0; pid < 16; ++pid) {
+      auto *page = buffer_pool_manager.FetchPage(fd, pid, true);
+      ASSERT_EQ(page->GetPageId(), pid);
+      buffer_pool_manager.UnpinPage(fd, pid, false);
+    }
+    for (page_id_t pid = 0; pid < 4; ++pid) {
+      ASSERT_NE(buffer_pool_manager.GetFrame(fd, pid), nullptr) << extent << " " << pid;
+    }
+    buffer_pool_manager.DeleteAllPages(fd);
+    disk_manager.CloseFile(fd);
+  }
+  njudb::DiskManager::DestroyFile("test_use_once.tbl");
+}
+
+/// partitioned buffer pool
+
+namespace partition_test {
+
+[[maybe_unused]] constexpr int    MAX_PAGES   = 64;
+[[maybe_unused]] constexpr int    THREAD_NUM  = 8;
+[[maybe_unused]] constexpr int    OPS_PER_THD = 20000;
+[[maybe_unused]] constexpr size_t POOL_SIZE   = 128;
+
+static void PrepareFile(const std::string &file_name)
+{
+  try {
+    njudb::DiskManager::CreateFile(file_name);
+  } catch (njudb::NJUDBException_ &e) {
+    // destroy and recreate the file
+    njudb::DiskManager::DestroyFile(file_name);
+    njudb::DiskManager::CreateFile(file_name);
+  }
+}
+
+static auto FetchPageRetry(njudb::BufferPoolManager &bpm, file_id_t fd, page_id_t pid) -> Page *
+{
+  Page *page = nullptr;
+  while (page == nullptr) {
+    try {
+      page = bpm.FetchPage(fd, pid);
+    } catch (njudb::NJUDBException_ &e) {
+      if (e.type_ == njudb::NJUDB_NO_FREE_FRAME) {
+        std::this_thread::yield();
+      } else {
+        throw;
+      }
+    }
+  }
+  return page;
+}
+
+TEST(BufferPoolPartitionTest, Basic)
+{
+  PrepareFile("test_partition.tbl");
+  njudb::DiskManager       disk_manager{};
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 4, 16);
+  ASSERT_EQ(buffer_pool_manager.GetPartitionNum(), 4);
+  ASSERT_EQ(buffer_pool_manager.GetPoolSize(), 16);
+
+  auto                     fd = disk_manager.OpenFile("test_partition.tbl");
+  std::vector<std::string> page_data(MAX_PAGES);
+  for (int i = 0; i < MAX_PAGES; ++i) {
+    page_data[i] = std::to_string(rand());
+    Page *page   = FetchPageRetry(buffer_pool_manager, fd, i);
+    ASSERT_EQ(page->GetFileId(), fd);
+    ASSERT_EQ(page->GetPageId(), i);
+    memcpy(page->GetData(), page_data[i].c_str(), page_data[i].size());
+    ASSERT_TRUE(buffer_pool_manager.UnpinPage(fd, i, true));
+  }
+  // pages are evicted across partitions and must be read back intact
+  for (int i = 0; i < MAX_PAGES; ++i) {
+    Page *page = FetchPageRetry(buffer_pool_manager, fd, i);
+    ASSERT_EQ(page->GetPageId(), i);
+    ASSERT_EQ(memcmp(page->GetData(), page_data[i].c_str(), page_data[i].size()), 0);
+    ASSERT_TRUE(buffer_pool_manager.UnpinPage(fd, i, false));
+  }
+  ASSERT_TRUE(buffer_pool_manager.FlushAllPages(fd));
+  ASSERT_TRUE(buffer_pool_manager.DeleteAllPages(fd));
+  for (int i = 0; i < MAX_PAGES; ++i) {
+    ASSERT_EQ(buffer_pool_manager.GetFrame(fd, i), nullptr);
+  }
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_partition.tbl");
+}
+
+TEST(BufferPoolPartitionTest, MultiThreadThroughput)
+{
+  PrepareFile("test_partition_mt.tbl");
+  for (size_t partitions : {1, 2, 4, 8}) {
+    njudb::DiskManager       disk_manager{};
+    njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, partitions, POOL_SIZE);
+    auto                     fd = disk_manager.OpenFile("test_partition_mt.tbl");
+    // the working set fits in the pool, so the loop below measures the latch overhead of hits
+    for (int i = 0; i < MAX_PAGES; ++i) {
+      Page *page = FetchPageRetry(buffer_pool_manager, fd, i);
+      memcpy(page->GetData(), &i, sizeof(int));
+      buffer_pool_manager.UnpinPage(fd, i, true);
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(THREAD_NUM);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < THREAD_NUM; ++t) {
+      threads.emplace_back([&buffer_pool_manager, fd, t] {
+        std::mt19937 gen(t);
+        for (int j = 0; j < OPS_PER_THD; ++j) {
+          page_id_t pid  = static_cast<page_id_t>(gen() % MAX_PAGES);
+          Page     *page = FetchPageRetry(buffer_pool_manager, fd, pid);
+          ASSERT_EQ(page->GetPageId(), pid);
+          ASSERT_EQ(*reinterpret_cast<int *>(page->GetData()), pid);
+          buffer_pool_manager.UnpinPage(fd, pid, false);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << fmt::format("partitions: {}, threads: {}, fetch/unpin throughput: {:.0f} ops/s",
+                     partitions,
+                     THREAD_NUM,
+                     THREAD_NUM * OPS_PER_THD / elapsed)
+              << std::endl;
+
+    buffer_pool_manager.DeleteAllPages(fd);
+    disk_manager.CloseFile(fd);
+  }
+  njudb::DiskManager::DestroyFile("test_partition_mt.tbl");
+}
+
+}  // namespace partition_test
+
+/// prefetching
+
+namespace prefetch_test {
+
+[[maybe_unused]] constexpr int    MAX_PAGES   = 32;
+[[maybe_unused]] constexpr size_t POOL_SIZE   = 16;
+[[maybe_unused]] constexpr int    THREAD_NUM  = 4;
+[[maybe_unused]] constexpr int    OPS_PER_THD = 5000;
+
+static void PrepareFile(const std::string &file_name, njudb::DiskManager &disk_manager)
+{
+  if (njudb::DiskManager::FileExists(file_name)) {
+    njudb::DiskManager::DestroyFile(file_name);
+  }
+  njudb::DiskManager::CreateFile(file_name);
+  // write the pages directly, so the buffer pool starts cold
+  auto fd = disk_manager.OpenFile(file_name);
+  char data[PAGE_SIZE]{};
+  for (int i = 0; i < MAX_PAGES; i++) {
+    memcpy(data, &i, sizeof(int));
+    disk_manager.WritePage(fd, i, data);
+  }
+  disk_manager.CloseFile(fd);
+}
+
+TEST(BufferPoolPrefetchTest, PrefetchRange)
+{
+  for (size_t partitions : {1, 4}) {
+    njudb::DiskManager disk_manager{};
+    PrepareFile("test_prefetch.tbl", disk_manager);
+    njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, partitions, POOL_SIZE);
+    auto                     fd = disk_manager.OpenFile("test_prefetch.tbl");
+
+    ASSERT_EQ(buffer_pool_manager.PrefetchRange(fd, 0, 8), 8);
+    for (int i = 0; i < 8; i++) {
+      auto *frame = buffer_pool_manager.GetFrame(fd, i);
+      ASSERT_NE(frame, nullptr);
+      // prefetched pages are evictable until someone fetches them
+      ASSERT_FALSE(frame->InUse());
+      ASSERT_EQ(*reinterpret_cast<int *>(frame->GetPage()->GetData()), i);
+    }
+    // prefetching resident pages is a no-op
+    ASSERT_EQ(buffer_pool_manager.PrefetchRange(fd, 4, 4), 4);
+
+    // a pinned page is not evicted by prefetching, the range is cut short when the pool runs out of frames
+    Page *page = buffer_pool_manager.FetchPage(fd, 0);
+    ASSERT_EQ(*reinterpret_cast<int *>(page->GetData()), 0);
+    memcpy(page->GetData() + sizeof(int), "dirty", 5);
+    auto loaded = buffer_pool_manager.PrefetchRange(fd, 8, MAX_PAGES - 8);
+    ASSERT_LT(loaded, MAX_PAGES - 8);
+    ASSERT_NE(buffer_pool_manager.GetFrame(fd, 0), nullptr);
+    ASSERT_TRUE(buffer_pool_manager.UnpinPage(fd, 0, true));
+
+    if (partitions == 1) {
+      // a range as large as the pool evicts every page, the dirty page is written back before its frame is reused
+      ASSERT_EQ(buffer_pool_manager.PrefetchRange(fd, MAX_PAGES - POOL_SIZE, POOL_SIZE), POOL_SIZE);
+      ASSERT_EQ(buffer_pool_manager.GetFrame(fd, 0), nullptr);
+      char data[PAGE_SIZE];
+      disk_manager.ReadPage(fd, 0, data);
+      ASSERT_EQ(memcmp(data + sizeof(int), "dirty", 5), 0);
+    }
+
+    buffer_pool_manager.DeleteAllPages(fd);
+    disk_manager.CloseFile(fd);
+    njudb::DiskManager::DestroyFile("test_prefetch.tbl");
+  }
+}
+
+TEST(BufferPoolPrefetchTest, ReadError)
+{
+  njudb::DiskManager disk_manager{};
+  PrepareFile("test_prefetch_err.tbl", disk_manager);
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, POOL_SIZE);
+  auto                     fd = disk_manager.OpenFile("test_prefetch_err.tbl");
+
+  // the reads fail while the file is write-only, the frames taken for them go back to the pool
+  auto rdwr_fd = dup(fd);
+  auto wr_fd   = open("test_prefetch_err.tbl", O_WRONLY);
+  dup2(wr_fd, fd);
+  close(wr_fd);
+  ASSERT_THROW(buffer_pool_manager.PrefetchRange(fd, 0, 8), njudb::NJUDBException_);
+  dup2(rdwr_fd, fd);
+  close(rdwr_fd);
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ(buffer_pool_manager.GetFrame(fd, i), nullptr);
+  }
+  // every frame can still hold a page
+  std::vector<Page *> pages;
+  for (int i = 0; i < static_cast<int>(POOL_SIZE); i++) {
+    pages.push_back(buffer_pool_manager.FetchPage(fd, i));
+    ASSERT_EQ(*reinterpret_cast<int *>(pages.back()->GetData()), i);
+  }
+  for (int i = 0; i < static_cast<int>(POOL_SIZE); i++) {
+    ASSERT_TRUE(buffer_pool_manager.UnpinPage(fd, i, false));
+  }
+  ASSERT_EQ(buffer_pool_manager.PrefetchRange(fd, POOL_SIZE, POOL_SIZE), POOL_SIZE);
+
+  buffer_pool_manager.DeleteAllPages(fd);
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_prefetch_err.tbl");
+}
+
+TEST(BufferPoolPrefetchTest, ConcurrentFetch)
+{
+  njudb::DiskManager disk_manager{};
+  PrepareFile("test_prefetch_mt.tbl", disk_manager);
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, POOL_SIZE);
+  auto                     fd = disk_manager.OpenFile("test_prefetch_mt.tbl");
+
+  // prefetches run their I/O without the latch while other threads fetch, dirty and evict the same pages
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_NUM; t++) {
+    threads.emplace_back([&buffer_pool_manager, fd, t] {
+      std::mt19937 gen(t);
+      for (int op = 0; op < OPS_PER_THD; op++) {
+        auto pid = static_cast<page_id_t>(gen() % MAX_PAGES);
+        if (op % 4 == 0) {
+          buffer_pool_manager.PrefetchRange(fd, pid, 6);
+          continue;
+        }
+        Page *page = nullptr;
+        while (page == nullptr) {
+          try {
+            page = buffer_pool_manager.FetchPage(fd, pid);
+          } catch (njudb::NJUDBException_ &e) {
+            ASSERT_EQ(e.type_, njudb::NJUDB_NO_FREE_FRAME);
+            std::this_thread::yield();
+          }
+        }
+        ASSERT_EQ(page->GetPageId(), pid);
+        ASSERT_EQ(*reinterpret_cast<int *>(page->GetData()), pid);
+        buffer_pool_manager.UnpinPage(fd, pid, op % 3 == 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_TRUE(buffer_pool_manager.FlushAllPages(fd));
+  char data[PAGE_SIZE];
+  for (int i = 0; i < MAX_PAGES; i++) {
+    disk_manager.ReadPage(fd, i, data);
+    ASSERT_EQ(*reinterpret_cast<int *>(data), i);
+  }
+  buffer_pool_manager.DeleteAllPages(fd);
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_prefetch_mt.tbl");
+}
+
+}  // namespace prefetch_test
+
+/// background flusher
+
+namespace flusher_test {
+
+[[maybe_unused]] constexpr size_t POOL_SIZE = 16;
+
+static void PrepareFile(const std::string &file_name)
+{
+  try {
+    njudb::DiskManager::CreateFile(file_name);
+  } catch (njudb::NJUDBException_ &e) {
+    njudb::DiskManager::DestroyFile(file_name);
+    njudb::DiskManager::CreateFile(file_name);
+  }
+}
+
+static void DirtyPages(njudb::BufferPoolManager &bpm, file_id_t fd, page_id_t first_pid, page_id_t last_pid)
+{
+  for (page_id_t pid = first_pid; pid < last_pid; ++pid) {
+    Page *page = bpm.FetchPage(fd, pid);
+    memcpy(page->GetData(), &pid, sizeof(page_id_t));
+    bpm.UnpinPage(fd, pid, true);
+  }
+}
+
+TEST(BufferPoolFlusherTest, FlushDirtyFrames)
+{
+  PrepareFile("test_flusher.tbl");
+  for (size_t partitions : {1, 4}) {
+    njudb::DiskManager       disk_manager{};
+    njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, partitions, POOL_SIZE);
+    auto                     fd = disk_manager.OpenFile("test_flusher.tbl");
+    DirtyPages(buffer_pool_manager, fd, 0, 8);
+    ASSERT_EQ(buffer_pool_manager.GetWriteStats().background_writes_, 0);
+
+    // a pinned page is skipped
+    buffer_pool_manager.FetchPage(fd, 3);
+    ASSERT_EQ(buffer_pool_manager.FlushDirtyFrames(), 7);
+    ASSERT_TRUE(buffer_pool_manager.GetFrame(fd, 3)->IsDirty());
+    ASSERT_TRUE(buffer_pool_manager.UnpinPage(fd, 3, false));
+    ASSERT_EQ(buffer_pool_manager.FlushDirtyFrames(), 1);
+    ASSERT_EQ(buffer_pool_manager.FlushDirtyFrames(), 0);
+
+    char data[PAGE_SIZE];
+    for (page_id_t pid = 0; pid < 8; ++pid) {
+      auto *frame = buffer_pool_manager.GetFrame(fd, pid);
+      ASSERT_FALSE(frame->IsDirty());
+      ASSERT_EQ(frame->GetPinCount(), 0);
+      disk_manager.ReadPage(fd, pid, data);
+      ASSERT_EQ(*reinterpret_cast<page_id_t *>(data), pid);
+    }
+    auto stats = buffer_pool_manager.GetWriteStats();
+    ASSERT_EQ(stats.background_writes_, 8);
+    ASSERT_EQ(stats.foreground_writes_, 0);
+
+    // the flushed frames are clean, so evicting them writes nothing
+    for (page_id_t pid = 8; pid < 8 + static_cast<page_id_t>(POOL_SIZE); ++pid) {
+      buffer_pool_manager.FetchPage(fd, pid);
+      buffer_pool_manager.UnpinPage(fd, pid, false);
+    }
+    ASSERT_EQ(buffer_pool_manager.GetWriteStats().foreground_writes_, 0);
+
+    ASSERT_TRUE(buffer_pool_manager.DeleteAllPages(fd));
+    disk_manager.CloseFile(fd);
+  }
+  njudb::DiskManager::DestroyFile("test_flusher.tbl");
+}
+
+TEST(BufferPoolFlusherTest, BackgroundFlusher)
+{
+  PrepareFile("test_flusher_bg.tbl");
+  njudb::DiskManager       disk_manager{};
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, POOL_SIZE);
+  auto                     fd = disk_manager.OpenFile("test_flusher_bg.tbl");
+  buffer_pool_manager.StartFlusher(0.25, 10, 0);
+
+  // below the watermark nothing is written
+  DirtyPages(buffer_pool_manager, fd, 0, 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(buffer_pool_manager.GetWriteStats().background_writes_, 0);
+
+  DirtyPages(buffer_pool_manager, fd, 2, 8);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (buffer_pool_manager.GetWriteStats().background_writes_ < 8 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  buffer_pool_manager.StopFlusher();
+  ASSERT_EQ(buffer_pool_manager.GetWriteStats().background_writes_, 8);
+  for (page_id_t pid = 0; pid < 8; ++pid) {
+    ASSERT_FALSE(buffer_pool_manager.GetFrame(fd, pid)->IsDirty());
+  }
+
+  ASSERT_TRUE(buffer_pool_manager.DeleteAllPages(fd));
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_flusher_bg.tbl");
+}
+
+}  // namespace flusher_test
+
+/// latch-free fetch of resident pages
+
+namespace resident_fetch_test {
+
+[[maybe_unused]] constexpr int    THREAD_NUM  = 8;
+[[maybe_unused]] constexpr int    OPS_PER_THD = 20000;
+[[maybe_unused]] constexpr size_t FRAME_NUM   = 256;
+
+TEST(BufferPoolManagerTest, ResidentPageFetch)
+{
+  try {
+    njudb::DiskManager::CreateFile("test_page_table.tbl");
+  } catch (njudb::NJUDBException_ &e) {
+    njudb::DiskManager::DestroyFile("test_page_table.tbl");
+    njudb::DiskManager::CreateFile("test_page_table.tbl");
+  }
+  njudb::DiskManager       disk_manager{};
+  njudb::BufferPoolManager buffer_pool_manager(&disk_manager, nullptr, 0, 1, FRAME_NUM);
+  auto                     fd = disk_manager.OpenFile("test_page_table.tbl");
+  for (page_id_t pid = 0; pid < 16; ++pid) {
+    Page *page = buffer_pool_manager.FetchPage(fd, pid);
+    memcpy(page->GetData(), &pid, sizeof(page_id_t));
+    buffer_pool_manager.UnpinPage(fd, pid, true);
+  }
+
+  // all pages are resident, so every fetch below pins the frame without the latch of the pool
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_NUM; ++t) {
+    threads.emplace_back([&buffer_pool_manager, fd, t] {
+      for (int i = 0; i < OPS_PER_THD; ++i) {
+        auto  pid  = static_cast<page_id_t>((i + t) % 16);
+        Page *page = buffer_pool_manager.FetchPage(fd, pid);
+        ASSERT_EQ(page->GetPageId(), pid);
+        ASSERT_EQ(*reinterpret_cast<page_id_t *>(page->GetData()), pid);
+        ASSERT_TRUE(buffer_pool_manager.UnpinPage(fd, pid, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (page_id_t pid = 0; pid < 16; ++pid) {
+    auto *frame = buffer_pool_manager.GetFrame(fd, pid);
+    ASSERT_NE(frame, nullptr);
+    ASSERT_EQ(frame->GetPinCount(), 0);
+  }
+  ASSERT_TRUE(buffer_pool_manager.DeleteAllPages(fd));
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_page_table.tbl");
+}
+
+}  // namespace resident_fetch_test
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,317 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "storage/disk/disk_manager.h"
+#include "common/config.h"
+#include "../../common/error.h"
+#include "../config.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+
+[[maybe_unused]] constexpr int MAX_PAGES = 64;
+
+static void PrepareFile(const std::string &file_name)
+{
+  if (njudb::DiskManager::FileExists(file_name)) {
+    njudb::DiskManager::DestroyFile(file_name);
+  }
+  njudb::DiskManager::CreateFile(file_name);
+}
+
+struct AlignedPages
+{
+  explicit AlignedPages(size_t n) : data_(static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, n * PAGE_SIZE)))
+  {}
+  ~AlignedPages() { std::free(data_); }
+  auto operator[](size_t i) const -> char * { return data_ + i * PAGE_SIZE; }
+  char *data_;
+};
+
+static void FillPage(char *data, int seed)
+{
+  for (size_t i = 0; i < PAGE_SIZE; i++) {
+    data[i] = static_cast<char>((seed * 31 + i) % 127);
+  }
+}
+
+TEST(DiskManagerTest, ReadPastEndOfFile)
+{
+  PrepareFile("test_disk_eof.tbl");
+  njudb::DiskManager disk_manager{};
+  auto               fd = disk_manager.OpenFile("test_disk_eof.tbl");
+
+  auto data = std::make_unique<char[]>(PAGE_SIZE);
+  FillPage(data.get(), 0);
+  disk_manager.WritePage(fd, 0, data.get());
+  // a page that has never been written reads as zeros
+  auto buf = std::make_unique<char[]>(PAGE_SIZE);
+  memset(buf.get(), 0xff, PAGE_SIZE);
+  disk_manager.ReadPage(fd, 3, buf.get());
+  for (size_t i = 0; i < PAGE_SIZE; i++) {
+    ASSERT_EQ(buf[i], 0);
+  }
+  // a page that is only partially in the file is completed with zeros
+  disk_manager.WriteFile(fd, data.get(), 10, SEEK_SET, static_cast<int>(PAGE_SIZE));
+  memset(buf.get(), 0xff, PAGE_SIZE);
+  disk_manager.ReadPageAsync(fd, 1, buf.get()).get();
+  ASSERT_EQ(memcmp(buf.get(), data.get(), 10), 0);
+  for (size_t i = 10; i < PAGE_SIZE; i++) {
+    ASSERT_EQ(buf[i], 0);
+  }
+
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_disk_eof.tbl");
+}
+
+TEST(DiskManagerTest, AsyncBatchIO)
+{
+  PrepareFile("test_disk_batch.tbl");
+  njudb::DiskManager disk_manager{};
+  std::cout << "io backend: " << disk_manager.GetIOBackendName() << std::endl;
+  auto fd = disk_manager.OpenFile("test_disk_batch.tbl");
+
+  std::vector<std::unique_ptr<char[]>> pages(MAX_PAGES);
+  std::vector<njudb::PageIO>           ios;
+  for (int i = 0; i < MAX_PAGES; i++) {
+    pages[i] = std::make_unique<char[]>(PAGE_SIZE);
+    FillPage(pages[i].get(), i);
+    ios.push_back({njudb::IOType::WRITE, fd, i, pages[i].get()});
+  }
+  for (auto &future : disk_manager.SubmitPageIO(ios)) {
+    future.get();
+  }
+
+  std::vector<std::unique_ptr<char[]>> bufs(MAX_PAGES);
+  ios.clear();
+  // read back in reverse order so that the backend can not rely on sequential offsets
+  for (int i = MAX_PAGES - 1; i >= 0; i--) {
+    bufs[i] = std::make_unique<char[]>(PAGE_SIZE);
+    ios.push_back({njudb::IOType::READ, fd, i, bufs[i].get()});
+  }
+  for (auto &future : disk_manager.SubmitPageIO(ios)) {
+    future.get();
+  }
+  for (int i = 0; i < MAX_PAGES; i++) {
+    ASSERT_EQ(memcmp(bufs[i].get(), pages[i].get(), PAGE_SIZE), 0);
+  }
+
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_disk_batch.tbl");
+}
+
+TEST(DiskManagerTest, VectoredWrite)
+{
+  PrepareFile("test_disk_vec.tbl");
+  njudb::DiskManager disk_manager{};
+  auto               fd = disk_manager.OpenFile("test_disk_vec.tbl");
+
+  std::vector<std::unique_ptr<char[]>> pages(MAX_PAGES);
+  std::vector<const char *>            bufs;
+  for (int i = 0; i < MAX_PAGES; i++) {
+    pages[i] = std::make_unique<char[]>(PAGE_SIZE);
+    FillPage(pages[i].get(), i + 2);
+    bufs.push_back(pages[i].get());
+  }
+  // pages [2, 2 + MAX_PAGES) in one call
+  disk_manager.WritePages(fd, 2, bufs);
+  ASSERT_EQ(disk_manager.GetPageWriteCount(), MAX_PAGES);
+
+  auto buf = std::make_unique<char[]>(PAGE_SIZE);
+  for (int i = 0; i < MAX_PAGES; i++) {
+    disk_manager.ReadPage(fd, i + 2, buf.get());
+    ASSERT_EQ(memcmp(buf.get(), pages[i].get(), PAGE_SIZE), 0);
+  }
+  // the hole before the first page reads as zeros
+  disk_manager.ReadPage(fd, 0, buf.get());
+  ASSERT_EQ(buf[0], 0);
+
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_disk_vec.tbl");
+}
+
+TEST(DiskManagerTest, VectoredRead)
+{
+  PrepareFile("test_disk_vec_read.tbl");
+  njudb::DiskManager disk_manager{};
+  auto               fd = disk_manager.OpenFile("test_disk_vec_read.tbl");
+
+  auto buf = std::make_unique<char[]>(PAGE_SIZE);
+  for (int i = 0; i < MAX_PAGES; i++) {
+    FillPage(buf.get(), i);
+    disk_manager.WritePage(fd, i, buf.get());
+  }
+  // the last two pages are beyond the end of file
+  std::vector<std::unique_ptr<char[]>> pages(MAX_PAGES);
+  std::vector<char *>                  bufs;
+  for (int i = 0; i < MAX_PAGES; i++) {
+    pages[i] = std::make_unique<char[]>(PAGE_SIZE);
+    memset(pages[i].get(), 0xff, PAGE_SIZE);
+    bufs.push_back(pages[i].get());
+  }
+  disk_manager.ReadPages(fd, 2, bufs);
+  for (int i = 0; i < MAX_PAGES - 2; i++) {
+    FillPage(buf.get(), i + 2);
+    ASSERT_EQ(memcmp(buf.get(), pages[i].get(), PAGE_SIZE), 0);
+  }
+  memset(buf.get(), 0, PAGE_SIZE);
+  for (int i = MAX_PAGES - 2; i < MAX_PAGES; i++) {
+    ASSERT_EQ(memcmp(buf.get(), pages[i].get(), PAGE_SIZE), 0);
+  }
+
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_disk_vec_read.tbl");
+}
+
+TEST(DiskManagerTest, AllocatePage)
+{
+  PrepareFile("test_disk_extent.tbl");
+  njudb::DiskManager disk_manager{};
+  auto               fd = disk_manager.OpenFile("test_disk_extent.tbl");
+
+  // page 0 is the file header
+  size_t page_num   = 1;
+  size_t extent_end = 0;
+  ASSERT_EQ(disk_manager.AllocatePage(fd, page_num, extent_end), 1);
+  ASSERT_EQ(page_num, 2);
+  ASSERT_EQ(extent_end, EXTENT_PAGES);
+  for (size_t i = 2; i < EXTENT_PAGES; i++) {
+    ASSERT_EQ(disk_manager.AllocatePage(fd, page_num, extent_end), static_cast<page_id_t>(i));
+    ASSERT_EQ(extent_end, EXTENT_PAGES);
+  }
+  ASSERT_EQ(disk_manager.AllocatePage(fd, page_num, extent_end), static_cast<page_id_t>(EXTENT_PAGES));
+  ASSERT_EQ(extent_end, 2 * EXTENT_PAGES);
+
+  // the extents are reserved on disk but the file size is kept
+  struct stat st{};
+  ASSERT_EQ(fstat(fd, &st), 0);
+  ASSERT_EQ(st.st_size, 0);
+  auto buf = std::make_unique<char[]>(PAGE_SIZE);
+  memset(buf.get(), 0xff, PAGE_SIZE);
+  disk_manager.ReadPage(fd, 3, buf.get());
+  ASSERT_EQ(buf[0], 0);
+
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_disk_extent.tbl");
+}
+
+TEST(DiskManagerTest, DirectIO)
+{
+  PrepareFile("test_disk_direct.tbl");
+  njudb::DiskManager disk_manager{true};
+  auto               fd = disk_manager.OpenFile("test_disk_direct.tbl");
+  if (!disk_manager.IsDirectIO(fd)) {
+    disk_manager.CloseFile(fd);
+    njudb::DiskManager::DestroyFile("test_disk_direct.tbl");
+    GTEST_SKIP() << "the file system does not support O_DIRECT";
+  }
+  // the header is written through the buffered descriptor at an unaligned size
+  char header[100];
+  memset(header, 'h', sizeof(header));
+  disk_manager.WriteFile(fd, header, sizeof(header), SEEK_SET);
+
+  AlignedPages pool(MAX_PAGES);
+  ASSERT_TRUE(njudb::DiskManager::IsDirectIOAligned(pool[0]));
+  std::vector<njudb::PageIO> ios;
+  for (int i = 1; i < MAX_PAGES; i++) {
+    FillPage(pool[i], i);
+    ios.push_back({njudb::IOType::WRITE, fd, i, pool[i]});
+  }
+  for (auto &future : disk_manager.SubmitPageIO(ios)) {
+    future.get();
+  }
+  // an unaligned buffer falls back to the buffered descriptor
+  auto unaligned = std::make_unique<char[]>(PAGE_SIZE + 1);
+  disk_manager.ReadPage(fd, 2, unaligned.get() + 1);
+  ASSERT_EQ(memcmp(unaligned.get() + 1, pool[2], PAGE_SIZE), 0);
+
+  AlignedPages read_pool(MAX_PAGES + 1);
+  for (int i = 1; i < MAX_PAGES; i++) {
+    disk_manager.ReadPage(fd, i, read_pool[i]);
+    ASSERT_EQ(memcmp(read_pool[i], pool[i], PAGE_SIZE), 0);
+  }
+  // past the end of file
+  memset(read_pool[MAX_PAGES], 'x', PAGE_SIZE);
+  disk_manager.ReadPage(fd, MAX_PAGES, read_pool[MAX_PAGES]);
+  ASSERT_EQ(read_pool[MAX_PAGES][0], 0);
+  // the header written through the page cache is visible to direct reads
+  disk_manager.ReadPage(fd, 0, read_pool[0]);
+  ASSERT_EQ(memcmp(read_pool[0], header, sizeof(header)), 0);
+
+  disk_manager.CloseFile(fd);
+  njudb::DiskManager::DestroyFile("test_disk_direct.tbl");
+}
+
+TEST(DiskManagerTest, AsyncReadPastEndOfFile)
+{
+  for (bool direct_io : {false, true}) {
+    PrepareFile("test_disk_async_eof.tbl");
+    njudb::DiskManager disk_manager{direct_io};
+    auto               fd = disk_manager.OpenFile("test_disk_async_eof.tbl");
+    // the file ends in the middle of page 1
+    AlignedPages written(2);
+    FillPage(written[0], 0);
+    FillPage(written[1], 1);
+    disk_manager.WriteFile(fd, written[0], PAGE_SIZE + PAGE_SIZE / 2, SEEK_SET);
+
+    AlignedPages               pages(3);
+    std::vector<njudb::PageIO> ios;
+    for (int i = 0; i < 3; i++) {
+      memset(pages[i], 'x', PAGE_SIZE);
+      ios.push_back({njudb::IOType::READ, fd, i, pages[i]});
+    }
+    for (auto &future : disk_manager.SubmitPageIO(ios)) {
+      future.get();
+    }
+    ASSERT_EQ(memcmp(pages[0], written[0], PAGE_SIZE), 0);
+    ASSERT_EQ(memcmp(pages[1], written[1], PAGE_SIZE / 2), 0);
+    for (size_t i = PAGE_SIZE / 2; i < PAGE_SIZE; i++) {
+      ASSERT_EQ(pages[1][i], 0);
+    }
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+      ASSERT_EQ(pages[2][i], 0);
+    }
+    disk_manager.CloseFile(fd);
+    njudb::DiskManager::DestroyFile("test_disk_async_eof.tbl");
+  }
+}
+
+TEST(DiskManagerTest, ThreadPoolBackendError)
+{
+  njudb::ThreadPoolIOBackend backend(2);
+  char                       buf[16];
+  // reading from an invalid fd reports the error through the future
+  auto futures = backend.Submit({{njudb::IOType::READ, -1, buf, sizeof(buf), 0}});
+  ASSERT_EQ(futures.size(), 1);
+  ASSERT_THROW(futures[0].get(), njudb::NJUDBException_);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  if (!std::filesystem::exists(TEST_DIR))
+    std::filesystem::create_directory(TEST_DIR);
+  std::filesystem::current_path(TEST_DIR);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,166 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "storage/buffer/page_table.h"
+#include "../config.h"
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+[[maybe_unused]] constexpr int    THREAD_NUM  = 8;
+[[maybe_unused]] constexpr int    OPS_PER_THD = 20000;
+[[maybe_unused]] constexpr size_t FRAME_NUM   = 256;
+
+TEST(PageTableTest, Basic)
+{
+  njudb::PageTable table(FRAME_NUM);
+  // (f, p) and (p, f) collide under a plain xor of fid and pid
+  frame_id_t frame_id = 0;
+  for (file_id_t fid = 0; fid < 8; ++fid) {
+    for (page_id_t pid = 0; pid < 16; ++pid) {
+      table.Insert(fid, pid, frame_id++);
+    }
+  }
+  ASSERT_EQ(table.Size(), 128);
+  frame_id = 0;
+  for (file_id_t fid = 0; fid < 8; ++fid) {
+    for (page_id_t pid = 0; pid < 16; ++pid) {
+      ASSERT_EQ(table.Find(fid, pid), frame_id++);
+    }
+  }
+  ASSERT_EQ(table.Find(8, 0), INVALID_FRAME_ID);
+
+  // erase every other page, the remaining ones must still be reachable after the backward shifts
+  for (file_id_t fid = 0; fid < 8; ++fid) {
+    for (page_id_t pid = 0; pid < 16; pid += 2) {
+      ASSERT_TRUE(table.Erase(fid, pid));
+    }
+  }
+  ASSERT_FALSE(table.Erase(0, 0));
+  ASSERT_EQ(table.Size(), 64);
+  for (file_id_t fid = 0; fid < 8; ++fid) {
+    for (page_id_t pid = 0; pid < 16; ++pid) {
+      ASSERT_EQ(table.Find(fid, pid), pid % 2 == 0 ? INVALID_FRAME_ID : fid * 16 + pid);
+    }
+  }
+  // overwrite
+  table.Insert(0, 1, 1000);
+  ASSERT_EQ(table.Find(0, 1), 1000);
+  ASSERT_EQ(table.Size(), 64);
+}
+
+TEST(PageTableTest, MapInterface)
+{
+  njudb::PageTable table(FRAME_NUM);
+  ASSERT_TRUE(table.empty());
+  ASSERT_EQ(table.find({0, 0}), table.end());
+  table[{0, 0}] = 1;
+  ASSERT_TRUE(table.insert({{0, 1}, 2}).second);
+  ASSERT_FALSE(table.insert({{0, 1}, 3}).second);
+  ASSERT_TRUE(table.emplace(njudb::fid_pid_t{1, 0}, 4).second);
+  ASSERT_EQ(table.size(), 3);
+  ASSERT_EQ(table.find({0, 1})->second, 2);
+  ASSERT_EQ(table.count({1, 0}), 1);
+  ASSERT_EQ(static_cast<frame_id_t>(table[{1, 1}]), INVALID_FRAME_ID);
+
+  // the entries added through the map interface are found under the latch, but not by readers without it
+  ASSERT_TRUE(table.HasPending());
+  ASSERT_EQ(table.Find(0, 0), 1);
+  ASSERT_EQ(table.FindPublished(0, 0), INVALID_FRAME_ID);
+  table.PublishPending();
+  ASSERT_FALSE(table.HasPending());
+  ASSERT_EQ(table.FindPublished(0, 0), 1);
+  ASSERT_EQ(table.FindPublished(1, 0), 4);
+  // moving a page to another frame hides it again
+  table[{0, 0}] = 5;
+  ASSERT_EQ(table.FindPublished(0, 0), INVALID_FRAME_ID);
+  ASSERT_EQ(table.Find(0, 0), 5);
+
+  size_t num = 0;
+  for (auto &[key, frame_id] : table) {
+    ASSERT_EQ(table.Find(key.fid, key.pid), frame_id);
+    num++;
+  }
+  ASSERT_EQ(num, 3);
+  ASSERT_EQ(table.erase({0, 1}), 1);
+  ASSERT_EQ(table.erase({0, 1}), 0);
+  for (auto it = table.begin(); it != table.end();) {
+    it = table.erase(it);
+  }
+  ASSERT_TRUE(table.empty());
+  // an erased pending entry is not brought back by the publication
+  table.PublishPending();
+  ASSERT_EQ(table.Find(0, 0), INVALID_FRAME_ID);
+}
+
+TEST(PageTableTest, ConcurrentFind)
+{
+  njudb::PageTable table(FRAME_NUM);
+  // pages of file 0 stay in the table, pages of file 1 are inserted and erased over and over
+  for (page_id_t pid = 0; pid < static_cast<page_id_t>(FRAME_NUM / 2); ++pid) {
+    table.Insert(0, pid, pid);
+  }
+  std::atomic<bool> stop{false};
+  std::thread       writer([&table, &stop] {
+    for (int round = 0; !stop.load(); ++round) {
+      for (page_id_t pid = 0; pid < static_cast<page_id_t>(FRAME_NUM / 2); ++pid) {
+        table.Insert(1, pid, round);
+      }
+      for (page_id_t pid = 0; pid < static_cast<page_id_t>(FRAME_NUM / 2); ++pid) {
+        table.Erase(1, pid);
+      }
+    }
+  });
+
+  std::vector<std::thread> readers;
+  std::atomic<size_t>      hits{0};
+  for (int t = 0; t < THREAD_NUM; ++t) {
+    readers.emplace_back([&table, &hits, t] {
+      size_t local_hits = 0;
+      for (int i = 0; i < OPS_PER_THD; ++i) {
+        auto pid      = static_cast<page_id_t>((i * 31 + t) % (FRAME_NUM / 2));
+        auto frame_id = table.Find(0, pid);
+        // a lookup may miss while entries are shifted, but never returns the frame of another page
+        ASSERT_TRUE(frame_id == pid || frame_id == INVALID_FRAME_ID);
+        local_hits += frame_id == pid ? 1 : 0;
+      }
+      hits += local_hits;
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  stop = true;
+  writer.join();
+  ASSERT_GT(hits.load(), 0);
+  for (page_id_t pid = 0; pid < static_cast<page_id_t>(FRAME_NUM / 2); ++pid) {
+    ASSERT_EQ(table.Find(0, pid), pid);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  if (!std::filesystem::exists(TEST_DIR))
+    std::filesystem::create_directory(TEST_DIR);
+  std::filesystem::current_path(TEST_DIR);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "storage/buffer/replacer/lru_replacer.h"
+#include "storage/buffer/replacer/lru_k_replacer.h"
+#include "storage/buffer/replacer/arc_replacer.h"
+#include "storage/buffer/replacer/two_queue_replacer.h"
+
+#include "common/types.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+[[maybe_unused]] constexpr size_t OPS_PER_FRAME = 16;
+
+using ReplacerFactory = std::function<std::unique_ptr<njudb::Replacer>(size_t)>;
+
+/**
+ * Replay a skewed pin/unpin workload on a full replacer and report the throughput, every miss victimizes a frame,
+ * so the cost of Victim dominates when the replacer scans all frames
+ */
+static void RunWorkload(const std::string &name, const ReplacerFactory &factory, size_t pool_size)
+{
+  auto replacer = factory(pool_size);
+  for (size_t i = 0; i < pool_size; ++i) {
+    replacer->Pin(static_cast<frame_id_t>(i));
+    replacer->Unpin(static_cast<frame_id_t>(i));
+  }
+  ASSERT_EQ(replacer->Size(), pool_size);
+
+  std::mt19937                        gen(0);
+  std::uniform_int_distribution<int>  hit_dist(0, 9);
+  std::uniform_int_distribution<long> hot_dist(0, static_cast<long>(pool_size / 10));
+  size_t                              ops    = pool_size * OPS_PER_FRAME;
+  size_t                              misses = 0;
+  auto                                start  = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ops; ++i) {
+    frame_id_t fid;
+    if (hit_dist(gen) < 8) {
+      // 80% of the accesses go to the hot 10% frames
+      fid = static_cast<frame_id_t>(hot_dist(gen));
+    } else {
+      ASSERT_TRUE(replacer->Victim(&fid));
+      misses++;
+    }
+    replacer->Pin(fid);
+    replacer->Unpin(fid);
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(replacer->Size(), pool_size);
+  std::cout << fmt::format("{:<18} frames: {:<7} ops: {:<8} victims: {:<7} throughput: {:.0f} ops/s",
+                   name,
+                   pool_size,
+                   ops,
+                   misses,
+                   ops / elapsed)
+            << std::endl;
+}
+
+TEST(ReplacerBenchmark, VictimScalability)
+{
+  std::vector<std::pair<std::string, ReplacerFactory>> replacers = {
+      {"LRUReplacer", [](size_t n) { return std::make_unique<njudb::LRUReplacer>(n); }},
+      {"LRUKReplacer", [](size_t n) { return std::make_unique<njudb::LRUKReplacer>(2, n); }},
+      {"ARCReplacer", [](size_t n) { return std::make_unique<njudb::ARCReplacer>(n); }},
+      {"TwoQueueReplacer", [](size_t n) { return std::make_unique<njudb::TwoQueueReplacer>(n); }},
+  };
+  for (size_t pool_size : {1000, 10000, 100000}) {
+    for (const auto &[name, factory] : replacers) {
+      RunWorkload(name, factory, pool_size);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -20,6 +20,9 @@
 //
 #include "storage/buffer/replacer/lru_replacer.h"
 #include "storage/buffer/replacer/lru_k_replacer.h"
+#include "storage/buffer/replacer/arc_replacer.h"
+#include "storage/buffer/replacer/two_queue_replacer.h"
+#include "storage/buffer/replacer/scan_ring_replacer.h"
 
 #include "../config.h"
 #include "common/types.h"
@@ -280,6 +283,193 @@ TEST(ReplacerTest, LRUK)
 
 }
 
+TEST(ReplacerTest, ARC)
+{
+  // frame_pages[f] is the page held by frame f, pages of a scan are numbered from 100
+  std::vector<njudb::page_key_t> frame_pages = {0, 1, 2, 3, 4, 5, 6, 7};
+  auto replacer = njudb::ARCReplacer(8, [&frame_pages](frame_id_t frame_id) { return frame_pages[frame_id]; });
+  SUB_TEST(ScanResistance)
+  {
+    // frames 0-3 hold hot pages referenced twice, they are in T2
+    for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) {
+      replacer.Pin(frame_id);
+      replacer.Unpin(frame_id);
+    }
+    for (frame_id_t frame_id = 0; frame_id < 4; ++frame_id) {
+      replacer.Pin(frame_id);
+      replacer.Unpin(frame_id);
+    }
+    ASSERT_EQ(replacer.Size(), 8);
+    // a long scan only recycles the frames of T1
+    for (njudb::page_key_t page = 100; page < 200; ++page) {
+      frame_id_t frame_id;
+      ASSERT_TRUE(replacer.Victim(&frame_id));
+      ASSERT_GE(frame_id, 4);
+      frame_pages[frame_id] = page;
+      replacer.Pin(frame_id);
+      replacer.Unpin(frame_id);
+    }
+    ASSERT_EQ(replacer.Size(), 8);
+  }
+
+  SUB_TEST(GhostHit)
+  {
+    // page 199 was evicted from T1 recently, bringing it back grows the target size of T1
+    frame_id_t frame_id;
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    auto evicted = frame_pages[frame_id];
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    auto p = replacer.GetTargetT1Size();
+    frame_pages[frame_id] = evicted;
+    replacer.Pin(frame_id);
+    ASSERT_GT(replacer.GetTargetT1Size(), p);
+    replacer.Unpin(frame_id);
+    ASSERT_EQ(replacer.Size(), 7);
+  }
+
+  SUB_TEST(PinnedNotEvicted)
+  {
+    frame_id_t frame_id;
+    while (replacer.Victim(&frame_id)) {}
+    ASSERT_EQ(replacer.Size(), 0);
+    for (frame_id_t i = 0; i < 8; ++i) {
+      frame_pages[i] = 300 + i;
+      replacer.Pin(i);
+    }
+    ASSERT_FALSE(replacer.Victim(&frame_id));
+    replacer.Unpin(5);
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    ASSERT_EQ(frame_id, 5);
+  }
+
+  SUB_TEST(RejectedVictim)
+  {
+    // the buffer pool gives up victim 5 because its page is pinned again, it is neither a ghost hit nor lost
+    auto p = replacer.GetTargetT1Size();
+    replacer.Pin(5);
+    ASSERT_EQ(replacer.GetTargetT1Size(), p);
+    replacer.Unpin(5);
+    ASSERT_EQ(replacer.Size(), 1);
+    frame_id_t frame_id;
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    ASSERT_EQ(frame_id, 5);
+    replacer.Unpin(5);
+    ASSERT_EQ(replacer.GetTargetT1Size(), p);
+    ASSERT_EQ(replacer.Size(), 1);
+  }
+}
+
+TEST(ReplacerTest, TwoQueue)
+{
+  std::vector<njudb::page_key_t> frame_pages = {0, 1, 2, 3, 4, 5, 6, 7};
+  auto replacer = njudb::TwoQueueReplacer(8, [&frame_pages](frame_id_t frame_id) { return frame_pages[frame_id]; });
+  SUB_TEST(CorrelatedReference)
+  {
+    // re-references while a page is in A1in do not promote it, so A1in is still evicted in FIFO order
+    for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) {
+      replacer.Pin(frame_id);
+      replacer.Pin(frame_id);
+      replacer.Unpin(frame_id);
+    }
+    ASSERT_EQ(replacer.Size(), 8);
+    for (frame_id_t expected = 0; expected < 8; ++expected) {
+      frame_id_t frame_id;
+      ASSERT_TRUE(replacer.Victim(&frame_id));
+      ASSERT_EQ(frame_id, expected);
+    }
+    ASSERT_EQ(replacer.Size(), 0);
+  }
+
+  SUB_TEST(ScanResistance)
+  {
+    // pages 4-7 are still remembered in A1out, loading them again puts them into Am
+    for (frame_id_t frame_id = 0; frame_id < 4; ++frame_id) {
+      frame_pages[frame_id] = 4 + frame_id;
+      replacer.Pin(frame_id);
+      replacer.Unpin(frame_id);
+    }
+    for (frame_id_t frame_id = 4; frame_id < 8; ++frame_id) {
+      frame_pages[frame_id] = 100 + frame_id;
+      replacer.Pin(frame_id);
+      replacer.Unpin(frame_id);
+    }
+    // the scan keeps evicting from A1in and never touches the hot pages in Am
+    for (njudb::page_key_t page = 200; page < 300; ++page) {
+      frame_id_t frame_id;
+      ASSERT_TRUE(replacer.Victim(&frame_id));
+      ASSERT_GE(frame_id, 4);
+      frame_pages[frame_id] = page;
+      replacer.Pin(frame_id);
+      replacer.Unpin(frame_id);
+    }
+    ASSERT_EQ(replacer.Size(), 8);
+  }
+
+  SUB_TEST(RejectedVictim)
+  {
+    // a victim of A1in that the buffer pool gives up goes back to A1in, it is not promoted to Am by its own ghost
+    frame_id_t frame_id;
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    replacer.Pin(frame_id);
+    replacer.Unpin(frame_id);
+    ASSERT_EQ(replacer.Size(), 8);
+    for (njudb::page_key_t page = 400; page < 403; ++page) {
+      frame_id_t victim;
+      ASSERT_TRUE(replacer.Victim(&victim));
+      ASSERT_GE(victim, 4);
+      ASSERT_NE(victim, frame_id);
+      frame_pages[victim] = page;
+      replacer.Pin(victim);
+      replacer.Unpin(victim);
+    }
+    frame_id_t victim;
+    ASSERT_TRUE(replacer.Victim(&victim));
+    ASSERT_EQ(victim, frame_id);
+  }
+}
+
+TEST(ReplacerTest, ScanRing)
+{
+  std::vector<njudb::page_key_t> frame_pages = {0, 1, 2, 3, 4, 5, 6, 7};
+  auto                    resolver    = [&frame_pages](frame_id_t frame_id) { return frame_pages[frame_id]; };
+  auto replacer = njudb::ScanRingReplacer(std::make_unique<njudb::TwoQueueReplacer>(8, resolver), resolver);
+  for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) {
+    replacer.Pin(frame_id);
+    replacer.Unpin(frame_id);
+  }
+  SUB_TEST(UseOnceFirst)
+  {
+    // frame 6 is read by a scan, it is reused before the older frames
+    replacer.Pin(6);
+    replacer.SetUseOnce(6);
+    replacer.Unpin(6);
+    ASSERT_EQ(replacer.Size(), 8);
+    frame_id_t frame_id;
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    ASSERT_EQ(frame_id, 6);
+    ASSERT_EQ(replacer.Size(), 7);
+  }
+
+  SUB_TEST(HintSticksToPage)
+  {
+    // frame 6 now holds another page, the hint is gone
+    frame_pages[6] = 100;
+    replacer.Pin(6);
+    replacer.Unpin(6);
+    // the hint survives plain accesses to the same page
+    replacer.Pin(3);
+    replacer.SetUseOnce(3);
+    replacer.Unpin(3);
+    replacer.Pin(3);
+    replacer.Unpin(3);
+    frame_id_t frame_id;
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    ASSERT_EQ(frame_id, 3);
+    ASSERT_TRUE(replacer.Victim(&frame_id));
+    ASSERT_NE(frame_id, 6);
+  }
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,173 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "system/handle/column_codec.h"
+
+#include <cstring>
+#include <random>
+
+#include "gtest/gtest.h"
+
+[[maybe_unused]] constexpr size_t VALUE_NUM = 1000;
+[[maybe_unused]] constexpr size_t STR_SIZE  = 16;
+
+static auto EncodeColumn(FieldType type, size_t size, const std::vector<char> &values,
+    const std::vector<bool> &nulls) -> std::vector<char>
+{
+  std::vector<char> out;
+  njudb::ColumnEncoder::Encode(type, size, values.data(), nulls, out);
+  return out;
+}
+
+static void CheckColumn(FieldType type, size_t size, const std::vector<char> &values,
+    const std::vector<bool> &nulls, const std::vector<char> &encoded)
+{
+  njudb::ColumnReader reader(type, size, nulls.size(), encoded.data());
+  ASSERT_EQ(reader.GetEncodedSize(), encoded.size());
+  std::vector<char> buf(size);
+  for (size_t i = 0; i < nulls.size(); i++) {
+    ASSERT_EQ(reader.IsNull(i), nulls[i]);
+    if (!nulls[i]) {
+      reader.Get(i, buf.data());
+      ASSERT_EQ(memcmp(buf.data(), values.data() + i * size, size), 0) << i;
+    }
+  }
+}
+
+TEST(ColumnCodecTest, Dict)
+{
+  std::vector<char> values(VALUE_NUM * STR_SIZE, 0);
+  std::vector<bool> nulls(VALUE_NUM, false);
+  const char       *cities[] = {"nanjing", "beijing", "shanghai", "suzhou", "hangzhou"};
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    strcpy(values.data() + i * STR_SIZE, cities[(i * 7) % 5]);
+    nulls[i] = i % 13 == 0;
+  }
+  auto encoded = EncodeColumn(TYPE_STRING, STR_SIZE, values, nulls);
+  CheckColumn(TYPE_STRING, STR_SIZE, values, nulls, encoded);
+  njudb::ColumnReader reader(TYPE_STRING, STR_SIZE, VALUE_NUM, encoded.data());
+  ASSERT_EQ(reader.GetEncoding(), njudb::kDict);
+  // 3 bits for each of the 5 distinct values
+  ASSERT_LT(encoded.size(), VALUE_NUM * STR_SIZE / 4);
+
+  std::vector<bool> sel(VALUE_NUM, true);
+  reader.Select(OP_EQ, njudb::ValueFactory::CreateStringValue("suzhou", 6), sel);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    ASSERT_EQ(sel[i], !nulls[i] && (i * 7) % 5 == 3) << i;
+  }
+  // a null is not equal to a value
+  std::vector<bool> ne(VALUE_NUM, true);
+  reader.Select(OP_NE, njudb::ValueFactory::CreateStringValue("suzhou", 6), ne);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    ASSERT_EQ(ne[i], nulls[i] || (i * 7) % 5 != 3) << i;
+  }
+  // a null is equal to a null only
+  std::vector<bool> eq_null(VALUE_NUM, true);
+  reader.Select(OP_EQ, njudb::ValueFactory::CreateNullValue(TYPE_STRING), eq_null);
+  ASSERT_EQ(eq_null, nulls);
+}
+
+TEST(ColumnCodecTest, FrameOfRef)
+{
+  std::vector<char> values(VALUE_NUM * sizeof(int), 0);
+  std::vector<bool> nulls(VALUE_NUM, false);
+  std::mt19937      gen(0);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    int v = -100000 + static_cast<int>(gen() % 200);
+    memcpy(values.data() + i * sizeof(int), &v, sizeof(int));
+    nulls[i] = i % 17 == 0;
+  }
+  auto encoded = EncodeColumn(TYPE_INT, sizeof(int), values, nulls);
+  CheckColumn(TYPE_INT, sizeof(int), values, nulls, encoded);
+  njudb::ColumnReader reader(TYPE_INT, sizeof(int), VALUE_NUM, encoded.data());
+  ASSERT_EQ(reader.GetEncoding(), njudb::kFrameOfRef);
+  ASSERT_LT(encoded.size(), VALUE_NUM * sizeof(int) / 3);
+
+  for (auto op : {OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE}) {
+    for (int rhs : {-100100, -100000, -99950, -99801, 0}) {
+      std::vector<bool> sel(VALUE_NUM, true);
+      reader.Select(op, njudb::ValueFactory::CreateIntValue(rhs), sel);
+      for (size_t i = 0; i < VALUE_NUM; i++) {
+        ASSERT_EQ(sel[i], njudb::EvalCompOp(op, reader.GetValue(i), njudb::ValueFactory::CreateIntValue(rhs)));
+      }
+    }
+  }
+  // the extreme values need 32 bits of offset
+  std::vector<char> extreme(2 * sizeof(int));
+  int               lo = INT32_MIN, hi = INT32_MAX;
+  memcpy(extreme.data(), &lo, sizeof(int));
+  memcpy(extreme.data() + sizeof(int), &hi, sizeof(int));
+  CheckColumn(TYPE_INT, sizeof(int), extreme, {false, false},
+      EncodeColumn(TYPE_INT, sizeof(int), extreme, {false, false}));
+}
+
+TEST(ColumnCodecTest, RunLength)
+{
+  std::vector<char> values(VALUE_NUM, 0);
+  std::vector<bool> nulls(VALUE_NUM, false);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    values[i] = static_cast<char>(i / 100 % 2);
+    nulls[i]  = i >= 500 && i < 550;
+  }
+  auto encoded = EncodeColumn(TYPE_BOOL, sizeof(bool), values, nulls);
+  CheckColumn(TYPE_BOOL, sizeof(bool), values, nulls, encoded);
+  njudb::ColumnReader reader(TYPE_BOOL, sizeof(bool), VALUE_NUM, encoded.data());
+  ASSERT_EQ(reader.GetEncoding(), njudb::kRunLength);
+  ASSERT_LT(encoded.size(), 64);
+
+  std::vector<bool> sel(VALUE_NUM, true);
+  reader.Select(OP_EQ, njudb::ValueFactory::CreateBoolValue(true), sel);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    ASSERT_EQ(sel[i], !nulls[i] && values[i] == 1) << i;
+  }
+}
+
+TEST(ColumnCodecTest, Plain)
+{
+  // random floats do not compress, they are kept plain
+  std::vector<char> values(VALUE_NUM * sizeof(float), 0);
+  std::vector<bool> nulls(VALUE_NUM, false);
+  std::mt19937      gen(1);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    float v = static_cast<float>(gen()) / 7.0f;
+    memcpy(values.data() + i * sizeof(float), &v, sizeof(float));
+  }
+  auto encoded = EncodeColumn(TYPE_FLOAT, sizeof(float), values, nulls);
+  CheckColumn(TYPE_FLOAT, sizeof(float), values, nulls, encoded);
+  njudb::ColumnReader reader(TYPE_FLOAT, sizeof(float), VALUE_NUM, encoded.data());
+  ASSERT_EQ(reader.GetEncoding(), njudb::kPlain);
+
+  std::vector<bool> sel(VALUE_NUM, true);
+  auto              rhs = reader.GetValue(VALUE_NUM / 2);
+  reader.Select(OP_LT, rhs, sel);
+  for (size_t i = 0; i < VALUE_NUM; i++) {
+    ASSERT_EQ(sel[i], njudb::EvalCompOp(OP_LT, reader.GetValue(i), rhs));
+  }
+  // a null constant is equal to no value and not equal to all of them
+  std::vector<bool> none(VALUE_NUM, true);
+  reader.Select(OP_EQ, njudb::ValueFactory::CreateNullValue(TYPE_FLOAT), none);
+  ASSERT_EQ(std::count(none.begin(), none.end(), true), 0);
+  std::vector<bool> all(VALUE_NUM, true);
+  reader.Select(OP_NE, njudb::ValueFactory::CreateNullValue(TYPE_FLOAT), all);
+  ASSERT_EQ(std::count(all.begin(), all.end(), true), VALUE_NUM);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+/*------------------------------------------------------------------------------
+ - Copyright (c) 2024. Websoft research group, Nanjing University.
+ -
+ - This program is free software: you can redistribute it and/or modify
+ - it under the terms of the GNU General Public License as published by
+ - the Free Software Foundation, either version 3 of the License, or
+ - (at your option) any later version.
+ -
+ - This program is distributed in the hope that it will be useful,
+ - but WITHOUT ANY WARRANTY; without even the implied warranty of
+ - MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ - GNU General Public License for more details.
+ -
+ - You should have received a copy of the GNU General Public License
+ - along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ -----------------------------------------------------------------------------*/
+
+#include "system/handle/free_space_map.h"
+
+#include <set>
+
+#include "gtest/gtest.h"
+
+[[maybe_unused]] constexpr size_t REC_PER_PAGE = 10;
+[[maybe_unused]] constexpr int    PAGE_NUM     = 200;
+
+TEST(FreeSpaceMapTest, Basic)
+{
+  njudb::FreeSpaceMap fsm(REC_PER_PAGE);
+  ASSERT_EQ(fsm.FindPage(), INVALID_PAGE_ID);
+  fsm.Update(1, REC_PER_PAGE);
+  ASSERT_EQ(fsm.GetPageNum(), 2);
+  ASSERT_EQ(fsm.FindPage(), INVALID_PAGE_ID);
+  // a nearly full page is used only when there is no roomy page
+  fsm.Update(1, REC_PER_PAGE - 1);
+  ASSERT_EQ(fsm.FindPage(), 1);
+  fsm.Update(PAGE_NUM - 1, REC_PER_PAGE / 2);
+  for (size_t hint = 0; hint < PAGE_NUM; hint++) {
+    ASSERT_EQ(fsm.FindPage(hint), PAGE_NUM - 1);
+  }
+  fsm.Update(PAGE_NUM - 1, REC_PER_PAGE);
+  ASSERT_EQ(fsm.FindPage(PAGE_NUM - 1), 1);
+  fsm.Update(1, REC_PER_PAGE);
+  ASSERT_EQ(fsm.FindPage(), INVALID_PAGE_ID);
+}
+
+TEST(FreeSpaceMapTest, Spread)
+{
+  njudb::FreeSpaceMap fsm(REC_PER_PAGE);
+  for (int i = 1; i < PAGE_NUM; i++) {
+    fsm.Update(i, 0);
+  }
+  // inserters with different hints start from different pages
+  std::set<page_id_t> pages;
+  for (size_t hint = 1; hint < PAGE_NUM; hint++) {
+    auto page_id = fsm.FindPage(hint);
+    ASSERT_EQ(page_id, static_cast<page_id_t>(hint));
+    pages.insert(page_id);
+  }
+  ASSERT_EQ(pages.size(), PAGE_NUM - 1);
+  // the search wraps around
+  for (int i = 2; i < PAGE_NUM; i++) {
+    fsm.Update(i, REC_PER_PAGE);
+  }
+  ASSERT_EQ(fsm.FindPage(PAGE_NUM - 1), 1);
+}
+
+TEST(FreeSpaceMapTest, Bytes)
+{
+  // slotted pages count the space in bytes, a page is taken only if it has room for the record
+  constexpr size_t    CAPACITY = 4000;
+  njudb::FreeSpaceMap fsm(CAPACITY);
+  fsm.Update(1, CAPACITY - 100);
+  fsm.Update(2, CAPACITY - 500);
+  fsm.Update(3, CAPACITY / 4);
+  ASSERT_EQ(fsm.FindPage(1, 200), 3);
+  ASSERT_EQ(fsm.FindPage(1, CAPACITY / 2), 3);
+  ASSERT_EQ(fsm.FindPage(1, CAPACITY), INVALID_PAGE_ID);
+  fsm.Update(3, CAPACITY - 10);
+  ASSERT_EQ(fsm.FindPage(3, 200), 2);
+  ASSERT_EQ(fsm.FindPage(3, 50), 1);
+  ASSERT_EQ(fsm.FindPage(3, 600), INVALID_PAGE_ID);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}